@@ -0,0 +1,81 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#ifndef RESOURCE_TUNER_TUNE_COALESCER_H
+#define RESOURCE_TUNER_TUNE_COALESCER_H
+
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <unordered_map>
+
+#include "UrmAPIs.h"
+
+/**
+ * @brief TuneCoalescer
+ * @details Tracks the Tune Requests issued by the client, so that identical Requests issued
+ *          within the coalescing window are served by the existing Request. Requests are keyed
+ *          by the issuing thread along with the contents of the Request (except for the duration),
+ *          since the Server only accepts a Retune for a Request from the thread which issued it.
+ */
+class TuneCoalescer {
+public:
+    /**
+     * @brief Extends the Request with the given handle to the given duration.
+     * @return 0 if the Server accepted the Retune, -1 otherwise.
+     */
+    typedef std::function<int8_t(int64_t handle, int64_t duration)> RetuneFn;
+
+    TuneCoalescer();
+
+    /**
+     * @brief Set the coalescing window, 0 disables coalescing and drops the tracked Requests.
+     */
+    void setWindow(std::chrono::milliseconds window);
+    int8_t isEnabled();
+    void getStats(UrmCoalescingStats* stats);
+
+    static std::string makeKey(int32_t threadId, int32_t properties, int32_t numRes, const SysResource* resourceList);
+
+    /**
+     * @brief Serve a Tune from the tracked Request with the given key, if there is one.
+     * @details The tracked Request is extended via retune if it does not outlast the new one.
+     *          If the Retune is not accepted, the Request is no longer tracked.
+     * @return The handle of the tracked Request, or -1 if a new Request has to be issued.
+     */
+    int64_t coalesce(const std::string& key, int64_t duration, const RetuneFn& retune);
+
+    void track(const std::string& key, int64_t handle, int64_t duration);
+
+    /**
+     * @brief The Request is gone (untuned or rejected), it can no longer be coalesced into.
+     */
+    void forget(int64_t handle);
+
+    // The state is held across fork, so that the child does not inherit any of it mid-update.
+    void lockForFork();
+    void unlockForFork();
+
+    /**
+     * @brief Drop the tracked Requests (they were issued by the parent) and release the lock.
+     */
+    void resetInChild();
+
+private:
+    typedef struct {
+        int64_t mHandle;
+        int64_t mDuration;
+        std::chrono::steady_clock::time_point mLastIssued;
+        std::chrono::steady_clock::time_point mExpiresAt; //!< time_point::max() for infinite Requests.
+    } CoalescedTune;
+
+    static const size_t mMaxTrackedTunes = 64;
+
+    std::mutex mLock;
+    std::chrono::milliseconds mWindow;
+    std::unordered_map<std::string, CoalescedTune> mTunes;
+    UrmCoalescingStats mStats;
+};
+
+#endif
@@ -41,17 +41,69 @@ extern "C" {
  * @return int64_t:\n
  *            - A Positive Integer Handle which uniquely identifies the issued Request. The handle is used for future retune / untune APIs.\n
  *            - -1: If the Request could not be sent to the server.
+ * @note Handles are normally assigned locally, from a block leased from the Server, in which case the
+ *       call does not wait on the Server, and a rejection is reported via the rejection callback
+ *       (see setRejectionCallback). This covers the Requests rejected on admission, i.e. those which
+ *       could not be dispatched, or failed verification, permission, rate limit or duplicate checks.
  */
 int64_t tuneResources(int64_t duration, int32_t prop, int32_t numRes, SysResource* resourceList);
 
+/**
+ * @brief Completion callback for the asynchronous Tune APIs.
+ * @details Invoked on the client library's I/O thread, hence it must not block, and must not
+ *          call any of the blocking APIs (they would fail with -1).
+ * @param handle The Request Handle, or -1 if the Request could not be sent or was rejected.
+ * @param userData The opaque pointer passed when issuing the Request.
+ */
+typedef void (*UrmCompletionCallback)(int64_t handle, void* userData);
+
+/**
+ * @brief Rejection callback, for Tune Requests issued with a locally assigned handle.
+ * @details Invoked on the client library's I/O thread, the same restrictions as for
+ *          UrmCompletionCallback apply.
+ * @param handle The handle of the rejected Request.
+ * @param userData The opaque pointer passed to setRejectionCallback.
+ */
+typedef void (*UrmRejectionCallback)(int64_t handle, void* userData);
+
+/**
+ * @brief Register the callback to be notified of rejected Tune Requests.
+ * @details Requests issued with a locally assigned handle are not waited on, hence the Server
+ *          reports their rejection on admission asynchronously (refer tuneResources).
+ *          Without a callback, rejections are only logged.
+ * @param callback Rejection callback, NULL to unregister.
+ * @param userData Opaque pointer, passed as is to the callback.
+ * @return int8_t:\n
+ *            - 0: If the callback was registered.\n
+ *            - -1: Otherwise.
+ */
+int8_t setRejectionCallback(UrmRejectionCallback callback, void* userData);
+
+/**
+ * @brief Asynchronous variant of tuneResources.
+ * @details The call returns as soon as the Request is queued, the handle is delivered via the callback.
+ *          Requests issued by multiple threads of a process are in flight concurrently.
+ * @param callback Completion callback, can be NULL if the caller is not interested in the handle.
+ * @param userData Opaque pointer, passed as is to the callback.
+ * @return int8_t:\n
+ *            - 0: If the Request was queued.\n
+ *            - -1: Otherwise (the callback is not invoked).
+ */
+int8_t tuneResourcesAsync(int64_t duration,
+                          int32_t properties,
+                          int32_t numRes,
+                          SysResource* resourceList,
+                          UrmCompletionCallback callback,
+                          void* userData);
+
 /**
  * @brief Modify the duration of a previously issued Tune Request.
  * @details Use this API to increase the duration (in milliseconds) of an existing Request issued via.
  * @param handle Request Handle, returned by tuneResources.
  * @param duration The new duration for the previously issued Tune request. A value of -1 denotes infinite duration.
  * @return int8_t:\n
- *            - 0: If the Request was successfully submitted to the server.\n
- *            - -1: Otherwise.
+ *            - 0: If the Request was accepted by the server.\n
+ *            - -1: Otherwise, for example if the original Request is no longer active.
  */
 int8_t retuneResources(int64_t handle, int64_t duration);
 
@@ -117,6 +169,26 @@ int64_t tuneSignal(uint32_t sigId,
                    int32_t numArgs,
                    uint32_t* list);
 
+/**
+ * @brief Asynchronous variant of tuneSignal.
+ * @details The call returns as soon as the Request is queued, the handle is delivered via the callback.
+ * @param callback Completion callback, can be NULL if the caller is not interested in the handle.
+ * @param userData Opaque pointer, passed as is to the callback.
+ * @return int8_t:\n
+ *            - 0: If the Request was queued.\n
+ *            - -1: Otherwise (the callback is not invoked).
+ */
+int8_t tuneSignalAsync(uint32_t sigId,
+                       uint32_t sigType,
+                       int64_t duration,
+                       int32_t properties,
+                       const char* appName,
+                       const char* scenario,
+                       int32_t numArgs,
+                       uint32_t* list,
+                       UrmCompletionCallback callback,
+                       void* userData);
+
 /**
  * @brief Relay the signal to all the features subscribed to the signal with the given ID.
  * @details Use this API to issue Signal Relay Requests.
@@ -163,6 +235,129 @@ int8_t relaySignal(uint32_t sigId,
  */
 int8_t untuneSignal(int64_t handle);
 
+/**
+ * @struct TuneRequest
+ * @brief Parameters of a single Tune Request, issued as part of the tuneResourcesBatch API.
+ *        The fields carry the same meaning as the corresponding tuneResources arguments.
+ */
+typedef struct {
+    int64_t duration;
+    int32_t properties;
+    int32_t numRes;
+    SysResource* resourceList;
+} TuneRequest;
+
+/**
+ * @struct SignalTuneRequest
+ * @brief Parameters of a single Signal Tune Request, issued as part of the tuneSignalBatch API.
+ *        The fields carry the same meaning as the corresponding tuneSignal arguments.
+ */
+typedef struct {
+    uint32_t sigId;
+    uint32_t sigType;
+    int64_t duration;
+    int32_t properties;
+    const char* appName;
+    const char* scenario;
+    int32_t numArgs;
+    uint32_t* list;
+} SignalTuneRequest;
+
+/**
+ * @brief Issue multiple independent Tune Requests in a single round trip to the server.
+ * @details Each Request in the batch is processed (and can be untuned) independently, exactly as
+ *          if it had been issued via the tuneResources API.
+ * @param numReqs Number of Requests in the batch.
+ * @param reqList List of Requests to be issued.
+ * @param handles Output list of size numReqs, on return holds the handle of each Request, in order.
+ *                A value of -1 indicates that the corresponding Request was rejected.
+ * @return int8_t:\n
+ *            - 0: If the batch was successfully sent to the server.\n
+ *            - -1: Otherwise
+ */
+int8_t tuneResourcesBatch(int32_t numReqs, TuneRequest* reqList, int64_t* handles);
+
+/**
+ * @brief Release (or free) multiple Requests in a single round trip to the server.
+ * @details The call returns once the server has acknowledged the batch.
+ * @param numHandles Number of handles in the list.
+ * @param handles List of Request Handles, returned by the tuneResources / tuneResourcesBatch APIs.
+ * @return int8_t:\n
+ *            - 0: If the batch was successfully sent to the server.\n
+ *            - -1: Otherwise
+ */
+int8_t untuneResourcesBatch(int32_t numHandles, int64_t* handles);
+
+/**
+ * @brief Tune multiple Signals in a single round trip to the server.
+ * @param numReqs Number of Signal Requests in the batch.
+ * @param reqList List of Signal Requests to be issued.
+ * @param handles Output list of size numReqs, on return holds the handle of each Request, in order.
+ *                A value of -1 indicates that the corresponding Request was rejected.
+ * @return int8_t:\n
+ *            - 0: If the batch was successfully sent to the server.\n
+ *            - -1: Otherwise
+ */
+int8_t tuneSignalBatch(int32_t numReqs, SignalTuneRequest* reqList, int64_t* handles);
+
+/**
+ * @brief Release (or free) multiple Signals in a single round trip to the server.
+ * @details The call returns once the server has acknowledged the batch.
+ * @param numHandles Number of handles in the list.
+ * @param handles List of Request Handles, returned by the tuneSignal / tuneSignalBatch APIs.
+ * @return int8_t:\n
+ *            - 0: If the batch was successfully sent to the server.\n
+ *            - -1: Otherwise
+ */
+int8_t untuneSignalBatch(int32_t numHandles, int64_t* handles);
+
+/**
+ * @struct UrmCoalescingStats
+ * @brief Counters maintained while Request coalescing is enabled (see setCoalescingWindow).
+ */
+typedef struct {
+    uint64_t tuneRequests; //!< Number of tuneResources calls made.
+    uint64_t coalesced; //!< Number of those calls served by an existing Request, i.e. new Requests saved.
+    uint64_t retunesSent; //!< Number of coalesced calls which extended the existing Request via a Retune.
+} UrmCoalescingStats;
+
+/**
+ * @brief Enable (or disable) coalescing of identical Tune Requests.
+ * @details With coalescing enabled, a tuneResources call from a thread, identical (except for the
+ *          duration) to a Request that thread issued within the window, does not create a new
+ *          Request. The existing Request is extended via a Retune if needed, and its handle is
+ *          returned. If the Server does not accept the Retune, a new Request is issued instead.
+ *          Hence, the same handle can be returned by multiple calls, and untuning it releases
+ *          the Request for all of them.
+ * @param windowMs Maximum gap (in milliseconds) between identical calls for them to be coalesced,
+ *                 0 (the default) disables coalescing.
+ * @return int8_t:\n
+ *            - 0: If the window was set.\n
+ *            - -1: Otherwise.
+ */
+int8_t setCoalescingWindow(int64_t windowMs);
+
+/**
+ * @brief Fetch the coalescing counters of the calling process.
+ * @param stats Output, holds the counters on return.
+ * @return int8_t:\n
+ *            - 0: If the counters were fetched.\n
+ *            - -1: Otherwise.
+ */
+int8_t getCoalescingStats(UrmCoalescingStats* stats);
+
+/**
+ * @brief Switch the calling process to the shared-memory transport (or back to the socket).
+ * @details With the shared-memory transport, Requests are exchanged through a memfd-backed ring
+ *          shared with the Server, and each Request costs a memcpy plus a single eventfd write,
+ *          instead of a socket round trip. Intended for latency sensitive clients.
+ * @param enable 1 to switch to the shared-memory transport, 0 to switch back to the socket.
+ * @return int8_t:\n
+ *            - 0: If the transport was switched.\n
+ *            - -1: If the shared-memory channel could not be negotiated, the socket is used instead.
+ */
+int8_t enableSharedMemoryTransport(int8_t enable);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,161 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include "TuneCoalescer.h"
+
+// Requests this close to expiry are not extended, the Retune might reach the Server too late.
+static const std::chrono::milliseconds coalesceExpiryMargin(100);
+
+static std::chrono::steady_clock::time_point expiryOf(std::chrono::steady_clock::time_point issuedAt,
+                                                      int64_t duration) {
+    if(duration == -1) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    return issuedAt + std::chrono::milliseconds(duration);
+}
+
+TuneCoalescer::TuneCoalescer() : mWindow(0), mStats({0, 0, 0}) {}
+
+void TuneCoalescer::setWindow(std::chrono::milliseconds window) {
+    const std::lock_guard<std::mutex> lock(this->mLock);
+    this->mWindow = window;
+    if(window.count() == 0) {
+        this->mTunes.clear();
+    }
+}
+
+int8_t TuneCoalescer::isEnabled() {
+    const std::lock_guard<std::mutex> lock(this->mLock);
+    return this->mWindow.count() > 0;
+}
+
+void TuneCoalescer::getStats(UrmCoalescingStats* stats) {
+    const std::lock_guard<std::mutex> lock(this->mLock);
+    *stats = this->mStats;
+}
+
+std::string TuneCoalescer::makeKey(int32_t threadId,
+                                   int32_t properties,
+                                   int32_t numRes,
+                                   const SysResource* resourceList) {
+    std::string key;
+    auto append = [&key](const void* data, size_t size) {
+        key.append((const char*)data, size);
+    };
+
+    append(&threadId, sizeof(threadId));
+    append(&properties, sizeof(properties));
+    append(&numRes, sizeof(numRes));
+
+    for(int32_t i = 0; i < numRes; i++) {
+        const SysResource& resource = resourceList[i];
+        append(&resource.mResCode, sizeof(resource.mResCode));
+        append(&resource.mResInfo, sizeof(resource.mResInfo));
+        append(&resource.mOptionalInfo, sizeof(resource.mOptionalInfo));
+        append(&resource.mNumValues, sizeof(resource.mNumValues));
+
+        if(resource.mNumValues == 1) {
+            append(&resource.mResValue.value, sizeof(int32_t));
+        } else if(resource.mResValue.values != nullptr && resource.mNumValues > 0) {
+            append(resource.mResValue.values, resource.mNumValues * sizeof(int32_t));
+        }
+    }
+
+    return key;
+}
+
+int64_t TuneCoalescer::coalesce(const std::string& key, int64_t duration, const RetuneFn& retune) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point expiresAt = expiryOf(now, duration);
+    int64_t handle = -1;
+    {
+        const std::lock_guard<std::mutex> lock(this->mLock);
+        this->mStats.tuneRequests++;
+
+        auto it = this->mTunes.find(key);
+        if(it == this->mTunes.end()) return -1;
+
+        CoalescedTune& tune = it->second;
+        if(now - tune.mLastIssued > this->mWindow || now + coalesceExpiryMargin >= tune.mExpiresAt) {
+            this->mTunes.erase(it);
+            return -1;
+        }
+
+        tune.mLastIssued = now;
+        if(expiresAt <= tune.mExpiresAt) {
+            // The existing Request already outlasts the new one.
+            this->mStats.coalesced++;
+            return tune.mHandle;
+        }
+
+        if(duration != -1 && duration < tune.mDuration) {
+            // The Server does not accept a Retune to a shorter duration.
+            this->mTunes.erase(it);
+            return -1;
+        }
+
+        handle = tune.mHandle;
+    }
+
+    // The key includes the calling thread, hence the entry is not coalesced into concurrently.
+    if(retune(handle, duration) != 0) {
+        // The Request might have been dropped by the Server, a new one has to be issued.
+        this->forget(handle);
+        return -1;
+    }
+
+    const std::lock_guard<std::mutex> lock(this->mLock);
+    auto it = this->mTunes.find(key);
+    if(it != this->mTunes.end() && it->second.mHandle == handle) {
+        it->second.mDuration = duration;
+        it->second.mExpiresAt = expiresAt;
+    }
+
+    this->mStats.coalesced++;
+    this->mStats.retunesSent++;
+    return handle;
+}
+
+void TuneCoalescer::track(const std::string& key, int64_t handle, int64_t duration) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const std::lock_guard<std::mutex> lock(this->mLock);
+    if(this->mWindow.count() == 0) return;
+
+    if(this->mTunes.size() >= mMaxTrackedTunes) {
+        for(auto it = this->mTunes.begin(); it != this->mTunes.end();) {
+            if(now - it->second.mLastIssued > this->mWindow || now >= it->second.mExpiresAt) {
+                it = this->mTunes.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if(this->mTunes.size() >= mMaxTrackedTunes) return;
+    }
+
+    this->mTunes[key] = {handle, duration, now, expiryOf(now, duration)};
+}
+
+void TuneCoalescer::forget(int64_t handle) {
+    const std::lock_guard<std::mutex> lock(this->mLock);
+    for(auto it = this->mTunes.begin(); it != this->mTunes.end();) {
+        if(it->second.mHandle == handle) {
+            it = this->mTunes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TuneCoalescer::lockForFork() {
+    this->mLock.lock();
+}
+
+void TuneCoalescer::unlockForFork() {
+    this->mLock.unlock();
+}
+
+void TuneCoalescer::resetInChild() {
+    this->mTunes.clear();
+    this->mLock.unlock();
+}
@@ -1,127 +1,677 @@
 // Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
 // SPDX-License-Identifier: BSD-3-Clause-Clear
 
+#include <pthread.h>
+
 #include <memory>
 #include <mutex>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
 
 #include "UrmAPIs.h"
 #include "Utils.h"
 #include "AuxRoutines.h"
 #include "SocketClient.h"
+#include "ShmClient.h"
+#include "TuneCoalescer.h"
 
 #define REQ_SEND_ERR(e) "Failed to send Request to Server, Error: " + std::string(e)
 #define CONN_SEND_FAIL "Failed to send Request to Server"
 #define CONN_INIT_FAIL "Failed to initialize Connection to resource-tuner Server"
 
-static std::shared_ptr<ClientEndpoint> conn(new SocketClient());
-
-// Byte Encoder
-static FlatBuffEncoder batch;
-static std::mutex apiLock;
+// Byte Encoder, one per thread so that callers do not serialize on encoding.
+static thread_local FlatBuffEncoder batch;
 static const int32_t maxResPerReq = 20;
 
-static int8_t sendMsgHelper(char* buf) {
-    if(conn == nullptr || RC_IS_NOTOK(conn->initiateConnection())) {
-        LOGE("RESTUNE_CLIENT", CONN_INIT_FAIL);
-        return -1;
+// Number of persistent connections shared by the threads of a process.
+static const int32_t connPoolSize = 4;
+
+// Invoked on the I/O thread once the Request has been sent (and its reply, if any, received).
+// status is 0 on success, in which case reply holds the Server's reply.
+typedef std::function<void(int8_t status, const char* reply)> CompletionHandler;
+
+typedef struct {
+    std::string mPayload;
+    size_t mReplySize; //!< Size of the Server's reply, 0 if the Server does not reply to the Request.
+    CompletionHandler mOnComplete;
+    std::shared_ptr<ClientEndpoint> mSwitchTo; //!< If set, not a Request but a switch to this transport.
+} PendingRequest;
+
+// Each connection to the Server is owned by an I/O thread (its Dispatcher). Requests are sent
+// in submission order, and since the Server replies in the order in which Requests arrive on a
+// connection, replies are matched to Requests in FIFO order.
+// Every thread of the process is bound to one Dispatcher of the pool on its first call, hence
+// the Requests of a thread are always sent in order, while threads bound to different
+// Dispatchers do not contend with each other at all.
+typedef struct {
+    std::mutex mLock;
+    std::condition_variable mCond;
+    std::deque<PendingRequest> mSubmissions;
+    std::shared_ptr<ClientEndpoint> mConn;
+
+    // Bumped whenever the connection is replaced, leases granted over the old one are void.
+    std::atomic<uint64_t> mConnGeneration {0};
+
+    // Handles leased from the Server for the current connection. Handles are claimed and their
+    // Requests submitted under mLeaseLock, so that they reach the Server in increasing order.
+    // The I/O thread never takes mLeaseLock.
+    std::mutex mLeaseLock;
+    int64_t mLeaseNext = 0;
+    int64_t mLeaseEnd = 0;
+    uint64_t mLeaseGeneration = 0;
+} Dispatcher;
+
+// Dispatchers are started on demand. They are intentionally never freed, the detached
+// I/O threads may still be using them at process exit. A forked child inherits the pool
+// but none of the I/O threads, it starts over with a pool of its own (refer onForkChild).
+static std::mutex poolLock;
+static Dispatcher* dispatchers[connPoolSize] = {nullptr};
+static std::atomic<uint32_t> nextDispatcher {0};
+static int8_t useShmTransport = false;
+
+static thread_local Dispatcher* threadDispatcher = nullptr;
+static thread_local int8_t onDispatcherThread = false;
+
+static std::mutex rejectionLock;
+static UrmRejectionCallback rejectionCb = nullptr;
+static void* rejectionUserData = nullptr;
+
+// Tune Requests tracked for coalescing (refer setCoalescingWindow).
+static TuneCoalescer coalescer;
+
+// Rejections of Requests issued with a leased handle arrive unsolicited, the connection is
+// polled for them for a while after such Requests are sent.
+static const std::chrono::milliseconds rejectionPollInterval(20);
+static const std::chrono::milliseconds rejectionWatchWindow(1000);
+
+static void reportRejection(int64_t handle) {
+    coalescer.forget(handle);
+
+    UrmRejectionCallback callback = nullptr;
+    void* userData = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(rejectionLock);
+        callback = rejectionCb;
+        userData = rejectionUserData;
+    }
+
+    if(callback == nullptr) {
+        LOGW("RESTUNE_CLIENT", "Request with handle " + std::to_string(handle) + " was rejected by the Server");
+        return;
+    }
+    callback(handle, userData);
+}
+
+// The connection has been dropped, replies still outstanding on it will never arrive.
+static void onConnectionLost(Dispatcher* dispatcher, std::deque<PendingRequest>& awaitingReply) {
+    dispatcher->mConnGeneration.fetch_add(1);
+    for(PendingRequest& request: awaitingReply) {
+        request.mOnComplete(-1, nullptr);
+    }
+    awaitingReply.clear();
+}
+
+// The connection to the Server is persistent, if it has gone stale (for example
+// due to a Server restart), reconnect and retry the Request once.
+static int8_t sendMsgHelper(Dispatcher* dispatcher,
+                            std::string& payload,
+                            std::deque<PendingRequest>& awaitingReply) {
+    std::shared_ptr<ClientEndpoint>& conn = dispatcher->mConn;
+
+    for(int32_t attempt = 0; attempt < 2; attempt++) {
+        if(RC_IS_NOTOK(conn->initiateConnection())) {
+            LOGE("RESTUNE_CLIENT", CONN_INIT_FAIL);
+            return -1;
+        }
+
+        // Send the request to Resource Tuner Server
+        if(RC_IS_OK(conn->sendMsg(&payload[0], payload.size()))) {
+            return 0;
+        }
+
+        onConnectionLost(dispatcher, awaitingReply);
     }
 
-    // Send the request to Resource Tuner Server
-    if(RC_IS_NOTOK(conn->sendMsg(buf, REQ_BUFFER_SIZE))) {
-        LOGE("RESTUNE_CLIENT", CONN_SEND_FAIL);
+    LOGE("RESTUNE_CLIENT", CONN_SEND_FAIL);
+    return -1;
+}
+
+// Read a single message off the connection, rejection notices are consumed here.
+// Returns 1 if a reply was read into buf, 0 if the message was a rejection notice, -1 on failure.
+static int8_t readMsgHelper(Dispatcher* dispatcher,
+                            char* buf,
+                            size_t bufSize,
+                            std::deque<PendingRequest>& awaitingReply) {
+    int64_t notice[2];
+    size_t readSize = std::max(bufSize, sizeof(notice));
+
+    // Replies shorter than a notice leave the rest of the buffer zeroed.
+    std::memset(buf, 0, readSize);
+    if(RC_IS_NOTOK(dispatcher->mConn->readMsg(buf, readSize))) {
+        onConnectionLost(dispatcher, awaitingReply);
         return -1;
     }
 
+    std::memcpy(notice, buf, sizeof(notice));
+    if(notice[0] != REQ_REJECTION_MARKER) {
+        return 1;
+    }
+
+    // The lease might have been revoked (for example if the transport was re-established
+    // without the client noticing), start over with a fresh one.
+    dispatcher->mConnGeneration.fetch_add(1);
+    reportRejection(notice[1]);
+    return 0;
+}
+
+// Wait for the reply to the oldest outstanding Request, and complete it.
+static void completeNextReply(Dispatcher* dispatcher, char* reply, std::deque<PendingRequest>& awaitingReply) {
+    if(readMsgHelper(dispatcher, reply, awaitingReply.front().mReplySize, awaitingReply) <= 0) {
+        return;
+    }
+
+    PendingRequest completed = std::move(awaitingReply.front());
+    awaitingReply.pop_front();
+    completed.mOnComplete(0, reply);
+}
+
+static void dispatcherRoutine(Dispatcher* dispatcher) {
+    std::deque<PendingRequest> awaitingReply;
+    std::chrono::steady_clock::time_point watchUntil;
+    char reply[RESTUNE_MAX_FRAME_SIZE];
+
+    // APIs called from completion callbacks are queued on this very Dispatcher.
+    threadDispatcher = dispatcher;
+    onDispatcherThread = true;
+
+    while(true) {
+        std::deque<PendingRequest> toSend;
+        {
+            std::unique_lock<std::mutex> lock(dispatcher->mLock);
+            auto isReady = [dispatcher, &awaitingReply] {
+                return !dispatcher->mSubmissions.empty() || !awaitingReply.empty();
+            };
+
+            if(std::chrono::steady_clock::now() < watchUntil) {
+                dispatcher->mCond.wait_for(lock, rejectionPollInterval, isReady);
+            } else {
+                dispatcher->mCond.wait(lock, isReady);
+            }
+            toSend.swap(dispatcher->mSubmissions);
+        }
+
+        for(PendingRequest& request: toSend) {
+            if(request.mSwitchTo != nullptr) {
+                // Replies outstanding on the current connection must be collected first.
+                while(!awaitingReply.empty()) {
+                    completeNextReply(dispatcher, reply, awaitingReply);
+                }
+
+                dispatcher->mConn = request.mSwitchTo;
+                dispatcher->mConnGeneration.fetch_add(1);
+                request.mOnComplete(0, nullptr);
+                continue;
+            }
+
+            // The shared memory transport can only hold so many replies, which the Server drops
+            // once the ring is full. Collect replies before the Server could run ahead that far.
+            while(awaitingReply.size() >= SHM_RING_SLOT_COUNT) {
+                completeNextReply(dispatcher, reply, awaitingReply);
+            }
+
+            if(sendMsgHelper(dispatcher, request.mPayload, awaitingReply) != 0) {
+                request.mOnComplete(-1, nullptr);
+            } else if(request.mReplySize == 0) {
+                watchUntil = std::chrono::steady_clock::now() + rejectionWatchWindow;
+                request.mOnComplete(0, nullptr);
+            } else {
+                awaitingReply.push_back(std::move(request));
+            }
+        }
+
+        if(awaitingReply.empty()) {
+            // Nothing is expected, but a rejection notice might be waiting.
+            while(dispatcher->mConn->hasPendingMsg()) {
+                if(readMsgHelper(dispatcher, reply, sizeof(int64_t), awaitingReply) > 0) {
+                    LOGW("RESTUNE_CLIENT", "Discarding an unexpected message from the Server");
+                }
+            }
+            continue;
+        }
+
+        completeNextReply(dispatcher, reply, awaitingReply);
+    }
+}
+
+static std::shared_ptr<ClientEndpoint> createEndpoint(int8_t shm) {
+    if(shm) {
+        return std::shared_ptr<ClientEndpoint>(new ShmClient());
+    }
+    return std::shared_ptr<ClientEndpoint>(new SocketClient());
+}
+
+// The client state is held across fork, so that the child does not inherit any of it mid-update.
+static void onForkPrepare() {
+    coalescer.lockForFork();
+    rejectionLock.lock();
+    poolLock.lock();
+}
+
+static void onForkParent() {
+    poolLock.unlock();
+    rejectionLock.unlock();
+    coalescer.unlockForFork();
+}
+
+// Only the forking thread is carried over into the child, Requests queued on the inherited
+// Dispatchers would never be sent. The inherited Dispatchers (and their connections, which
+// are shared with the parent) are left untouched, the child sets up its own on demand.
+static void onForkChild() {
+    for(int32_t i = 0; i < connPoolSize; i++) {
+        dispatchers[i] = nullptr;
+    }
+    nextDispatcher.store(0);
+    threadDispatcher = nullptr;
+    onDispatcherThread = false;
+
+    poolLock.unlock();
+    rejectionLock.unlock();
+
+    // Requests tracked for coalescing were issued by the parent.
+    coalescer.resetInChild();
+}
+
+// Get the Dispatcher the calling thread is bound to, binding it (round robin) on the first call.
+static Dispatcher* getDispatcher() {
+    if(threadDispatcher != nullptr) {
+        return threadDispatcher;
+    }
+
+    static std::once_flag forkHandlersRegistered;
+    std::call_once(forkHandlersRegistered, [] {
+        pthread_atfork(onForkPrepare, onForkParent, onForkChild);
+    });
+
+    int32_t slot = nextDispatcher.fetch_add(1) % connPoolSize;
+    const std::lock_guard<std::mutex> lock(poolLock);
+    if(dispatchers[slot] == nullptr) {
+        Dispatcher* dispatcher = new Dispatcher();
+        try {
+            dispatcher->mConn = createEndpoint(useShmTransport);
+            std::thread ioThread(dispatcherRoutine, dispatcher);
+            ioThread.detach();
+        } catch(const std::exception& e) {
+            delete dispatcher;
+            throw;
+        }
+        dispatchers[slot] = dispatcher;
+    }
+
+    threadDispatcher = dispatchers[slot];
+    return threadDispatcher;
+}
+
+static void enqueueRequest(Dispatcher* dispatcher, PendingRequest& request) {
+    {
+        const std::lock_guard<std::mutex> lock(dispatcher->mLock);
+        dispatcher->mSubmissions.push_back(std::move(request));
+    }
+    dispatcher->mCond.notify_one();
+}
+
+static int8_t submitRequest(const char* buf, size_t bufSize, size_t replySize, CompletionHandler onComplete) {
+    PendingRequest request;
+    request.mPayload.assign(buf, bufSize);
+    request.mReplySize = replySize;
+    request.mOnComplete = onComplete;
+
+    enqueueRequest(getDispatcher(), request);
     return 0;
 }
 
-static int64_t readHandleHelper() {
-    // Get the handle
-    char resultBuf[64] = {0};
-    if(RC_IS_NOTOK(conn->readMsg(resultBuf, sizeof(resultBuf)))) {
+// Submit the Request, and block until it has been sent and its reply (if any) received.
+static int8_t submitAndWait(const char* buf, size_t bufSize, char* reply, size_t replySize) {
+    if(onDispatcherThread) {
+        // Waiting on the I/O thread (i.e. from a completion callback) would never return.
+        LOGE("RESTUNE_CLIENT", "Blocking APIs can not be called from a completion callback");
         return -1;
     }
 
-    int64_t handleReceived = -1;
-    std::memcpy(&handleReceived, resultBuf, sizeof(handleReceived));
-    return handleReceived;
+    std::promise<int8_t> done;
+    std::future<int8_t> result = done.get_future();
+
+    submitRequest(buf, bufSize, replySize, [&done, reply, replySize](int8_t status, const char* data) {
+        if(status == 0 && data != nullptr && reply != nullptr) {
+            std::memcpy(reply, data, replySize);
+        }
+        done.set_value(status);
+    });
+
+    return result.get();
+}
+
+static CompletionHandler handleCallback(UrmCompletionCallback callback, void* userData) {
+    return [callback, userData](int8_t status, const char* reply) {
+        if(callback == nullptr) return;
+
+        int64_t handle = -1;
+        if(status == 0 && reply != nullptr) {
+            std::memcpy(&handle, reply, sizeof(int64_t));
+        }
+        callback(handle, userData);
+    };
+}
+
+// Claim the next handle from the Dispatcher's lease, leasing a fresh block if needed.
+// Must be called with the Dispatcher's mLeaseLock held. Returns 0 if no lease could be obtained.
+static int64_t claimLeasedHandle(Dispatcher* dispatcher) {
+    if(dispatcher->mLeaseNext < dispatcher->mLeaseEnd &&
+       dispatcher->mLeaseGeneration == dispatcher->mConnGeneration.load()) {
+        return dispatcher->mLeaseNext++;
+    }
+
+    char leaseReq[2] = {MOD_RESTUNE, REQ_HANDLE_LEASE};
+    int64_t firstHandle = -1;
+    if(submitAndWait(leaseReq, sizeof(leaseReq), (char*)&firstHandle, sizeof(firstHandle)) != 0 ||
+       firstHandle <= 0) {
+        dispatcher->mLeaseNext = dispatcher->mLeaseEnd = 0;
+        return 0;
+    }
+
+    // Read only once the lease is granted, any transport switch queued ahead of the
+    // lease Request has been applied by then.
+    dispatcher->mLeaseNext = firstHandle;
+    dispatcher->mLeaseEnd = firstHandle + HANDLE_LEASE_SIZE;
+    dispatcher->mLeaseGeneration = dispatcher->mConnGeneration.load();
+    return dispatcher->mLeaseNext++;
+}
+
+typedef std::function<int32_t(char* buf, int64_t handle)> TuneEncoder;
+
+// Issue a Tune Request. Where possible the handle is assigned locally from a lease, and the
+// Request is sent without waiting on the Server, rejections are then reported via the
+// rejection callback. Otherwise (or from a completion callback, which can not wait on a
+// lease) the handle is assigned by the Server.
+// If async is set, the handle is delivered via the callback, and the call returns 0 once queued.
+static int64_t issueTuneRequest(const TuneEncoder& encode,
+                                int8_t async,
+                                UrmCompletionCallback callback,
+                                void* userData) {
+    char buf[REQ_BUFFER_SIZE];
+    int32_t encodedSize = -1;
+
+    if(!onDispatcherThread) {
+        Dispatcher* dispatcher = getDispatcher();
+        const std::lock_guard<std::mutex> leaseGuard(dispatcher->mLeaseLock);
+        int64_t handle = claimLeasedHandle(dispatcher);
+        if(handle > 0) {
+            if((encodedSize = encode(buf, handle)) < 0) return -1;
+
+            submitRequest(buf, encodedSize, 0, [handle, callback, userData](int8_t status, const char*) {
+                if(status != 0) {
+                    reportRejection(handle);
+                }
+                if(callback != nullptr) {
+                    callback(status == 0 ? handle : -1, userData);
+                }
+            });
+
+            return async ? 0 : handle;
+        }
+    }
+
+    if((encodedSize = encode(buf, 0)) < 0) return -1;
+
+    if(async) {
+        return submitRequest(buf, encodedSize, sizeof(int64_t), handleCallback(callback, userData));
+    }
+
+    int64_t handle = -1;
+    if(submitAndWait(buf, encodedSize, (char*)&handle, sizeof(handle)) != 0) {
+        return -1;
+    }
+    return handle;
+}
+
+// Encoding Order (refer WireFormat.h):
+// 0. Module ID
+// 1. Request Type
+// 2. Format Version
+// 3. Request Handle (leased handle for tune requests, if any)
+// 4. Flags, indicating which of the optional fields (5, 6) are present
+// 5. Duration (optional, -1 if absent)
+// 6. Properties (optional, 0 if absent)
+// 7. PID
+// 8. TID
+// 9. Number of Resources
+// 10. Resource List:
+//      Each resource is encoded as:
+//          10.1 ResCode
+//          10.2 ResInfo
+//          10.3 OptionalInfo
+//          10.4 NumValues
+//          10.5 List of "#NumValues" values.
+// Returns the encoded size, or -1 if the Request does not fit in the buffer.
+static FlatBuffEncoder& encodeCommonFields(FlatBuffEncoder& encoder,
+                                           int8_t requestType,
+                                           int64_t handle,
+                                           int64_t duration,
+                                           int32_t properties) {
+    uint64_t flags = 0;
+    if(duration != -1) flags |= WIRE_HAS_DURATION;
+    if(properties != 0) flags |= WIRE_HAS_PROPERTIES;
+
+    encoder.append<int8_t>(MOD_RESTUNE)
+           .append<int8_t>(requestType)
+           .append<int8_t>(WIRE_FORMAT_VERSION)
+           .appendSignedVarint(handle)
+           .appendVarint(flags);
+
+    if(flags & WIRE_HAS_DURATION) encoder.appendSignedVarint(duration);
+    if(flags & WIRE_HAS_PROPERTIES) encoder.appendVarint((uint32_t)VALIDATE_GE(properties, 0));
+
+    return encoder.appendVarint((uint32_t)getpid())
+                  .appendVarint((uint32_t)gettid());
+}
+
+static int32_t encodeTuneRequest(char* buf,
+                                 int64_t handle,
+                                 int64_t duration,
+                                 int32_t properties,
+                                 int32_t numRes,
+                                 SysResource* resourceList) {
+    // Preliminary Tests
+    // These are some basic checks done at the Client end itself to detect
+    // Potentially Malformed Reqeusts, to prevent wastage of Server-End Resources.
+    if(resourceList == nullptr || numRes <= 0 || duration == 0 || duration < -1) {
+        LOGE("RESTUNE_CLIENT", "Invalid Request Params");
+        return -1;
+    }
+
+    if(numRes > maxResPerReq) {
+        LOGE("RESTUNE_CLIENT", "Number of Resources in Request exceeds max limit.");
+        return -1;
+    }
+
+    batch.setBuf(buf);
+    encodeCommonFields(batch, REQ_RESOURCE_TUNING, handle, duration, properties)
+         .appendVarint((uint32_t)VALIDATE_GT(numRes, 0));
+
+    for(int32_t i = 0; i < numRes; i++) {
+        SysResource resource = SafeDeref((resourceList + i));
+
+        batch.appendVarint(VALIDATE_GT(resource.mResCode, 0))
+             .appendVarint((uint32_t)VALIDATE_GE(resource.mResInfo, 0))
+             .appendVarint((uint32_t)VALIDATE_GE(resource.mOptionalInfo, 0))
+             .appendVarint((uint32_t)VALIDATE_GT(resource.mNumValues, 0));
+
+        if(resource.mNumValues == 1) {
+            batch.appendSignedVarint(resource.mResValue.value);
+        } else {
+            for(int32_t j = 0; j < resource.mNumValues; j++) {
+                batch.appendSignedVarint(resource.mResValue.values[j]);
+            }
+        }
+    }
+
+    if(!batch.isBufSane()) {
+        LOGE("RESTUNE_CLIENT", "Request Size exceeds max capacity");
+        return -1;
+    }
+
+    return batch.getEncodedSize();
+}
+
+// Retune and Untune Requests only carry the handle (and duration) of an existing Request.
+static int32_t encodeHandleRequest(char* buf, int8_t requestType, int64_t handle, int64_t duration) {
+    batch.setBuf(buf);
+    encodeCommonFields(batch, requestType, handle, duration, 0)
+         .appendVarint(0);
+
+    if(!batch.isBufSane()) {
+        LOGE("RESTUNE_CLIENT", "Malformed Request");
+        return -1;
+    }
+
+    return batch.getEncodedSize();
+}
+
+static char* encodeString(char* charPointer, const char* str) {
+    const char* charIterator = str;
+    while(*charIterator != '\0') {
+        ASSIGN_AND_INCR(charPointer, *charIterator);
+        charIterator++;
+    }
+
+    ASSIGN_AND_INCR(charPointer, '\0');
+    return charPointer;
+}
+
+// Encodes a Signal Request, using an encoder local to the call (Signal APIs are not serialized).
+// Returns the encoded size, or -1 if the Request exceeds the Server's Request buffer.
+static int32_t encodeSignalRequest(char* buf,
+                                   int8_t requestType,
+                                   uint32_t sigId,
+                                   uint32_t sigType,
+                                   int64_t handle,
+                                   int64_t duration,
+                                   int32_t properties,
+                                   const char* appName,
+                                   const char* scenario,
+                                   int32_t numArgs,
+                                   uint32_t* list) {
+    FlatBuffEncoder encoder(REQ_BUFFER_SIZE);
+    encoder.setBuf(buf);
+
+    encodeCommonFields(encoder, requestType, handle, duration, properties)
+           .appendVarint(sigId)
+           .appendVarint(sigType)
+           .appendString(appName)
+           .appendString(scenario)
+           .appendVarint((uint32_t)VALIDATE_GE(numArgs, 0));
+
+    for(int32_t i = 0; i < numArgs; i++) {
+        encoder.appendVarint(list[i]);
+    }
+
+    if(!encoder.isBufSane()) {
+        LOGE("RESTUNE_CLIENT", "Request Size exceeds max capacity");
+        return -1;
+    }
+
+    return encoder.getEncodedSize();
+}
+
+// Batch layout: [Module ID][REQ_BATCH][int32_t Count]{[uint32_t Length][Request]} x Count
+static int32_t initBatch(char* batchBuf, int32_t count) {
+    int8_t* ptr8 = (int8_t*)batchBuf;
+    ASSIGN_AND_INCR(ptr8, MOD_RESTUNE);
+    ASSIGN_AND_INCR(ptr8, REQ_BATCH);
+
+    int32_t* ptr = (int32_t*)ptr8;
+    ASSIGN_AND_INCR(ptr, count);
+
+    return (char*)ptr - batchBuf;
+}
+
+// Returns the new size of the batch, or -1 if the Request does not fit.
+static int32_t appendToBatch(char* batchBuf, int32_t batchSize, const char* reqBuf, int32_t reqSize) {
+    if(reqSize <= 0 || batchSize + sizeof(uint32_t) + reqSize > REQ_BATCH_BUFFER_SIZE) {
+        LOGE("RESTUNE_CLIENT", "Batch Size exceeds max capacity");
+        return -1;
+    }
+
+    uint32_t length = reqSize;
+    std::memcpy(batchBuf + batchSize, &length, sizeof(uint32_t));
+    std::memcpy(batchBuf + batchSize + sizeof(uint32_t), reqBuf, reqSize);
+
+    return batchSize + sizeof(uint32_t) + reqSize;
+}
+
+// The Server replies to a Retune with its status, 0 if accepted.
+static int8_t issueRetune(int64_t handle, int64_t duration) {
+    char buf[REQ_BUFFER_SIZE] = {0};
+    int64_t status = -1;
+    int32_t encodedSize = encodeHandleRequest(buf, REQ_RESOURCE_RETUNING, handle, duration);
+    if(encodedSize < 0 || submitAndWait(buf, encodedSize, (char*)&status, sizeof(status)) != 0) {
+        return -1;
+    }
+    return (status == 0) ? 0 : -1;
 }
 
 // - Construct a Request object and populate it with the API specified Params
-// - Initiate a connection to the Resource Tuner Server, and send the request to the server
+// - Send the request to the Resource Tuner Server
 // - Wait for the response from the server, and return the response to the caller (end-client).
 int64_t tuneResources(int64_t duration,
                       int32_t properties,
                       int32_t numRes,
                       SysResource* resourceList) {
-    // Only one client Thread can send a Request at any moment
     try {
-        const std::lock_guard<std::mutex> lock(apiLock);
-        const ConnectionManager connMgr(conn);
-
-        // Preliminary Tests
-        // These are some basic checks done at the Client end itself to detect
-        // Potentially Malformed Reqeusts, to prevent wastage of Server-End Resources.
-        if(resourceList == nullptr || numRes <= 0 || duration == 0 || duration < -1) {
-            LOGE("RESTUNE_CLIENT", "Invalid Request Params");
-            return -1;
+        std::string key;
+        if(coalescer.isEnabled() && resourceList != nullptr && numRes > 0 && numRes <= maxResPerReq &&
+           (duration == -1 || duration > 0)) {
+            key = TuneCoalescer::makeKey(gettid(), properties, numRes, resourceList);
+
+            // Falls back to a new Request if the existing one could not be extended.
+            int64_t handle = coalescer.coalesce(key, duration, issueRetune);
+            if(handle > 0) return handle;
         }
 
-        if(numRes > maxResPerReq) {
-            LOGE("RESTUNE_CLIENT", "Number of Resources in Request exceeds max limit.");
-            return -1;
+        int64_t handle = issueTuneRequest([&](char* buf, int64_t handle) {
+            return encodeTuneRequest(buf, handle, duration, properties, numRes, resourceList);
+        }, false, nullptr, nullptr);
+
+        if(handle > 0 && !key.empty()) {
+            coalescer.track(key, handle, duration);
         }
+        return handle;
 
-        // Encoding Order:
-        // 0. Module ID
-        // 1. Request Type
-        // 2. Request Handle (applicable for untune and retune requests)
-        // 3. Duration
-        // 4. Number of Resources
-        // 5. Properties
-        // 6. PID
-        // 7. TID
-        // 8. Resource List:
-        //      Each resource is encoded as:
-        //          8.1 ResCode
-        //          8.2 ResInfo
-        //          8.3 OptionalInfo
-        //          8.4 NumValues
-        //          8.5 List of "#NumValues" values.
+    } catch(const std::exception& e) {
+        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
+    }
 
-        char buf[REQ_BUFFER_SIZE] = {0};
-        batch.setBuf(buf);
-        batch.append<int8_t>(MOD_RESTUNE)
-             .append<int8_t>(REQ_RESOURCE_TUNING)
-             .append<int64_t>(0)
-             .append<int64_t>(duration)
-             .append<int32_t>(VALIDATE_GT(numRes, 0))
-             .append<int32_t>(VALIDATE_GE(properties, 0))
-             .append<int32_t>((int32_t)getpid())
-             .append<int32_t>((int32_t)gettid());
-
-        for(int32_t i = 0; i < numRes; i++) {
-            SysResource resource = SafeDeref((resourceList + i));
-
-            batch.append<uint32_t>(VALIDATE_GT(resource.mResCode, 0))
-                 .append<int32_t>(VALIDATE_GE(resource.mResInfo, 0))
-                 .append<int32_t>(VALIDATE_GE(resource.mOptionalInfo, 0))
-                 .append<int32_t>(VALIDATE_GT(resource.mNumValues, 0));
-
-            if(resource.mNumValues == 1) {
-                batch.append<int32_t>(resource.mResValue.value);
-            } else {
-                for(int32_t j = 0; j < resource.mNumValues; j++) {
-                    batch.append<int32_t>(resource.mResValue.values[j]);
-                }
-            }
-        }
+    return -1;
+}
 
-        if(batch.isBufSane()) {
-            if(sendMsgHelper(buf) == 0) return readHandleHelper();
-        } else {
-            LOGE("RESTUNE_CLIENT", "Request Size exceeds max capacity");
-        }
+// - Same as tuneResources, except that the call returns as soon as the Request is queued,
+//   the handle is delivered via the callback.
+int8_t tuneResourcesAsync(int64_t duration,
+                          int32_t properties,
+                          int32_t numRes,
+                          SysResource* resourceList,
+                          UrmCompletionCallback callback,
+                          void* userData) {
+    try {
+        return issueTuneRequest([&](char* buf, int64_t handle) {
+            return encodeTuneRequest(buf, handle, duration, properties, numRes, resourceList);
+        }, true, callback, userData);
 
     } catch(const std::exception& e) {
         LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
@@ -131,33 +681,15 @@ int64_t tuneResources(int64_t duration,
 }
 
 // - Construct a Request object and populate it with the API specified Params
-// - Initiate a connection to the Resource Tuner Server, and send the request to the server
+// - Send the request to the Resource Tuner Server
 int8_t retuneResources(int64_t handle, int64_t duration) {
     try {
-        const std::lock_guard<std::mutex> lock(apiLock);
-        const ConnectionManager connMgr(conn);
-
         if(handle <= 0  || duration == 0 || duration < -1) {
             LOGE("RESTUNE_CLIENT", "Invalid Request Params");
             return -1;
         }
 
-        char buf[REQ_BUFFER_SIZE] = {0};
-        batch.setBuf(buf);
-        batch.append<int8_t>(MOD_RESTUNE)
-             .append<int8_t>(REQ_RESOURCE_RETUNING)
-             .append<int64_t>(handle)
-             .append<int64_t>(duration)
-             .append<int32_t>(0)
-             .append<int32_t>(0)
-             .append<int32_t>((int32_t)getpid())
-             .append<int32_t>((int32_t)gettid());
-
-        if(batch.isBufSane()) {
-            if(sendMsgHelper(buf) == 0) return 0;
-        } else {
-            LOGE("RESTUNE_CLIENT", "Malformed Request");
-        }
+        return issueRetune(handle, duration);
 
     } catch(const std::exception& e) {
         LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
@@ -167,33 +699,20 @@ int8_t retuneResources(int64_t handle, int64_t duration) {
 }
 
 // - Construct a Request object and populate it with the API specified Params
-// - Initiate a connection to the Resource Tuner Server, and send the request to the server
+// - Send the request to the Resource Tuner Server
 int8_t untuneResources(int64_t handle) {
     try {
-        const std::lock_guard<std::mutex> lock(apiLock);
-        const ConnectionManager connMgr(conn);
-
         if(handle <= 0) {
             LOGE("RESTUNE_CLIENT", "Invalid Request Params");
             return -1;
         }
 
+        coalescer.forget(handle);
+
         char buf[REQ_BUFFER_SIZE] = {0};
-        batch.setBuf(buf);
-        batch.append<int8_t>(MOD_RESTUNE)
-             .append<int8_t>(REQ_RESOURCE_UNTUNING)
-             .append<int64_t>(handle)
-             .append<int64_t>(-1)
-             .append<int32_t>(0)
-             .append<int32_t>(0)
-             .append<int32_t>((int32_t)getpid())
-             .append<int32_t>((int32_t)gettid());
-
-        if(batch.isBufSane()) {
-            if(sendMsgHelper(buf) == 0) return 0;
-        } else {
-            LOGE("RESTUNE_CLIENT", "Malformed Request");
-        }
+        int32_t encodedSize = encodeHandleRequest(buf, REQ_RESOURCE_UNTUNING, handle, -1);
+
+        if(encodedSize >= 0 && submitAndWait(buf, encodedSize, nullptr, 0) == 0) return 0;
 
     } catch(const std::exception& e) {
         LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
@@ -203,53 +722,38 @@ int8_t untuneResources(int64_t handle) {
 }
 
 // - Construct a Prop Get Request object and populate it with the Request Params
-// - Initiate a connection to the Resource Tuner Server, and send the request to the server
+// - Send the request to the Resource Tuner Server
 // - Wait for the response from the server, and return the response to the caller (end-client).
 int8_t getProp(const char* prop, char* buffer, size_t bufferSize, const char* defValue) {
     try {
-        const std::lock_guard<std::mutex> lock(apiLock);
-        const ConnectionManager connMgr(conn);
+        if(prop == nullptr || buffer == nullptr || bufferSize == 0 || defValue == nullptr) {
+            LOGE("RESTUNE_CLIENT", "Invalid Request Params");
+            return -1;
+        }
 
         char buf[1024];
         int8_t* ptr8 = (int8_t*)buf;
         ASSIGN_AND_INCR(ptr8, MOD_RESTUNE);
         ASSIGN_AND_INCR(ptr8, REQ_PROP_GET);
 
-        const char* charIterator = prop;
-        char* charPointer = (char*) ptr8;
-
-        while(*charIterator != '\0') {
-            ASSIGN_AND_INCR(charPointer, *charIterator);
-            charIterator++;
-        }
-
-        ASSIGN_AND_INCR(charPointer, '\0');
+        char* charPointer = encodeString((char*) ptr8, prop);
 
         uint64_t* ptr64 = (uint64_t*)charPointer;
         ASSIGN_AND_INCR(ptr64, bufferSize);
 
-        if(conn == nullptr || RC_IS_NOTOK(conn->initiateConnection())) {
-            LOGE("RESTUNE_CLIENT", CONN_INIT_FAIL);
-            return -1;
-        }
-
-        if(RC_IS_NOTOK(conn->sendMsg(buf, sizeof(buf)))) {
-            LOGE("RESTUNE_CLIENT", CONN_SEND_FAIL);
-            return -1;
-        }
-
         // read the response
-        char resultBuf[bufferSize];
-        if(RC_IS_NOTOK(conn->readMsg(resultBuf, sizeof(resultBuf)))) {
+        size_t resultSize = std::min(bufferSize, (size_t)RESTUNE_MAX_FRAME_SIZE);
+        std::string resultBuf(resultSize, '\0');
+        if(submitAndWait(buf, (char*)ptr64 - buf, &resultBuf[0], resultSize) != 0) {
             return -1;
         }
 
         buffer[bufferSize - 1] = '\0';
-        if(strncmp(resultBuf, "na", 2) == 0) {
+        if(strncmp(resultBuf.c_str(), "na", 2) == 0) {
             // Copy default value
             strncpy(buffer, defValue, bufferSize - 1);
         } else {
-            strncpy(buffer, resultBuf, bufferSize - 1);
+            strncpy(buffer, resultBuf.c_str(), bufferSize - 1);
         }
 
         return 0;
@@ -267,7 +771,7 @@ int8_t getProp(const char* prop, char* buffer, size_t bufferSize, const char* de
 }
 
 // - Construct a Signal object and populate it with the Signal Request Params
-// - Initiate a connection to the Resource Tuner Server, and send the request to the server
+// - Send the request to the Resource Tuner Server
 // - Wait for the response from the server, and return the response to the caller (end-client).
 int64_t tuneSignal(uint32_t sigId,
                    uint32_t sigType,
@@ -278,78 +782,117 @@ int64_t tuneSignal(uint32_t sigId,
                    int32_t numArgs,
                    uint32_t* list) {
     try {
-        const std::lock_guard<std::mutex> lock(apiLock);
-        const ConnectionManager connMgr(conn);
-
         if(duration < -1) {
             LOGE("RESTUNE_CLIENT", "Invalid Request Params");
             return -1;
         }
 
-        char buf[1024];
-        int8_t* ptr8 = (int8_t*)buf;
-        ASSIGN_AND_INCR(ptr8, MOD_RESTUNE);
-        ASSIGN_AND_INCR(ptr8, REQ_SIGNAL_TUNING);
+        return issueTuneRequest([&](char* buf, int64_t handle) {
+            return encodeSignalRequest(buf, REQ_SIGNAL_TUNING, sigId, sigType, handle, duration, properties,
+                                       appName, scenario, numArgs, list);
+        }, false, nullptr, nullptr);
 
-        int32_t* ptr = (int32_t*)ptr8;
-        ASSIGN_AND_INCR(ptr, sigId);
-        ASSIGN_AND_INCR(ptr, sigType);
+    } catch(const std::invalid_argument& e) {
+        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
+        return -1;
 
-        int64_t* ptr64 = (int64_t*)ptr;
-        ASSIGN_AND_INCR(ptr64, 0);
-        ASSIGN_AND_INCR(ptr64, duration);
+    } catch(const std::exception& e) {
+        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
+        return -1;
+    }
 
-        const char* charIterator = appName;
-        char* charPointer = (char*) ptr64;
+    return -1;
+}
 
-        while(*charIterator != '\0') {
-            ASSIGN_AND_INCR(charPointer, *charIterator);
-            charIterator++;
+// - Same as tuneSignal, except that the call returns as soon as the Request is queued,
+//   the handle is delivered via the callback.
+int8_t tuneSignalAsync(uint32_t sigId,
+                       uint32_t sigType,
+                       int64_t duration,
+                       int32_t properties,
+                       const char* appName,
+                       const char* scenario,
+                       int32_t numArgs,
+                       uint32_t* list,
+                       UrmCompletionCallback callback,
+                       void* userData) {
+    try {
+        if(duration < -1) {
+            LOGE("RESTUNE_CLIENT", "Invalid Request Params");
+            return -1;
         }
 
-        ASSIGN_AND_INCR(charPointer, '\0');
+        return issueTuneRequest([&](char* buf, int64_t handle) {
+            return encodeSignalRequest(buf, REQ_SIGNAL_TUNING, sigId, sigType, handle, duration, properties,
+                                       appName, scenario, numArgs, list);
+        }, true, callback, userData);
 
-        charIterator = scenario;
-
-        while(*charIterator != '\0') {
-            ASSIGN_AND_INCR(charPointer, *charIterator);
-            charIterator++;
-        }
+    } catch(const std::invalid_argument& e) {
+        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
+        return -1;
 
-        ASSIGN_AND_INCR(charPointer, '\0');
+    } catch(const std::exception& e) {
+        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
+        return -1;
+    }
 
-        ptr = (int32_t*)charPointer;
-        ASSIGN_AND_INCR(ptr, VALIDATE_GE(numArgs, 0));
-        ASSIGN_AND_INCR(ptr, VALIDATE_GE(properties, 0));
-        ASSIGN_AND_INCR(ptr, (int32_t)getpid());
-        ASSIGN_AND_INCR(ptr, (int32_t)gettid());
+    return -1;
+}
 
-        for(int32_t i = 0; i < numArgs; i++) {
-            uint32_t arg = list[i];
-            ASSIGN_AND_INCR(ptr, arg)
+// - Construct a Signal object and populate it with the Signal Request Params
+// - Send the request to the Resource Tuner Server
+int8_t untuneSignal(int64_t handle) {
+    try {
+        if(handle <= 0) {
+            LOGE("RESTUNE_CLIENT", "Invalid Request Params");
+            return -1;
         }
 
-        if(conn == nullptr || RC_IS_NOTOK(conn->initiateConnection())) {
-            LOGE("RESTUNE_CLIENT", CONN_INIT_FAIL);
+        char buf[REQ_BUFFER_SIZE];
+        int32_t encodedSize = encodeSignalRequest(buf, REQ_SIGNAL_UNTUNING, 0, 0, handle, -1, 0,
+                                                  "", "", 0, nullptr);
+        if(encodedSize < 0 || submitAndWait(buf, encodedSize, nullptr, 0) != 0) {
             return -1;
         }
 
-        // Send the request to Resource Tuner Server
-        if(RC_IS_NOTOK(conn->sendMsg(buf, sizeof(buf)))) {
-            LOGE("RESTUNE_CLIENT", CONN_SEND_FAIL);
+        return 0;
+
+    } catch(const std::invalid_argument& e) {
+        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
+        return -1;
+
+    } catch(const std::exception& e) {
+        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
+        return -1;
+    }
+
+    return -1;
+}
+
+// - Construct a Signal object and populate it with the Signal Request Params
+// - Send the request to the Resource Tuner Server
+int8_t relaySignal(uint32_t sigId,
+                   uint32_t sigType,
+                   int64_t duration,
+                   int32_t properties,
+                   const char* appName,
+                   const char* scenario,
+                   int32_t numArgs,
+                   uint32_t* list) {
+    try {
+        if(duration < -1) {
+            LOGE("RESTUNE_CLIENT", "Invalid Request Params");
             return -1;
         }
 
-        // Get the handle
-        char resultBuf[64] = {0};
-        if(RC_IS_NOTOK(conn->readMsg(resultBuf, sizeof(resultBuf)))) {
+        char buf[REQ_BUFFER_SIZE];
+        int32_t encodedSize = encodeSignalRequest(buf, REQ_SIGNAL_RELAY, sigId, sigType, 0, duration, properties,
+                                                  appName, scenario, numArgs, list);
+        if(encodedSize < 0 || submitAndWait(buf, encodedSize, nullptr, 0) != 0) {
             return -1;
         }
 
-        int64_t handleReceived = -1;
-        std::memcpy(&handleReceived, resultBuf, sizeof(handleReceived));
-
-        return handleReceived;
+        return 0;
 
     } catch(const std::invalid_argument& e) {
         LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
@@ -363,164 +906,214 @@ int64_t tuneSignal(uint32_t sigId,
     return -1;
 }
 
-// - Construct a Signal object and populate it with the Signal Request Params
-// - Initiate a connection to the Resource Tuner Server, and send the request to the server
-int8_t untuneSignal(int64_t handle) {
-    try {
-        const std::lock_guard<std::mutex> lock(apiLock);
-        const ConnectionManager connMgr(conn);
+// The Server replies with one handle per Request, in the order in which they were batched.
+static int8_t submitBatchAndWait(const char* batchBuf, int32_t batchSize, int32_t numReqs, int64_t* handles) {
+    for(int32_t i = 0; i < numReqs; i++) {
+        handles[i] = -1;
+    }
+    return submitAndWait(batchBuf, batchSize, (char*)handles, numReqs * sizeof(int64_t));
+}
 
-        if(handle <= 0) {
+// - Encode each of the Requests, and pack them into a single batch
+// - Send the batch to the Resource Tuner Server in one go
+// - Wait for the handles of all the Requests, which are returned in a single response.
+int8_t tuneResourcesBatch(int32_t numReqs, TuneRequest* reqList, int64_t* handles) {
+    try {
+        if(reqList == nullptr || handles == nullptr || numReqs <= 0 || numReqs > REQ_BATCH_MAX_COUNT) {
             LOGE("RESTUNE_CLIENT", "Invalid Request Params");
             return -1;
         }
 
-        char buf[1024];
-        int8_t* ptr8 = (int8_t*)buf;
-        ASSIGN_AND_INCR(ptr8, MOD_RESTUNE);
-        ASSIGN_AND_INCR(ptr8, REQ_SIGNAL_UNTUNING);
+        char batchBuf[REQ_BATCH_BUFFER_SIZE];
+        int32_t batchSize = initBatch(batchBuf, numReqs);
+        for(int32_t i = 0; i < numReqs; i++) {
+            char buf[REQ_BUFFER_SIZE] = {0};
+            int32_t reqSize = encodeTuneRequest(buf, 0, reqList[i].duration, reqList[i].properties,
+                                                reqList[i].numRes, reqList[i].resourceList);
+            if(reqSize < 0) return -1;
 
-        int32_t* ptr = (int32_t*)ptr8;
-        ASSIGN_AND_INCR(ptr, 0);
-        ASSIGN_AND_INCR(ptr, 0);
+            if((batchSize = appendToBatch(batchBuf, batchSize, buf, reqSize)) < 0) return -1;
+        }
 
-        int64_t* ptr64 = (int64_t*)ptr;
-        ASSIGN_AND_INCR(ptr64, handle);
-        ASSIGN_AND_INCR(ptr64, -1);
+        return submitBatchAndWait(batchBuf, batchSize, numReqs, handles);
 
-        const char* charIterator = "";
-        char* charPointer = (char*) ptr64;
+    } catch(const std::exception& e) {
+        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
+    }
+
+    return -1;
+}
 
-        while(*charIterator != '\0') {
-            ASSIGN_AND_INCR(charPointer, *charIterator);
-            charIterator++;
+int8_t untuneResourcesBatch(int32_t numHandles, int64_t* handles) {
+    try {
+        if(handles == nullptr || numHandles <= 0 || numHandles > REQ_BATCH_MAX_COUNT) {
+            LOGE("RESTUNE_CLIENT", "Invalid Request Params");
+            return -1;
         }
 
-        ASSIGN_AND_INCR(charPointer, '\0');
+        char batchBuf[REQ_BATCH_BUFFER_SIZE];
+        int32_t batchSize = initBatch(batchBuf, numHandles);
+        for(int32_t i = 0; i < numHandles; i++) {
+            if(handles[i] <= 0) {
+                LOGE("RESTUNE_CLIENT", "Invalid Request Params");
+                return -1;
+            }
+
+            coalescer.forget(handles[i]);
 
-        charIterator = "";
+            char buf[REQ_BUFFER_SIZE] = {0};
+            int32_t reqSize = encodeHandleRequest(buf, REQ_RESOURCE_UNTUNING, handles[i], -1);
+            if(reqSize < 0) return -1;
 
-        while(*charIterator != '\0') {
-            ASSIGN_AND_INCR(charPointer, *charIterator);
-            charIterator++;
+            if((batchSize = appendToBatch(batchBuf, batchSize, buf, reqSize)) < 0) return -1;
         }
 
-        ASSIGN_AND_INCR(charPointer, '\0');
+        // Batches are always acknowledged, the reply must be consumed to keep the connection in sync.
+        int64_t results[REQ_BATCH_MAX_COUNT];
+        return submitBatchAndWait(batchBuf, batchSize, numHandles, results);
 
-        ptr = (int32_t*)charPointer;
-        ASSIGN_AND_INCR(ptr, 0);
-        ASSIGN_AND_INCR(ptr, 0);
-        ASSIGN_AND_INCR(ptr, (int32_t)getpid());
-        ASSIGN_AND_INCR(ptr, (int32_t)gettid());
+    } catch(const std::exception& e) {
+        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
+    }
 
-        if(conn == nullptr || RC_IS_NOTOK(conn->initiateConnection())) {
-            LOGE("RESTUNE_CLIENT", CONN_INIT_FAIL);
-            return -1;
-        }
+    return -1;
+}
 
-        // Send the request to Resource Tuner Server
-        if(RC_IS_NOTOK(conn->sendMsg(buf, sizeof(buf)))) {
-            LOGE("RESTUNE_CLIENT", CONN_SEND_FAIL);
+int8_t tuneSignalBatch(int32_t numReqs, SignalTuneRequest* reqList, int64_t* handles) {
+    try {
+        if(reqList == nullptr || handles == nullptr || numReqs <= 0 || numReqs > REQ_BATCH_MAX_COUNT) {
+            LOGE("RESTUNE_CLIENT", "Invalid Request Params");
             return -1;
         }
 
-        return 0;
+        char batchBuf[REQ_BATCH_BUFFER_SIZE];
+        int32_t batchSize = initBatch(batchBuf, numReqs);
 
-    } catch(const std::invalid_argument& e) {
-        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
-        return -1;
+        for(int32_t i = 0; i < numReqs; i++) {
+            const SignalTuneRequest& req = reqList[i];
+            if(req.duration < -1) {
+                LOGE("RESTUNE_CLIENT", "Invalid Request Params");
+                return -1;
+            }
+
+            char buf[REQ_BUFFER_SIZE];
+            int32_t reqSize = encodeSignalRequest(buf, REQ_SIGNAL_TUNING, req.sigId, req.sigType, 0,
+                                                  req.duration, req.properties, req.appName,
+                                                  req.scenario, req.numArgs, req.list);
+            if(reqSize < 0) return -1;
+
+            if((batchSize = appendToBatch(batchBuf, batchSize, buf, reqSize)) < 0) return -1;
+        }
+
+        return submitBatchAndWait(batchBuf, batchSize, numReqs, handles);
 
     } catch(const std::exception& e) {
         LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
-        return -1;
     }
 
     return -1;
 }
 
-// - Construct a Signal object and populate it with the Signal Request Params
-// - Initiate a connection to the Resource Tuner Server, and send the request to the server
-int8_t relaySignal(uint32_t sigId,
-                   uint32_t sigType,
-                   int64_t duration,
-                   int32_t properties,
-                   const char* appName,
-                   const char* scenario,
-                   int32_t numArgs,
-                   uint32_t* list) {
+int8_t untuneSignalBatch(int32_t numHandles, int64_t* handles) {
     try {
-        const std::lock_guard<std::mutex> lock(apiLock);
-        const ConnectionManager connMgr(conn);
-
-        if(duration < -1) {
+        if(handles == nullptr || numHandles <= 0 || numHandles > REQ_BATCH_MAX_COUNT) {
             LOGE("RESTUNE_CLIENT", "Invalid Request Params");
             return -1;
         }
 
-        char buf[1024];
-        int8_t* ptr8 = (int8_t*)buf;
-        ASSIGN_AND_INCR(ptr8, MOD_RESTUNE);
-        ASSIGN_AND_INCR(ptr8, REQ_SIGNAL_RELAY);
-
-        int32_t* ptr = (int32_t*)ptr8;
-        ASSIGN_AND_INCR(ptr, sigId);
-        ASSIGN_AND_INCR(ptr, sigType);
+        char batchBuf[REQ_BATCH_BUFFER_SIZE];
+        int32_t batchSize = initBatch(batchBuf, numHandles);
 
-        int64_t* ptr64 = (int64_t*)ptr;
-        ASSIGN_AND_INCR(ptr64, 0);
-        ASSIGN_AND_INCR(ptr64, duration);
+        for(int32_t i = 0; i < numHandles; i++) {
+            if(handles[i] <= 0) {
+                LOGE("RESTUNE_CLIENT", "Invalid Request Params");
+                return -1;
+            }
 
-        const char* charIterator = appName;
-        char* charPointer = (char*) ptr64;
+            char buf[REQ_BUFFER_SIZE];
+            int32_t reqSize = encodeSignalRequest(buf, REQ_SIGNAL_UNTUNING, 0, 0, handles[i], -1, 0,
+                                                  "", "", 0, nullptr);
+            if(reqSize < 0) return -1;
 
-        while(*charIterator != '\0') {
-            ASSIGN_AND_INCR(charPointer, *charIterator);
-            charIterator++;
+            if((batchSize = appendToBatch(batchBuf, batchSize, buf, reqSize)) < 0) return -1;
         }
 
-        ASSIGN_AND_INCR(charPointer, '\0');
+        // Batches are always acknowledged, the reply must be consumed to keep the connection in sync.
+        int64_t results[REQ_BATCH_MAX_COUNT];
+        return submitBatchAndWait(batchBuf, batchSize, numHandles, results);
 
-        charIterator = scenario;
+    } catch(const std::exception& e) {
+        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
+    }
 
-        while(*charIterator != '\0') {
-            ASSIGN_AND_INCR(charPointer, *charIterator);
-            charIterator++;
-        }
+    return -1;
+}
 
-        ASSIGN_AND_INCR(charPointer, '\0');
+int8_t enableSharedMemoryTransport(int8_t enable) {
+    try {
+        // Make sure that at least the caller's connection is switched (and negotiated) right away.
+        getDispatcher();
 
-        ptr = (int32_t*)charPointer;
-        ASSIGN_AND_INCR(ptr, VALIDATE_GE(numArgs, 0));
-        ASSIGN_AND_INCR(ptr, VALIDATE_GE(properties, 0));
-        ASSIGN_AND_INCR(ptr, (int32_t)getpid());
-        ASSIGN_AND_INCR(ptr, (int32_t)gettid());
+        const std::lock_guard<std::mutex> lock(poolLock);
 
-        for(int32_t i = 0; i < numArgs; i++) {
-            uint32_t arg = list[i];
-            ASSIGN_AND_INCR(ptr, arg)
-        }
+        // Negotiate the channels up front, so that a failure is reported to the caller
+        // before any of the connections is switched over.
+        std::shared_ptr<ClientEndpoint> nextConns[connPoolSize];
+        for(int32_t i = 0; i < connPoolSize; i++) {
+            if(dispatchers[i] == nullptr) continue;
 
-        if(conn == nullptr || RC_IS_NOTOK(conn->initiateConnection())) {
-            LOGE("RESTUNE_CLIENT", CONN_INIT_FAIL);
-            return -1;
+            nextConns[i] = createEndpoint(enable);
+            if(enable && RC_IS_NOTOK(nextConns[i]->initiateConnection())) {
+                LOGE("RESTUNE_CLIENT", CONN_INIT_FAIL);
+                return -1;
+            }
         }
+        useShmTransport = enable;
 
-        // Send the request to Resource Tuner Server
-        if(RC_IS_NOTOK(conn->sendMsg(buf, sizeof(buf)))) {
-            LOGE("RESTUNE_CLIENT", CONN_SEND_FAIL);
-            return -1;
+        // Each connection is owned by its I/O thread, it switches over once the Requests queued
+        // so far are done. Handles leased over the old connection can not be used on the new one.
+        for(int32_t i = 0; i < connPoolSize; i++) {
+            if(dispatchers[i] == nullptr) continue;
+
+            const std::lock_guard<std::mutex> leaseGuard(dispatchers[i]->mLeaseLock);
+            dispatchers[i]->mLeaseNext = dispatchers[i]->mLeaseEnd = 0;
+
+            PendingRequest request;
+            request.mReplySize = 0;
+            request.mOnComplete = [](int8_t, const char*) {};
+            request.mSwitchTo = nextConns[i];
+            enqueueRequest(dispatchers[i], request);
         }
 
         return 0;
 
-    } catch(const std::invalid_argument& e) {
-        LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
-        return -1;
-
     } catch(const std::exception& e) {
         LOGE("RESTUNE_CLIENT", REQ_SEND_ERR(e.what()));
-        return -1;
     }
 
     return -1;
 }
+
+int8_t setRejectionCallback(UrmRejectionCallback callback, void* userData) {
+    const std::lock_guard<std::mutex> lock(rejectionLock);
+    rejectionCb = callback;
+    rejectionUserData = userData;
+    return 0;
+}
+
+int8_t setCoalescingWindow(int64_t windowMs) {
+    if(windowMs < 0) {
+        LOGE("RESTUNE_CLIENT", "Invalid Request Params");
+        return -1;
+    }
+
+    coalescer.setWindow(std::chrono::milliseconds(windowMs));
+    return 0;
+}
+
+int8_t getCoalescingStats(UrmCoalescingStats* stats) {
+    if(stats == nullptr) return -1;
+
+    coalescer.getStats(stats);
+    return 0;
+}
@@ -0,0 +1,45 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#ifndef RESOURCE_TUNER_SHM_CLIENT_H
+#define RESOURCE_TUNER_SHM_CLIENT_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include "ClientEndpoint.h"
+#include "SocketClient.h"
+#include "ShmRing.h"
+#include "ErrCodes.h"
+
+/**
+ * @brief ShmClient
+ * @details Shared-memory transport, for latency sensitive clients. The client creates a sealed
+ *          memfd holding a pair of SPSC rings and two eventfd doorbells, and hands them to the
+ *          Server once over the socket. Afterwards a Request is a copy into the Request ring
+ *          followed by a single eventfd write, and Responses are picked up from the Response ring.
+ *          The socket is kept open only to tie the channel's lifetime to the client's.
+ */
+class ShmClient : public ClientEndpoint {
+private:
+    SocketClient mSocket;
+    int32_t mMemFd;
+    int32_t mRequestDoorbell;
+    int32_t mResponseDoorbell;
+    ShmRegion* mRegion;
+
+    int32_t createChannel();
+    void releaseChannel();
+
+public:
+    ShmClient();
+    ~ShmClient();
+
+    virtual int32_t initiateConnection();
+    virtual int32_t sendMsg(char* buf, size_t bufSize);
+    virtual int32_t readMsg(char* buf, size_t bufSize);
+    virtual int8_t hasPendingMsg();
+    virtual int32_t closeConnection();
+};
+
+#endif
@@ -0,0 +1,177 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+
+#include "ShmClient.h"
+
+ShmClient::ShmClient() {
+    this->mMemFd = -1;
+    this->mRequestDoorbell = -1;
+    this->mResponseDoorbell = -1;
+    this->mRegion = nullptr;
+}
+
+void ShmClient::releaseChannel() {
+    if(this->mRegion != nullptr) {
+        munmap(this->mRegion, sizeof(ShmRegion));
+        this->mRegion = nullptr;
+    }
+
+    int32_t* fds[] = {&this->mMemFd, &this->mRequestDoorbell, &this->mResponseDoorbell};
+    for(int32_t* fd: fds) {
+        if(*fd != -1) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+
+    this->mSocket.closeConnection();
+}
+
+int32_t ShmClient::createChannel() {
+    this->mMemFd = memfd_create("urm-shm-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if(this->mMemFd < 0 || ftruncate(this->mMemFd, sizeof(ShmRegion)) < 0) {
+        TYPELOGV(ERRNO_LOG, "memfd_create", strerror(errno));
+        return RC_SOCKET_CONN_NOT_INITIALIZED;
+    }
+
+    // The Server maps the region as well, it must not be resizable once handed over.
+    if(fcntl(this->mMemFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0) {
+        TYPELOGV(ERRNO_LOG, "fcntl", strerror(errno));
+        return RC_SOCKET_CONN_NOT_INITIALIZED;
+    }
+
+    void* region = mmap(nullptr, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, this->mMemFd, 0);
+    if(region == MAP_FAILED) {
+        TYPELOGV(ERRNO_LOG, "mmap", strerror(errno));
+        return RC_SOCKET_CONN_NOT_INITIALIZED;
+    }
+
+    // The memfd is zero-filled, hence both rings start out empty.
+    this->mRegion = (ShmRegion*)region;
+    this->mRegion->mMagic = SHM_RING_MAGIC;
+    this->mRegion->mVersion = SHM_RING_VERSION;
+
+    this->mRequestDoorbell = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    this->mResponseDoorbell = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if(this->mRequestDoorbell < 0 || this->mResponseDoorbell < 0) {
+        TYPELOGV(ERRNO_LOG, "eventfd", strerror(errno));
+        return RC_SOCKET_CONN_NOT_INITIALIZED;
+    }
+
+    if(RC_IS_NOTOK(this->mSocket.initiateConnection())) {
+        return RC_SOCKET_CONN_NOT_INITIALIZED;
+    }
+
+    char attachReq[2] = {MOD_RESTUNE, REQ_SHM_ATTACH};
+    int32_t fds[3] = {this->mMemFd, this->mRequestDoorbell, this->mResponseDoorbell};
+    if(RC_IS_NOTOK(this->mSocket.sendMsgWithFds(attachReq, sizeof(attachReq), fds, 3))) {
+        return RC_SOCKET_CONN_NOT_INITIALIZED;
+    }
+
+    int64_t channelId = -1;
+    if(RC_IS_NOTOK(this->mSocket.readMsg((char*)&channelId, sizeof(channelId))) || channelId < 0) {
+        LOGE("RESTUNE_SHM_CLIENT", "Server rejected the shared memory channel");
+        return RC_SOCKET_CONN_NOT_INITIALIZED;
+    }
+
+    return RC_SUCCESS;
+}
+
+int32_t ShmClient::initiateConnection() {
+    if(this->mRegion != nullptr) {
+        if(this->mSocket.isConnectionAlive()) {
+            return RC_SUCCESS;
+        }
+
+        // The Server has gone away, negotiate a fresh channel.
+        this->releaseChannel();
+    }
+
+    int32_t status = this->createChannel();
+    if(RC_IS_NOTOK(status)) {
+        this->releaseChannel();
+    }
+    return status;
+}
+
+int32_t ShmClient::sendMsg(char* buf, size_t bufSize) {
+    if(buf == nullptr || bufSize == 0) return RC_BAD_ARG;
+    if(this->mRegion == nullptr) return RC_SOCKET_CONN_NOT_INITIALIZED;
+
+    if(bufSize > SHM_RING_SLOT_SIZE) {
+        LOGE("RESTUNE_SHM_CLIENT", "Request exceeds the ring slot size");
+        return RC_SOCKET_FD_WRITE_FAILURE;
+    }
+
+    // The Server drains the ring asynchronously, if it is full wait for a slot to free up,
+    // periodically checking that the Server is still around.
+    int32_t attempts = 0;
+    while(!shmRingPush(&this->mRegion->mRequestRing, buf, bufSize)) {
+        if(++attempts % SHM_RING_LIVENESS_CHECK_INTERVAL == 0 && !this->mSocket.isConnectionAlive()) {
+            this->releaseChannel();
+            return RC_SOCKET_FD_WRITE_FAILURE;
+        }
+        usleep(SHM_RING_FULL_BACKOFF_US);
+    }
+
+    uint64_t doorbell = 1;
+    if(write(this->mRequestDoorbell, &doorbell, sizeof(doorbell)) < 0) {
+        TYPELOGV(ERRNO_LOG, "write", strerror(errno));
+        return RC_SOCKET_FD_WRITE_FAILURE;
+    }
+
+    return RC_SUCCESS;
+}
+
+int32_t ShmClient::readMsg(char* buf, size_t bufSize) {
+    if(buf == nullptr || bufSize == 0) return RC_BAD_ARG;
+    if(this->mRegion == nullptr) return RC_SOCKET_CONN_NOT_INITIALIZED;
+
+    while(true) {
+        int32_t msgSize = shmRingPop(&this->mRegion->mResponseRing, buf, bufSize);
+        if(msgSize > 0) {
+            return RC_SUCCESS;
+        }
+
+        if(msgSize < 0) {
+            this->releaseChannel();
+            return RC_SOCKET_FD_READ_FAILURE;
+        }
+
+        // Wait for the Server to ring the doorbell, periodically checking that it is still around.
+        struct pollfd pfd = {this->mResponseDoorbell, POLLIN, 0};
+        int32_t ready = poll(&pfd, 1, 100);
+        if(ready > 0) {
+            uint64_t doorbell = 0;
+            if(read(this->mResponseDoorbell, &doorbell, sizeof(doorbell)) < 0 && errno != EAGAIN) {
+                TYPELOGV(ERRNO_LOG, "read", strerror(errno));
+            }
+            continue;
+        }
+
+        if((ready < 0 && errno != EINTR) || !this->mSocket.isConnectionAlive()) {
+            this->releaseChannel();
+            return RC_SOCKET_FD_READ_FAILURE;
+        }
+    }
+}
+
+int8_t ShmClient::hasPendingMsg() {
+    if(this->mRegion == nullptr) return false;
+    return !shmRingIsEmpty(&this->mRegion->mResponseRing);
+}
+
+int32_t ShmClient::closeConnection() {
+    this->releaseChannel();
+    return RC_SUCCESS;
+}
+
+ShmClient::~ShmClient() {
+    this->releaseChannel();
+}
@@ -15,9 +15,18 @@
 #include "Utils.h"
 #include "ClientEndpoint.h"
 #include "ErrCodes.h"
+#include "UrmSettings.h"
 
 #define RESTUNE_SOCKET_PATH "/run/restune_sock"
 
+// Must match the Server: every message is framed as [uint32_t payload length][payload]
+#define RESTUNE_MAX_FRAME_SIZE REQ_BATCH_BUFFER_SIZE
+#define RESTUNE_MAX_PASSED_FDS 4
+
+/**
+ * @brief SocketClient
+ * @details The connection to the Server is established once and reused for subsequent Requests.
+ */
 class SocketClient : public ClientEndpoint {
 private:
     int32_t sockFd;
@@ -29,7 +38,18 @@ public:
     virtual int32_t initiateConnection();
     virtual int32_t sendMsg(char* buf, size_t bufSize);
     virtual int32_t readMsg(char* buf, size_t bufSize);
+    virtual int8_t hasPendingMsg();
     virtual int32_t closeConnection();
+
+    /**
+     * @brief Send a message along with a set of fds (SCM_RIGHTS), used for transport negotiation.
+     */
+    int32_t sendMsgWithFds(char* buf, size_t bufSize, const int32_t* fds, int32_t numFds);
+
+    /**
+     * @brief Check (without blocking) whether the connection is still open on the Server end.
+     */
+    int8_t isConnectionAlive();
 };
 
 #endif
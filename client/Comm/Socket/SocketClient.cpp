@@ -1,6 +1,9 @@
 // Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
 // SPDX-License-Identifier: BSD-3-Clause-Clear
 
+#include <poll.h>
+#include <algorithm>
+
 #include "SocketClient.h"
 
 #ifndef UNIX_PATH_MAX
@@ -12,8 +15,14 @@ SocketClient::SocketClient() {
 }
 
 int32_t SocketClient::initiateConnection() {
-    if((this->sockFd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    // The connection is persistent, reuse it if already established.
+    if(this->sockFd != -1) {
+        return RC_SUCCESS;
+    }
+
+    if((this->sockFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0) {
         TYPELOGV(ERRNO_LOG, "socket", strerror(errno));
+        this->sockFd = -1;
         return RC_SOCKET_CONN_NOT_INITIALIZED;
     }
 
@@ -37,34 +46,151 @@ int32_t SocketClient::initiateConnection() {
     return RC_SUCCESS;
 }
 
+static int8_t readFully(int32_t fd, char* buf, size_t bufSize) {
+    size_t bytesRead = 0;
+    while(bytesRead < bufSize) {
+        ssize_t curRead = read(fd, buf + bytesRead, bufSize - bytesRead);
+        if(curRead < 0 && errno == EINTR) continue;
+        if(curRead <= 0) {
+            if(curRead < 0) {
+                TYPELOGV(ERRNO_LOG, "read", strerror(errno));
+            }
+            return false;
+        }
+        bytesRead += curRead;
+    }
+    return true;
+}
+
 int32_t SocketClient::sendMsg(char* buf, size_t bufSize) {
-    if(buf == nullptr) return RC_BAD_ARG;
+    if(buf == nullptr || bufSize == 0 || bufSize > RESTUNE_MAX_FRAME_SIZE) return RC_BAD_ARG;
+    if(this->sockFd == -1) return RC_SOCKET_CONN_NOT_INITIALIZED;
+
+    // Frame: [uint32_t payload length][payload], sent in one go so that
+    // the header and payload are not split across separate segments.
+    char frame[sizeof(uint32_t) + RESTUNE_MAX_FRAME_SIZE];
+    uint32_t payloadSize = bufSize;
+    std::memcpy(frame, &payloadSize, sizeof(uint32_t));
+    std::memcpy(frame + sizeof(uint32_t), buf, bufSize);
+
+    size_t totalSize = sizeof(uint32_t) + bufSize;
+    size_t bytesSent = 0;
+    while(bytesSent < totalSize) {
+        ssize_t curSent = send(this->sockFd, frame + bytesSent, totalSize - bytesSent, MSG_NOSIGNAL);
+        if(curSent < 0 && errno == EINTR) continue;
+        if(curSent < 0) {
+            TYPELOGV(ERRNO_LOG, "send", strerror(errno));
+            // The Server might have restarted, force a reconnect on the next Request.
+            this->closeConnection();
+            return RC_SOCKET_FD_WRITE_FAILURE;
+        }
+        bytesSent += curSent;
+    }
+
+    return RC_SUCCESS;
+}
+
+int32_t SocketClient::sendMsgWithFds(char* buf, size_t bufSize, const int32_t* fds, int32_t numFds) {
+    if(buf == nullptr || bufSize == 0 || bufSize > RESTUNE_MAX_FRAME_SIZE ||
+       fds == nullptr || numFds <= 0 || numFds > RESTUNE_MAX_PASSED_FDS) {
+        return RC_BAD_ARG;
+    }
+    if(this->sockFd == -1) return RC_SOCKET_CONN_NOT_INITIALIZED;
 
-    if(write(this->sockFd, buf, bufSize) == -1) {
-        TYPELOGV(ERRNO_LOG, "write", strerror(errno));
+    char frame[sizeof(uint32_t) + RESTUNE_MAX_FRAME_SIZE];
+    uint32_t payloadSize = bufSize;
+    std::memcpy(frame, &payloadSize, sizeof(uint32_t));
+    std::memcpy(frame + sizeof(uint32_t), buf, bufSize);
+
+    // The fds are attached to the first byte of the frame, the whole frame is sent in one call.
+    char controlBuf[CMSG_SPACE(sizeof(int32_t) * RESTUNE_MAX_PASSED_FDS)];
+    std::memset(controlBuf, 0, sizeof(controlBuf));
+
+    struct iovec iov = {frame, sizeof(uint32_t) + bufSize};
+    struct msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = controlBuf;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int32_t) * numFds);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int32_t) * numFds);
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int32_t) * numFds);
+
+    ssize_t bytesSent = 0;
+    do {
+        bytesSent = sendmsg(this->sockFd, &msg, MSG_NOSIGNAL);
+    } while(bytesSent < 0 && errno == EINTR);
+
+    if(bytesSent != (ssize_t)(sizeof(uint32_t) + bufSize)) {
+        if(bytesSent < 0) {
+            TYPELOGV(ERRNO_LOG, "sendmsg", strerror(errno));
+        }
+        this->closeConnection();
         return RC_SOCKET_FD_WRITE_FAILURE;
     }
 
     return RC_SUCCESS;
 }
 
+int8_t SocketClient::hasPendingMsg() {
+    if(this->sockFd == -1) return false;
+
+    struct pollfd pfd = {this->sockFd, POLLIN, 0};
+    return poll(&pfd, 1, 0) > 0;
+}
+
+int8_t SocketClient::isConnectionAlive() {
+    if(this->sockFd == -1) return false;
+
+    // Only used for the socket backing a shared memory channel, over which the Server never
+    // sends unsolicited messages (they go over the channel), hence any readiness means hang-up.
+    struct pollfd pfd = {this->sockFd, POLLIN, 0};
+    return poll(&pfd, 1, 0) == 0;
+}
+
 int32_t SocketClient::readMsg(char* buf, size_t bufSize) {
     if(buf == nullptr || bufSize == 0) {
         return RC_BAD_ARG;
     }
-    int32_t statusCode;
+    if(this->sockFd == -1) return RC_SOCKET_CONN_NOT_INITIALIZED;
+
+    uint32_t payloadSize = 0;
+    if(!readFully(this->sockFd, (char*)&payloadSize, sizeof(uint32_t)) ||
+       payloadSize > RESTUNE_MAX_FRAME_SIZE) {
+        this->closeConnection();
+        return RC_SOCKET_FD_READ_FAILURE;
+    }
 
-    if((statusCode = read(this->sockFd, buf, bufSize)) < 0) {
-        TYPELOGV(ERRNO_LOG, "read", strerror(errno));
+    size_t toCopy = std::min<size_t>(payloadSize, bufSize);
+    if(!readFully(this->sockFd, buf, toCopy)) {
+        this->closeConnection();
         return RC_SOCKET_FD_READ_FAILURE;
     }
 
+    // Discard any part of the payload which does not fit in the caller's buffer,
+    // so that the stream stays aligned to the frame boundary.
+    char discardBuf[64];
+    size_t remaining = payloadSize - toCopy;
+    while(remaining > 0) {
+        size_t curChunk = std::min(remaining, sizeof(discardBuf));
+        if(!readFully(this->sockFd, discardBuf, curChunk)) {
+            this->closeConnection();
+            return RC_SOCKET_FD_READ_FAILURE;
+        }
+        remaining -= curChunk;
+    }
+
     return RC_SUCCESS;
 }
 
 int32_t SocketClient::closeConnection() {
     if(this->sockFd != -1) {
-        return close(this->sockFd);
+        int32_t status = close(this->sockFd);
+        this->sockFd = -1;
+        return status;
     }
     return RC_SOCKET_FD_CLOSE_FAILURE;
 }
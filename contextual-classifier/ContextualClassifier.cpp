@@ -11,6 +11,8 @@
 #include <pthread.h>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "Utils.h"
 #include "UrmPlatformAL.h"
@@ -107,13 +109,15 @@ static Request* createResourceTuningRequest(uint32_t sigId,
     return nullptr;
 }
 
-static ResIterable* createMovePidResource(int32_t cGroupdId, pid_t pid) {
+static ResIterable* createMovePidResource(int32_t cGroupdId, const std::vector<pid_t>& pids) {
     ResIterable* resIterable = MPLACED(ResIterable);
     Resource* resource = MPLACED(Resource);
     resource->setResCode(RES_CGRP_MOVE_PID);
-    resource->setNumValues(2);
+    resource->setNumValues(pids.size() + 1);
     resource->setValueAt(0, cGroupdId);
-    resource->setValueAt(1, pid);
+    for(size_t i = 0; i < pids.size(); i++) {
+        resource->setValueAt(i + 1, pids[i]);
+    }
 
     resIterable->mData = resource;
     return resIterable;
@@ -478,9 +482,12 @@ void ContextualClassifier::MoveAppThreadsToCGroup(pid_t incomingPID,
         request->setClientPID(incomingPID);
         request->setClientTID(incomingTID);
 
+        // Group the pids by their target CGroup, so that each CGroup gets a single
+        // multi-valued Resource and the pids are migrated in one pass.
+        std::unordered_map<int32_t, std::vector<pid_t>> cGroupPids;
+
         // Move the incoming pid
-        ResIterable* resIter = createMovePidResource(cgroupIdentifier, incomingPID);
-        request->addResource(resIter);
+        cGroupPids[cgroupIdentifier].push_back(incomingPID);
 
         AppConfig* appConfig = AppConfigs::getInstance()->getAppConfig(comm);
         if(appConfig != nullptr && appConfig->mThreadNameList != nullptr) {
@@ -492,11 +499,15 @@ void ContextualClassifier::MoveAppThreadsToCGroup(pid_t incomingPID,
                 if(targetPID != -1 && targetPID != incomingPID) {
                     // Get the CGroup
                     int32_t currCGroupID = appConfig->mCGroupIds[i];
-                    request->addResource(createMovePidResource(currCGroupID, targetPID));
+                    cGroupPids[currCGroupID].push_back(targetPID);
                 }
             }
         }
 
+        for(std::pair<const int32_t, std::vector<pid_t>>& entry: cGroupPids) {
+            request->addResource(createMovePidResource(entry.first, entry.second));
+        }
+
         // Anything to issue
         if(request->getResourcesCount() > 0) {
             // fast path to Request Queue
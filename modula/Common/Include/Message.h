@@ -17,14 +17,16 @@ protected:
     int32_t mProperties; //!< Request Properties, includes Priority and Background Processing Status.
     int32_t mClientPID; //!< Process ID of the client making the request.
     int32_t mClientTID; //!< Thread ID of the client making the request.
+    int8_t mClientLevel; //!< Permission level of the client, as verified by the Listener. -1 if unknown.
 
 public:
-    Message() : mProperties(0) {}
+    Message() : mProperties(0), mClientLevel(-1) {}
 
     int8_t getRequestType() const;
     int64_t getDuration() const;
     int32_t getClientPID() const;
     int32_t getClientTID() const;
+    int8_t getClientLevel() const;
     int64_t getHandle() const;
     int8_t getPriority() const;
     int8_t getProcessingModes() const;
@@ -34,6 +36,7 @@ public:
     void setDuration(int64_t duration);
     void setClientPID(int32_t clientPID);
     void setClientTID(int32_t clientTID);
+    void setClientLevel(int8_t clientLevel);
     void setProperties(int32_t properties);
     void setPriority(int8_t priority);
     void addProcessingMode(int8_t processingMode);
@@ -13,6 +13,7 @@
 #include "Message.h"
 #include "Resource.h"
 #include "DLManager.h"
+#include "WireFormat.h"
 
 #define REQUEST_DL_NR 0
 #define COCO_TABLE_DL_NR 1
@@ -24,6 +25,7 @@ class Request : public Message {
 private:
     Timer* mTimer; //!< Timer associated with the request.
     DLManager* mResourceList;
+    uint64_t mFingerprint; //!< Hash of the Resources, 0 if not computed yet.
 
 public:
     Request();
@@ -38,7 +40,21 @@ public:
     void unsetTimer();
     void clearResources();
 
-    ErrCode deserialize(char* buf);
+    /**
+     * @brief Compute the fingerprint of the Request's Resources.
+     * @details The fingerprint does not depend on the order in which the Resources are
+     *          specified. It is computed when the Request is decoded, and should be recomputed
+     *          if the Resources are modified afterwards.
+     */
+    void computeFingerprint();
+
+    /**
+     * @brief Get the fingerprint of the Request's Resources, computing it if needed.
+     * @return uint64_t: Non-zero fingerprint, equal for Requests with the same Resources.
+     */
+    uint64_t getFingerprint();
+
+    ErrCode deserialize(char* buf, uint64_t bufSize);
 
     void populateUntuneRequest(Request* request);
     void populateRetuneRequest(Request* request, int64_t duration);
@@ -0,0 +1,122 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+/*!
+ * \file  ShmRing.h
+ */
+
+/*!
+ * \ingroup  SHM_RING
+ * \defgroup SHM_RING Shared Memory Ring
+ * \details Layout of the memfd-backed region shared between a client and the Server, when the
+ *          shared-memory transport is in use.\n\n
+ *          The region holds two single-producer / single-consumer rings:\n
+ *          1) The Request ring, written by the client and drained by the Server.\n
+ *          2) The Response ring, written by the Server (handles, prop values) and drained by the client.\n\n
+ *          Each side signals the other through an eventfd doorbell after publishing a slot, hence
+ *          sending a Request is a memcpy into the ring followed by a single eventfd write.
+ *
+ *          The region is created by the client, the Server never trusts its contents: indices and
+ *          lengths are bounds checked on every access.
+ *
+ * @{
+ */
+
+#ifndef URM_SHM_RING_H
+#define URM_SHM_RING_H
+
+#include <cstdint>
+#include <cstring>
+
+#define SHM_RING_MAGIC 0x53524d55
+#define SHM_RING_VERSION 1
+#define SHM_RING_SLOT_COUNT 16
+#define SHM_RING_SLOT_SIZE 4096
+
+// Producers back off while the ring is full, checking on the consumer every so many attempts.
+#define SHM_RING_FULL_BACKOFF_US 50
+#define SHM_RING_LIVENESS_CHECK_INTERVAL 2000
+
+typedef struct {
+    uint32_t mLength;
+    char mPayload[SHM_RING_SLOT_SIZE];
+} ShmSlot;
+
+// Producer and Consumer indices are kept on separate cache lines.
+typedef struct {
+    alignas(64) uint32_t mHead; //!< Next slot to be written, advanced by the producer.
+    alignas(64) uint32_t mTail; //!< Next slot to be read, advanced by the consumer.
+    ShmSlot mSlots[SHM_RING_SLOT_COUNT];
+} ShmRing;
+
+typedef struct {
+    uint32_t mMagic;
+    uint32_t mVersion;
+    ShmRing mRequestRing;
+    ShmRing mResponseRing;
+} ShmRegion;
+
+/**
+ * @brief Publish a message to the ring, to be called only by the producer.
+ * @return int8_t:\n
+ *            - 1: If the message was published\n
+ *            - 0: If the ring is full, or the message does not fit in a slot
+ */
+inline int8_t shmRingPush(ShmRing* ring, const void* buf, uint32_t bufSize) {
+    if(bufSize > SHM_RING_SLOT_SIZE) return false;
+
+    uint32_t head = __atomic_load_n(&ring->mHead, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&ring->mTail, __ATOMIC_ACQUIRE);
+    if(head - tail >= SHM_RING_SLOT_COUNT) {
+        return false;
+    }
+
+    ShmSlot* slot = &ring->mSlots[head % SHM_RING_SLOT_COUNT];
+    std::memcpy(slot->mPayload, buf, bufSize);
+    slot->mLength = bufSize;
+
+    __atomic_store_n(&ring->mHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Consume the oldest message from the ring, to be called only by the consumer.
+ * @details Messages larger than the supplied buffer are truncated.
+ * @return int32_t:\n
+ *            - Length of the message consumed\n
+ *            - 0: If the ring is empty\n
+ *            - -1: If the ring is corrupted
+ */
+inline int32_t shmRingPop(ShmRing* ring, void* buf, uint32_t bufSize) {
+    uint32_t tail = __atomic_load_n(&ring->mTail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&ring->mHead, __ATOMIC_ACQUIRE);
+    if(head == tail) {
+        return 0;
+    }
+
+    if(head - tail > SHM_RING_SLOT_COUNT) {
+        return -1;
+    }
+
+    ShmSlot* slot = &ring->mSlots[tail % SHM_RING_SLOT_COUNT];
+    uint32_t length = __atomic_load_n(&slot->mLength, __ATOMIC_RELAXED);
+    if(length == 0 || length > SHM_RING_SLOT_SIZE) {
+        return -1;
+    }
+
+    std::memcpy(buf, slot->mPayload, length < bufSize ? length : bufSize);
+    __atomic_store_n(&ring->mTail, tail + 1, __ATOMIC_RELEASE);
+
+    return length;
+}
+
+/**
+ * @brief Check whether the ring holds any message, to be called only by the consumer.
+ */
+inline int8_t shmRingIsEmpty(ShmRing* ring) {
+    return __atomic_load_n(&ring->mHead, __ATOMIC_ACQUIRE) == __atomic_load_n(&ring->mTail, __ATOMIC_RELAXED);
+}
+
+#endif
+
+/*! @} */
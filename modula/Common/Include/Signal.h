@@ -11,6 +11,7 @@
 #include "Logger.h"
 #include "Message.h"
 #include "MemoryPool.h"
+#include "WireFormat.h"
 
 /**
 * @brief Encapsulation type for a Signal Tuning Request.
@@ -43,8 +44,8 @@ public:
     void setNumArgs(int32_t numArgs);
     void setList(std::vector<uint32_t>* mListArgs);
 
-    ErrCode serialize(char* buf);
-    ErrCode deserialize(char* buf);
+    ErrCode serialize(char* buf, uint64_t bufSize);
+    ErrCode deserialize(char* buf, uint64_t bufSize);
 
     static void cleanUpSignal(Signal* signal);
 };
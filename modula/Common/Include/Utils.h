@@ -32,7 +32,12 @@ enum RequestType : int8_t {
     REQ_PROP_GET,
     REQ_SIGNAL_TUNING,
     REQ_SIGNAL_UNTUNING,
-    REQ_SIGNAL_RELAY
+    REQ_SIGNAL_RELAY,
+    REQ_BATCH,
+    REQ_SHM_ATTACH,
+    REQ_HANDLE_LEASE,
+    REQ_MODE_TRANSITION, //!< Internal to the Server, never sent over the wire.
+    REQ_CLIENT_CLEANUP //!< Internal to the Server, never sent over the wire.
 };
 
 /**
@@ -86,12 +91,26 @@ enum TranslationUnit {
     U_GHz = 1000 * 1000 * 1000,
 };
 
+/**
+ * @brief Identity of the process at the other end of a client connection, as reported
+ *        by the Kernel (SO_PEERCRED). Fields are -1 if the identity could not be fetched.
+ */
+typedef struct {
+    int32_t mPID;
+    int32_t mUID;
+    int8_t mLevel; //!< Permission level derived from the UID.
+} PeerIdentity;
+
 typedef struct {
     int8_t mModuleID;
     int8_t mRequestType;
-    uint64_t mBufferSize;
+    uint64_t mBufferSize; //!< Size of the buffer allocated, refer allocReqBuffer.
+    uint64_t mPayloadSize; //!< Size of the Request held in the buffer, the rest of which is zeroed.
     int64_t mHandle;
     char* mBuffer;
+    PeerIdentity mPeer; //!< Identity of the connection the Request was received over.
+    int32_t mClientId = -1; //!< Connection (socket or shared memory channel) the Request was received over.
+    uint64_t mLeaseGeneration = 0; //!< Non-zero if the handle was leased to the client, refer RequestReceiver.
 } MsgForwardInfo;
 
 typedef struct {
@@ -126,10 +145,11 @@ typedef void (*MessageReceivedCallback)(int32_t, MsgForwardInfo*);
 #define MAX_RESOURCES_PER_REQUEST "resource_tuner.maximum.resources.per.request"
 #define PULSE_MONITOR_DURATION "resource_tuner.pulse.duration"
 #define GARBAGE_COLLECTOR_DURATION "resource_tuner.garbage_collection.duration"
-#define GARBAGE_COLLECTOR_BATCH_SIZE "resource_tuner.garbage_collection.batch_size"
 #define RATE_LIMITER_DELTA "resource_tuner.rate_limiter.delta"
 #define RATE_LIMITER_PENALTY_FACTOR "resource_tuner.penalty.factor"
 #define RATE_LIMITER_REWARD_FACTOR "resource_tuner.reward.factor"
+#define DRIFT_DETECTOR_DURATION "resource_tuner.drift_detector.duration"
+#define DRIFT_DETECTOR_REASSERT "resource_tuner.drift_detector.reassert"
 #define LOGGER_LOGGING_LEVEL "urm.logging.level"
 #define LOGGER_LOGGING_LEVEL_TYPE "urm.logging.level.exact"
 #define LOGGER_LOGGING_OUTPUT_REDIRECT "urm.logging.redirect_to"
@@ -0,0 +1,131 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+/*!
+ * \file  WireFormat.h
+ */
+
+/*!
+ * \ingroup  WIRE_FORMAT
+ * \defgroup WIRE_FORMAT Wire Format
+ * \details Compact encoding of the Tune / Retune / Untune and Signal Requests.\n\n
+ *          Every Request starts with a fixed header: [Module ID][Request Type][Format Version],
+ *          followed by fields encoded as LEB128 varints (signed fields are zigzag encoded) and
+ *          NUL-terminated strings. Fields which are most often left at their defaults are
+ *          optional, and their presence is flagged in the Request.\n\n
+ *          Resource Requests:\n
+ *          [Handle][Flags]([Duration])([Properties])[PID][TID][NumRes]
+ *          {[ResCode][ResInfo][OptionalInfo][NumValues]{[Value]} x NumValues} x NumRes\n\n
+ *          Signal Requests:\n
+ *          [Handle][Flags]([Duration])([Properties])[PID][TID][SigID][SigType]
+ *          [AppName][Scenario][NumArgs]{[Arg]} x NumArgs\n\n
+ *          The handle is always the first field, so that it can be picked up without
+ *          decoding the whole Request.
+ *
+ * @{
+ */
+
+#ifndef URM_WIRE_FORMAT_H
+#define URM_WIRE_FORMAT_H
+
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+
+#define WIRE_FORMAT_VERSION 1
+#define WIRE_HEADER_SIZE 3
+#define WIRE_MAX_VARINT_SIZE 10
+
+// Optional fields, absent fields take the values noted below.
+#define WIRE_HAS_DURATION 0x1   //!< Defaults to -1
+#define WIRE_HAS_PROPERTIES 0x2 //!< Defaults to 0
+
+inline uint64_t wireZigZag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t wireUnZigZag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/**
+ * @brief Encode a varint into the buffer.
+ * @return int32_t:\n
+ *            - Number of bytes written\n
+ *            - -1: If the buffer is too small
+ */
+inline int32_t wireEncodeVarint(char* buf, int32_t bufSize, uint64_t value) {
+    int32_t length = 0;
+    do {
+        if(length >= bufSize) return -1;
+
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        buf[length++] = (char)(value != 0 ? (byte | 0x80) : byte);
+    } while(value != 0);
+
+    return length;
+}
+
+/**
+ * @brief WireReader
+ * @details Bounds-checked decoding of a Request, a std::invalid_argument exception
+ *          is thrown if a field runs past the end of the buffer or is malformed.
+ */
+class WireReader {
+private:
+    const char* mCur;
+    const char* mEnd;
+
+public:
+    WireReader(const char* buf, uint64_t bufSize) {
+        this->mCur = buf;
+        this->mEnd = buf + bufSize;
+    }
+
+    int8_t readByte() {
+        if(this->mCur >= this->mEnd) {
+            throw std::invalid_argument("Request truncated");
+        }
+        return *this->mCur++;
+    }
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for(int32_t shift = 0; shift < 7 * WIRE_MAX_VARINT_SIZE; shift += 7) {
+            uint8_t byte = (uint8_t)this->readByte();
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::invalid_argument("Malformed varint");
+    }
+
+    int64_t readSignedVarint() {
+        return wireUnZigZag(this->readVarint());
+    }
+
+    /**
+     * @brief Read a count of elements, each of which takes up at least one more byte.
+     * @details Counts which the remaining buffer could not possibly hold are rejected,
+     *          before the caller sizes any allocation by them.
+     */
+    int32_t readCount() {
+        uint64_t count = this->readVarint();
+        if(count > (uint64_t)(this->mEnd - this->mCur)) {
+            throw std::invalid_argument("Element count exceeds the Request size");
+        }
+        return (int32_t)count;
+    }
+
+    std::string readString() {
+        const char* start = this->mCur;
+        while(this->readByte() != '\0') {}
+        return std::string(start, this->mCur - start - 1);
+    }
+};
+
+#endif
+
+/*! @} */
@@ -19,6 +19,10 @@ int32_t Message::getClientTID() const {
     return this->mClientTID;
 }
 
+int8_t Message::getClientLevel() const {
+    return this->mClientLevel;
+}
+
 int8_t Message::getPriority() const {
     return (int8_t) ((this->mProperties) & (((int32_t)1 << 8) - 1));
 }
@@ -55,6 +59,10 @@ void Message::setClientTID(int32_t clientTid) {
     this->mClientTID = clientTid;
 }
 
+void Message::setClientLevel(int8_t clientLevel) {
+    this->mClientLevel = clientLevel;
+}
+
 void Message::setProperties(int32_t properties) {
     this->mProperties = properties;
 }
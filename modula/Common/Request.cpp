@@ -6,6 +6,7 @@
 Request::Request() {
     this->mTimer = nullptr;
     this->mResourceList = nullptr;
+    this->mFingerprint = 0;
 }
 
 int32_t Request::getResourcesCount() {
@@ -65,6 +66,46 @@ void Request::clearResources() {
     }
 }
 
+static uint64_t mixFingerprint(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void Request::computeFingerprint() {
+    // Each Resource is hashed on its own and the hashes are summed up, so that the
+    // order of the Resources does not matter, while repeated Resources still count.
+    uint64_t fingerprint = mixFingerprint(0, this->getResourcesCount());
+    if(this->mResourceList != nullptr) {
+        DL_ITERATE(this->mResourceList) {
+            ResIterable* resIter = (ResIterable*) iter;
+            if(resIter == nullptr || resIter->mData == nullptr) continue;
+
+            Resource* resource = (Resource*) resIter->mData;
+            uint64_t resHash = mixFingerprint(0, resource->getResCode());
+            resHash = mixFingerprint(resHash, (uint32_t)resource->getResInfo());
+            resHash = mixFingerprint(resHash, (uint32_t)resource->getOptionalInfo());
+            resHash = mixFingerprint(resHash, (uint32_t)resource->getValuesCount());
+            for(int32_t i = 0; i < resource->getValuesCount(); i++) {
+                resHash = mixFingerprint(resHash, (uint32_t)resource->getValueAt(i));
+            }
+            fingerprint += resHash;
+        }
+    }
+
+    // 0 is reserved for "not computed".
+    this->mFingerprint = (fingerprint == 0) ? 1 : fingerprint;
+}
+
+uint64_t Request::getFingerprint() {
+    if(this->mFingerprint == 0) {
+        this->computeFingerprint();
+    }
+    return this->mFingerprint;
+}
+
 // Use cleanpUpRequest for clearing a Request and it's associated components
 Request::~Request() {
     if(this->mResourceList != nullptr) {
@@ -95,42 +136,47 @@ void Request::populateRetuneRequest(Request* retuneRequest, int64_t newDuration)
     retuneRequest->mResourceList = nullptr;
 }
 
-ErrCode Request::deserialize(char* buf) {
+// Refer WireFormat.h for the encoding.
+ErrCode Request::deserialize(char* buf, uint64_t bufSize) {
     try {
-        int32_t numResources = 0;
-        int8_t* ptr8 = (int8_t*)buf;
-        DEREF_AND_INCR(ptr8, int8_t);
-        this->mReqType = DEREF_AND_INCR(ptr8, int8_t);
-
-        int64_t* ptr64 = (int64_t*)ptr8;
-        this->mHandle = DEREF_AND_INCR(ptr64, int64_t);
-        this->mDuration = DEREF_AND_INCR(ptr64, int64_t);
+        WireReader reader(buf, bufSize);
+        reader.readByte();
+        this->mReqType = reader.readByte();
+        if(reader.readByte() != WIRE_FORMAT_VERSION) {
+            throw std::invalid_argument("Unsupported wire format version");
+        }
 
-        int32_t* ptr = (int32_t*)ptr64;
-        numResources = DEREF_AND_INCR(ptr, int32_t);
-        this->mProperties = DEREF_AND_INCR(ptr, int32_t);
-        this->mClientPID = DEREF_AND_INCR(ptr, int32_t);
-        this->mClientTID = DEREF_AND_INCR(ptr, int32_t);
+        this->mHandle = reader.readSignedVarint();
+        uint64_t flags = reader.readVarint();
+        this->mDuration = (flags & WIRE_HAS_DURATION) ? reader.readSignedVarint() : -1;
+        this->mProperties = (flags & WIRE_HAS_PROPERTIES) ? (int32_t)reader.readVarint() : 0;
+        this->mClientPID = (int32_t)reader.readVarint();
+        this->mClientTID = (int32_t)reader.readVarint();
+        int32_t numResources = reader.readCount();
 
         if(this->mReqType == REQ_RESOURCE_TUNING) {
             for(int32_t i = 0; i < numResources; i++) {
                 ResIterable* resIterable = MPLACED(ResIterable);
                 Resource* resource = MPLACED(Resource);
 
-                resource->setResCode(DEREF_AND_INCR(ptr, int32_t));
-                resource->setResInfo(DEREF_AND_INCR(ptr, int32_t));
-                resource->setOptionalInfo(DEREF_AND_INCR(ptr, int32_t));
-                resource->setNumValues(DEREF_AND_INCR(ptr, int32_t));
+                // Tracked by the Request right away, so that it is released along with it on failure.
+                resIterable->mData = resource;
+                this->addResource(resIterable);
+
+                resource->setResCode((uint32_t)reader.readVarint());
+                resource->setResInfo((int32_t)reader.readVarint());
+                resource->setOptionalInfo((int32_t)reader.readVarint());
+                resource->setNumValues(reader.readCount());
 
                 for(int32_t j = 0; j < resource->getValuesCount(); j++) {
-                    if(RC_IS_NOTOK(resource->setValueAt(j, DEREF_AND_INCR(ptr, int32_t)))) {
+                    if(RC_IS_NOTOK(resource->setValueAt(j, (int32_t)reader.readSignedVarint()))) {
                         return RC_REQUEST_DESERIALIZATION_FAILURE;
                     }
                 }
-
-                resIterable->mData = resource;
-                this->addResource(resIterable);
             }
+
+            // Hashed here, so that Duplicate Checking doesn't have to walk the Resources.
+            this->computeFingerprint();
         }
 
     } catch(const std::invalid_argument& e) {
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause-Clear
 
 #include "Signal.h"
+#include "AuxRoutines.h"
 
 Signal::Signal() {}
 
@@ -57,91 +58,62 @@ void Signal::setList(std::vector<uint32_t>* listArgs) {
     this->mListArgs = listArgs;
 }
 
-ErrCode Signal::serialize(char* buf) {
-    try {
-        int8_t* ptr8 = (int8_t*)buf;
-        ASSIGN_AND_INCR(ptr8, this->getRequestType());
-
-        int32_t* ptr = (int32_t*)ptr8;
-        ASSIGN_AND_INCR(ptr, this->getSignalCode());
-
-        int64_t* ptr64 = (int64_t*)ptr;
-        ASSIGN_AND_INCR(ptr64, this->getHandle());
-        ASSIGN_AND_INCR(ptr64, this->getDuration());
-
-        char* charPointer = (char*) ptr64;
-
-        for(char ch: this->getAppName()) {
-            ASSIGN_AND_INCR(charPointer, ch);
-        }
-
-        ASSIGN_AND_INCR(charPointer, '\0');
-
-        for(char ch: this->getScenario()) {
-            ASSIGN_AND_INCR(charPointer, ch);
-        }
-
-        ASSIGN_AND_INCR(charPointer, '\0');
-
-        ptr = (int32_t*)charPointer;
-        ASSIGN_AND_INCR(ptr, this->getNumArgs());
-        ASSIGN_AND_INCR(ptr, this->getProperties());
-        ASSIGN_AND_INCR(ptr, this->getClientPID());
-        ASSIGN_AND_INCR(ptr, this->getClientTID());
-
-        for(int32_t i = 0; i < this->getNumArgs(); i++) {
-            uint32_t arg = this->getListArgAt(i);
-            ASSIGN_AND_INCR(ptr, arg)
-        }
-    } catch(const std::bad_alloc& e) {
-        return RC_REQUEST_PARSING_FAILED;
-    } catch(const std::exception& e) {
-        return RC_INVALID_VALUE;
+// Refer WireFormat.h for the encoding.
+ErrCode Signal::serialize(char* buf, uint64_t bufSize) {
+    FlatBuffEncoder encoder(bufSize);
+    encoder.setBuf(buf);
+
+    uint64_t flags = WIRE_HAS_DURATION | WIRE_HAS_PROPERTIES;
+    encoder.append<int8_t>(MOD_RESTUNE)
+           .append<int8_t>(this->getRequestType())
+           .append<int8_t>(WIRE_FORMAT_VERSION)
+           .appendSignedVarint(this->getHandle())
+           .appendVarint(flags)
+           .appendSignedVarint(this->getDuration())
+           .appendVarint((uint32_t)this->getProperties())
+           .appendVarint((uint32_t)this->getClientPID())
+           .appendVarint((uint32_t)this->getClientTID())
+           .appendVarint(this->getSignalCode())
+           .appendVarint(this->getSignalType())
+           .appendString(this->getAppName().c_str())
+           .appendString(this->getScenario().c_str())
+           .appendVarint((uint32_t)this->getNumArgs());
+
+    for(int32_t i = 0; i < this->getNumArgs(); i++) {
+        encoder.appendVarint(this->getListArgAt(i));
     }
 
-    return RC_SUCCESS;
+    return encoder.isBufSane() ? RC_SUCCESS : RC_INVALID_VALUE;
 }
 
-ErrCode Signal::deserialize(char* buf) {
+// Refer WireFormat.h for the encoding.
+ErrCode Signal::deserialize(char* buf, uint64_t bufSize) {
     try {
-        int8_t* ptr8 = (int8_t*)buf;
-        DEREF_AND_INCR(ptr8, int8_t);
-        this->mReqType = DEREF_AND_INCR(ptr8, int8_t);
-
-        int32_t* ptr = (int32_t*)ptr8;
-        this->mSignalCode = DEREF_AND_INCR(ptr, int32_t);
-        this->mSignalType = DEREF_AND_INCR(ptr, int32_t);
-
-        int64_t* ptr64 = (int64_t*)ptr;
-        this->mHandle = DEREF_AND_INCR(ptr64, int64_t);
-        this->mDuration = DEREF_AND_INCR(ptr64, int64_t);
-
-        char* charIterator = (char*)ptr64;
-        this->mAppName = charIterator;
-
-        while(*charIterator != '\0') {
-            charIterator++;
+        WireReader reader(buf, bufSize);
+        reader.readByte();
+        this->mReqType = reader.readByte();
+        if(reader.readByte() != WIRE_FORMAT_VERSION) {
+            throw std::invalid_argument("Unsupported wire format version");
         }
-        charIterator++;
 
-        this->mScenario = charIterator;
-
-        while(*charIterator != '\0') {
-            charIterator++;
-        }
-        charIterator++;
+        this->mHandle = reader.readSignedVarint();
+        uint64_t flags = reader.readVarint();
+        this->mDuration = (flags & WIRE_HAS_DURATION) ? reader.readSignedVarint() : -1;
+        this->mProperties = (flags & WIRE_HAS_PROPERTIES) ? (int32_t)reader.readVarint() : 0;
+        this->mClientPID = (int32_t)reader.readVarint();
+        this->mClientTID = (int32_t)reader.readVarint();
 
-        ptr = (int32_t*)charIterator;
-        this->mNumArgs = DEREF_AND_INCR(ptr, int32_t);
-        this->mProperties = DEREF_AND_INCR(ptr, int32_t);
-        this->mClientPID = DEREF_AND_INCR(ptr, int32_t);
-        this->mClientTID = DEREF_AND_INCR(ptr, int32_t);
+        this->mSignalCode = (uint32_t)reader.readVarint();
+        this->mSignalType = (uint32_t)reader.readVarint();
+        this->mAppName = reader.readString();
+        this->mScenario = reader.readString();
+        this->mNumArgs = reader.readCount();
 
         this->mListArgs = MPLACED(std::vector<uint32_t>);
         this->mListArgs->resize(this->mNumArgs);
 
         for(int32_t i = 0; i < this->mNumArgs; i++) {
-            (*this->mListArgs)[i] = DEREF_AND_INCR(ptr, uint32_t);
+            (*this->mListArgs)[i] = (uint32_t)reader.readVarint();
         }
 
     } catch(const std::invalid_argument& e) {
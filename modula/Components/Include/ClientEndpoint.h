@@ -14,6 +14,7 @@ public:
     virtual int32_t initiateConnection() = 0;
     virtual int32_t sendMsg(char* buf, size_t bufSize) = 0;
     virtual int32_t readMsg(char* buf, size_t bufSize) = 0;
+    virtual int8_t hasPendingMsg() = 0; //!< Non-blocking check for a message waiting to be read.
     virtual int32_t closeConnection() = 0;
 };
 
@@ -5,19 +5,32 @@
 #define LOGGER_H
 
 #include <string>
+#include <atomic>
 #include <ctime>
 #include <chrono>
 #include <fstream>
 #include <cstdarg>
 #include <sstream>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <condition_variable>
 #include <syslog.h>
 
-#define LOGD(tag, message) Logger::log(LOG_DEBUG, tag, __func__, message)
-#define LOGI(tag, message) Logger::log(LOG_INFO, tag, __func__, message)
-#define LOGE(tag, message) Logger::log(LOG_ERR, tag, __func__, message)
-#define LOGW(tag, message) Logger::log(LOG_WARNING, tag, __func__, message)
-#define TYPELOGV(type, args...) Logger::typeLog(type, __func__, args)
-#define TYPELOGD(type) Logger::typeLog(type, __func__)
+// The level is checked before the message is evaluated, hence a disabled level
+// costs a single branch and none of the string building or formatting.
+#define LOG_AT_LEVEL(level, tag, message) \
+    do { if(Logger::isLevelEnabled(level)) Logger::log(level, tag, __func__, message); } while(0)
+
+#define LOGD(tag, message) LOG_AT_LEVEL(LOG_DEBUG, tag, message)
+#define LOGI(tag, message) LOG_AT_LEVEL(LOG_INFO, tag, message)
+#define LOGE(tag, message) LOG_AT_LEVEL(LOG_ERR, tag, message)
+#define LOGW(tag, message) LOG_AT_LEVEL(LOG_WARNING, tag, message)
+#define TYPELOGV(type, args...) \
+    do { if(Logger::isTypeEnabled(type)) Logger::typeLog(type, __func__, args); } while(0)
+#define TYPELOGD(type) \
+    do { if(Logger::isTypeEnabled(type)) Logger::typeLog(type, __func__); } while(0)
 
 enum RedirectOptions {
     LOG_TOFILE,
@@ -112,8 +125,37 @@ enum CommonMessageTypes {
     NOTIFY_CLASSIFIER_PROC_EVENT,
     NOTIFY_CLASSIFIER_PROC_IGNORE,
     NOTIFY_MODEL_PREDICTION,
+    COMMON_MESSAGE_TYPES_COUNT,
 };
 
+#define LOG_TYPE_MASK_WORDS ((COMMON_MESSAGE_TYPES_COUNT + 63) / 64)
+
+// Records longer than the below sizes are truncated.
+#define LOG_RECORD_TAG_SIZE 32
+#define LOG_RECORD_FUNC_SIZE 48
+#define LOG_RECORD_MESSAGE_SIZE 420
+#define LOG_RING_SLOT_COUNT 64
+
+typedef struct {
+    int64_t mTimestamp; //!< Seconds since the epoch, captured by the logging thread.
+    int32_t mLevel;
+    char mTag[LOG_RECORD_TAG_SIZE];
+    char mFuncName[LOG_RECORD_FUNC_SIZE];
+    char mMessage[LOG_RECORD_MESSAGE_SIZE];
+} LogRecord;
+
+/**
+ * @brief LogRing
+ * @details Single-producer / single-consumer ring of LogRecords. Each logging thread owns one
+ *          ring, which is drained by the Logger's sink thread.
+ */
+typedef struct {
+    alignas(64) std::atomic<uint32_t> mHead {0}; //!< Next slot to be written, advanced by the logging thread.
+    std::atomic<int8_t> mWriting {false}; //!< Set while the logging thread is pushing a record, refer stopSink.
+    alignas(64) std::atomic<uint32_t> mTail {0}; //!< Next slot to be read, advanced by the sink thread.
+    LogRecord mSlots[LOG_RING_SLOT_COUNT];
+} LogRing;
+
 /**
  * @brief Logger.
  * @details Provides a Simplified and Consistent interface for Logging across different Targets
@@ -124,12 +166,35 @@ enum CommonMessageTypes {
  */
 class Logger {
 private:
-    static int32_t mLowestLogLevel;
-    static int8_t mLevelSpecificLogging;
+    // Bitmasks of the levels and message types which are currently not logged. Both are
+    // zero (everything logged) until configure is called, and are read lock-free by the macros.
+    static std::atomic<uint32_t> mSuppressedLevels;
+    static std::atomic<uint64_t> mSuppressedTypes[LOG_TYPE_MASK_WORDS];
     static RedirectOptions mRedirectOutputTo;
 
-    static std::string getTimestamp();
+    // Sink state, while the sink is running Messages are handed off to it through the
+    // calling thread's ring, and written out with a persistent fd.
+    static std::atomic<int8_t> mSinkRunning;
+    static std::atomic<uint64_t> mDroppedCount;
+    static int32_t mSinkFd;
+    static std::thread mSinkThread;
+    static std::mutex mSinkMutex;
+    static std::condition_variable mSinkCond;
+    static std::atomic<int8_t> mSinkIdle; //!< Set while the sink waits for records, refer sinkRoutine.
+    static int8_t mSinkWakeup; //!< Guarded by mSinkMutex.
+    static std::mutex mRingsMutex;
+    static std::vector<std::shared_ptr<LogRing>> mRings;
+
     static const char* levelToString(int32_t level);
+    static int32_t getTypeLevel(CommonMessageTypes type);
+
+    static LogRing* getThreadRing();
+    static int32_t openOutput();
+    static void writeRecord(const LogRecord& record, int32_t outputFd);
+    static int32_t drainRings();
+    static int8_t hasPendingRecords();
+    static void wakeSink();
+    static void sinkRoutine();
 
 public:
     /**
@@ -147,6 +212,20 @@ public:
      */
     static void configure(int32_t level, int8_t levelSpecificLogging, RedirectOptions redirectOutputTo);
 
+    /**
+     * @brief Check whether Messages at the given level are currently logged.
+     */
+    static inline int8_t isLevelEnabled(int32_t level) {
+        return ((mSuppressedLevels.load(std::memory_order_relaxed) >> (level & 31)) & 1) == 0;
+    }
+
+    /**
+     * @brief Check whether Messages of the given type are currently logged.
+     */
+    static inline int8_t isTypeEnabled(CommonMessageTypes type) {
+        return ((mSuppressedTypes[type / 64].load(std::memory_order_relaxed) >> (type % 64)) & 1) == 0;
+    }
+
     /**
      * @brief Responsible for actually Logging a Message to the desired Medium (file or syslog)
      * @details Note, this Routine should not be called directly, instead the Macros
@@ -155,6 +234,29 @@ public:
     static void log(int32_t level, const std::string& tag, const std::string& funcName, const char* message);
     static void log(int32_t level, const std::string& tag, const std::string& funcName, const std::string& message);
     static void typeLog(CommonMessageTypes type, const std::string& funcName, ...);
+
+    /**
+     * @brief Start the background sink.
+     * @details Once started, logging threads only copy a fixed-size record into their own ring,
+     *          the formatting and the actual write (to syslog, or a file / trace_marker fd which
+     *          is kept open) happen on the sink thread. If a ring is full, the record is dropped
+     *          rather than blocking the caller. Until the sink is started (or after it is stopped),
+     *          Messages are written inline. Should be called after configure.
+     * @return int8_t:\n
+     *            - 1: If the sink is running\n
+     *            - 0: Otherwise
+     */
+    static int8_t startSink();
+
+    /**
+     * @brief Stop the background sink, after writing out the records pending in the rings.
+     */
+    static void stopSink();
+
+    /**
+     * @brief Get the number of records dropped due to a full ring.
+     */
+    static uint64_t getDroppedCount();
 };
 
 #endif
@@ -1,26 +1,50 @@
 // Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
 // SPDX-License-Identifier: BSD-3-Clause-Clear
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
 #include "Logger.h"
 
-int32_t Logger::mLowestLogLevel = LOG_DEBUG;
-int8_t Logger::mLevelSpecificLogging = false;
+std::atomic<uint32_t> Logger::mSuppressedLevels {0};
+std::atomic<uint64_t> Logger::mSuppressedTypes[LOG_TYPE_MASK_WORDS] {};
 RedirectOptions Logger::mRedirectOutputTo = RedirectOptions::LOG_TOSYSLOG;
 
+std::atomic<int8_t> Logger::mSinkRunning {false};
+std::atomic<uint64_t> Logger::mDroppedCount {0};
+int32_t Logger::mSinkFd = -1;
+std::thread Logger::mSinkThread {};
+std::mutex Logger::mSinkMutex {};
+std::condition_variable Logger::mSinkCond {};
+std::atomic<int8_t> Logger::mSinkIdle {false};
+int8_t Logger::mSinkWakeup = false;
+std::mutex Logger::mRingsMutex {};
+std::vector<std::shared_ptr<LogRing>> Logger::mRings {};
+
 void Logger::configure(int32_t level, int8_t levelSpecificLogging, RedirectOptions redirectOutputTo) {
-    mLowestLogLevel = level;
-    mLevelSpecificLogging = levelSpecificLogging;
     mRedirectOutputTo = redirectOutputTo;
-}
 
-std::string Logger::getTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    time_t now_c = std::chrono::system_clock::to_time_t(now);
-    tm local_tm = *localtime(&now_c);
-
-    char buffer[64];
-    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local_tm);
-    return std::string(buffer);
+    uint32_t suppressedLevels = 0;
+    for(int32_t logLevel = LOG_EMERG; logLevel <= LOG_DEBUG; logLevel++) {
+        if(levelSpecificLogging ? (logLevel != level) : (logLevel > level)) {
+            suppressedLevels |= (1U << logLevel);
+        }
+    }
+    mSuppressedLevels.store(suppressedLevels, std::memory_order_relaxed);
+
+    // Each message type is logged at a fixed level, resolve them once here
+    // instead of on every call.
+    uint64_t suppressedTypes[LOG_TYPE_MASK_WORDS] = {};
+    for(int32_t type = 0; type < COMMON_MESSAGE_TYPES_COUNT; type++) {
+        if(suppressedLevels & (1U << getTypeLevel((CommonMessageTypes)type))) {
+            suppressedTypes[type / 64] |= (1ULL << (type % 64));
+        }
+    }
+    for(int32_t i = 0; i < LOG_TYPE_MASK_WORDS; i++) {
+        mSuppressedTypes[i].store(suppressedTypes[i], std::memory_order_relaxed);
+    }
 }
 
 const char* Logger::levelToString(int32_t level) {
@@ -39,39 +63,129 @@ const char* Logger::levelToString(int32_t level) {
     return "";
 }
 
-void Logger::log(int32_t level,
-                 const std::string& tag,
-                 const std::string& funcName,
-                 const char* message) {
-    if(mLevelSpecificLogging) {
-        if(level != mLowestLogLevel) return;
-    } else {
-        if(level > mLowestLogLevel) return;
+int32_t Logger::getTypeLevel(CommonMessageTypes type) {
+    switch(type) {
+        case CommonMessageTypes::NOTIFY_COCO_TABLE_INSERT_START:
+        case CommonMessageTypes::NOTIFY_COCO_TABLE_INSERT_SUCCESS:
+        case CommonMessageTypes::NOTIFY_COCO_TABLE_UPDATE_START:
+        case CommonMessageTypes::NOTIFY_COCO_TABLE_REMOVAL_START:
+        case CommonMessageTypes::NOTIFY_COCO_TABLE_REQUEST_EXPIRY:
+        case CommonMessageTypes::NOTIFY_COCO_TABLE_WRITE:
+        case CommonMessageTypes::NOTIFY_CLASSIFIER_PROC_EVENT:
+        case CommonMessageTypes::NOTIFY_CLASSIFIER_PROC_IGNORE:
+            return LOG_DEBUG;
+
+        case CommonMessageTypes::NOTIFY_MODULE_ENABLED:
+        case CommonMessageTypes::LISTENER_THREAD_CREATION_SUCCESS:
+        case CommonMessageTypes::NOTIFY_RESOURCE_TUNER_INIT_START:
+        case CommonMessageTypes::NOTIFY_CURRENT_TARGET_NAME:
+        case CommonMessageTypes::NOTIFY_EXTENSIONS_LIB_NOT_PRESENT:
+        case CommonMessageTypes::NOTIFY_EXTENSIONS_LIB_LOADED_SUCCESS:
+        case CommonMessageTypes::VERIFIER_REQUEST_VALIDATED:
+        case CommonMessageTypes::NOTIFY_NODE_WRITE:
+        case CommonMessageTypes::NOTIFY_NODE_WRITE_S:
+        case CommonMessageTypes::NOTIFY_NODE_RESET:
+        case CommonMessageTypes::RATE_LIMITER_RATE_LIMITED:
+        case CommonMessageTypes::NOTIFY_PARSING_START:
+        case CommonMessageTypes::NOTIFY_PARSING_SUCCESS:
+        case CommonMessageTypes::NOTIFY_CUSTOM_CONFIG_FILE:
+        case CommonMessageTypes::NOTIFY_PARSER_FILE_NOT_FOUND:
+        case CommonMessageTypes::LOGICAL_TO_PHYSICAL_MAPPING_GEN_SUCCESS:
+        case CommonMessageTypes::NOTIFY_MODEL_PREDICTION:
+            return LOG_INFO;
+
+        default:
+            break;
     }
+    return LOG_ERR;
+}
+
+static void copyTruncated(char* dest, size_t destSize, const char* src, size_t srcLength) {
+    size_t length = srcLength < destSize - 1 ? srcLength : destSize - 1;
+    std::memcpy(dest, src, length);
+    dest[length] = '\0';
+}
+
+static void fillRecord(LogRecord* record,
+                       int32_t level,
+                       const std::string& tag,
+                       const std::string& funcName,
+                       const char* message) {
+    record->mTimestamp = (int64_t)time(nullptr);
+    record->mLevel = level;
+    copyTruncated(record->mTag, sizeof(record->mTag), tag.c_str(), tag.length());
+    copyTruncated(record->mFuncName, sizeof(record->mFuncName), funcName.c_str(), funcName.length());
+    copyTruncated(record->mMessage, sizeof(record->mMessage), message, strlen(message));
+}
 
-    std::string timestamp = getTimestamp();
-    const char* levelStr = levelToString(level);
+// The ring is shared with the sink, so that records written by a thread are
+// still drained after it exits.
+static thread_local std::shared_ptr<LogRing> threadRing = nullptr;
+
+LogRing* Logger::getThreadRing() {
+    if(threadRing == nullptr) {
+        try {
+            std::shared_ptr<LogRing> ring = std::make_shared<LogRing>();
+            const std::lock_guard<std::mutex> lock(mRingsMutex);
+            mRings.push_back(ring);
+            threadRing = ring;
+        } catch(const std::bad_alloc& e) {
+            return nullptr;
+        }
+    }
+    return threadRing.get();
+}
 
+int32_t Logger::openOutput() {
     switch(mRedirectOutputTo) {
-        case RedirectOptions::LOG_TOSYSLOG: {
-            syslog(level, "[%s] [%s] %s: %s", tag.c_str(), levelStr, funcName.c_str(), message);
+        case RedirectOptions::LOG_TOFTRACE:
+            return open("/sys/kernel/debug/tracing/trace_marker", O_WRONLY | O_CLOEXEC);
+
+        case RedirectOptions::LOG_TOFILE:
+            return open("log.txt", O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+        default:
             break;
-        }
+    }
+    return -1;
+}
 
-        case RedirectOptions::LOG_TOFTRACE: {
-            std::ofstream logFile("/sys/kernel/debug/tracing/trace_marker", std::ios::app);
-            if(logFile.is_open()) {
-                logFile<<"["<<timestamp<<"] ["<<tag<<"] ["<<levelStr<<"] "<<funcName<<": "<<message<<std::endl;
-                logFile.close();
-            }
+void Logger::writeRecord(const LogRecord& record, int32_t outputFd) {
+    const char* levelStr = levelToString(record.mLevel);
+
+    switch(mRedirectOutputTo) {
+        case RedirectOptions::LOG_TOSYSLOG: {
+            syslog(record.mLevel, "[%s] [%s] %s: %s", record.mTag, levelStr, record.mFuncName, record.mMessage);
             break;
         }
 
+        case RedirectOptions::LOG_TOFTRACE:
         case RedirectOptions::LOG_TOFILE: {
-            std::ofstream logFile("log.txt", std::ios::app);
-            if(logFile.is_open()) {
-                logFile<<"["<<timestamp<<"] ["<<tag<<"] ["<<levelStr<<"] "<<funcName<<": "<<message<<std::endl;
-                logFile.close();
+            // Without a persistent fd (sink not running), open the output for this record alone.
+            int32_t fd = (outputFd >= 0) ? outputFd : openOutput();
+            if(fd < 0) {
+                break;
+            }
+
+            time_t timestamp = (time_t)record.mTimestamp;
+            tm localTm;
+            char timestampStr[64];
+            localtime_r(&timestamp, &localTm);
+            strftime(timestampStr, sizeof(timestampStr), "%Y-%m-%d %H:%M:%S", &localTm);
+
+            // Sized to hold the largest record, hence the line is never truncated.
+            char line[640];
+            int32_t length = snprintf(line, sizeof(line), "[%s] [%s] [%s] %s: %s\n",
+                                      timestampStr, record.mTag, levelStr, record.mFuncName, record.mMessage);
+            if(length > 0) {
+                ssize_t bytesWritten = 0;
+                do {
+                    bytesWritten = write(fd, line, length);
+                } while(bytesWritten < 0 && errno == EINTR);
+            }
+
+            if(fd != outputFd) {
+                close(fd);
             }
             break;
         }
@@ -81,50 +195,209 @@ void Logger::log(int32_t level,
     }
 }
 
+void Logger::log(int32_t level,
+                 const std::string& tag,
+                 const std::string& funcName,
+                 const char* message) {
+    if(!isLevelEnabled(level)) return;
+
+    if(!mSinkRunning.load(std::memory_order_acquire)) {
+        LogRecord record;
+        fillRecord(&record, level, tag, funcName, message);
+        writeRecord(record, -1);
+        return;
+    }
+
+    LogRing* ring = getThreadRing();
+    if(ring == nullptr) {
+        mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Pairs with stopSink: either the sink's shutdown is observed here, and the record is
+    // written inline, or stopSink waits for the push to complete before its final drain.
+    ring->mWriting.store(true, std::memory_order_seq_cst);
+    if(!mSinkRunning.load(std::memory_order_seq_cst)) {
+        ring->mWriting.store(false, std::memory_order_release);
+
+        LogRecord record;
+        fillRecord(&record, level, tag, funcName, message);
+        writeRecord(record, -1);
+        return;
+    }
+
+    uint32_t head = ring->mHead.load(std::memory_order_relaxed);
+    if(head - ring->mTail.load(std::memory_order_acquire) >= LOG_RING_SLOT_COUNT) {
+        // Never wait on the sink, the record is dropped instead.
+        ring->mWriting.store(false, std::memory_order_release);
+        mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    fillRecord(&ring->mSlots[head % LOG_RING_SLOT_COUNT], level, tag, funcName, message);
+    ring->mHead.store(head + 1, std::memory_order_seq_cst);
+    ring->mWriting.store(false, std::memory_order_release);
+
+    // The sink sleeps until woken up once it has found all the rings empty.
+    if(mSinkIdle.load(std::memory_order_seq_cst)) {
+        wakeSink();
+    }
+}
+
 void Logger::log(int32_t level,
                  const std::string& tag,
                  const std::string& funcName,
                  const std::string& message) {
+    Logger::log(level, tag, funcName, message.c_str());
+}
 
-    if(mLevelSpecificLogging) {
-        if(level != mLowestLogLevel) return;
-    } else {
-        if(level > mLowestLogLevel) return;
+int32_t Logger::drainRings() {
+    std::vector<std::shared_ptr<LogRing>> rings;
+    {
+        const std::lock_guard<std::mutex> lock(mRingsMutex);
+        for(auto it = mRings.begin(); it != mRings.end();) {
+            // Release the rings of exited threads, once they have been drained.
+            LogRing* ring = it->get();
+            if(it->use_count() == 1 &&
+               ring->mHead.load(std::memory_order_acquire) == ring->mTail.load(std::memory_order_relaxed)) {
+                it = mRings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        rings = mRings;
     }
 
-    std::string timestamp = getTimestamp();
-    const char* levelStr = levelToString(level);
+    int32_t drainedCount = 0;
+    for(std::shared_ptr<LogRing>& ring: rings) {
+        uint32_t tail = ring->mTail.load(std::memory_order_relaxed);
+        uint32_t head = ring->mHead.load(std::memory_order_acquire);
 
-    switch(mRedirectOutputTo) {
-        case RedirectOptions::LOG_TOSYSLOG: {
-            syslog(level, "[%s] [%s] %s: %s", tag.c_str(), levelStr, funcName.c_str(), message.c_str());
-            break;
+        while(tail != head) {
+            writeRecord(ring->mSlots[tail % LOG_RING_SLOT_COUNT], mSinkFd);
+            tail++;
+            ring->mTail.store(tail, std::memory_order_release);
+            drainedCount++;
         }
+    }
 
-        case RedirectOptions::LOG_TOFTRACE: {
-            std::ofstream logFile("/sys/kernel/debug/tracing/trace_marker", std::ios::app);
-            if(logFile.is_open()) {
-                logFile<<"["<<timestamp<<"] ["<<tag<<"] ["<<levelStr<<"] "<<funcName<<": "<<message<<std::endl;
-                logFile.close();
-            }
-            break;
+    return drainedCount;
+}
+
+int8_t Logger::hasPendingRecords() {
+    const std::lock_guard<std::mutex> lock(mRingsMutex);
+    for(std::shared_ptr<LogRing>& ring: mRings) {
+        if(ring->mHead.load(std::memory_order_seq_cst) != ring->mTail.load(std::memory_order_relaxed)) {
+            return true;
         }
+    }
+    return false;
+}
 
-        case RedirectOptions::LOG_TOFILE: {
-            std::ofstream logFile("log.txt", std::ios::app);
-            if(logFile.is_open()) {
-                logFile<<"["<<timestamp<<"] ["<<tag<<"] ["<<levelStr<<"] "<<funcName<<": "<<message<<std::endl;
-                logFile.close();
-            }
-            break;
+void Logger::wakeSink() {
+    {
+        const std::lock_guard<std::mutex> lock(mSinkMutex);
+        mSinkWakeup = true;
+    }
+    mSinkCond.notify_one();
+}
+
+void Logger::sinkRoutine() {
+    while(true) {
+        if(drainRings() > 0) {
+            continue;
         }
 
-        default:
+        std::unique_lock<std::mutex> lock(mSinkMutex);
+        if(!mSinkRunning.load(std::memory_order_acquire)) {
             break;
+        }
+
+        // Pairs with log: either a record pushed from here on is seen by the check below,
+        // or its logging thread sees the sink idle, and wakes it up.
+        mSinkIdle.store(true, std::memory_order_seq_cst);
+        if(!hasPendingRecords()) {
+            mSinkCond.wait(lock, [] {
+                return mSinkWakeup || !mSinkRunning.load(std::memory_order_acquire);
+            });
+        }
+        mSinkWakeup = false;
+        mSinkIdle.store(false, std::memory_order_release);
     }
 }
 
+int8_t Logger::startSink() {
+    const std::lock_guard<std::mutex> lock(mSinkMutex);
+    if(mSinkRunning.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    mSinkFd = openOutput();
+    try {
+        mSinkRunning.store(true, std::memory_order_release);
+        mSinkThread = std::thread(&Logger::sinkRoutine);
+
+    } catch(const std::system_error& e) {
+        mSinkRunning.store(false, std::memory_order_release);
+        if(mSinkFd >= 0) {
+            close(mSinkFd);
+            mSinkFd = -1;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+void Logger::stopSink() {
+    {
+        const std::lock_guard<std::mutex> lock(mSinkMutex);
+        if(!mSinkRunning.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        // Logging falls back to inline writes from here on, the sink drains what is
+        // already in the rings before exiting.
+        mSinkRunning.store(false, std::memory_order_seq_cst);
+        mSinkCond.notify_all();
+    }
+
+    if(mSinkThread.joinable()) {
+        mSinkThread.join();
+    }
+
+    // Threads which found the sink still running might have pushed past its final drain.
+    // Wait for their pushes to land, and drain the rings once more before closing the output.
+    std::vector<std::shared_ptr<LogRing>> rings;
+    {
+        const std::lock_guard<std::mutex> lock(mRingsMutex);
+        rings = mRings;
+    }
+    for(std::shared_ptr<LogRing>& ring: rings) {
+        while(ring->mWriting.load(std::memory_order_seq_cst)) {
+            std::this_thread::yield();
+        }
+    }
+    drainRings();
+
+    if(mSinkFd >= 0) {
+        close(mSinkFd);
+        mSinkFd = -1;
+    }
+
+    uint64_t droppedCount = mDroppedCount.load(std::memory_order_relaxed);
+    if(droppedCount > 0) {
+        LOGW("RESTUNE_LOGGER", "Log records dropped due to full rings: " + std::to_string(droppedCount));
+    }
+}
+
+uint64_t Logger::getDroppedCount() {
+    return mDroppedCount.load(std::memory_order_relaxed);
+}
+
 void Logger::typeLog(CommonMessageTypes type, const std::string& funcName, ...) {
+    if(!isTypeEnabled(type)) return;
+
     char buffer[256];
     va_list args;
     va_start(args, funcName);
@@ -44,43 +44,6 @@ void AuxRoutines::writeToFile(const std::string& fileName, const std::string& va
     fileStream.close();
 }
 
-void AuxRoutines::writeSysFsDefaults() {
-    // Write Defaults
-    std::ifstream file;
-
-    file.open(UrmSettings::mPersistenceFile);
-    if(!file.is_open()) {
-        LOGE("RESTUNE_SERVER_INIT",
-             "Failed to open sysfs original values file: " + UrmSettings::mPersistenceFile);
-        return;
-    }
-
-    std::string line;
-    while(std::getline(file, line)) {
-        std::stringstream lineStream(line);
-        std::string token;
-
-        int8_t index = 0;
-        std::string sysfsNodePath = "";
-        int32_t sysfsNodeDefaultValue = -1;
-
-        while(std::getline(lineStream, token, ',')) {
-            if(index == 0) {
-                sysfsNodePath = token;
-            } else if(index == 1) {
-                try {
-                    sysfsNodeDefaultValue = std::stoi(token);
-                } catch(const std::exception& e) {}
-            }
-            index++;
-        }
-
-        if(sysfsNodePath.length() > 0 && sysfsNodeDefaultValue != -1) {
-            AuxRoutines::writeToFile(sysfsNodePath, std::to_string(sysfsNodeDefaultValue));
-        }
-    }
-}
-
 void AuxRoutines::deleteFile(const std::string& fileName) {
     remove(fileName.c_str());
 }
@@ -172,10 +135,11 @@ int32_t AuxRoutines::fetchComm(pid_t pid, std::string &comm) {
     return 0;
 }
 
-FlatBuffEncoder::FlatBuffEncoder() {
+FlatBuffEncoder::FlatBuffEncoder(int32_t capacity) {
     this->mBuffer = nullptr;
     this->mCurPtr = nullptr;
     this->mRunningIndex = 0;
+    this->mCapacity = capacity;
 }
 
 void FlatBuffEncoder::setBuf(char* buffer) {
@@ -184,7 +148,7 @@ void FlatBuffEncoder::setBuf(char* buffer) {
     this->mRunningIndex = 0;
 }
 
-FlatBuffEncoder FlatBuffEncoder::appendString(const char* valStr) {
+FlatBuffEncoder& FlatBuffEncoder::appendString(const char* valStr) {
     if(this->mRunningIndex == -1 || this->mBuffer == nullptr) {
         return *this;
     }
@@ -193,7 +157,7 @@ FlatBuffEncoder FlatBuffEncoder::appendString(const char* valStr) {
     char* charPointer = reinterpret_cast<char*>(this->mCurPtr);
 
     while(*charIterator != '\0') {
-        if(this->mRunningIndex != -1 && this->mRunningIndex + 1 < REQ_BUFFER_SIZE) {
+        if(this->mRunningIndex != -1 && this->mRunningIndex + 1 < this->mCapacity) {
             try {
                 ASSIGN_AND_INCR(charPointer, *charIterator);
                 this->mRunningIndex++;
@@ -205,36 +169,71 @@ FlatBuffEncoder FlatBuffEncoder::appendString(const char* valStr) {
             }
         } else {
             // Prevent further updates on the current buffer
-            this->mRunningIndex = REQ_BUFFER_SIZE;
+            this->mRunningIndex = this->mCapacity;
             break;
         }
 
         charIterator++;
     }
 
-    if(this->mRunningIndex >= 0 && this->mRunningIndex < REQ_BUFFER_SIZE) {
+    if(this->mRunningIndex >= 0 && this->mRunningIndex < this->mCapacity) {
         return this->append<char>('\0');
     }
 
     return *this;
 }
 
+FlatBuffEncoder& FlatBuffEncoder::appendVarint(uint64_t val) {
+    if(this->mRunningIndex == -1 || this->mBuffer == nullptr || this->mRunningIndex >= this->mCapacity) {
+        return *this;
+    }
+
+    // Stays below the capacity, in line with append.
+    int32_t length = wireEncodeVarint((char*)this->mCurPtr, this->mCapacity - this->mRunningIndex - 1, val);
+    if(length < 0) {
+        // Prevent further updates on the current buffer
+        this->mRunningIndex = this->mCapacity;
+        return *this;
+    }
+
+    this->mRunningIndex += length;
+    this->mCurPtr = (char*)this->mCurPtr + length;
+    return *this;
+}
+
+FlatBuffEncoder& FlatBuffEncoder::appendSignedVarint(int64_t val) {
+    return this->appendVarint(wireZigZag(val));
+}
+
 int8_t FlatBuffEncoder::isBufSane() {
-    if(this->mRunningIndex >= REQ_BUFFER_SIZE || this->mBuffer == nullptr) {
+    if(this->mRunningIndex >= this->mCapacity || this->mBuffer == nullptr) {
         return false;
     }
     return true;
 }
 
+int32_t FlatBuffEncoder::getEncodedSize() {
+    if(!this->isBufSane() || this->mRunningIndex < 0) {
+        return -1;
+    }
+    return this->mRunningIndex;
+}
+
 int64_t AuxRoutines::generateUniqueHandle() {
+    return reserveHandleRange(1);
+}
+
+int64_t AuxRoutines::reserveHandleRange(int32_t count) {
+    if(count <= 0) return -1;
     const std::lock_guard<std::mutex> lock(handleGenLock);
 
     static int64_t handleGenerator = 0;
     OperationStatus opStatus;
-    int64_t nextHandle = Add(handleGenerator, (int64_t)1, opStatus);
+    int64_t lastHandle = Add(handleGenerator, (int64_t)count, opStatus);
     if(opStatus == SUCCESS) {
-        handleGenerator = nextHandle;
-        return nextHandle;
+        int64_t firstHandle = handleGenerator + 1;
+        handleGenerator = lastHandle;
+        return firstHandle;
     }
 
     return -1;
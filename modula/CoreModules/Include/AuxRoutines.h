@@ -18,6 +18,7 @@
 #include "Request.h"
 #include "Signal.h"
 #include "UrmSettings.h"
+#include "WireFormat.h"
 #include "ClientEndpoint.h"
 
 class AuxRoutines {
@@ -28,7 +29,6 @@ public:
     static std::string readFromFile(const std::string& fileName);
     static void writeToFile(const std::string& fileName, const std::string& value);
     static void deleteFile(const std::string& fileName);
-    static void writeSysFsDefaults();
     static int8_t fileExists(const std::string& filePath);
     static int32_t createProcess();
     static std::string getMachineName();
@@ -39,6 +39,14 @@ public:
     static int8_t getProcName(pid_t pid, std::string& procName);
 
     static int64_t generateUniqueHandle();
+
+    /**
+     * @brief Reserve a block of consecutive handles, from the same space as generateUniqueHandle.
+     * @return int64_t:\n
+     *            - The first handle of the block\n
+     *            - -1: If the handle space is exhausted
+     */
+    static int64_t reserveHandleRange(int32_t count);
     static int64_t getCurrentTimeInMilliseconds();
 };
 
@@ -48,9 +56,10 @@ private:
     char* mBuffer;
     void* mCurPtr;
     int32_t mRunningIndex;
+    int32_t mCapacity;
 
 public:
-    FlatBuffEncoder();
+    FlatBuffEncoder(int32_t capacity = REQ_BUFFER_SIZE);
 
     template <typename T>
     FlatBuffEncoder& append(T val) {
@@ -58,7 +67,7 @@ public:
             return *this;
         }
 
-        if(this->mRunningIndex + sizeof(T) < REQ_BUFFER_SIZE) {
+        if(this->mRunningIndex + sizeof(T) < (uint64_t)this->mCapacity) {
             T* tPtr = (T*)(this->mCurPtr);
             try {
                 ASSIGN_AND_INCR(tPtr, val);
@@ -70,16 +79,21 @@ public:
             }
         } else {
             // Prevent further updates on the current buffer
-            this->mRunningIndex = REQ_BUFFER_SIZE;
+            this->mRunningIndex = this->mCapacity;
         }
 
         return *this;
     }
 
-    FlatBuffEncoder appendString(const char* valStr);
+    FlatBuffEncoder& appendString(const char* valStr);
+
+    // Refer WireFormat.h
+    FlatBuffEncoder& appendVarint(uint64_t val);
+    FlatBuffEncoder& appendSignedVarint(int64_t val);
 
     void setBuf(char* buffer);
     int8_t isBufSane();
+    int32_t getEncodedSize();
 };
 
 class ConnectionManager {
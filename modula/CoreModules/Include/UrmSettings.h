@@ -4,6 +4,8 @@
 #ifndef URM_SETTINGS_H
 #define URM_SETTINGS_H
 
+#include <cstdint>
+#include <cstring>
 #include <unordered_map>
 
 #include "ErrCodes.h"
@@ -14,6 +16,75 @@
 #define URM_IDENTIFIER "urm"
 #define REQ_BUFFER_SIZE 580
 
+// Requests are compactly encoded (refer WireFormat.h), most Retune / Untune and small Tune
+// Requests fit in this size class, which is tried before REQ_BUFFER_SIZE.
+#define REQ_SMALL_BUFFER_SIZE 64
+
+// Batched Requests are carried in a single message:
+// [Module ID][REQ_BATCH][int32_t Count]{[uint32_t Length][Request]} x Count
+#define REQ_BATCH_BUFFER_SIZE 4096
+#define REQ_BATCH_MAX_COUNT 16
+
+// Handles are leased to each client connection in blocks, so that the client can assign
+// handles locally and send Tune Requests without waiting on a reply. [REQ_HANDLE_LEASE]
+#define HANDLE_LEASE_SIZE 256
+#define HANDLE_LEASE_MAX_PER_CLIENT 2
+
+// Sent (unsolicited) when a Tune Request issued with a leased handle is rejected:
+// [int64_t REQ_REJECTION_MARKER][int64_t handle]. This can never be mistaken for a reply,
+// since handles are >= -1, and Prop values are NUL-terminated strings.
+#define REQ_REJECTION_MARKER INT64_MIN
+
+/**
+ * @brief Get a zeroed Request buffer from the smallest size class which fits the payload.
+ * @details If the pool is out of blocks of that class, the next class is tried. Only payloads
+ *          larger than REQ_BUFFER_SIZE (i.e. batches) are served from the REQ_BATCH_BUFFER_SIZE class.
+ *          Throws std::bad_alloc if no block could be retrieved.
+ * @param payloadSize Size of the Request.
+ * @param bufferSize Set to the size of the buffer returned.
+ */
+inline char* allocReqBuffer(uint64_t payloadSize, uint64_t& bufferSize) {
+    char* buffer = nullptr;
+
+    if(payloadSize <= REQ_SMALL_BUFFER_SIZE) {
+        try {
+            buffer = new (GetBlock<char[REQ_SMALL_BUFFER_SIZE]>()) char[REQ_SMALL_BUFFER_SIZE];
+            bufferSize = REQ_SMALL_BUFFER_SIZE;
+        } catch(const std::bad_alloc& e) {}
+    }
+
+    if(buffer == nullptr && payloadSize <= REQ_BUFFER_SIZE) {
+        buffer = new (GetBlock<char[REQ_BUFFER_SIZE]>()) char[REQ_BUFFER_SIZE];
+        bufferSize = REQ_BUFFER_SIZE;
+    }
+
+    if(buffer == nullptr) {
+        buffer = new (GetBlock<char[REQ_BATCH_BUFFER_SIZE]>()) char[REQ_BATCH_BUFFER_SIZE];
+        bufferSize = REQ_BATCH_BUFFER_SIZE;
+    }
+
+    std::memset(buffer, 0, bufferSize);
+    return buffer;
+}
+
+inline void freeReqBuffer(char* buffer, uint64_t bufferSize) {
+    if(bufferSize == REQ_SMALL_BUFFER_SIZE) {
+        FreeBlock<char[REQ_SMALL_BUFFER_SIZE]>(buffer);
+    } else if(bufferSize == REQ_BUFFER_SIZE) {
+        FreeBlock<char[REQ_BUFFER_SIZE]>(buffer);
+    } else {
+        FreeBlock<char[REQ_BATCH_BUFFER_SIZE]>(buffer);
+    }
+}
+
+/**
+ * @brief Release a forwarded Request, along with its buffer.
+ */
+inline void freeForwardInfo(MsgForwardInfo* info) {
+    freeReqBuffer(info->mBuffer, info->mBufferSize);
+    FreeBlock<MsgForwardInfo>(info);
+}
+
 // Operational Tunable Parameters for Resource Tuner
 typedef struct {
     uint32_t mMaxConcurrentRequests;
@@ -22,7 +93,8 @@ typedef struct {
     uint32_t mPulseDuration;
     uint32_t mClientGarbageCollectorDuration;
     uint32_t mDelta;
-    uint32_t mCleanupBatchSize;
+    uint32_t mDriftCheckDuration;
+    int8_t mReassertOnDrift;
     double mPenaltyFactor;
     double mRewardFactor;
 } MetaConfigs;
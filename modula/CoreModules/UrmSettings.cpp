@@ -47,7 +47,7 @@ const std::string UrmSettings::focusedCgroup =
                                     "focused.slice";
 
 const std::string UrmSettings::mPersistenceFile =
-                                    "/etc/urm/data/resource_original_values.txt";
+                                    "/etc/urm/data/resource_original_values.journal";
 
 int32_t UrmSettings::isServerOnline() {
     return serverOnlineStatus;
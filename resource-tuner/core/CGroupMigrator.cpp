@@ -0,0 +1,237 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+#include "CGroupMigrator.h"
+#include "UrmSettings.h"
+
+std::shared_ptr<CGroupMigrator> CGroupMigrator::mCGroupMigratorInstance = nullptr;
+std::mutex CGroupMigrator::instanceProtectionLock {};
+
+// Fetch the current CGroup of the PID / TID, relative to the cgroup root.
+// /proc/<id>/cgroup (for cgroup v2) contains a single line of the form: "0::/<cgroup>"
+static std::string readCurrentCGroup(int32_t id) {
+    std::string procFilePath = "/proc/" + std::to_string(id) + "/cgroup";
+    int32_t fd = open(procFilePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return "";
+    }
+
+    char buffer[256];
+    ssize_t bytesRead = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+
+    if(bytesRead <= 4) {
+        return "";
+    }
+
+    std::string currentCGroup(buffer + 4, bytesRead - 4);
+    size_t lineEnd = currentCGroup.find('\n');
+    if(lineEnd != std::string::npos) {
+        currentCGroup.resize(lineEnd);
+    }
+
+    return currentCGroup;
+}
+
+static int8_t writeID(int32_t fd, int32_t id) {
+    // The Kernel accepts only a single ID per write call.
+    std::string idString = std::to_string(id);
+    ssize_t bytesWritten = 0;
+    do {
+        bytesWritten = write(fd, idString.c_str(), idString.length());
+    } while(bytesWritten < 0 && errno == EINTR);
+
+    return bytesWritten >= 0;
+}
+
+CGroupMigrator::CGroupMigrator() {}
+
+static int32_t openControllerFd(const std::string& controllerFilePath) {
+    int32_t fd = open(controllerFilePath.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if(fd < 0) {
+        TYPELOGV(ERRNO_LOG, "open", strerror(errno));
+    }
+    return fd;
+}
+
+int32_t CGroupMigrator::getControllerFd(const std::string& controllerFilePath) {
+    auto it = this->mControllerFds.find(controllerFilePath);
+    if(it != this->mControllerFds.end()) {
+        return it->second;
+    }
+
+    int32_t fd = openControllerFd(controllerFilePath);
+    if(fd < 0) {
+        return -1;
+    }
+
+    this->mControllerFds[controllerFilePath] = fd;
+    return fd;
+}
+
+void CGroupMigrator::dropControllerFd(const std::string& controllerFilePath) {
+    auto it = this->mControllerFds.find(controllerFilePath);
+    if(it != this->mControllerFds.end()) {
+        close(it->second);
+        this->mControllerFds.erase(it);
+    }
+}
+
+int32_t CGroupMigrator::migrate(const std::string& controllerFilePath,
+                                const std::vector<int32_t>& ids,
+                                std::unordered_map<int32_t, std::string>& originStore,
+                                int8_t cacheFd) {
+    if(controllerFilePath.length() == 0 || ids.empty()) return 0;
+
+    int32_t fd = cacheFd ? this->getControllerFd(controllerFilePath) : openControllerFd(controllerFilePath);
+    if(fd < 0) {
+        return 0;
+    }
+
+    int32_t movedCount = 0;
+    for(int32_t id: ids) {
+        // Only the first migration captures the original CGroup, any subsequent
+        // migrations (while the ID is still tracked) would otherwise overwrite it.
+        if(originStore.find(id) == originStore.end()) {
+            originStore[id] = readCurrentCGroup(id);
+        }
+
+        TYPELOGV(NOTIFY_NODE_WRITE, controllerFilePath.c_str(), id);
+        if(writeID(fd, id)) {
+            movedCount++;
+            continue;
+        }
+
+        if(errno == ESRCH) {
+            // The Process / Thread has already exited.
+            originStore.erase(id);
+            continue;
+        }
+
+        // The fd might have gone stale (for example if the CGroup was re-created),
+        // reopen it once and retry.
+        TYPELOGV(ERRNO_LOG, "write", strerror(errno));
+        if(cacheFd) {
+            this->dropControllerFd(controllerFilePath);
+            fd = this->getControllerFd(controllerFilePath);
+        } else {
+            close(fd);
+            fd = openControllerFd(controllerFilePath);
+        }
+
+        if(fd < 0) {
+            break;
+        }
+
+        if(writeID(fd, id)) {
+            movedCount++;
+        }
+    }
+
+    if(!cacheFd && fd >= 0) {
+        close(fd);
+    }
+
+    return movedCount;
+}
+
+void CGroupMigrator::restore(const std::vector<int32_t>& ids,
+                             const std::string& controllerName,
+                             std::unordered_map<int32_t, std::string>& originStore) {
+    // Group the IDs by their original CGroup, so that each CGroup is written to in a single pass.
+    std::unordered_map<std::string, std::vector<int32_t>> restoreList;
+
+    for(int32_t id: ids) {
+        std::string originalCGroup = "";
+        auto it = originStore.find(id);
+        if(it != originStore.end()) {
+            originalCGroup = it->second;
+            originStore.erase(it);
+        }
+
+        std::string controllerFilePath = UrmSettings::mBaseCGroupPath;
+        if(originalCGroup.length() > 0) {
+            controllerFilePath += originalCGroup + "/";
+        }
+        controllerFilePath += controllerName;
+
+        restoreList[controllerFilePath].push_back(id);
+    }
+
+    // IDs are no longer tracked, use a scratch store so that they are not re-recorded.
+    // The original CGroups are arbitrary (per-app or transient scopes), hence their fds
+    // are not cached, only those of the configured migration targets are.
+    std::unordered_map<int32_t, std::string> scratchStore;
+    for(std::pair<const std::string, std::vector<int32_t>>& entry: restoreList) {
+        for(int32_t id: entry.second) {
+            scratchStore[id] = "";
+        }
+        this->migrate(entry.first, entry.second, scratchStore, false);
+    }
+}
+
+int32_t CGroupMigrator::migrateProcesses(const std::string& controllerFilePath,
+                                         const std::vector<int32_t>& pids) {
+    const std::lock_guard<std::mutex> lock(this->mMigratorMutex);
+    return this->migrate(controllerFilePath, pids, this->mOriginalProcCGroups, true);
+}
+
+int32_t CGroupMigrator::migrateThreads(const std::string& controllerFilePath,
+                                       const std::vector<int32_t>& tids) {
+    const std::lock_guard<std::mutex> lock(this->mMigratorMutex);
+    return this->migrate(controllerFilePath, tids, this->mOriginalThreadCGroups, true);
+}
+
+void CGroupMigrator::restoreProcesses(const std::vector<int32_t>& pids) {
+    const std::lock_guard<std::mutex> lock(this->mMigratorMutex);
+    this->restore(pids, "cgroup.procs", this->mOriginalProcCGroups);
+}
+
+void CGroupMigrator::restoreThreads(const std::vector<int32_t>& tids) {
+    const std::lock_guard<std::mutex> lock(this->mMigratorMutex);
+    this->restore(tids, "cgroup.threads", this->mOriginalThreadCGroups);
+}
+
+void CGroupMigrator::restoreAll() {
+    const std::lock_guard<std::mutex> lock(this->mMigratorMutex);
+
+    std::vector<int32_t> ids;
+    for(std::pair<const int32_t, std::string>& entry: this->mOriginalThreadCGroups) {
+        ids.push_back(entry.first);
+    }
+    this->restore(ids, "cgroup.threads", this->mOriginalThreadCGroups);
+
+    ids.clear();
+    for(std::pair<const int32_t, std::string>& entry: this->mOriginalProcCGroups) {
+        ids.push_back(entry.first);
+    }
+    this->restore(ids, "cgroup.procs", this->mOriginalProcCGroups);
+}
+
+std::string CGroupMigrator::getOriginalCGroup(int32_t id) {
+    const std::lock_guard<std::mutex> lock(this->mMigratorMutex);
+
+    auto it = this->mOriginalProcCGroups.find(id);
+    if(it != this->mOriginalProcCGroups.end()) {
+        return it->second;
+    }
+
+    it = this->mOriginalThreadCGroups.find(id);
+    if(it != this->mOriginalThreadCGroups.end()) {
+        return it->second;
+    }
+
+    return "";
+}
+
+CGroupMigrator::~CGroupMigrator() {
+    for(std::pair<const std::string, int32_t>& entry: this->mControllerFds) {
+        close(entry.second);
+    }
+    this->mControllerFds.clear();
+}
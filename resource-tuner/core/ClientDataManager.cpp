@@ -1,8 +1,23 @@
 // Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
 // SPDX-License-Identifier: BSD-3-Clause-Clear
 
+#include <cmath>
+#include <cerrno>
+#include <algorithm>
+#include <sys/syscall.h>
+
 #include "ClientDataManager.h"
 
+static int32_t openPidFd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
 static int8_t isRootProcess(pid_t pid) {
     std::string statusFile = "/proc/" + std::to_string(pid) + "/status";
     std::ifstream file(statusFile);
@@ -31,260 +46,487 @@ static int8_t isRootProcess(pid_t pid) {
     return PERMISSION_THIRD_PARTY;
 }
 
-std::mutex ClientDataManager::instanceProtectionLock {};
-std::shared_ptr<ClientDataManager> ClientDataManager::mClientDataManagerInstance = nullptr;
-ClientDataManager::ClientDataManager() {}
+// Handle Set utilities, callers hold the lock on the TID shard.
+static int8_t insertHandle(ClientHandleSet& handleSet, int64_t handle) {
+    for(int32_t i = 0; i < handleSet.mInlineCount; i++) {
+        if(handleSet.mInlineHandles[i] == handle) return true;
+    }
 
-int8_t ClientDataManager::clientExists(int32_t clientPID, int32_t clientTID) {
-    this->mGlobalTableMutex.lock_shared();
+    if(handleSet.mSpill == nullptr && handleSet.mInlineCount < CLIENT_INLINE_HANDLES) {
+        handleSet.mInlineHandles[handleSet.mInlineCount++] = handle;
+        return true;
+    }
 
-    // Check that an entry corresponding to the client PID exists in the mClientRepo table, and
-    // An entry for the client TID exists in the mClientTidRepo table.
-    int8_t clientCheck = (this->mClientRepo.find(clientPID) != this->mClientRepo.end()) &&
-                         (this->mClientTidRepo.find(clientTID) != this->mClientTidRepo.end());
+    if(handleSet.mSpill == nullptr) {
+        try {
+            handleSet.mSpill = MPLACED(std::unordered_set<int64_t>);
+        } catch(const std::bad_alloc& e) {
+            TYPELOGV(GENERIC_CALL_FAILURE_LOG, e.what());
+            return false;
+        }
+    }
 
-    this->mGlobalTableMutex.unlock_shared();
-    return clientCheck;
+    handleSet.mSpill->insert(handle);
+    return true;
 }
 
-int8_t ClientDataManager::createNewClient(int32_t clientPID, int32_t clientTID) {
-    this->mGlobalTableMutex.lock();
-    // First create an entry in the mClientTidRepo table
+static void eraseHandle(ClientHandleSet& handleSet, int64_t handle) {
+    for(int32_t i = 0; i < handleSet.mInlineCount; i++) {
+        if(handleSet.mInlineHandles[i] == handle) {
+            handleSet.mInlineHandles[i] = handleSet.mInlineHandles[--handleSet.mInlineCount];
+            return;
+        }
+    }
 
-    int8_t clientCheck = (this->mClientRepo.find(clientPID) != this->mClientRepo.end()) &&
-                         (this->mClientTidRepo.find(clientTID) != this->mClientTidRepo.end());
+    if(handleSet.mSpill != nullptr) {
+        handleSet.mSpill->erase(handle);
+    }
+}
 
-    if(clientCheck) {
-        // Edge Case, control should not reach here since it is expected that createNewClient
-        // Routine is used in conjunction with the clientExists Routine
-        this->mGlobalTableMutex.unlock();
-        return true;
+static void collectHandles(ClientHandleSet& handleSet, std::vector<int64_t>& requestHandles) {
+    for(int32_t i = 0; i < handleSet.mInlineCount; i++) {
+        requestHandles.push_back(handleSet.mInlineHandles[i]);
     }
 
-    ClientTidData* clientData = nullptr;
-    try {
-        clientData = MPLACED(ClientTidData);
-        clientData->mLastRequestTimestamp = 0;
-        clientData->mHealth = 100.0;
-        clientData->mClientHandles = MPLACED(std::unordered_set<int64_t>);
+    if(handleSet.mSpill != nullptr) {
+        for(int64_t handle: *handleSet.mSpill) {
+            requestHandles.push_back(handle);
+        }
+    }
+}
 
-    } catch(const std::bad_alloc& e) {
-        TYPELOGV(CLIENT_ALLOCATION_FAILURE, clientPID, clientTID, e.what());
+static void releaseHandles(ClientHandleSet& handleSet) {
+    if(handleSet.mSpill != nullptr) {
+        FreeBlock<std::unordered_set<int64_t>>(static_cast<void*>(handleSet.mSpill));
+        handleSet.mSpill = nullptr;
+    }
+    handleSet.mInlineCount = 0;
+}
 
-        this->mGlobalTableMutex.unlock();
+// Reserve an entry against the bound, which applies across all the shards.
+static int8_t reserveEntry(std::atomic<int32_t>& count, int32_t bound) {
+    if(count.fetch_add(1) >= bound && bound > 0) {
+        count.fetch_sub(1);
         return false;
+    }
+    return true;
+}
 
-    } catch(const std::exception& e) {
-        TYPELOGV(CLIENT_ALLOCATION_FAILURE, clientPID, clientTID, e.what());
+std::mutex ClientDataManager::instanceProtectionLock {};
+std::shared_ptr<ClientDataManager> ClientDataManager::mClientDataManagerInstance = nullptr;
+ClientDataManager::ClientDataManager() {
+    this->mMaxClients = UrmSettings::metaConfigs.mMaxConcurrentRequests *
+                        UrmSettings::metaConfigs.mMaxResourcesPerRequest;
+    this->mClientCount.store(0);
+    this->mThreadCount.store(0);
+
+    // Sized for the bound at half load, assuming the clients are evenly spread.
+    int32_t shardCapacity = 2 * (this->mMaxClients / CLIENT_TABLE_SHARD_COUNT + 1);
+    for(int32_t i = 0; i < CLIENT_TABLE_SHARD_COUNT; i++) {
+        this->mClientRepo[i].reserve(shardCapacity);
+        this->mClientTidRepo[i].reserve(shardCapacity);
+    }
 
-        this->mGlobalTableMutex.unlock();
-        return false;
+    this->mUnwatchedClients.store(0);
+    this->mClientExitFd = epoll_create1(EPOLL_CLOEXEC);
+    if(this->mClientExitFd < 0) {
+        TYPELOGV(ERRNO_LOG, "epoll_create1", strerror(errno));
     }
+}
 
-    // Check if a client PID entry exists
-    int8_t clientPIDExists = (this->mClientRepo.find(clientPID) != this->mClientRepo.end());
-    this->mClientTidRepo[clientTID] = clientData;
+// Register the client's pidfd with the exit epoll set, the pidfd becomes readable once the
+// client terminates. Returns the fd now owned by the client entry, -1 if the client is unwatched.
+int32_t ClientDataManager::watchClient(int32_t clientPID, int32_t pidFd) {
+    if(pidFd >= 0 && this->mClientExitFd >= 0) {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLONESHOT;
+        event.data.u64 = (uint32_t)clientPID;
+        if(epoll_ctl(this->mClientExitFd, EPOLL_CTL_ADD, pidFd, &event) == 0) {
+            return pidFd;
+        }
+        TYPELOGV(ERRNO_LOG, "epoll_ctl", strerror(errno));
+    }
 
-    if(clientPIDExists) {
-        // If it does, then add the client TID to the list of TIDs for that client PID
-        int32_t curTIDCount = this->mClientRepo[clientPID]->mCurClientThreads;
-        if(curTIDCount < PER_CLIENT_TID_CAP) {
-            this->mClientRepo[clientPID]->mClientTIDs[curTIDCount] = clientTID;
-            curTIDCount++;
-            this->mClientRepo[clientPID]->mCurClientThreads = curTIDCount;
-        } else {
-            this->mGlobalTableMutex.unlock();
+    if(pidFd >= 0) close(pidFd);
+    this->mUnwatchedClients.fetch_add(1);
+    return -1;
+}
+
+int32_t ClientDataManager::getClientExitFd() {
+    return this->mClientExitFd;
+}
+
+ClientShard<ClientInfo>& ClientDataManager::getPidShard(int32_t clientPID) {
+    return this->mClientRepo[(clientKeyHash(clientPID) >> 16) % CLIENT_TABLE_SHARD_COUNT];
+}
+
+ClientShard<ClientTidData>& ClientDataManager::getTidShard(int32_t clientTID) {
+    return this->mClientTidRepo[(clientKeyHash(clientTID) >> 16) % CLIENT_TABLE_SHARD_COUNT];
+}
+
+int8_t ClientDataManager::clientExists(int32_t clientPID, int32_t clientTID) {
+    // Check that an entry corresponding to the client PID exists in the mClientRepo table, and
+    // An entry for the client TID exists in the mClientTidRepo table.
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock_shared();
+    int8_t clientCheck = (tidShard.find(clientTID) != nullptr);
+    tidShard.mMutex.unlock_shared();
+
+    if(!clientCheck) return false;
+
+    ClientShard<ClientInfo>& pidShard = this->getPidShard(clientPID);
+    pidShard.mMutex.lock_shared();
+    clientCheck = (pidShard.find(clientPID) != nullptr);
+    pidShard.mMutex.unlock_shared();
+
+    return clientCheck;
+}
+
+int8_t ClientDataManager::createNewClient(int32_t clientPID, int32_t clientTID, int8_t clientLevel) {
+    // First create an entry in the mClientTidRepo table
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock();
+
+    if(tidShard.find(clientTID) == nullptr) {
+        ClientTidData* clientData = nullptr;
+        if(reserveEntry(this->mThreadCount, this->mMaxClients)) {
+            clientData = tidShard.insert(clientTID);
+            if(clientData == nullptr) {
+                this->mThreadCount.fetch_sub(1);
+            }
+        }
+
+        if(clientData == nullptr) {
+            TYPELOGV(CLIENT_ALLOCATION_FAILURE, clientPID, clientTID, "Client TID table full");
+            tidShard.mMutex.unlock();
             return false;
         }
-    } else {
-        // If it doesn't, then create a new entry in the mClientRepo table
-        try {
-            ClientInfo* clientInfo = MPLACED(ClientInfo);
 
-            int32_t curTIDCount = clientInfo->mCurClientThreads;
-            clientInfo->mClientTIDs[curTIDCount] = clientTID;
-            curTIDCount++;
-            clientInfo->mCurClientThreads = curTIDCount;
+        clientData->mRateBucket.mTokens.store(RATE_BUCKET_CAPACITY);
+        clientData->mRateBucket.mLastRequestTimestamp.store(0);
+        clientData->mClientHandles.mInlineCount = 0;
+        clientData->mClientHandles.mSpill = nullptr;
+    }
+    tidShard.mMutex.unlock();
+
+    // The permission level and pidfd are set up outside the lock, since they need syscalls.
+    ClientShard<ClientInfo>& pidShard = this->getPidShard(clientPID);
+    pidShard.mMutex.lock_shared();
+    int8_t clientPIDExists = (pidShard.find(clientPID) != nullptr);
+    pidShard.mMutex.unlock_shared();
+
+    int32_t pidFd = -1;
+    if(!clientPIDExists) {
+        if(clientLevel < 0) {
+            clientLevel = isRootProcess(clientPID);
+        }
+        pidFd = openPidFd(clientPID);
+    }
 
-            clientInfo->mClientType = isRootProcess(clientPID);
-            this->mClientRepo[clientPID] = clientInfo;
+    int8_t status = true;
+    pidShard.mMutex.lock();
 
-        } catch(const std::bad_alloc& e) {
-            TYPELOGV(CLIENT_ALLOCATION_FAILURE, clientPID, clientTID, e.what());
+    ClientInfo* clientInfo = pidShard.find(clientPID);
+    if(clientInfo == nullptr) {
+        // If it doesn't, then create a new entry in the mClientRepo table
+        if(reserveEntry(this->mClientCount, this->mMaxClients)) {
+            clientInfo = pidShard.insert(clientPID);
+            if(clientInfo == nullptr) {
+                this->mClientCount.fetch_sub(1);
+            }
+        }
+
+        if(clientInfo == nullptr) {
+            TYPELOGV(CLIENT_ALLOCATION_FAILURE, clientPID, clientTID, "Client PID table full");
+            pidShard.mMutex.unlock();
 
-            this->mGlobalTableMutex.unlock();
+            if(pidFd >= 0) close(pidFd);
             return false;
+        }
 
-        } catch(const std::exception& e) {
-            TYPELOGV(CLIENT_ALLOCATION_FAILURE, clientPID, clientTID, e.what());
+        // The PID entry might have been removed since it was checked above.
+        if(clientLevel < 0) {
+            clientLevel = isRootProcess(clientPID);
+        }
+        if(pidFd < 0) {
+            pidFd = openPidFd(clientPID);
+        }
 
-            this->mGlobalTableMutex.unlock();
-            return false;
+        clientInfo->mClientType = clientLevel;
+        clientInfo->mPidFd = this->watchClient(clientPID, pidFd);
+        pidFd = -1;
+    }
+
+    // Add the client TID to the list of TIDs for that client PID
+    int8_t tidTracked = false;
+    for(int32_t i = 0; i < clientInfo->mCurClientThreads; i++) {
+        if(clientInfo->mClientTIDs[i] == clientTID) {
+            tidTracked = true;
+            break;
         }
     }
 
-    this->mGlobalTableMutex.unlock();
-    return true;
+    if(!tidTracked) {
+        int32_t curTIDCount = clientInfo->mCurClientThreads;
+        if(curTIDCount < PER_CLIENT_TID_CAP) {
+            clientInfo->mClientTIDs[curTIDCount] = clientTID;
+            clientInfo->mCurClientThreads = curTIDCount + 1;
+        } else {
+            status = false;
+        }
+    }
+
+    pidShard.mMutex.unlock();
+
+    // Another thread of the client created the PID entry in the meantime.
+    if(pidFd >= 0) close(pidFd);
+    return status;
 }
 
-std::unordered_set<int64_t>* ClientDataManager::getRequestsByClientID(int32_t clientTID) {
-    this->mGlobalTableMutex.lock_shared();
+int8_t ClientDataManager::getRequestsByClientID(int32_t clientTID, std::vector<int64_t>& requestHandles) {
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock_shared();
 
-    if(this->mClientTidRepo[clientTID] == nullptr || this->mClientTidRepo.size() == 0) {
-        this->mGlobalTableMutex.unlock_shared();
-        return nullptr;
+    ClientTidData* clientData = tidShard.find(clientTID);
+    if(clientData == nullptr) {
+        tidShard.mMutex.unlock_shared();
+        return false;
     }
 
-    std::unordered_set<int64_t>* clientHandlesPtr = this->mClientTidRepo[clientTID]->mClientHandles;
-    this->mGlobalTableMutex.unlock_shared();
+    collectHandles(clientData->mClientHandles, requestHandles);
+    tidShard.mMutex.unlock_shared();
 
-    return clientHandlesPtr;
+    return true;
 }
 
 void ClientDataManager::insertRequestByClientId(int32_t clientTID, int64_t requestHandle) {
-    this->mGlobalTableMutex.lock_shared();
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock();
 
-    if(this->mClientTidRepo[clientTID] == nullptr || this->mClientTidRepo.size() == 0) {
-        this->mGlobalTableMutex.unlock_shared();
-        return;
+    ClientTidData* clientData = tidShard.find(clientTID);
+    if(clientData != nullptr) {
+        insertHandle(clientData->mClientHandles, requestHandle);
     }
 
-    this->mClientTidRepo[clientTID]->mClientHandles->insert(requestHandle);
-    this->mGlobalTableMutex.unlock_shared();
+    tidShard.mMutex.unlock();
 }
 
 void ClientDataManager::deleteRequestByClientId(int32_t clientTID, int64_t requestHandle) {
-    this->mGlobalTableMutex.lock_shared();
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock();
 
-    if(this->mClientTidRepo.find(clientTID) == this->mClientTidRepo.end()) {
-        this->mGlobalTableMutex.unlock_shared();
-        return;
+    ClientTidData* clientData = tidShard.find(clientTID);
+    if(clientData != nullptr) {
+        eraseHandle(clientData->mClientHandles, requestHandle);
     }
 
-    this->mClientTidRepo[clientTID]->mClientHandles->erase(requestHandle);
-    this->mGlobalTableMutex.unlock_shared();
+    tidShard.mMutex.unlock();
 }
 
 int8_t ClientDataManager::getClientLevelByClientID(int32_t clientPID) {
-    this->mGlobalTableMutex.lock_shared();
+    ClientShard<ClientInfo>& pidShard = this->getPidShard(clientPID);
+    pidShard.mMutex.lock_shared();
 
-    if(this->mClientRepo.find(clientPID) == this->mClientRepo.end()) {
-        this->mGlobalTableMutex.unlock_shared();
+    ClientInfo* clientInfo = pidShard.find(clientPID);
+    if(clientInfo == nullptr) {
+        pidShard.mMutex.unlock_shared();
         return -1;
     }
 
-    int8_t clientLevel = this->mClientRepo[clientPID]->mClientType;
-    this->mGlobalTableMutex.unlock_shared();
+    int8_t clientLevel = clientInfo->mClientType;
+    pidShard.mMutex.unlock_shared();
 
     return clientLevel;
 }
 
 void ClientDataManager::getThreadsByClientId(int32_t clientPID, std::vector<int32_t>& threadIDs) {
-    this->mGlobalTableMutex.lock_shared();
+    ClientShard<ClientInfo>& pidShard = this->getPidShard(clientPID);
+    pidShard.mMutex.lock_shared();
 
-    if(this->mClientRepo.find(clientPID) == this->mClientRepo.end()) {
-        this->mGlobalTableMutex.unlock_shared();
+    ClientInfo* clientInfo = pidShard.find(clientPID);
+    if(clientInfo == nullptr) {
+        pidShard.mMutex.unlock_shared();
         return;
     }
 
-    for(int32_t i = 0; i < this->mClientRepo[clientPID]->mCurClientThreads; i++) {
-        threadIDs.push_back(this->mClientRepo[clientPID]->mClientTIDs[i]);
+    for(int32_t i = 0; i < clientInfo->mCurClientThreads; i++) {
+        threadIDs.push_back(clientInfo->mClientTIDs[i]);
     }
 
-    this->mGlobalTableMutex.unlock_shared();
+    pidShard.mMutex.unlock_shared();
+}
+
+int8_t ClientDataManager::chargeRateBucket(int32_t clientTID,
+                                           int64_t currentMillis,
+                                           int64_t minGap,
+                                           int64_t penaltyTokens,
+                                           int64_t rewardTokens) {
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock_shared();
+
+    ClientTidData* clientData = tidShard.find(clientTID);
+    if(clientData == nullptr) {
+        tidShard.mMutex.unlock_shared();
+        return false;
+    }
+
+    RateBucket& bucket = clientData->mRateBucket;
+    int64_t tokens = bucket.mTokens.load(std::memory_order_relaxed);
+    if(tokens <= 0) {
+        // Repeat offender, total block
+        tidShard.mMutex.unlock_shared();
+        return false;
+    }
+
+    // If this is the First Request, don't update the tokens
+    int64_t lastRequestTimestamp = bucket.mLastRequestTimestamp.exchange(currentMillis, std::memory_order_relaxed);
+    int64_t adjustment = 0;
+    if(lastRequestTimestamp != 0) {
+        adjustment = (currentMillis - lastRequestTimestamp < minGap) ? -penaltyTokens : rewardTokens;
+    }
+
+    int64_t updatedTokens = 0;
+    do {
+        updatedTokens = std::min((int64_t)RATE_BUCKET_CAPACITY, tokens + adjustment);
+    } while(!bucket.mTokens.compare_exchange_weak(tokens, updatedTokens, std::memory_order_relaxed));
+
+    tidShard.mMutex.unlock_shared();
+    return updatedTokens > 0;
 }
 
 double ClientDataManager::getHealthByClientID(int32_t clientTID) {
-    this->mGlobalTableMutex.lock_shared();
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock_shared();
 
-    if(this->mClientTidRepo.find(clientTID) == this->mClientTidRepo.end()) {
-        this->mGlobalTableMutex.unlock_shared();
+    ClientTidData* clientData = tidShard.find(clientTID);
+    if(clientData == nullptr) {
+        tidShard.mMutex.unlock_shared();
         return -1;
     }
 
-    double health = this->mClientTidRepo[clientTID]->mHealth;
-    this->mGlobalTableMutex.unlock_shared();
+    double health = (double)clientData->mRateBucket.mTokens.load() / RATE_BUCKET_SCALE;
+    tidShard.mMutex.unlock_shared();
 
     return health;
 }
 
 int64_t ClientDataManager::getLastRequestTimestampByClientID(int32_t clientTID) {
-    this->mGlobalTableMutex.lock_shared();
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock_shared();
 
-    if(this->mClientTidRepo.find(clientTID) == this->mClientTidRepo.end()) {
-        this->mGlobalTableMutex.unlock_shared();
+    ClientTidData* clientData = tidShard.find(clientTID);
+    if(clientData == nullptr) {
+        tidShard.mMutex.unlock_shared();
         return 0;
     }
 
-    int64_t lastRequestTimestamp = this->mClientTidRepo[clientTID]->mLastRequestTimestamp;
-    this->mGlobalTableMutex.unlock_shared();
+    int64_t lastRequestTimestamp = clientData->mRateBucket.mLastRequestTimestamp.load();
+    tidShard.mMutex.unlock_shared();
 
     return lastRequestTimestamp;
 }
 
 void ClientDataManager::updateHealthByClientID(int32_t clientTID, double health) {
-    this->mGlobalTableMutex.lock_shared();
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock_shared();
 
-    if(this->mClientTidRepo.find(clientTID) == this->mClientTidRepo.end()) {
-        this->mGlobalTableMutex.unlock_shared();
-        return;
+    ClientTidData* clientData = tidShard.find(clientTID);
+    if(clientData != nullptr) {
+        clientData->mRateBucket.mTokens.store(std::llround(health * RATE_BUCKET_SCALE));
     }
 
-    this->mClientTidRepo[clientTID]->mHealth = health;
-    this->mGlobalTableMutex.unlock_shared();
+    tidShard.mMutex.unlock_shared();
 }
 
 void ClientDataManager::updateLastRequestTimestampByClientID(int32_t clientTID, int64_t currentMillis) {
-    this->mGlobalTableMutex.lock_shared();
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock_shared();
 
-    if(this->mClientTidRepo.find(clientTID) == this->mClientTidRepo.end()) {
-        this->mGlobalTableMutex.unlock_shared();
-        return;
+    ClientTidData* clientData = tidShard.find(clientTID);
+    if(clientData != nullptr) {
+        clientData->mRateBucket.mLastRequestTimestamp.store(currentMillis);
     }
 
-    this->mClientTidRepo[clientTID]->mLastRequestTimestamp = currentMillis;
-    this->mGlobalTableMutex.unlock_shared();
+    tidShard.mMutex.unlock_shared();
 }
 
 void ClientDataManager::getActiveClientList(std::vector<int32_t>& clientList) {
-    this->mGlobalTableMutex.lock_shared();
+    for(int32_t i = 0; i < CLIENT_TABLE_SHARD_COUNT; i++) {
+        ClientShard<ClientInfo>& pidShard = this->mClientRepo[i];
+        pidShard.mMutex.lock_shared();
 
-    for(std::pair<int32_t, ClientInfo*> clientInfo : this->mClientRepo) {
-        clientList.push_back(clientInfo.first);
+        pidShard.forEach([&clientList](int32_t clientPID, ClientInfo&) {
+            clientList.push_back(clientPID);
+        });
+
+        pidShard.mMutex.unlock_shared();
     }
+}
+
+void ClientDataManager::getUnwatchedClientList(std::vector<int32_t>& clientList) {
+    if(this->mUnwatchedClients.load() == 0) return;
+
+    for(int32_t i = 0; i < CLIENT_TABLE_SHARD_COUNT; i++) {
+        ClientShard<ClientInfo>& pidShard = this->mClientRepo[i];
+        pidShard.mMutex.lock_shared();
 
-    this->mGlobalTableMutex.unlock_shared();
+        pidShard.forEach([&clientList](int32_t clientPID, ClientInfo& clientInfo) {
+            if(clientInfo.mPidFd < 0) {
+                clientList.push_back(clientPID);
+            }
+        });
+
+        pidShard.mMutex.unlock_shared();
+    }
 }
 
 void ClientDataManager::deleteClientPID(int32_t clientPID) {
-    this->mGlobalTableMutex.lock();
+    ClientShard<ClientInfo>& pidShard = this->getPidShard(clientPID);
+    pidShard.mMutex.lock();
 
-    if(this->mClientRepo.find(clientPID) == this->mClientRepo.end()) {
-        this->mGlobalTableMutex.unlock();
+    ClientInfo* clientInfo = pidShard.find(clientPID);
+    if(clientInfo == nullptr) {
+        pidShard.mMutex.unlock();
         return;
     }
 
-    ClientInfo* clientInfo = this->mClientRepo[clientPID];
-    FreeBlock<ClientInfo>(static_cast<void*>(clientInfo));
+    // Closing the pidfd drops it from the exit epoll set as well.
+    if(clientInfo->mPidFd >= 0) {
+        close(clientInfo->mPidFd);
+    } else {
+        this->mUnwatchedClients.fetch_sub(1);
+    }
 
-    this->mClientRepo.erase(clientPID);
-    this->mGlobalTableMutex.unlock();
+    pidShard.erase(clientPID);
+    this->mClientCount.fetch_sub(1);
+    pidShard.mMutex.unlock();
 }
 
 void ClientDataManager::deleteClientTID(int32_t clientTID) {
-    this->mGlobalTableMutex.lock();
-
-    if(this->mClientTidRepo.find(clientTID) == this->mClientTidRepo.end()) {
-        this->mGlobalTableMutex.unlock();
-        return;
+    ClientShard<ClientTidData>& tidShard = this->getTidShard(clientTID);
+    tidShard.mMutex.lock();
+
+    ClientTidData* clientData = tidShard.find(clientTID);
+    if(clientData != nullptr) {
+        releaseHandles(clientData->mClientHandles);
+        tidShard.erase(clientTID);
+        this->mThreadCount.fetch_sub(1);
     }
 
-    ClientTidData* clientData = this->mClientTidRepo[clientTID];
-    this->mClientTidRepo.erase(clientTID);
+    tidShard.mMutex.unlock();
+}
 
-    FreeBlock<std::unordered_set<int64_t>>
-            (static_cast<void*>(clientData->mClientHandles));
-    FreeBlock<ClientTidData>(static_cast<void*>(clientData));
+ClientDataManager::~ClientDataManager() {
+    for(int32_t i = 0; i < CLIENT_TABLE_SHARD_COUNT; i++) {
+        this->mClientRepo[i].forEach([](int32_t, ClientInfo& clientInfo) {
+            if(clientInfo.mPidFd >= 0) {
+                close(clientInfo.mPidFd);
+            }
+        });
+    }
 
-    this->mGlobalTableMutex.unlock();
+    if(this->mClientExitFd >= 0) {
+        close(this->mClientExitFd);
+        this->mClientExitFd = -1;
+    }
 }
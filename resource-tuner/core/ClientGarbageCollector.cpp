@@ -23,53 +23,32 @@ void ClientGarbageCollector::submitClientThreadsForCleanup(int32_t clientPid) {
 
 void ClientGarbageCollector::performCleanup() {
     const std::lock_guard<std::mutex> lock(this->mGcQueueMutex);
+    if(this->mGcQueue.empty()) return;
 
-    uint32_t batchSize = UrmSettings::metaConfigs.mCleanupBatchSize;
-    for(uint32_t count = 0; count < std::min((uint32_t)this->mGcQueue.size(), batchSize); count++) {
+    // Pick up the Requests of all the queued client threads, these are then removed
+    // from the CocoTable by the RequestQueue consumer as a single batch.
+    std::vector<int64_t> handlesToRemove;
+    while(!this->mGcQueue.empty()) {
         int32_t clientTID = this->mGcQueue.front();
         this->mGcQueue.pop();
 
         LOGD("RESTUNE_CLIENT_GARBAGE_COLLECTOR",
              "Proceeding with Cleanup for Client TID: " + std::to_string(clientTID));
 
-        std::unordered_set<int64_t>* clientHandles =
-            ClientDataManager::getInstance()->getRequestsByClientID(clientTID);
-
-        // Issue Untune Requests, to remove the corresponding Tune Requests from the CocoTable
-        // Delete this Request from RequestManager's activeList and tracker.
-        std::vector<int64_t> handlesToRemove;
-        for(int64_t handle: *clientHandles) {
-            handlesToRemove.push_back(handle);
-        }
-
+        ClientDataManager::getInstance()->getRequestsByClientID(clientTID, handlesToRemove);
         ClientDataManager::getInstance()->deleteClientTID(clientTID);
+    }
 
-        for(int64_t handle: handlesToRemove) {
-            RequestInfo reqInfo = RequestManager::getInstance()->getRequestFromMap(handle);
-            Request* request = reqInfo.first;
-            if(request == nullptr) continue;
-
-            Request* untuneRequest = nullptr;
-
-            try {
-                untuneRequest = MPLACED(Request);
-                request->populateUntuneRequest(untuneRequest);
-            } catch(const std::bad_alloc& e) {
-                LOGI("RESTUNE_CLIENT_GARBAGE_COLLECTOR",
-                     "Failed to Allocate Memory for Untune Request. Error: " + std::string(e.what()));
-            }
-
-            // Keep the Untune Request's Priority as: "high"
-            // So that most of (if not all) the existing Requests are untuned before
-            // more new Requests are Added.
-            if(untuneRequest != nullptr) {
-                untuneRequest->setPriority(REQ_PRIORITY_HIGH);
-                RequestQueue::getInstance()->addAndWakeup(untuneRequest);
-            }
-        }
+    if(!RequestQueue::getInstance()->postClientCleanup(handlesToRemove)) {
+        LOGE("RESTUNE_CLIENT_GARBAGE_COLLECTOR",
+             "Failed to queue the cleanup of " + std::to_string(handlesToRemove.size()) + " Requests");
     }
 }
 
+void ClientGarbageCollector::triggerCleanup() {
+    this->performCleanup();
+}
+
 ErrCode ClientGarbageCollector::startClientGarbageCollectorDaemon() {
     try {
         this->mTimer = MPLACEV(Timer, std::bind(&ClientGarbageCollector::performCleanup, this), true);
@@ -55,7 +55,16 @@ int8_t CocoTable::needAllocation(Resource* res) {
 std::shared_ptr<CocoTable> CocoTable::mCocoTableInstance = nullptr;
 std::mutex CocoTable::instanceProtectionLock {};
 
+static int64_t getGroupKey(int32_t primaryIndex, int32_t groupIndex) {
+    return ((int64_t)primaryIndex << 32) | (uint32_t)groupIndex;
+}
+
+static int64_t getPassThroughKey(Resource* resource) {
+    return ((int64_t)resource->getResCode() << 32) | (uint32_t)resource->getResInfo();
+}
+
 CocoTable::CocoTable() {
+    this->mSuspended = false;
     this->mResourceRegistry = ResourceRegistry::getInstance();
     int32_t totalResources = this->mResourceRegistry->getTotalResourcesCount();
 
@@ -239,8 +248,15 @@ int8_t CocoTable::insertInCocoTable(ResIterable* newNode, int8_t priority) {
 
     // Special handling for resources with policy: "pass_through"
     if(rConf->mPolicy == Policy::PASS_THROUGH) {
+        this->mPassThroughNodes.push_back(newNode);
+
         // straightaway apply the action
-        this->fastPathApply(resource);
+        if(!this->mSuspended || this->isEligibleInSuspend(newNode)) {
+            this->fastPathApply(resource);
+        } else {
+            // Held back until resume.
+            this->mHeldPassThroughNodes.insert(newNode);
+        }
         return true;
     }
 
@@ -262,52 +278,192 @@ int8_t CocoTable::insertInCocoTable(ResIterable* newNode, int8_t priority) {
         return false;
     }
 
+    ErrCode opStatus = RC_SUCCESS;
     switch(policy) {
         case INSTANT_APPLY: {
-            // Insert this Request at the head of the linked list and apply it.
-            if(RC_IS_OK(dlm->insert(newNode, DLOptions::INSERT_START))) {
-                if(dlm->isNodeNth(0, newNode)) {
-                    this->applyAction(newNode, primaryIndex, priority);
-                }
-            }
+            // Insert this Request at the head of the linked list.
+            opStatus = dlm->insert(newNode, DLOptions::INSERT_START);
             break;
         }
         case HIGHER_BETTER: {
             // Insert the request in accordance with higher_is_better policy
-            // If the request ends up at the head of the resource DLL, apply it
-            if(RC_IS_OK(dlm->insertWithPolicy(newNode, comparHBetter))) {
-                if(dlm->isNodeNth(0, newNode)) {
-                    this->applyAction(newNode, primaryIndex, priority);
-                }
-            }
+            opStatus = dlm->insertWithPolicy(newNode, comparHBetter);
             break;
         }
         case LOWER_BETTER: {
             // Insert the request in accordance with lower_is_better policy
-            // If the request ends up at the head of the resource DLL, apply it
-            if(RC_IS_OK(dlm->insertWithPolicy(newNode, comparLBetter))) {
-                if(dlm->isNodeNth(0, newNode)) {
-                    this->applyAction(newNode, primaryIndex, priority);
-                }
-            }
+            opStatus = dlm->insertWithPolicy(newNode, comparLBetter);
             break;
         }
         case LAZY_APPLY: {
             // Insert the request at the end of the Resource DLL.
-            if(RC_IS_OK(dlm->insert(newNode))) {
-                if(dlm->isNodeNth(0, newNode)) {
-                    this->applyAction(newNode, primaryIndex, priority);
-                }
-            }
+            opStatus = dlm->insert(newNode);
             break;
         }
         default:
             return false;
     }
 
+    if(RC_IS_NOTOK(opStatus)) {
+        return true;
+    }
+
+    if(this->mSuspended) {
+        // The head of the Resource DLL might not be eligible in the current mode.
+        this->settleGroup(primaryIndex, secondaryIndex - priority, resource);
+    } else if(dlm->isNodeNth(0, newNode)) {
+        // If the request ends up at the head of the resource DLL, apply it
+        this->applyAction(newNode, primaryIndex, priority);
+    }
+
     return true;
 }
 
+int8_t CocoTable::isEligibleInSuspend(ResIterable* node) {
+    if(this->mBackgroundNodes.find(node) == this->mBackgroundNodes.end()) {
+        return false;
+    }
+
+    Resource* resource = (Resource*) node->mData;
+    ResConfInfo* resourceConfig = this->mResourceRegistry->getResConf(resource->getResCode());
+    return resourceConfig != nullptr && (resourceConfig->mModes & MODE_SUSPEND);
+}
+
+// The Request which should be applied for the given Resource (and core / cluster / cgroup),
+// i.e. the first eligible node, going over the priority levels in order.
+ResIterable* CocoTable::findWinner(int32_t primaryIndex, int32_t groupIndex, int8_t inSuspend, int8_t& priority) {
+    for(int32_t prioLevel = 0; prioLevel < TOTAL_PRIORITIES; prioLevel++) {
+        DLManager* dlm = this->mCocoTable[primaryIndex][groupIndex + prioLevel];
+        DL_ITERATE(dlm) {
+            if(!inSuspend || this->isEligibleInSuspend((ResIterable*) iter)) {
+                priority = prioLevel;
+                return (ResIterable*) iter;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+// Pass-through Resources are not ordered by policy, the last Request applied wins.
+// Re-apply the last applicable Request for each of the given Resources, or reset them if there is none.
+void CocoTable::settlePassThrough(const std::unordered_set<int64_t>& resources, int8_t inSuspend) {
+    for(int64_t resourceKey: resources) {
+        Resource* lastResource = nullptr;
+        ResIterable* winner = nullptr;
+
+        for(auto it = this->mPassThroughNodes.rbegin(); it != this->mPassThroughNodes.rend(); ++it) {
+            Resource* resource = (Resource*) (*it)->mData;
+            if(getPassThroughKey(resource) != resourceKey) continue;
+
+            if(lastResource == nullptr) {
+                lastResource = resource;
+            }
+
+            if(!inSuspend || this->isEligibleInSuspend(*it)) {
+                winner = *it;
+                break;
+            }
+        }
+
+        if(winner != nullptr) {
+            this->fastPathApply((Resource*) winner->mData);
+        } else if(lastResource != nullptr) {
+            this->fastPathReset(lastResource);
+        }
+    }
+}
+
+void CocoTable::removePassThrough(ResIterable* node, Resource* resource) {
+    auto it = std::find(this->mPassThroughNodes.begin(), this->mPassThroughNodes.end(), node);
+    if(it != this->mPassThroughNodes.end()) {
+        this->mPassThroughNodes.erase(it);
+    }
+
+    // Held back while suspended, hence never applied.
+    if(this->mHeldPassThroughNodes.erase(node) > 0) return;
+
+    this->fastPathReset(resource);
+}
+
+// Apply the winner for the given Resource while suspended, or reset it if there is none.
+void CocoTable::settleGroup(int32_t primaryIndex, int32_t groupIndex, Resource* resource) {
+    this->mSuspendedGroups.insert(getGroupKey(primaryIndex, groupIndex));
+
+    int8_t priority = -1;
+    ResIterable* winner = this->findWinner(primaryIndex, groupIndex, true, priority);
+    if(winner != nullptr) {
+        this->mCurrentlyAppliedPriority[primaryIndex] = priority;
+        this->applyAction(winner, primaryIndex, priority);
+    } else {
+        this->removeAction(primaryIndex, resource);
+    }
+}
+
+void CocoTable::applyModeTransition(int8_t mode) {
+    if(mode == MODE_SUSPEND) {
+        if(this->mSuspended) return;
+
+        for(int32_t primaryIndex = 0; primaryIndex < (int32_t)this->mCocoTable.size(); primaryIndex++) {
+            int32_t groupCount = this->mCocoTable[primaryIndex].size();
+            for(int32_t groupIndex = 0; groupIndex < groupCount; groupIndex += TOTAL_PRIORITIES) {
+                int8_t priority = -1;
+                ResIterable* winner = this->findWinner(primaryIndex, groupIndex, false, priority);
+                if(winner == nullptr) continue;
+
+                ResIterable* suspendWinner = this->findWinner(primaryIndex, groupIndex, true, priority);
+                if(suspendWinner == winner) continue;
+
+                this->mSuspendedGroups.insert(getGroupKey(primaryIndex, groupIndex));
+                if(suspendWinner != nullptr) {
+                    this->mCurrentlyAppliedPriority[primaryIndex] = priority;
+                    this->applyAction(suspendWinner, primaryIndex, priority);
+                } else {
+                    this->removeAction(primaryIndex, (Resource*) winner->mData);
+                }
+            }
+        }
+
+        // Pass-through Resources applied by Requests not eligible in the background are held back.
+        std::unordered_set<int64_t> heldResources;
+        for(ResIterable* node: this->mPassThroughNodes) {
+            if(!this->isEligibleInSuspend(node)) {
+                this->mHeldPassThroughNodes.insert(node);
+                heldResources.insert(getPassThroughKey((Resource*) node->mData));
+            }
+        }
+        this->settlePassThrough(heldResources, true);
+
+        this->mSuspended = true;
+
+    } else if(mode == MODE_RESUME) {
+        if(!this->mSuspended) return;
+        this->mSuspended = false;
+
+        std::unordered_set<int64_t> heldResources;
+        for(ResIterable* node: this->mHeldPassThroughNodes) {
+            heldResources.insert(getPassThroughKey((Resource*) node->mData));
+        }
+        this->mHeldPassThroughNodes.clear();
+        this->settlePassThrough(heldResources, false);
+
+        // Resources which were reset while suspended, and have no Requests left, need no action.
+        for(int64_t groupKey: this->mSuspendedGroups) {
+            int32_t primaryIndex = (int32_t)(groupKey >> 32);
+            int32_t groupIndex = (int32_t)(groupKey & 0xffffffff);
+
+            int8_t priority = -1;
+            ResIterable* winner = this->findWinner(primaryIndex, groupIndex, false, priority);
+            if(winner != nullptr) {
+                this->mCurrentlyAppliedPriority[primaryIndex] = priority;
+                this->applyAction(winner, primaryIndex, priority);
+            }
+        }
+
+        this->mSuspendedGroups.clear();
+    }
+}
+
 // Insert a new Request into the CocoTable
 // Note: This method is only called for Tune Requests
 // As part of this Routine, we allocate CocoNodes for the Request.
@@ -342,10 +498,14 @@ int8_t CocoTable::insertRequest(Request* req) {
         return false;
     }
 
+    int8_t backgroundProcessing = (req->getProcessingModes() & MODE_SUSPEND) != 0;
     DL_ITERATE(req->getResDlMgr()) {
         // Expect ResIterable* iter to be provided by the macro
         if(iter == nullptr) continue;
         ResIterable* resIter = (ResIterable*) iter;
+        if(backgroundProcessing) {
+            this->mBackgroundNodes.insert(resIter);
+        }
         this->insertInCocoTable(resIter, req->getPriority());
     }
 
@@ -424,10 +584,13 @@ int8_t CocoTable::removeRequest(Request* request) {
         if(resIter == nullptr || resIter->mData == nullptr) continue;
 
         Resource* resource = (Resource*) resIter->mData;
+        if(!this->mBackgroundNodes.empty()) {
+            this->mBackgroundNodes.erase(resIter);
+        }
 
         ResConfInfo* resourceConfig = this->mResourceRegistry->getResConf(resource->getResCode());
         if(resourceConfig->mPolicy == Policy::PASS_THROUGH) {
-            this->fastPathReset(resource);
+            this->removePassThrough(resIter, resource);
             continue;
         }
 
@@ -448,6 +611,11 @@ int8_t CocoTable::removeRequest(Request* request) {
         // Proceed with removal of the node from CocoTable
         dlm->deleteNode(iter);
 
+        if(this->mSuspended) {
+            this->settleGroup(primaryIndex, secondaryIndex - priority, resource);
+            continue;
+        }
+
         // Reset the Resource Node value or if there are pending Requests for this Resource
         // then apply those Requests in the order determined by Resource Policy and Priority Level.
 
@@ -494,6 +662,79 @@ int8_t CocoTable::removeRequest(Request* request) {
     return 0;
 }
 
+void CocoTable::removeRequests(const std::vector<Request*>& requests) {
+    // Resources touched by the batch, along with whether their applied Request was removed.
+    std::unordered_map<int64_t, std::pair<Resource*, int8_t>> touchedGroups;
+
+    for(Request* request: requests) {
+        if(request == nullptr || request->getResDlMgr() == nullptr) continue;
+        TYPELOGV(NOTIFY_COCO_TABLE_REMOVAL_START, request->getHandle());
+
+        DL_ITERATE(request->getResDlMgr()) {
+            if(iter == nullptr) continue;
+
+            ResIterable* resIter = (ResIterable*) iter;
+            if(resIter->mData == nullptr) continue;
+
+            Resource* resource = (Resource*) resIter->mData;
+            if(!this->mBackgroundNodes.empty()) {
+                this->mBackgroundNodes.erase(resIter);
+            }
+
+            ResConfInfo* resourceConfig = this->mResourceRegistry->getResConf(resource->getResCode());
+            if(resourceConfig->mPolicy == Policy::PASS_THROUGH) {
+                this->removePassThrough(resIter, resource);
+                continue;
+            }
+
+            int8_t priority = request->getPriority();
+            int32_t primaryIndex = this->getCocoTablePrimaryIndex(resource->getResCode());
+            int32_t secondaryIndex = this->getCocoTableSecondaryIndex(resource, priority);
+
+            if(primaryIndex < 0 || secondaryIndex < 0 ||
+               primaryIndex >= (int32_t)this->mCocoTable.size() ||
+               secondaryIndex >= (int32_t)this->mCocoTable[primaryIndex].size()) {
+                continue;
+            }
+
+            DLManager* dlm = this->mCocoTable[primaryIndex][secondaryIndex];
+            if(dlm == nullptr) continue;
+            int8_t nodeIsHead = dlm->isNodeNth(0, iter);
+            dlm->deleteNode(iter);
+
+            std::pair<Resource*, int8_t>& groupInfo =
+                touchedGroups[getGroupKey(primaryIndex, secondaryIndex - priority)];
+            if(groupInfo.first == nullptr) {
+                groupInfo.first = resource;
+            }
+            groupInfo.second = groupInfo.second || nodeIsHead;
+        }
+    }
+
+    for(std::pair<const int64_t, std::pair<Resource*, int8_t>>& entry: touchedGroups) {
+        int32_t primaryIndex = (int32_t)(entry.first >> 32);
+        int32_t groupIndex = (int32_t)(entry.first & 0xffffffff);
+        Resource* resource = entry.second.first;
+
+        if(this->mSuspended) {
+            this->settleGroup(primaryIndex, groupIndex, resource);
+            continue;
+        }
+
+        // The applied Request is still in place, no action is needed.
+        if(!entry.second.second) continue;
+
+        int8_t priority = -1;
+        ResIterable* winner = this->findWinner(primaryIndex, groupIndex, false, priority);
+        if(winner != nullptr) {
+            this->mCurrentlyAppliedPriority[primaryIndex] = priority;
+            this->applyAction(winner, primaryIndex, priority);
+        } else {
+            this->removeAction(primaryIndex, resource);
+        }
+    }
+}
+
 void CocoTable::timerExpired(Request* request) {
     TYPELOGV(NOTIFY_COCO_TABLE_REQUEST_EXPIRY, request->getHandle());
 
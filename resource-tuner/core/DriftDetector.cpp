@@ -0,0 +1,241 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+
+#include "DriftDetector.h"
+#include "SysfsWriter.h"
+#include "UrmSettings.h"
+#include "Logger.h"
+
+std::shared_ptr<DriftDetector> DriftDetector::mDriftDetectorInstance = nullptr;
+std::mutex DriftDetector::instanceProtectionLock {};
+
+static std::string trimNodeValue(const char* buffer, ssize_t length) {
+    ssize_t start = 0;
+    while(start < length && isspace((unsigned char)buffer[start])) start++;
+    while(length > start && isspace((unsigned char)buffer[length - 1])) length--;
+    return std::string(buffer + start, length - start);
+}
+
+// The fd is shared with any drift check in progress, it is closed once released by both.
+static std::shared_ptr<int32_t> openNodeFd(const std::string& nodePath) {
+    int32_t fd = open(nodePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return nullptr;
+    }
+
+    try {
+        return std::shared_ptr<int32_t>(new int32_t(fd), [](int32_t* cachedFd) {
+            close(*cachedFd);
+            delete cachedFd;
+        });
+    } catch(const std::bad_alloc& e) {
+        close(fd);
+        return nullptr;
+    }
+}
+
+// Read back a tracked node, outside of the lock.
+typedef struct {
+    std::string mNodePath;
+    std::string mExpectedValue;
+    uint64_t mVersion;
+    std::shared_ptr<int32_t> mFd;
+    int8_t mFdOpened; //!< The fd was opened by this check, and is to be cached.
+    std::string mCurrentValue;
+} NodeReadback;
+
+DriftDetector::DriftDetector() {
+    this->mTimer = nullptr;
+    this->mLastVersion = 0;
+    this->mCheckDuration = UrmSettings::metaConfigs.mDriftCheckDuration;
+    this->mReassertOnDrift = UrmSettings::metaConfigs.mReassertOnDrift;
+}
+
+void DriftDetector::trackNode(const std::string& nodePath, const std::string& value, uint32_t resCode) {
+    if(nodePath.length() == 0) return;
+    const std::lock_guard<std::mutex> lock(this->mTrackedNodesMutex);
+
+    auto it = this->mTrackedNodes.find(nodePath);
+    if(it != this->mTrackedNodes.end()) {
+        it->second.mResCode = resCode;
+        it->second.mExpectedValue = value;
+        it->second.mVersion = ++this->mLastVersion;
+        return;
+    }
+
+    TrackedNodeInfo nodeInfo;
+    nodeInfo.mResCode = resCode;
+    nodeInfo.mExpectedValue = value;
+    nodeInfo.mVersion = ++this->mLastVersion;
+    nodeInfo.mFd = openNodeFd(nodePath);
+    this->mTrackedNodes[nodePath] = nodeInfo;
+}
+
+void DriftDetector::untrackNode(const std::string& nodePath) {
+    const std::lock_guard<std::mutex> lock(this->mTrackedNodesMutex);
+
+    auto it = this->mTrackedNodes.find(nodePath);
+    if(it == this->mTrackedNodes.end()) {
+        return;
+    }
+    this->mTrackedNodes.erase(it);
+}
+
+int32_t DriftDetector::checkForDrift() {
+    int32_t driftedNodes = 0;
+    std::vector<NodeReadback> readbacks;
+
+    {
+        const std::lock_guard<std::mutex> lock(this->mTrackedNodesMutex);
+        readbacks.reserve(this->mTrackedNodes.size());
+        for(std::pair<const std::string, TrackedNodeInfo>& entry: this->mTrackedNodes) {
+            readbacks.push_back({entry.first, entry.second.mExpectedValue, entry.second.mVersion,
+                                 entry.second.mFd, false, ""});
+        }
+    }
+
+    std::vector<NodeReadback*> drifted;
+    for(NodeReadback& readback: readbacks) {
+        if(readback.mFd == nullptr) {
+            // The node might not have existed when tracking started, retry.
+            readback.mFd = openNodeFd(readback.mNodePath);
+            if(readback.mFd == nullptr) continue;
+            readback.mFdOpened = true;
+        }
+
+        // The expected value has not reached the Kernel yet.
+        if(SysfsWriter::getInstance()->isPending(readback.mNodePath)) {
+            continue;
+        }
+
+        char buffer[128];
+        ssize_t bytesRead = pread(*readback.mFd, buffer, sizeof(buffer) - 1, 0);
+        if(bytesRead < 0) {
+            TYPELOGV(ERRNO_LOG, "pread", strerror(errno));
+            continue;
+        }
+
+        readback.mCurrentValue = trimNodeValue(buffer, bytesRead);
+        if(readback.mCurrentValue != readback.mExpectedValue) {
+            drifted.push_back(&readback);
+        }
+    }
+
+    const std::lock_guard<std::mutex> lock(this->mTrackedNodesMutex);
+    for(NodeReadback& readback: readbacks) {
+        if(!readback.mFdOpened) continue;
+
+        auto it = this->mTrackedNodes.find(readback.mNodePath);
+        if(it != this->mTrackedNodes.end() && it->second.mFd == nullptr) {
+            it->second.mFd = readback.mFd;
+        }
+    }
+
+    for(NodeReadback* readback: drifted) {
+        // The node was reset or written with a new value since it was read, the
+        // value read back is stale, the next check compares it afresh.
+        auto it = this->mTrackedNodes.find(readback->mNodePath);
+        if(it == this->mTrackedNodes.end() || it->second.mVersion != readback->mVersion) {
+            continue;
+        }
+
+        TrackedNodeInfo& nodeInfo = it->second;
+        driftedNodes++;
+        this->mDriftCounts[nodeInfo.mResCode]++;
+        LOGW("RESTUNE_DRIFT_DETECTOR",
+             "Node: " + readback->mNodePath + " expected: " + nodeInfo.mExpectedValue +
+             ", found: " + readback->mCurrentValue + ", drift count for resource " +
+             std::to_string(nodeInfo.mResCode) + ": " +
+             std::to_string(this->mDriftCounts[nodeInfo.mResCode]));
+
+        // Posted under the lock, so that a concurrent untrack (followed by the reset to
+        // the default value) cannot be overtaken by this stale value in the Writer's mailbox.
+        // The post only queues the value with the Writer.
+        if(this->mReassertOnDrift) {
+            SysfsWriter::getInstance()->post(readback->mNodePath, nodeInfo.mExpectedValue);
+        }
+    }
+
+    return driftedNodes;
+}
+
+void DriftDetector::checkForDriftCb() {
+    this->checkForDrift();
+}
+
+uint64_t DriftDetector::getDriftCount(uint32_t resCode) {
+    const std::lock_guard<std::mutex> lock(this->mTrackedNodesMutex);
+
+    auto it = this->mDriftCounts.find(resCode);
+    if(it == this->mDriftCounts.end()) {
+        return 0;
+    }
+    return it->second;
+}
+
+int32_t DriftDetector::getTrackedNodesCount() {
+    const std::lock_guard<std::mutex> lock(this->mTrackedNodesMutex);
+    return this->mTrackedNodes.size();
+}
+
+void DriftDetector::setReassertOnDrift(int8_t reassertOnDrift) {
+    const std::lock_guard<std::mutex> lock(this->mTrackedNodesMutex);
+    this->mReassertOnDrift = reassertOnDrift;
+}
+
+ErrCode DriftDetector::startDriftDetectorDaemon() {
+    if(this->mCheckDuration == 0) {
+        LOGI("RESTUNE_DRIFT_DETECTOR", "Drift Detector is disabled");
+        return RC_SUCCESS;
+    }
+
+    try {
+        this->mTimer = MPLACEV(Timer, std::bind(&DriftDetector::checkForDriftCb, this), true);
+
+    } catch(const std::bad_alloc& e) {
+        return RC_MEMORY_ALLOCATION_FAILURE;
+
+    } catch(const std::exception& e) {
+        return RC_MEMORY_ALLOCATION_FAILURE;
+    }
+
+    if(!this->mTimer->startTimer(this->mCheckDuration)) {
+        return RC_WORKER_THREAD_ASSIGNMENT_FAILURE;
+    }
+
+    LOGI("RESTUNE_DRIFT_DETECTOR", "Drift Detector Daemon Thread Started");
+    return RC_SUCCESS;
+}
+
+void DriftDetector::stopDriftDetectorDaemon() {
+    if(this->mTimer != nullptr) {
+        this->mTimer->killTimer();
+    }
+}
+
+DriftDetector::~DriftDetector() {
+    if(this->mTimer != nullptr) {
+        FreeBlock<Timer>(this->mTimer);
+        this->mTimer = nullptr;
+    }
+}
+
+ErrCode startDriftDetectorDaemon() {
+    if(DriftDetector::getInstance() == nullptr) {
+        return RC_MEMORY_ALLOCATION_FAILURE;
+    }
+    return DriftDetector::getInstance()->startDriftDetectorDaemon();
+}
+
+void stopDriftDetectorDaemon() {
+    if(DriftDetector::getInstance() == nullptr) {
+        return;
+    }
+    return DriftDetector::getInstance()->stopDriftDetectorDaemon();
+}
@@ -0,0 +1,124 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+/*!
+ * \file  CGroupMigrator.h
+ */
+
+/*!
+ * \ingroup  CGROUP_MIGRATOR
+ * \defgroup CGROUP_MIGRATOR CGroup Migrator
+ * \details Moves Processes and Threads across CGroups in bulk.\n\n
+ *          1) The cgroup.procs / cgroup.threads controller files are opened once and the fds are
+ *             cached for subsequent migrations, so moving a list of PIDs / TIDs is a burst of
+ *             write calls on the same fd instead of an open / write / close cycle per ID.\n\n
+ *          2) The CGroup a PID / TID belonged to before it was first migrated is cached, so that it
+ *             can be moved back when the Request is untuned, without re-reading procfs.\n\n
+ *
+ * @{
+ */
+
+#ifndef CGROUP_MIGRATOR_H
+#define CGROUP_MIGRATOR_H
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "ErrCodes.h"
+#include "Logger.h"
+
+/**
+ * @brief CGroupMigrator
+ * @details Bulk PID / TID CGroup migration engine, with cached controller fds.
+ */
+class CGroupMigrator {
+private:
+    static std::shared_ptr<CGroupMigrator> mCGroupMigratorInstance;
+    static std::mutex instanceProtectionLock;
+
+    std::mutex mMigratorMutex;
+    std::unordered_map<std::string, int32_t> mControllerFds; //!< Migration target path to cached fd.
+    std::unordered_map<int32_t, std::string> mOriginalProcCGroups; //!< PID to CGroup prior to migration.
+    std::unordered_map<int32_t, std::string> mOriginalThreadCGroups; //!< TID to CGroup prior to migration.
+
+    CGroupMigrator();
+
+    int32_t getControllerFd(const std::string& controllerFilePath);
+    void dropControllerFd(const std::string& controllerFilePath);
+    int32_t migrate(const std::string& controllerFilePath,
+                    const std::vector<int32_t>& ids,
+                    std::unordered_map<int32_t, std::string>& originStore,
+                    int8_t cacheFd);
+    void restore(const std::vector<int32_t>& ids,
+                 const std::string& controllerName,
+                 std::unordered_map<int32_t, std::string>& originStore);
+
+public:
+    ~CGroupMigrator();
+
+    /**
+     * @brief Move all the given Processes to the CGroup whose cgroup.procs file is specified.
+     * @param controllerFilePath Path to the target CGroup's cgroup.procs file.
+     * @param pids List of Process IDs to be moved.
+     * @return int32_t:\n
+     *            - Number of Processes which were successfully moved.
+     */
+    int32_t migrateProcesses(const std::string& controllerFilePath, const std::vector<int32_t>& pids);
+
+    /**
+     * @brief Move all the given Threads to the CGroup whose cgroup.threads file is specified.
+     * @param controllerFilePath Path to the target CGroup's cgroup.threads file.
+     * @param tids List of Thread IDs to be moved.
+     * @return int32_t:\n
+     *            - Number of Threads which were successfully moved.
+     */
+    int32_t migrateThreads(const std::string& controllerFilePath, const std::vector<int32_t>& tids);
+
+    /**
+     * @brief Move the given Processes back to the CGroups they belonged to prior to migration.
+     * @param pids List of Process IDs.
+     */
+    void restoreProcesses(const std::vector<int32_t>& pids);
+
+    /**
+     * @brief Move the given Threads back to the CGroups they belonged to prior to migration.
+     * @param tids List of Thread IDs.
+     */
+    void restoreThreads(const std::vector<int32_t>& tids);
+
+    /**
+     * @brief Move every Process and Thread migrated by Resource Tuner back to its original CGroup.
+     */
+    void restoreAll();
+
+    /**
+     * @brief Get the CGroup (relative to the cgroup root) in which the ID was before it was migrated.
+     * @param id Process or Thread ID.
+     * @return std::string:\n
+     *            - Relative CGroup path, or an empty string if the ID was never migrated.
+     */
+    std::string getOriginalCGroup(int32_t id);
+
+    static std::shared_ptr<CGroupMigrator> getInstance() {
+        if(mCGroupMigratorInstance == nullptr) {
+            instanceProtectionLock.lock();
+            if(mCGroupMigratorInstance == nullptr) {
+                try {
+                    mCGroupMigratorInstance = std::shared_ptr<CGroupMigrator> (new CGroupMigrator());
+                } catch(const std::bad_alloc& e) {
+                    instanceProtectionLock.unlock();
+                    return nullptr;
+                }
+            }
+            instanceProtectionLock.unlock();
+        }
+        return mCGroupMigratorInstance;
+    }
+};
+
+#endif
+
+/*! @} */
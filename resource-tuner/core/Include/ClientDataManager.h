@@ -4,12 +4,14 @@
 #ifndef CLIENT_DATA_MANAGER_H
 #define CLIENT_DATA_MANAGER_H
 
+#include <atomic>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
 #include <shared_mutex>
 #include <memory>
 #include <mutex>
+#include <sys/epoll.h>
 #include "string.h"
 #include "unistd.h"
 #include "fstream"
@@ -24,20 +26,209 @@
 
 #define PER_CLIENT_TID_CAP 32
 
+// The Client Tables are split into shards, each an open-addressing table. The shards are sized
+// from the configured client bound, and grow if the clients are unevenly spread across them.
+#define CLIENT_TABLE_SHARD_COUNT 16
+#define CLIENT_SHARD_MIN_CAPACITY 16
+#define CLIENT_INLINE_HANDLES 6
+
+// Client Health is tracked in thousandths, so that it can be updated atomically.
+#define RATE_BUCKET_SCALE 1000
+#define RATE_BUCKET_CAPACITY (100 * RATE_BUCKET_SCALE)
+
 typedef struct _client_info {
     uint8_t mClientType;
     int32_t mCurClientThreads;
     int32_t mClientTIDs[PER_CLIENT_TID_CAP];
+    int32_t mPidFd; //!< pidfd watched for the client's exit, -1 if it could not be opened.
 
-    _client_info(): mCurClientThreads(0) {}
+    _client_info(): mCurClientThreads(0), mPidFd(-1) {}
 } ClientInfo;
 
+/**
+ * @brief RateBucket
+ * @details Token bucket backing the Client Health. Requests arriving closer than the RateLimiter
+ *          delta drain the bucket, suitably spaced out Requests refill it (upto the capacity).
+ */
+typedef struct _rate_bucket {
+    std::atomic<int64_t> mTokens;
+    std::atomic<int64_t> mLastRequestTimestamp;
+
+    // Only used when relocating a slot, under the shard's exclusive lock.
+    _rate_bucket& operator=(const _rate_bucket& other) {
+        this->mTokens.store(other.mTokens.load());
+        this->mLastRequestTimestamp.store(other.mLastRequestTimestamp.load());
+        return *this;
+    }
+} RateBucket;
+
+/**
+ * @brief ClientHandleSet
+ * @details Handles of the Requests issued by a client thread. Most threads hold only a few
+ *          Requests at a time, these are stored inline. The handles spill over to a pool
+ *          allocated set only once the inline slots are exhausted.
+ */
+typedef struct {
+    int32_t mInlineCount;
+    int64_t mInlineHandles[CLIENT_INLINE_HANDLES];
+    std::unordered_set<int64_t>* mSpill;
+} ClientHandleSet;
+
 typedef struct {
-    std::unordered_set<int64_t>* mClientHandles;
-    int64_t mLastRequestTimestamp;
-    double mHealth;
+    ClientHandleSet mClientHandles;
+    RateBucket mRateBucket;
 } ClientTidData;
 
+inline uint32_t clientKeyHash(int32_t key) {
+    return (uint32_t)key * 2654435761u;
+}
+
+/**
+ * @brief ClientShard
+ * @details A linear probing table of client entries (keyed by PID or TID), along with the lock
+ *          guarding it. Entries are stored inline in the table, hence adding a client does not
+ *          allocate, unless the table has to grow (once it is 3/4 full). Deletions shift the
+ *          following entries back, so that no tombstones are left behind.
+ */
+template <typename T>
+class ClientShard {
+private:
+    struct Slot {
+        int32_t mKey = 0;
+        int8_t mOccupied = false;
+        T mData;
+    };
+
+    std::vector<Slot> mSlots;
+    int32_t mMask;
+    int32_t mCount;
+
+    int32_t homeOf(int32_t key) {
+        return clientKeyHash(key) & this->mMask;
+    }
+
+    int32_t indexOf(int32_t key) {
+        int32_t index = this->homeOf(key);
+        for(int32_t probe = 0; probe <= this->mMask; probe++) {
+            if(!this->mSlots[index].mOccupied) return -1;
+            if(this->mSlots[index].mKey == key) return index;
+            index = (index + 1) & this->mMask;
+        }
+        return -1;
+    }
+
+    int8_t grow() {
+        std::vector<Slot> slots;
+        try {
+            slots = std::vector<Slot>(2 * this->mSlots.size());
+        } catch(const std::bad_alloc& e) {
+            return false;
+        }
+
+        slots.swap(this->mSlots);
+        this->mMask = this->mSlots.size() - 1;
+
+        for(Slot& slot: slots) {
+            if(!slot.mOccupied) continue;
+
+            int32_t index = this->homeOf(slot.mKey);
+            while(this->mSlots[index].mOccupied) {
+                index = (index + 1) & this->mMask;
+            }
+
+            this->mSlots[index].mKey = slot.mKey;
+            this->mSlots[index].mOccupied = true;
+            this->mSlots[index].mData = slot.mData;
+        }
+        return true;
+    }
+
+public:
+    alignas(64) std::shared_timed_mutex mMutex;
+
+    ClientShard() : mSlots(CLIENT_SHARD_MIN_CAPACITY), mMask(CLIENT_SHARD_MIN_CAPACITY - 1), mCount(0) {}
+
+    /**
+     * @brief Size the (empty) table for the given number of entries, rounded up to a power of 2.
+     */
+    void reserve(int32_t capacity) {
+        int32_t size = CLIENT_SHARD_MIN_CAPACITY;
+        while(size < capacity) {
+            size <<= 1;
+        }
+
+        if(this->mCount > 0 || size <= (int32_t)this->mSlots.size()) return;
+        this->mSlots = std::vector<Slot>(size);
+        this->mMask = size - 1;
+    }
+
+    int32_t getCapacity() {
+        return this->mSlots.size();
+    }
+
+    T* find(int32_t key) {
+        int32_t index = this->indexOf(key);
+        return (index < 0) ? nullptr : &this->mSlots[index].mData;
+    }
+
+    /**
+     * @brief Claim a slot for a key not present in the shard.
+     * @return T*:\n
+     *            - The (default initialized) entry\n
+     *            - nullptr: If the shard is full and could not be grown
+     */
+    T* insert(int32_t key) {
+        if(4 * (this->mCount + 1) > 3 * (int32_t)this->mSlots.size()) {
+            this->grow();
+        }
+        if(this->mCount >= (int32_t)this->mSlots.size()) return nullptr;
+
+        int32_t index = this->homeOf(key);
+        while(this->mSlots[index].mOccupied) {
+            index = (index + 1) & this->mMask;
+        }
+
+        this->mSlots[index].mKey = key;
+        this->mSlots[index].mOccupied = true;
+        this->mSlots[index].mData = T();
+        this->mCount++;
+        return &this->mSlots[index].mData;
+    }
+
+    void erase(int32_t key) {
+        int32_t hole = this->indexOf(key);
+        if(hole < 0) return;
+
+        int32_t index = hole;
+        while(true) {
+            index = (index + 1) & this->mMask;
+            if(!this->mSlots[index].mOccupied) break;
+
+            // Move the entry back, if the hole lies on its probe sequence.
+            int32_t home = this->homeOf(this->mSlots[index].mKey);
+            int32_t distToHole = (hole - home) & this->mMask;
+            int32_t distToIndex = (index - home) & this->mMask;
+            if(distToHole < distToIndex) {
+                this->mSlots[hole].mKey = this->mSlots[index].mKey;
+                this->mSlots[hole].mData = this->mSlots[index].mData;
+                hole = index;
+            }
+        }
+
+        this->mSlots[hole].mOccupied = false;
+        this->mCount--;
+    }
+
+    template <typename F>
+    void forEach(F callback) {
+        for(Slot& slot: this->mSlots) {
+            if(slot.mOccupied) {
+                callback(slot.mKey, slot.mData);
+            }
+        }
+    }
+};
+
 /**
  * @details Stores and Maintains Client Tracking Data for all the Active Clients (i.e. clients with
  *          outstanding Requests). The Data Tracked for each Client includes:
@@ -46,19 +237,39 @@ typedef struct {
  *          - List of Requests (identified by Handle) belonging to this Client
  *          - Health and Timestamp of Last Request (Used by RateLimiter)
  *          - Essentially ClientDataManager is a central storage for Client Data, and other Components
- *            like RateLimiter, PulseMonitor and RequestManager are clients of the ClientDataManager.
+ *            like RateLimiter, PulseMonitor and RequestManager are clients of the ClientDataManager.\n\n
+ *          The PID and TID tables are sharded (see ClientShard), each shard with its own lock, so that
+ *          many short-lived client threads do not contend on a single table lock. As many client
+ *          PIDs (and TIDs) are tracked as there are Resource blocks preallocated, i.e. the maximum
+ *          number of concurrent Requests times the maximum number of Resources per Request.\n\n
+ *          A pidfd is held for every client PID, and registered with the client exit epoll set
+ *          (see getClientExitFd), so that the PulseMonitor learns of a client's exit right away.
  */
 class ClientDataManager {
 private:
     static std::shared_ptr<ClientDataManager> mClientDataManagerInstance;
     static std::mutex instanceProtectionLock;
-    std::unordered_map<int32_t, ClientInfo*> mClientRepo; //!< Maintains Client Info indexed by PID
-    std::unordered_map<int32_t, ClientTidData*> mClientTidRepo; //!< Maintains Client Info indexed by TID
-    std::shared_timed_mutex mGlobalTableMutex;
+    ClientShard<ClientInfo> mClientRepo[CLIENT_TABLE_SHARD_COUNT]; //!< Maintains Client Info indexed by PID
+    ClientShard<ClientTidData> mClientTidRepo[CLIENT_TABLE_SHARD_COUNT]; //!< Maintains Client Info indexed by TID
+
+    // Bound on the number of client PIDs (and TIDs) tracked, 0 if not configured.
+    int32_t mMaxClients;
+    std::atomic<int32_t> mClientCount;
+    std::atomic<int32_t> mThreadCount;
+
+    int32_t mClientExitFd;
+    std::atomic<int32_t> mUnwatchedClients; //!< Clients for which no pidfd could be registered.
 
     ClientDataManager();
 
+    int32_t watchClient(int32_t clientPID, int32_t pidFd);
+
+    ClientShard<ClientInfo>& getPidShard(int32_t clientPID);
+    ClientShard<ClientTidData>& getTidShard(int32_t clientTID);
+
 public:
+    ~ClientDataManager();
+
     /**
      * @brief Checks if the client with the given ID exists in the Client Data Table.
      * @param clientPID PID of the client
@@ -74,19 +285,23 @@ public:
      * @details This method should only be called if the clientExists method returns 0.
      * @param clientPID PID of the client
      * @param clientTID TID of the client
+     * @param clientLevel Permission level of the client, as verified by the Listener. If -1,
+     *                    the level is determined from /proc/<pid>/status instead.
      * @return int8_t:\n
      *             - 1: Indicating that a new Client Tracking Entry was successfully Created.\n
      *             - 0: Otherwise
      */
-    int8_t createNewClient(int32_t clientPID, int32_t clientTID);
+    int8_t createNewClient(int32_t clientPID, int32_t clientTID, int8_t clientLevel = -1);
 
     /**
-     * @brief Returns a list of active requests for the client with the given PID.
+     * @brief Returns a list of active requests for the client with the given TID.
      * @param clientTID Process TID of the client
-     * @return std::unordered_set<int64_t>*:\n
-     *             - Pointer to an unordered_set containing the requests.
+     * @param requestHandles An IN/OUT parameter to store the handles of the requests.
+     * @return int8_t:\n
+     *             - 1: If the client exists\n
+     *             - 0: Otherwise
      */
-    std::unordered_set<int64_t>* getRequestsByClientID(int32_t clientTID);
+    int8_t getRequestsByClientID(int32_t clientTID, std::vector<int64_t>& requestHandles);
 
     /**
      * @brief This method is called by the RequestMap to insert a new Request (represented by it's handle)
@@ -104,6 +319,24 @@ public:
      */
     void deleteRequestByClientId(int32_t clientTID, int64_t requestHandle);
 
+    /**
+     * @brief This method is called by the RateLimiter to charge a Request against the client's RateBucket.
+     * @details The bucket is updated with atomics, only a shared lock on the Client Table is taken.
+     * @param clientTID TID of the client
+     * @param currentMillis Arrival time of the Request
+     * @param minGap Requests spaced closer than this (in milliseconds) are penalized
+     * @param penaltyTokens Tokens drained for a Request arriving within the minGap
+     * @param rewardTokens Tokens refilled for a suitably spaced out Request
+     * @return int8_t:\n
+     *            - 1: If the bucket still holds tokens, i.e. the Request can be accepted\n
+     *            - 0: Otherwise
+     */
+    int8_t chargeRateBucket(int32_t clientTID,
+                            int64_t currentMillis,
+                            int64_t minGap,
+                            int64_t penaltyTokens,
+                            int64_t rewardTokens);
+
     /**
      * @brief This method is called by the RateLimiter to fetch the current health for a given
      *        client in the Client Data Table.
@@ -152,11 +385,26 @@ public:
     void getThreadsByClientId(int32_t clientPID, std::vector<int32_t>& threadIDs);
 
     /**
-     * @brief This method is called by the PulseMonitor to fetch the list of all active clients.
+     * @brief Fetch the list of all active clients.
      * @param clientList An IN/OUT parameter to store the list of active clients.
      */
     void getActiveClientList(std::vector<int32_t>& clientList);
 
+    /**
+     * @brief Get the epoll fd over which client exits are reported.
+     * @details Each event carries the PID of a terminated client in data.u64, and is reported only once.
+     * @return int32_t:\n
+     *            - The epoll fd\n
+     *            - -1: If it could not be created, all clients are then unwatched
+     */
+    int32_t getClientExitFd();
+
+    /**
+     * @brief Fetch the clients for which no pidfd could be registered, these need to be polled.
+     * @param clientList An IN/OUT parameter to store the list of unwatched clients.
+     */
+    void getUnwatchedClientList(std::vector<int32_t>& clientList);
+
     /**
      * @brief Delete a client PID Entry from the Client Table.
      * @param clientPID Process ID of the client
@@ -12,16 +12,15 @@
  * \ingroup  CLIENT_GARBAGE_COLLECTOR
  * \defgroup CLIENT_GARBAGE_COLLECTOR Client Garbage Collector
  * \details Runs as a Daemon Thread and Periodically (Every 83 seconds) and performs cleanup for
- *          a pre-defined max number of clients found in the Garbage Collector Queue (added by the Pulse Monitor).\n
+ *          all the clients found in the Garbage Collector Queue (added by the Pulse Monitor).
+ *          A round of cleanup is also triggered by the Pulse Monitor, as soon as it detects a dead client.\n
  *          As part of the cleanup:\n\n
- *          1) All the active Requests from the client (if any) are untuned.\n\n
- *          2) The Request Manager is updated, so that these requests are no longer tracked
- *             as active Requests.\n\n
- *          3) The Client tracking entries maintained by the ClientDataManager for this client PID are cleared.\n\n
- *
- *          Note, not all clients in the queue are cleaned up at once, instead a pre-defined
- *          upper bound is placed on the number of clients to be cleaned in one iteration. The pending
- *          clients will be taken up in subsequent iterations.
+ *          1) The Client tracking entries maintained by the ClientDataManager for the client threads are cleared.\n\n
+ *          2) All the active Requests from the clients (if any) are handed over to the RequestQueue, which
+ *             removes them from the CocoTable as a single batch, i.e. each affected Resource is
+ *             re-applied (or reset) only once.\n\n
+ *          3) The Request Manager is updated, so that these requests are no longer tracked
+ *             as active Requests, and their memory is released.
  * @{
  */
 
@@ -69,6 +68,13 @@ public:
     void stopClientGarbageCollectorDaemon();
     void submitClientThreadsForCleanup(int32_t clientTid);
 
+    /**
+     * @brief Perform a round of cleanup right away, on the calling thread.
+     * @details Called by the PulseMonitor once it detects a dead client, so that the client's
+     *          Requests need not wait for the next periodic collection.
+     */
+    void triggerCleanup();
+
     static std::shared_ptr<ClientGarbageCollector> getInstance() {
         if(mClientGarbageCollectorInstance == nullptr) {
             mClientGarbageCollectorInstance = std::shared_ptr<ClientGarbageCollector> (new ClientGarbageCollector());
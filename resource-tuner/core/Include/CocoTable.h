@@ -6,7 +6,9 @@
 
 #include <fstream>
 #include <vector>
+#include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 #include <cerrno>
 #include <atomic>
@@ -76,6 +78,13 @@
  * -# Reset each of the Resource Sysfs Nodes to their original values, if there are no
  * other Pending Requests for that Resource.\n
  *
+ * **Suspend / Resume**:\n
+ *     Requests stay in the CocoTable across device mode transitions. On suspend, only the Resources
+ *     whose applied Request is not eligible for background processing are switched over to the next
+ *     eligible Request (or reset). These Resources are remembered, and on resume only they are
+ *     re-applied, with their winners at that time. Pass-through Resources follow the same rule, with
+ *     the last eligible Request applied standing in for the winner.\n
+ *
  * @{
  */
 
@@ -109,6 +118,12 @@ private:
      */
     std::vector<int32_t> mCurrentlyAppliedPriority;
 
+    int8_t mSuspended;
+    std::unordered_set<ResIterable*> mBackgroundNodes; //!< CocoNodes of Requests enabled for background processing.
+    std::unordered_set<int64_t> mSuspendedGroups; //!< Resources switched over while suspended.
+    std::vector<ResIterable*> mPassThroughNodes; //!< CocoNodes of pass-through Resources, in the order applied.
+    std::unordered_set<ResIterable*> mHeldPassThroughNodes; //!< Pass-through CocoNodes held back while suspended.
+
     CocoTable();
 
     void timerExpired(Request* req);
@@ -124,6 +139,12 @@ private:
 
     int8_t insertInCocoTable(ResIterable* currNode, int8_t priority);
 
+    int8_t isEligibleInSuspend(ResIterable* node);
+    ResIterable* findWinner(int32_t primaryIndex, int32_t groupIndex, int8_t inSuspend, int8_t& priority);
+    void settleGroup(int32_t primaryIndex, int32_t groupIndex, Resource* resource);
+    void settlePassThrough(const std::unordered_set<int64_t>& resources, int8_t inSuspend);
+    void removePassThrough(ResIterable* node, Resource* resource);
+
     void fastPathApply(Resource* resource);
     void fastPathReset(Resource* resource);
     int8_t needAllocation(Resource* res);
@@ -157,6 +178,15 @@ public:
      */
     int8_t removeRequest(Request* req);
 
+    /**
+     * @brief Remove a set of Tune Requests from the CocoTable, as a single batch.
+     * @details Used to clean up after dead clients. All the nodes are unlinked first, after which
+     *          the winner is recomputed (and applied) once for every Resource whose applied
+     *          Request was removed, instead of once per Request.
+     * @param requests The Requests to be removed, these are not freed.
+     */
+    void removeRequests(const std::vector<Request*>& requests);
+
     /**
      * @brief Used to update the duration of an Active Request
      * @details This routine is invoked when a retune request is received, to modify the
@@ -170,6 +200,17 @@ public:
      */
     int8_t updateRequest(Request* req, int64_t duration);
 
+    /**
+     * @brief Switch the applied Requests over for the given device mode.
+     * @details On MODE_SUSPEND, each Resource whose applied Request is not enabled for background
+     *          processing, or which is not allowed in MODE_SUSPEND, is switched over to the next
+     *          eligible Request, or reset if there is none. Pass-through Resources are switched over
+     *          to the last eligible Request applied for them. On MODE_RESUME, only the Resources
+     *          switched over while suspended are re-applied. No Requests are untuned or resubmitted.
+     * @param mode The device mode being entered, MODE_SUSPEND or MODE_RESUME.
+     */
+    void applyModeTransition(int8_t mode);
+
     static std::shared_ptr<CocoTable> getInstance() {
         if(mCocoTableInstance == nullptr) {
             instanceProtectionLock.lock();
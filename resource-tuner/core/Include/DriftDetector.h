@@ -0,0 +1,135 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#ifndef DRIFT_DETECTOR_H
+#define DRIFT_DETECTOR_H
+
+/*!
+ * \file  DriftDetector.h
+ */
+
+/*!
+ * \ingroup  DRIFT_DETECTOR
+ * \defgroup DRIFT_DETECTOR Drift Detector
+ * \details Runs as a Daemon Thread and Periodically verifies that the values applied by Resource Tuner
+ *          are still in effect. Other entities in the system (for example thermal or power HALs) can
+ *          overwrite the same nodes, and without this check such overrides go unnoticed until the
+ *          Request expires.\n\n
+ *          1) Whenever a Resource Applier writes the winning value for a node, the node is tracked
+ *             along with the expected value. The tracking is removed when the node is reset.\n\n
+ *          2) Every check interval, each tracked node is read back (through an fd which is kept open
+ *             for as long as the node is tracked) and compared against the expected value.\n\n
+ *          3) Mismatches are counted per Resource, and if enabled, the expected value is re-asserted.\n\n
+ *
+ * @{
+ */
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "ErrCodes.h"
+#include "Timer.h"
+
+typedef struct {
+    uint32_t mResCode; //!< Resource which owns the currently applied value.
+    std::string mExpectedValue; //!< Value last written to the node.
+    uint64_t mVersion; //!< Changes whenever the node is (re)tracked, refer checkForDrift.
+    std::shared_ptr<int32_t> mFd; //!< Cached read-only fd, closed along with the last reference.
+} TrackedNodeInfo;
+
+/**
+ * @brief DriftDetector
+ * @details Compares the Kernel value of every currently applied Resource Node against
+ *          the value written by Resource Tuner.
+ */
+class DriftDetector {
+private:
+    static std::shared_ptr<DriftDetector> mDriftDetectorInstance;
+    static std::mutex instanceProtectionLock;
+
+    Timer* mTimer;
+    uint32_t mCheckDuration;
+    int8_t mReassertOnDrift;
+
+    // Held only to update or snapshot the tracked nodes, the nodes are read without it,
+    // so that a slow node does not hold up the Resource Appliers.
+    std::mutex mTrackedNodesMutex;
+    std::unordered_map<std::string, TrackedNodeInfo> mTrackedNodes;
+    std::unordered_map<uint32_t, uint64_t> mDriftCounts;
+    uint64_t mLastVersion;
+
+    DriftDetector();
+
+    void checkForDriftCb();
+
+public:
+    ~DriftDetector();
+
+    /**
+     * @brief Start tracking the given node, or update its expected value if already tracked.
+     * @param nodePath Path of the Resource Node.
+     * @param value Value written to the node.
+     * @param resCode Resource Code of the Resource which wrote the value.
+     */
+    void trackNode(const std::string& nodePath, const std::string& value, uint32_t resCode);
+
+    /**
+     * @brief Stop tracking the given node, this should be called once the node is reset.
+     * @param nodePath Path of the Resource Node.
+     */
+    void untrackNode(const std::string& nodePath);
+
+    /**
+     * @brief Read back all tracked nodes and compare them against the expected values.
+     * @return int32_t:\n
+     *            - Number of nodes found to have drifted in this pass.
+     */
+    int32_t checkForDrift();
+
+    /**
+     * @brief Get the number of times the value applied for a Resource was found overwritten.
+     * @param resCode Resource Code
+     * @return uint64_t:\n
+     *            - Total drift count recorded for the Resource
+     */
+    uint64_t getDriftCount(uint32_t resCode);
+    int32_t getTrackedNodesCount();
+
+    void setReassertOnDrift(int8_t reassertOnDrift);
+
+    /**
+     * @brief Starts the Drift Detector
+     * @details A recurring timer is created by using a thread from the Thread Pool. If
+     *          the configured check interval is 0, the detector is not started.
+     * @return ErrCode:\n
+     *            - RC_SUCCESS If the Drift Detector is successfully started (or disabled)\n
+     *            - Enum Code indicating error: Otherwise.
+     */
+    ErrCode startDriftDetectorDaemon();
+    void stopDriftDetectorDaemon();
+
+    static std::shared_ptr<DriftDetector> getInstance() {
+        if(mDriftDetectorInstance == nullptr) {
+            instanceProtectionLock.lock();
+            if(mDriftDetectorInstance == nullptr) {
+                try {
+                    mDriftDetectorInstance = std::shared_ptr<DriftDetector> (new DriftDetector());
+                } catch(const std::bad_alloc& e) {
+                    instanceProtectionLock.unlock();
+                    return nullptr;
+                }
+            }
+            instanceProtectionLock.unlock();
+        }
+        return mDriftDetectorInstance;
+    }
+};
+
+ErrCode startDriftDetectorDaemon();
+void stopDriftDetectorDaemon();
+
+#endif
+
+/*! @} */
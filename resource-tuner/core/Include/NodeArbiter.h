@@ -0,0 +1,109 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+/*!
+ * \file  NodeArbiter.h
+ */
+
+/*!
+ * \ingroup  NODE_ARBITER
+ * \defgroup NODE_ARBITER Node Arbiter
+ * \details Multiple Resources can be backed by the same physical node, for example the cluster and core
+ *          variants of RES_PM_QOS_LATENCY both expand to cpu%d/power/pm_qos_resume_latency_us. The
+ *          CocoTable arbitrates each Resource independently, hence without further coordination each
+ *          Resource would overwrite the value applied by the other, and the tear of one would reset the
+ *          node even though the other still holds an active Request.\n\n
+ *          Shared nodes are identified by the ResourceRegistry at init. For such nodes, the CocoTable
+ *          winner of every Resource is registered here as a claim, and a single node-level winner is
+ *          picked as per the Resource Policy. The node is written only when that winner changes.
+ *
+ * @{
+ */
+
+#ifndef NODE_ARBITER_H
+#define NODE_ARBITER_H
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Utils.h"
+
+/**
+ * @brief NodeArbiter
+ * @details Node-level arbitration for nodes shared across Resources.
+ */
+class NodeArbiter {
+private:
+    static std::shared_ptr<NodeArbiter> mNodeArbiterInstance;
+    static std::mutex instanceProtectionLock;
+
+    typedef struct {
+        enum Policy mPolicy;
+        std::string mAppliedValue;
+        std::vector<std::pair<uint32_t, std::string>> mClaims; //!< ResCode to value, in claim order.
+    } SharedNodeInfo;
+
+    std::mutex mArbiterMutex;
+    std::unordered_map<std::string, SharedNodeInfo> mSharedNodes;
+
+    NodeArbiter();
+
+    size_t pickWinner(SharedNodeInfo& nodeInfo);
+
+public:
+    ~NodeArbiter();
+
+    /**
+     * @brief Register the value selected by the CocoTable for a Resource on a shared node.
+     * @param nodePath Path of the shared node.
+     * @param resCode Resource claiming the node.
+     * @param value Value selected for the Resource.
+     * @param policy Policy of the Resource, used to pick the node-level winner.
+     * @param winner Node-level winning value, populated if the return value is true.
+     * @param winnerResCode Resource holding the winning value, populated if the return value is true.
+     * @return int8_t:\n
+     *            - 1: If the node-level winner changed, and hence needs to be written\n
+     *            - 0: Otherwise
+     */
+    int8_t claim(const std::string& nodePath, uint32_t resCode,
+                 const std::string& value, enum Policy policy,
+                 std::string& winner, uint32_t& winnerResCode);
+
+    /**
+     * @brief Drop the claim of a Resource on a shared node.
+     * @param nodePath Path of the shared node.
+     * @param resCode Resource releasing the node.
+     * @param winner Value held by the remaining claims, populated if the return value is true.
+     * @param winnerResCode Resource holding the winning value, populated if the return value is true.
+     * @return int8_t:\n
+     *            - 1: If other Resources still claim the node, the node should be written with "winner"\n
+     *            - 0: If no claims remain, the node should be reset
+     */
+    int8_t release(const std::string& nodePath, uint32_t resCode,
+                   std::string& winner, uint32_t& winnerResCode);
+
+    int32_t getClaimsCount(const std::string& nodePath);
+
+    static std::shared_ptr<NodeArbiter> getInstance() {
+        if(mNodeArbiterInstance == nullptr) {
+            instanceProtectionLock.lock();
+            if(mNodeArbiterInstance == nullptr) {
+                try {
+                    mNodeArbiterInstance = std::shared_ptr<NodeArbiter> (new NodeArbiter());
+                } catch(const std::bad_alloc& e) {
+                    instanceProtectionLock.unlock();
+                    return nullptr;
+                }
+            }
+            instanceProtectionLock.unlock();
+        }
+        return mNodeArbiterInstance;
+    }
+};
+
+#endif
+
+/*! @} */
@@ -0,0 +1,152 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+/*!
+ * \file  NodeJournal.h
+ */
+
+/*!
+ * \ingroup  NODE_JOURNAL
+ * \defgroup NODE_JOURNAL Node Journal
+ * \details Crash-safe record of the original value of every Resource Node modified by Resource Tuner,
+ *          so that the nodes can be restored if the Server terminates abnormally.\n\n
+ *          1) The journal is a fixed-layout file, memory mapped (MAP_SHARED) by the Server. Each node
+ *             is assigned a slot on its first tune, holding the node path, its original value and
+ *             the value currently applied.\n\n
+ *          2) Updates are plain stores into the mapping, no syscalls are issued on the Request path.
+ *             Since the mapping is shared, the page cache already reflects every update if the process
+ *             dies, the mapping is additionally msync'd by the Sysfs Writer thread after each batch.\n\n
+ *          3) On the next start, the slots are walked in a single sequential pass and each node is
+ *             written back with its original value.\n\n
+ *
+ * @{
+ */
+
+#ifndef NODE_JOURNAL_H
+#define NODE_JOURNAL_H
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "ErrCodes.h"
+#include "Logger.h"
+
+#define JOURNAL_MAGIC 0x4e4a4d55
+#define JOURNAL_VERSION 1
+#define JOURNAL_SLOT_COUNT 512
+#define JOURNAL_PATH_LENGTH 128
+#define JOURNAL_VALUE_LENGTH 64
+
+/**
+ * @brief Journal entry for a single node.
+ * @details mInUse is stored last, once the rest of the slot has been populated, so that a
+ *          partially written slot is never picked up during recovery.
+ */
+typedef struct {
+    uint32_t mInUse;
+    uint32_t mReserved;
+    char mNodePath[JOURNAL_PATH_LENGTH];
+    char mOriginalValue[JOURNAL_VALUE_LENGTH];
+    char mAppliedValue[JOURNAL_VALUE_LENGTH];
+} JournalSlot;
+
+typedef struct {
+    uint32_t mMagic;
+    uint32_t mVersion;
+    uint32_t mSlotCount;
+    uint32_t mReserved;
+} JournalHeader;
+
+typedef struct {
+    JournalHeader mHeader;
+    JournalSlot mSlots[JOURNAL_SLOT_COUNT];
+} JournalLayout;
+
+/**
+ * @brief NodeJournal
+ * @details Memory mapped journal of the original and applied values of the tuned Resource Nodes.
+ */
+class NodeJournal {
+private:
+    static std::shared_ptr<NodeJournal> mNodeJournalInstance;
+    static std::mutex instanceProtectionLock;
+
+    std::mutex mJournalMutex;
+    JournalLayout* mJournal;
+    int32_t mJournalFd;
+    int32_t mNextFreeSlot;
+    std::unordered_map<std::string, int32_t> mSlotIndex; //!< Node path to slot in the journal.
+
+    NodeJournal();
+
+public:
+    ~NodeJournal();
+
+    /**
+     * @brief Create (or truncate) the journal file and map it.
+     * @param journalPath Path of the journal file.
+     * @return ErrCode:\n
+     *            - RC_SUCCESS: If the journal is ready for use\n
+     *            - RC_FILE_NOT_FOUND: If the file could not be created or mapped
+     */
+    ErrCode open(const std::string& journalPath);
+
+    /**
+     * @brief Unmap and close the journal, the file itself is retained.
+     */
+    void close();
+
+    /**
+     * @brief Record the original value of a node, a slot is allocated if the node has none.
+     * @details Nodes which already have a slot retain their recorded original value.
+     */
+    void recordOriginalValue(const std::string& nodePath, const std::string& value);
+
+    /**
+     * @brief Record the value currently applied on a node.
+     */
+    void recordAppliedValue(const std::string& nodePath, const std::string& value);
+
+    /**
+     * @brief Release the slot held by the node, the node will no longer be restored during recovery.
+     */
+    void eraseNode(const std::string& nodePath);
+
+    /**
+     * @brief Flush the mapping to the backing file.
+     */
+    void sync();
+
+    int32_t getRecordedNodesCount();
+
+    /**
+     * @brief Restore every node recorded in the journal file to its original value.
+     * @details Used at Server start, if the journal was left behind by an abnormal termination.
+     * @param journalPath Path of the journal file.
+     * @return int32_t:\n
+     *            - Number of nodes which were restored.
+     */
+    static int32_t recover(const std::string& journalPath);
+
+    static std::shared_ptr<NodeJournal> getInstance() {
+        if(mNodeJournalInstance == nullptr) {
+            instanceProtectionLock.lock();
+            if(mNodeJournalInstance == nullptr) {
+                try {
+                    mNodeJournalInstance = std::shared_ptr<NodeJournal> (new NodeJournal());
+                } catch(const std::bad_alloc& e) {
+                    instanceProtectionLock.unlock();
+                    return nullptr;
+                }
+            }
+            instanceProtectionLock.unlock();
+        }
+        return mNodeJournalInstance;
+    }
+};
+
+#endif
+
+/*! @} */
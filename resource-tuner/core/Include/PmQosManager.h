@@ -0,0 +1,101 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+/*!
+ * \file  PmQosManager.h
+ */
+
+/*!
+ * \ingroup  PM_QOS_MANAGER
+ * \defgroup PM_QOS_MANAGER PM QoS Manager
+ * \details The Kernel holds a PM QoS constraint (for example /dev/cpu_dma_latency) only for as
+ *          long as the fd through which it was requested remains open, the constraint is dropped
+ *          as soon as the fd is closed. Hence the node cannot be handled like a regular sysfs node.\n\n
+ *          1) When a value is first applied, the node is opened and the fd is retained.\n\n
+ *          2) Subsequent winner changes overwrite the value in place, over the same fd.\n\n
+ *          3) On tear, the fd is closed, which releases the constraint.\n\n
+ *
+ * @{
+ */
+
+#ifndef PM_QOS_MANAGER_H
+#define PM_QOS_MANAGER_H
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "ErrCodes.h"
+#include "Logger.h"
+
+/**
+ * @brief PmQosManager
+ * @details Holds the PM QoS request fds, for as long as a value is applied on the node.
+ */
+class PmQosManager {
+private:
+    static std::shared_ptr<PmQosManager> mPmQosManagerInstance;
+    static std::mutex instanceProtectionLock;
+
+    std::mutex mHandlesMutex;
+    std::unordered_map<std::string, int32_t> mQosHandles; //!< Node path to the open request fd.
+
+    PmQosManager();
+
+public:
+    ~PmQosManager();
+
+    /**
+     * @brief Apply (or update) the constraint on the given PM QoS node.
+     * @details The value is written as a raw 32-bit integer, which the Kernel accepts for all
+     *          PM QoS class devices. The fd is kept open until releaseQos is called.
+     * @param nodePath Path of the PM QoS node.
+     * @param value Constraint value.
+     * @return ErrCode:\n
+     *            - RC_SUCCESS: If the constraint was applied\n
+     *            - RC_FILE_NOT_FOUND: If the node could not be opened\n
+     *            - RC_INVALID_VALUE: If the value could not be written
+     */
+    ErrCode applyQos(const std::string& nodePath, int32_t value);
+
+    /**
+     * @brief Drop the constraint held on the given PM QoS node, by closing its fd.
+     * @param nodePath Path of the PM QoS node.
+     */
+    void releaseQos(const std::string& nodePath);
+
+    /**
+     * @brief Drop all the constraints currently held.
+     */
+    void releaseAll();
+
+    /**
+     * @brief Check if a constraint is currently held on the given node.
+     * @param nodePath Path of the PM QoS node.
+     * @return int8_t:\n
+     *            - 1: If an fd for the node is open\n
+     *            - 0: Otherwise
+     */
+    int8_t isQosHeld(const std::string& nodePath);
+
+    static std::shared_ptr<PmQosManager> getInstance() {
+        if(mPmQosManagerInstance == nullptr) {
+            instanceProtectionLock.lock();
+            if(mPmQosManagerInstance == nullptr) {
+                try {
+                    mPmQosManagerInstance = std::shared_ptr<PmQosManager> (new PmQosManager());
+                } catch(const std::bad_alloc& e) {
+                    instanceProtectionLock.unlock();
+                    return nullptr;
+                }
+            }
+            instanceProtectionLock.unlock();
+        }
+        return mPmQosManagerInstance;
+    }
+};
+
+#endif
+
+/*! @} */
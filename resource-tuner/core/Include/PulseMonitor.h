@@ -8,18 +8,18 @@
 /*!
  * \ingroup  PULSE_MONITOR
  * \defgroup PULSE_MONITOR Pulse Monitor
- * \details Runs as a Daemon Thread and Periodically (Every 60 seconds) checks if any of the Clients with
- *          Active or Pending Requests with the Resource Tuner Server have died or terminated.
+ * \details Runs as a Daemon Thread and detects Clients with Active or Pending Requests with the
+ *          Resource Tuner Server which have died or terminated.
  *          When such a Client is Found it is added to the Garbage Collector Queue, so that it
  *          can be cleaned up.
  *
  *          Pulse Monitor Flow:\n\n
- *          1) The Pulse Monitor, retrieves the list of Clients (i.e. clients with Outstanding Requests)
- *             from the ClientDataManager.\n\n
- *          2) Next, it checks if the /proc/<pid>/status file exists for this Process or not. If it does
- *             not exist, it indicates that the Process has been terminated.\n\n
- *          3) If it detects a Dead Client, the Pulse Monitor adds it to the Garbage Collector Queue,
- *             for further cleanup (Refer ClientGarbageCollector for more details regarding Cleanup).\n\n
+ *          1) The ClientDataManager holds a pidfd for every Client, registered with the client exit
+ *             epoll set. The Pulse Monitor waits on this set, and is woken up as soon as a Client exits.\n\n
+ *          2) The Dead Client is added to the Garbage Collector Queue, and the Garbage Collector is
+ *             triggered right away (Refer ClientGarbageCollector for more details regarding Cleanup).\n\n
+ *          3) Clients for which no pidfd could be opened (for example on Kernels without pidfd support)
+ *             are still checked Periodically (Every 60 seconds), via their /proc/<pid>/comm file.\n\n
  *
  * @{
  */
@@ -28,9 +28,10 @@
 #define PULSE_MONITOR_H
 
 #include <mutex>
-#include <dirent.h>
+#include <atomic>
+#include <thread>
+#include <sys/epoll.h>
 
-#include "Timer.h"
 #include "RequestManager.h"
 #include "CocoTable.h"
 #include "ClientDataManager.h"
@@ -38,20 +39,25 @@
 #include "UrmSettings.h"
 #include "Logger.h"
 
+#define PULSE_MONITOR_MAX_EVENTS 16
+#define PULSE_MONITOR_WAKEUP_INTERVAL_MS 1000
+
 /**
- * @brief Responsible for checking if all clients are alive after a certain time interval.
- * @details It spawns a background thread which lists all alive processes in the system and
- *          compares them with the client list. If a clientPID doesn't exist in the system,
- *          it is cleaned up.
+ * @brief Responsible for detecting clients which have terminated.
+ * @details It spawns a background thread which waits for client exits reported by the
+ *          ClientDataManager. If a clientPID no longer exists in the system, it is cleaned up.
  */
 class PulseMonitor {
 private:
     static std::shared_ptr<PulseMonitor> mPulseMonitorInstance;
-    Timer* mTimer;
+    std::thread mMonitorThread;
+    std::atomic<int8_t> mIsRunning;
     uint32_t mPulseDuration;
 
     PulseMonitor();
 
+    void monitorRoutine();
+    void submitDeadClient(int32_t clientPID);
     int8_t checkForDeadClients();
 
 public:
@@ -59,9 +65,8 @@ public:
 
     /**
      * @brief Starts the Pulse Monitor
-     * @details To start the pulse monitor a recurring timer is created by using a
-     *          thread from the Thread Pool. This Thread will wake up periodically
-     *          and check for dead clients and if found add them to the garbage collector queue.
+     * @details A dedicated thread is created, which waits on the client exit epoll set
+     *          and adds any dead clients to the garbage collector queue.
      * @return ErrCode:\n
      *            - RC_SUCCESS If the Pulse Monitor is successfully started\n
      *            - Enum Code indicating error: Otherwise.
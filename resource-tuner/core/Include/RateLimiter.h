@@ -15,7 +15,9 @@
  *          health and a reward result in an increment in health (upto 100 max).
  *          If the client health drops to a value <= 0, then the client shall be dropped, i.e. any
  *          further requests sent by the client will be dropped without any further processing.\n\n
- *          How are Punishment and Rewards Defined: RateLimiter provides a time interval “delta”, say 5 ms. If a client sends 2 requests within a time interval smaller than delta, then we punish the client. If consecutive client requests are suitably spaced out, we reward the client for good behavior.
+ *          How are Punishment and Rewards Defined: RateLimiter provides a time interval “delta”, say 5 ms. If a client sends 2 requests within a time interval smaller than delta, then we punish the client. If consecutive client requests are suitably spaced out, we reward the client for good behavior.\n\n
+ *          The health is held as a token bucket inline in the client's record (see RateBucket), and is
+ *          updated with atomics, hence rate checks for different clients never serialize on each other.
  *
  * @{
  */
@@ -24,7 +26,6 @@
 #define RATE_LIMITER_H
 
 #include <mutex>
-#include <shared_mutex>
 #include <memory>
 
 #include "RequestManager.h"
@@ -39,11 +40,10 @@ class RateLimiter {
 private:
     static std::shared_ptr<RateLimiter> mRateLimiterInstance;
     static std::mutex instanceProtectionLock;
-    std::shared_timed_mutex mRateLimiterMutex;
 
     uint32_t mDelta;
-    double mPenaltyFactor;
-    double mRewardFactor;
+    int64_t mPenaltyTokens;
+    int64_t mRewardTokens;
     int8_t shouldBeProcessed(int32_t clientPID);
 
     RateLimiter();
@@ -4,8 +4,10 @@
 #ifndef REQUEST_MANAGER_H
 #define REQUEST_MANAGER_H
 
+#include <atomic>
 #include <unordered_set>
 #include <unordered_map>
+#include <shared_mutex>
 #include <memory>
 
 #include "Request.h"
@@ -14,10 +16,22 @@
 
 typedef std::pair<Request*, int8_t> RequestInfo;
 
-enum RequestListType {
-    ACTIVE_TUNE = 0,
-    PENDING_TUNE,
-};
+// Fingerprints of a client's active Requests, mapped to the Request handles.
+typedef std::unordered_multimap<uint64_t, int64_t> FingerprintIndex;
+
+#define REQUEST_TABLE_STRIPE_COUNT 16
+
+// One stripe of the active Requests table, Requests are assigned to stripes by handle.
+typedef struct {
+    alignas(64) std::shared_timed_mutex mMutex;
+    std::unordered_map<int64_t, RequestInfo> mRequests;
+} RequestStripe;
+
+// One stripe of the fingerprint index, clients are assigned to stripes by TID.
+typedef struct {
+    alignas(64) std::shared_timed_mutex mMutex;
+    std::unordered_map<int32_t, FingerprintIndex> mClients;
+} FingerprintStripe;
 
 enum RequestProcessingStatus : int8_t {
     REQ_UNCHANGED = 0x01,
@@ -45,23 +59,34 @@ public:
  *          submitted to the Resource Tuner Server. Additionally it is responsible for performing
  *          Request Duplication Check, which aims to improve System efficiency by reducing
  *          wasteful duplicate processing.
+ *          The active Requests are split across lock stripes, hence admissions and completions
+ *          of different Requests do not contend with each other.
  */
 class RequestManager {
 private:
     static std::shared_ptr<RequestManager> mReqeustManagerInstance;
     static std::mutex instanceProtectionLock;
 
-    int64_t mTotalRequestServed;
-    std::unordered_set<Request*> mRequestsList[2];
-    std::unordered_map<int64_t, RequestInfo> mActiveRequests;
+    std::atomic<int64_t> mTotalRequestServed;
+    std::atomic<int64_t> mActiveRequestsCount;
+    RequestStripe mActiveRequests[REQUEST_TABLE_STRIPE_COUNT];
+    FingerprintStripe mClientFingerprints[REQUEST_TABLE_STRIPE_COUNT];
+
+    // Accessed with the stripe lock of the handle held, so that an Untune can't slip
+    // in between the lookup and the insertion of the corresponding Tune.
     HandleCache mUntuneCache;
-    std::shared_timed_mutex mRequestMapMutex;
+    std::mutex mUntuneCacheMutex;
 
     RequestManager();
 
+    RequestStripe& getStripe(int64_t handle);
+    FingerprintStripe& getFingerprintStripe(int32_t clientTID);
+
     int8_t checkOwnership(Request* request, Request* targetRequest);
     int8_t isSane(Request* request);
     int8_t requestMatch(Request* request);
+    void indexRequest(Request* request);
+    void unindexRequest(Request* request);
 
 public:
     ~RequestManager();
@@ -130,20 +155,6 @@ public:
 
     int8_t getRequestProcessingStatus(int64_t handle);
 
-    std::vector<Request*> getPendingList();
-
-    /**
-     * @brief Handles Device Mode transition from RESUME to SUSPEND
-     * @details As part of this routine, the CocoTable will be drained out, i.e. all active
-     *          Requests will be untuned, and the Resources restored to their original values.
-     *          Requests which are not eligible for background processing will be removed from the
-     *          Active List and put into the Pending List, so that they get processed again when the
-     *          Device transitions back to the RESUME mode.
-     *
-     */
-    void moveToPendingList();
-
-    void clearPending();
 
     static std::shared_ptr<RequestManager> getInstance() {
         if(mReqeustManagerInstance == nullptr) {
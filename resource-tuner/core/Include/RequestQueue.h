@@ -4,6 +4,9 @@
 #ifndef REQUEST_QUEUE_H
 #define REQUEST_QUEUE_H
 
+#include <mutex>
+#include <vector>
+
 #include "UrmPlatformAL.h"
 #include "Utils.h"
 #include "Request.h"
@@ -20,13 +23,39 @@ private:
     static std::shared_ptr<RequestQueue> mRequestQueueInstance;
     static std::mutex instanceProtectionLock;
 
+    std::mutex mCleanupHandlesMutex;
+    std::vector<int64_t> mCleanupHandles; //!< Requests of dead clients, awaiting the consumer.
+
     RequestQueue();
 
+    void processClientCleanup();
+
 public:
     ~RequestQueue();
 
     void orderedQueueConsumerHook();
 
+    /**
+     * @brief Queue a device mode transition, to be applied to the CocoTable by the consumer.
+     * @details The transition is placed ahead of the Requests waiting in the queue.
+     * @param mode The device mode being entered, MODE_SUSPEND or MODE_RESUME.
+     * @return int8_t:\n
+     *            - 1: If the transition was queued\n
+     *            - 0: Otherwise
+     */
+    int8_t postModeTransition(int8_t mode);
+
+    /**
+     * @brief Queue the Requests of dead clients for removal, to be performed by the consumer.
+     * @details The Requests are removed from the CocoTable as a single batch, ahead of the
+     *          Requests waiting in the queue.
+     * @param handles Handles of the Requests to be removed.
+     * @return int8_t:\n
+     *            - 1: If the cleanup was queued\n
+     *            - 0: Otherwise
+     */
+    int8_t postClientCleanup(const std::vector<int64_t>& handles);
+
     static std::shared_ptr<RequestQueue> getInstance() {
         if(mRequestQueueInstance == nullptr) {
             instanceProtectionLock.lock();
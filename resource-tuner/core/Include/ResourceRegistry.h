@@ -4,6 +4,7 @@
 #ifndef RESOURCE_REGISTRY_H
 #define RESOURCE_REGISTRY_H
 
+#include <mutex>
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -90,6 +91,11 @@ typedef struct {
      *        the BU via the Extension Interface.
      */
     ResourceLifecycleCallback mResourceTearCallback;
+    /**
+     * @brief Set if the Resource Path is shared with some other Resource, writes to such
+     *        nodes are arbitrated at the node-level via the NodeArbiter.
+     */
+    int8_t mSharesNode;
 } ResConfInfo;
 
 /**
@@ -105,12 +111,12 @@ private:
     std::vector<ResConfInfo*> mResourceConfigs;
     std::unordered_map<uint32_t, int32_t> mSystemIndependentLayerMappings;
     std::unordered_map<std::string, std::string> mDefaultValueStore;
+    std::mutex mDefaultValueStoreMutex;
 
     ResourceRegistry();
 
     int8_t isResourceConfigMalformed(ResConfInfo* resourceConfigInfo);
     void setLifeCycleCallbacks(ResConfInfo* resourceConfigInfo);
-    void fetchAndStoreDefaults(ResConfInfo* resourceConfigInfo);
 
 public:
     ~ResourceRegistry();
@@ -138,6 +144,15 @@ public:
     int32_t getTotalResourcesCount();
     std::string getDefaultValue(const std::string& fileName);
 
+    /**
+     * @brief Record the current value of the node as its default, if not already recorded.
+     * @details Default values are captured lazily, i.e. on the first tune of each node rather
+     *          than for every node expansion at Resource registration, hence this must be
+     *          called before the first write to the node is issued.
+     * @param filePath Path of the Resource Node.
+     */
+    void captureDefaultValue(const std::string& filePath);
+
     void addDefaultValue(const std::string& key, const std::string& value);
     void deleteDefaultValue(const std::string& filePath);
     void restoreResourcesToDefaultValues();
@@ -146,6 +161,14 @@ public:
     // Merge the Changes provided by the BU with the existing ResourceTable.
     void pluginModifications();
 
+    /**
+     * @brief Flag the Resources whose Path is shared with some other registered Resource.
+     * @details Must be called once all the Resources (including the BU specified ones) are registered.
+     * @return int32_t:\n
+     *            - Number of Resources which share their node with another Resource.
+     */
+    int32_t identifySharedNodes();
+
     static std::shared_ptr<ResourceRegistry> getInstance() {
         if(resourceRegistryInstance == nullptr) {
             resourceRegistryInstance = std::shared_ptr<ResourceRegistry>(new ResourceRegistry());
@@ -31,6 +31,23 @@ void submitResProvisionReqMsg(void* request);
 
 void submitResProvisionRequest(Request* request, int8_t isVerified);
 
+/**
+ * @brief Same as submitResProvisionRequest, additionally reporting the outcome.
+ * @return int8_t:\n
+ *            - 1: If the Request was accepted for processing\n
+ *            - 0: If it was rejected (and freed)
+ */
+int8_t admitResProvisionRequest(Request* request, int8_t isVerified);
+
+/**
+ * @brief Same as submitResProvisionReqMsg, additionally reporting the outcome.
+ * @details The buffer is freed in either case.
+ * @return int8_t:\n
+ *            - 1: If the Request was accepted for processing\n
+ *            - 0: If it was rejected
+ */
+int8_t admitResProvisionReqMsg(void* request);
+
 /**
  * @brief Gets a property from the Config Store.
  * @details Note: This API is meant to be used internally, i.e. by other Resource Tuner modules like Signals
@@ -0,0 +1,144 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+/*!
+ * \file  SysfsWriter.h
+ */
+
+/*!
+ * \ingroup  SYSFS_WRITER
+ * \defgroup SYSFS_WRITER Sysfs Writer
+ * \details Decouples the decision of which value a Resource Node should hold (taken by the
+ *          CocoTable) from the actual write to the Kernel. Certain cgroup and devfreq writes
+ *          can block for milliseconds, and if performed inline they stall every Request waiting
+ *          in the RequestQueue.
+ *
+ *          Writer Flow:\n\n
+ *          1) The Resource Appliers / Tear Callbacks post a (node, value) intent to the Writer.\n\n
+ *          2) Intents are held in a per-node mailbox, if an intent for the same node is already
+ *             pending, its value is simply overwritten (last writer wins). Hence intermediate values
+ *             which have already been superseded never reach the Kernel.\n\n
+ *          3) A dedicated Writer thread drains the mailbox, nodes are written in the order in which
+ *             they were first posted, and writes to a given node always complete in posting order.\n\n
+ *
+ *          If the Writer thread has not been started (for example in tests or before Server Init),
+ *          intents are written synchronously by the posting thread.
+ *
+ * @{
+ */
+
+#ifndef SYSFS_WRITER_H
+#define SYSFS_WRITER_H
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "ErrCodes.h"
+#include "Logger.h"
+
+/**
+ * @brief SysfsWriter
+ * @details Asynchronous, coalescing write stage for Resource Nodes.
+ */
+class SysfsWriter {
+private:
+    static std::shared_ptr<SysfsWriter> mSysfsWriterInstance;
+    static std::mutex instanceProtectionLock;
+
+    std::unordered_map<std::string, std::string> mMailbox; //!< Node path to latest posted value.
+    std::deque<std::string> mPendingNodes; //!< Nodes with a pending intent, in first-posted order.
+
+    std::thread mWriterThread;
+    std::mutex mWriterMutex;
+    std::condition_variable mWriterCond; //!< Signalled when new intents are posted.
+    std::condition_variable mDrainCond; //!< Signalled when the mailbox has been fully drained.
+
+    int8_t mIsRunning;
+    int8_t mWriterBusy;
+
+    std::atomic<uint64_t> mPostedCount;
+    std::atomic<uint64_t> mSupersededCount;
+    std::atomic<uint64_t> mWrittenCount;
+
+    SysfsWriter();
+
+    void writerRoutine();
+
+public:
+    ~SysfsWriter();
+
+    /**
+     * @brief Write the given value to the node immediately, on the calling thread.
+     * @param nodePath Path of the Resource Node.
+     * @param value Value to be written.
+     * @return int8_t:\n
+     *            - 1: If the value was successfully written\n
+     *            - 0: Otherwise
+     */
+    static int8_t writeNode(const std::string& nodePath, const std::string& value);
+
+    /**
+     * @brief Spawn the Writer thread, after this call intents are applied asynchronously.
+     * @return ErrCode:\n
+     *            - RC_SUCCESS: If the Writer thread was started\n
+     *            - RC_MODULE_INIT_FAILURE: Otherwise
+     */
+    ErrCode start();
+
+    /**
+     * @brief Drain all the pending intents and terminate the Writer thread.
+     */
+    void stop();
+
+    /**
+     * @brief Post a write intent for a Resource Node.
+     * @details If an intent for the same node is still pending, it will be replaced by this one.
+     * @param nodePath Path of the Resource Node.
+     * @param value Value to be written.
+     */
+    void post(const std::string& nodePath, const std::string& value);
+
+    /**
+     * @brief Block until all the intents posted before this call have been written.
+     */
+    void flush();
+
+    /**
+     * @brief Check if an intent for the given node is still waiting to be written.
+     * @param nodePath Path of the Resource Node.
+     * @return int8_t:\n
+     *            - 1: If an intent is pending\n
+     *            - 0: Otherwise
+     */
+    int8_t isPending(const std::string& nodePath);
+
+    uint64_t getPostedCount();
+    uint64_t getSupersededCount();
+    uint64_t getWrittenCount();
+
+    static std::shared_ptr<SysfsWriter> getInstance() {
+        if(mSysfsWriterInstance == nullptr) {
+            instanceProtectionLock.lock();
+            if(mSysfsWriterInstance == nullptr) {
+                try {
+                    mSysfsWriterInstance = std::shared_ptr<SysfsWriter> (new SysfsWriter());
+                } catch(const std::bad_alloc& e) {
+                    instanceProtectionLock.unlock();
+                    return nullptr;
+                }
+            }
+            instanceProtectionLock.unlock();
+        }
+        return mSysfsWriterInstance;
+    }
+};
+
+#endif
+
+/*! @} */
@@ -0,0 +1,117 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <cstdlib>
+
+#include "NodeArbiter.h"
+
+std::shared_ptr<NodeArbiter> NodeArbiter::mNodeArbiterInstance = nullptr;
+std::mutex NodeArbiter::instanceProtectionLock {};
+
+NodeArbiter::NodeArbiter() {}
+
+size_t NodeArbiter::pickWinner(SharedNodeInfo& nodeInfo) {
+    if(nodeInfo.mClaims.empty()) return 0;
+
+    switch(nodeInfo.mPolicy) {
+        case HIGHER_BETTER:
+        case LOWER_BETTER: {
+            size_t winnerIndex = 0;
+            int64_t winnerValue = strtoll(nodeInfo.mClaims[0].second.c_str(), nullptr, 10);
+
+            for(size_t i = 1; i < nodeInfo.mClaims.size(); i++) {
+                int64_t curValue = strtoll(nodeInfo.mClaims[i].second.c_str(), nullptr, 10);
+                if((nodeInfo.mPolicy == HIGHER_BETTER && curValue > winnerValue) ||
+                   (nodeInfo.mPolicy == LOWER_BETTER && curValue < winnerValue)) {
+                    winnerIndex = i;
+                    winnerValue = curValue;
+                }
+            }
+            return winnerIndex;
+        }
+        case LAZY_APPLY:
+            // First come, first served
+            return 0;
+        default:
+            // The most recent claim wins
+            return nodeInfo.mClaims.size() - 1;
+    }
+}
+
+int8_t NodeArbiter::claim(const std::string& nodePath, uint32_t resCode,
+                          const std::string& value, enum Policy policy,
+                          std::string& winner, uint32_t& winnerResCode) {
+    const std::lock_guard<std::mutex> lock(this->mArbiterMutex);
+
+    SharedNodeInfo& nodeInfo = this->mSharedNodes[nodePath];
+    nodeInfo.mPolicy = policy;
+
+    int8_t claimFound = false;
+    for(size_t i = 0; i < nodeInfo.mClaims.size(); i++) {
+        if(nodeInfo.mClaims[i].first == resCode) {
+            if(policy == INSTANT_APPLY) {
+                // Re-claims count as the latest claim
+                nodeInfo.mClaims.erase(nodeInfo.mClaims.begin() + i);
+            } else {
+                nodeInfo.mClaims[i].second = value;
+                claimFound = true;
+            }
+            break;
+        }
+    }
+
+    if(!claimFound) {
+        nodeInfo.mClaims.push_back({resCode, value});
+    }
+
+    std::pair<uint32_t, std::string>& newWinner = nodeInfo.mClaims[this->pickWinner(nodeInfo)];
+    if(nodeInfo.mClaims.size() > 1 && newWinner.second == nodeInfo.mAppliedValue) {
+        return false;
+    }
+
+    nodeInfo.mAppliedValue = newWinner.second;
+    winner = newWinner.second;
+    winnerResCode = newWinner.first;
+    return true;
+}
+
+int8_t NodeArbiter::release(const std::string& nodePath, uint32_t resCode,
+                            std::string& winner, uint32_t& winnerResCode) {
+    const std::lock_guard<std::mutex> lock(this->mArbiterMutex);
+
+    auto it = this->mSharedNodes.find(nodePath);
+    if(it == this->mSharedNodes.end()) {
+        return false;
+    }
+
+    SharedNodeInfo& nodeInfo = it->second;
+    for(size_t i = 0; i < nodeInfo.mClaims.size(); i++) {
+        if(nodeInfo.mClaims[i].first == resCode) {
+            nodeInfo.mClaims.erase(nodeInfo.mClaims.begin() + i);
+            break;
+        }
+    }
+
+    if(nodeInfo.mClaims.empty()) {
+        this->mSharedNodes.erase(it);
+        return false;
+    }
+
+    std::pair<uint32_t, std::string>& newWinner = nodeInfo.mClaims[this->pickWinner(nodeInfo)];
+    nodeInfo.mAppliedValue = newWinner.second;
+    winner = newWinner.second;
+    winnerResCode = newWinner.first;
+    return true;
+}
+
+int32_t NodeArbiter::getClaimsCount(const std::string& nodePath) {
+    const std::lock_guard<std::mutex> lock(this->mArbiterMutex);
+
+    auto it = this->mSharedNodes.find(nodePath);
+    if(it == this->mSharedNodes.end()) {
+        return 0;
+    }
+    return it->second.mClaims.size();
+}
+
+NodeArbiter::~NodeArbiter() {}
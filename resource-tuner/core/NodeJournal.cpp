@@ -0,0 +1,216 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <cerrno>
+
+#include "NodeJournal.h"
+#include "SysfsWriter.h"
+
+std::shared_ptr<NodeJournal> NodeJournal::mNodeJournalInstance = nullptr;
+std::mutex NodeJournal::instanceProtectionLock {};
+
+static void copyBounded(char* dest, const std::string& src, size_t capacity) {
+    size_t length = std::min(src.length(), capacity - 1);
+    std::memcpy(dest, src.c_str(), length);
+    dest[length] = '\0';
+}
+
+NodeJournal::NodeJournal() {
+    this->mJournal = nullptr;
+    this->mJournalFd = -1;
+    this->mNextFreeSlot = 0;
+}
+
+ErrCode NodeJournal::open(const std::string& journalPath) {
+    const std::lock_guard<std::mutex> lock(this->mJournalMutex);
+    if(this->mJournal != nullptr) {
+        return RC_SUCCESS;
+    }
+
+    // Create the parent directory, if it does not exist yet
+    size_t dirEnd = journalPath.find_last_of('/');
+    if(dirEnd != std::string::npos && dirEnd > 0) {
+        mkdir(journalPath.substr(0, dirEnd).c_str(), 0755);
+    }
+
+    int32_t fd = ::open(journalPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        TYPELOGV(ERRNO_LOG, "open", strerror(errno));
+        return RC_FILE_NOT_FOUND;
+    }
+
+    if(ftruncate(fd, sizeof(JournalLayout)) < 0) {
+        TYPELOGV(ERRNO_LOG, "ftruncate", strerror(errno));
+        ::close(fd);
+        return RC_FILE_NOT_FOUND;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(JournalLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(mapping == MAP_FAILED) {
+        TYPELOGV(ERRNO_LOG, "mmap", strerror(errno));
+        ::close(fd);
+        return RC_FILE_NOT_FOUND;
+    }
+
+    // The file was just truncated, hence all the slots are zeroed (free).
+    this->mJournal = static_cast<JournalLayout*>(mapping);
+    this->mJournalFd = fd;
+    this->mNextFreeSlot = 0;
+    this->mSlotIndex.clear();
+
+    this->mJournal->mHeader.mVersion = JOURNAL_VERSION;
+    this->mJournal->mHeader.mSlotCount = JOURNAL_SLOT_COUNT;
+    __atomic_store_n(&this->mJournal->mHeader.mMagic, JOURNAL_MAGIC, __ATOMIC_RELEASE);
+
+    return RC_SUCCESS;
+}
+
+void NodeJournal::close() {
+    const std::lock_guard<std::mutex> lock(this->mJournalMutex);
+    if(this->mJournal == nullptr) {
+        return;
+    }
+
+    munmap(this->mJournal, sizeof(JournalLayout));
+    ::close(this->mJournalFd);
+
+    this->mJournal = nullptr;
+    this->mJournalFd = -1;
+    this->mSlotIndex.clear();
+}
+
+void NodeJournal::recordOriginalValue(const std::string& nodePath, const std::string& value) {
+    const std::lock_guard<std::mutex> lock(this->mJournalMutex);
+    if(this->mJournal == nullptr) return;
+
+    if(this->mSlotIndex.find(nodePath) != this->mSlotIndex.end()) {
+        return;
+    }
+
+    if(nodePath.length() >= JOURNAL_PATH_LENGTH || value.length() >= JOURNAL_VALUE_LENGTH) {
+        LOGW("RESTUNE_NODE_JOURNAL", "Node: " + nodePath + " cannot be journaled");
+        return;
+    }
+
+    int32_t slotIndex = this->mNextFreeSlot;
+    while(slotIndex < JOURNAL_SLOT_COUNT && this->mJournal->mSlots[slotIndex].mInUse) {
+        slotIndex++;
+    }
+
+    if(slotIndex >= JOURNAL_SLOT_COUNT) {
+        LOGW("RESTUNE_NODE_JOURNAL", "Journal full, Node: " + nodePath + " will not be journaled");
+        return;
+    }
+
+    JournalSlot& slot = this->mJournal->mSlots[slotIndex];
+    copyBounded(slot.mNodePath, nodePath, JOURNAL_PATH_LENGTH);
+    copyBounded(slot.mOriginalValue, value, JOURNAL_VALUE_LENGTH);
+    copyBounded(slot.mAppliedValue, value, JOURNAL_VALUE_LENGTH);
+
+    // Commit the slot
+    __atomic_store_n(&slot.mInUse, 1, __ATOMIC_RELEASE);
+
+    this->mSlotIndex[nodePath] = slotIndex;
+    this->mNextFreeSlot = slotIndex + 1;
+}
+
+void NodeJournal::recordAppliedValue(const std::string& nodePath, const std::string& value) {
+    const std::lock_guard<std::mutex> lock(this->mJournalMutex);
+    if(this->mJournal == nullptr) return;
+
+    auto it = this->mSlotIndex.find(nodePath);
+    if(it == this->mSlotIndex.end()) {
+        return;
+    }
+
+    copyBounded(this->mJournal->mSlots[it->second].mAppliedValue, value, JOURNAL_VALUE_LENGTH);
+}
+
+void NodeJournal::eraseNode(const std::string& nodePath) {
+    const std::lock_guard<std::mutex> lock(this->mJournalMutex);
+    if(this->mJournal == nullptr) return;
+
+    auto it = this->mSlotIndex.find(nodePath);
+    if(it == this->mSlotIndex.end()) {
+        return;
+    }
+
+    __atomic_store_n(&this->mJournal->mSlots[it->second].mInUse, 0, __ATOMIC_RELEASE);
+    this->mNextFreeSlot = std::min(this->mNextFreeSlot, it->second);
+    this->mSlotIndex.erase(it);
+}
+
+void NodeJournal::sync() {
+    const std::lock_guard<std::mutex> lock(this->mJournalMutex);
+    if(this->mJournal == nullptr) return;
+
+    if(msync(this->mJournal, sizeof(JournalLayout), MS_ASYNC) < 0) {
+        TYPELOGV(ERRNO_LOG, "msync", strerror(errno));
+    }
+}
+
+int32_t NodeJournal::getRecordedNodesCount() {
+    const std::lock_guard<std::mutex> lock(this->mJournalMutex);
+    return this->mSlotIndex.size();
+}
+
+int32_t NodeJournal::recover(const std::string& journalPath) {
+    int32_t fd = ::open(journalPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return 0;
+    }
+
+    struct stat journalStat;
+    if(fstat(fd, &journalStat) < 0 || (size_t)journalStat.st_size != sizeof(JournalLayout)) {
+        LOGW("RESTUNE_NODE_JOURNAL", "Discarding malformed journal: " + journalPath);
+        ::close(fd);
+        return 0;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(JournalLayout), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED) {
+        TYPELOGV(ERRNO_LOG, "mmap", strerror(errno));
+        return 0;
+    }
+
+    const JournalLayout* journal = static_cast<const JournalLayout*>(mapping);
+    int32_t restoredCount = 0;
+
+    if(journal->mHeader.mMagic == JOURNAL_MAGIC &&
+       journal->mHeader.mVersion == JOURNAL_VERSION &&
+       journal->mHeader.mSlotCount == JOURNAL_SLOT_COUNT) {
+
+        for(int32_t i = 0; i < JOURNAL_SLOT_COUNT; i++) {
+            const JournalSlot& slot = journal->mSlots[i];
+            if(!slot.mInUse) continue;
+
+            std::string nodePath(slot.mNodePath, strnlen(slot.mNodePath, JOURNAL_PATH_LENGTH));
+            std::string originalValue(slot.mOriginalValue,
+                                      strnlen(slot.mOriginalValue, JOURNAL_VALUE_LENGTH));
+
+            LOGI("RESTUNE_NODE_JOURNAL",
+                 "Restoring Node: " + nodePath + " from: " +
+                 std::string(slot.mAppliedValue, strnlen(slot.mAppliedValue, JOURNAL_VALUE_LENGTH)) +
+                 " to: " + originalValue);
+
+            if(SysfsWriter::writeNode(nodePath, originalValue)) {
+                restoredCount++;
+            }
+        }
+    } else {
+        LOGW("RESTUNE_NODE_JOURNAL", "Discarding malformed journal: " + journalPath);
+    }
+
+    munmap(mapping, sizeof(JournalLayout));
+    return restoredCount;
+}
+
+NodeJournal::~NodeJournal() {
+    this->close();
+}
@@ -0,0 +1,79 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+#include "PmQosManager.h"
+
+std::shared_ptr<PmQosManager> PmQosManager::mPmQosManagerInstance = nullptr;
+std::mutex PmQosManager::instanceProtectionLock {};
+
+PmQosManager::PmQosManager() {}
+
+ErrCode PmQosManager::applyQos(const std::string& nodePath, int32_t value) {
+    if(nodePath.length() == 0) return RC_BAD_ARG;
+    const std::lock_guard<std::mutex> lock(this->mHandlesMutex);
+
+    int32_t fd = -1;
+    auto it = this->mQosHandles.find(nodePath);
+    if(it != this->mQosHandles.end()) {
+        fd = it->second;
+    } else {
+        fd = open(nodePath.c_str(), O_RDWR | O_CLOEXEC);
+        if(fd < 0) {
+            TYPELOGV(ERRNO_LOG, "open", strerror(errno));
+            return RC_FILE_NOT_FOUND;
+        }
+        this->mQosHandles[nodePath] = fd;
+    }
+
+    // Overwrite the request in place, the PM QoS devices ignore the offset,
+    // rewinding keeps the behaviour consistent for regular files as well.
+    lseek(fd, 0, SEEK_SET);
+
+    ssize_t bytesWritten = 0;
+    do {
+        bytesWritten = write(fd, &value, sizeof(value));
+    } while(bytesWritten < 0 && errno == EINTR);
+
+    if(bytesWritten != sizeof(value)) {
+        TYPELOGV(ERRNO_LOG, "write", strerror(errno));
+        return RC_INVALID_VALUE;
+    }
+
+    return RC_SUCCESS;
+}
+
+void PmQosManager::releaseQos(const std::string& nodePath) {
+    const std::lock_guard<std::mutex> lock(this->mHandlesMutex);
+
+    auto it = this->mQosHandles.find(nodePath);
+    if(it == this->mQosHandles.end()) {
+        return;
+    }
+
+    // Closing the fd removes the constraint
+    close(it->second);
+    this->mQosHandles.erase(it);
+}
+
+void PmQosManager::releaseAll() {
+    const std::lock_guard<std::mutex> lock(this->mHandlesMutex);
+
+    for(std::pair<const std::string, int32_t>& entry: this->mQosHandles) {
+        close(entry.second);
+    }
+    this->mQosHandles.clear();
+}
+
+int8_t PmQosManager::isQosHeld(const std::string& nodePath) {
+    const std::lock_guard<std::mutex> lock(this->mHandlesMutex);
+    return this->mQosHandles.find(nodePath) != this->mQosHandles.end();
+}
+
+PmQosManager::~PmQosManager() {
+    this->releaseAll();
+}
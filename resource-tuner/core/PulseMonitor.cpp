@@ -1,48 +1,90 @@
 // Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
 // SPDX-License-Identifier: BSD-3-Clause-Clear
 
+#include <cerrno>
+#include <cstring>
+
 #include "PulseMonitor.h"
 
 std::shared_ptr<PulseMonitor> PulseMonitor::mPulseMonitorInstance = nullptr;
 
 PulseMonitor::PulseMonitor() {
-    this->mTimer = nullptr;
+    this->mIsRunning.store(false);
     this->mPulseDuration = UrmSettings::metaConfigs.mPulseDuration;
 }
 
-// Check for optimizations
+void PulseMonitor::submitDeadClient(int32_t clientPID) {
+    LOGD("RESTUNE_PULSE_MONITOR", "Client with PID: " + std::to_string(clientPID) + " is dead.");
+    ClientGarbageCollector::getInstance()->submitClientThreadsForCleanup(clientPID);
+    ClientDataManager::getInstance()->deleteClientPID(clientPID);
+}
+
+// Fallback for the clients which could not be watched via a pidfd.
 int8_t PulseMonitor::checkForDeadClients() {
-    // stores pid of all the running process right now
     std::vector<int32_t> clientList;
+    ClientDataManager::getInstance()->getUnwatchedClientList(clientList);
 
-    // This method will internally acquire a shared lock on the table.
-    ClientDataManager::getInstance()->getActiveClientList(clientList);
-
-    // Delete the clients if they are dead.
+    int8_t deadClientFound = false;
     for(int32_t pid: clientList) {
         if(!AuxRoutines::fileExists(COMM(pid))) {
-        // Client is dead, Schedule it for deletion.
-            LOGD("RESTUNE_PULSE_MONITOR", "Client with PID: " + std::to_string(pid) + " is dead.");
-            ClientGarbageCollector::getInstance()->submitClientThreadsForCleanup(pid);
-            ClientDataManager::getInstance()->deleteClientPID(pid);
+            // Client is dead, Schedule it for deletion.
+            this->submitDeadClient(pid);
+            deadClientFound = true;
         }
     }
 
-    return 0;
+    return deadClientFound;
 }
 
-ErrCode PulseMonitor::startPulseMonitorDaemon() {
-    try {
-        this->mTimer = MPLACEV(Timer, std::bind(&PulseMonitor::checkForDeadClients, this), true);
+void PulseMonitor::monitorRoutine() {
+    int32_t clientExitFd = ClientDataManager::getInstance()->getClientExitFd();
+    int64_t lastPulseMillis = AuxRoutines::getCurrentTimeInMilliseconds();
+
+    epoll_event events[PULSE_MONITOR_MAX_EVENTS];
+    while(this->mIsRunning.load()) {
+        int32_t readyFdCount = 0;
+        if(clientExitFd >= 0) {
+            readyFdCount = epoll_wait(clientExitFd, events, PULSE_MONITOR_MAX_EVENTS,
+                                      PULSE_MONITOR_WAKEUP_INTERVAL_MS);
+            if(readyFdCount < 0 && errno != EINTR) {
+                TYPELOGV(ERRNO_LOG, "epoll_wait", strerror(errno));
+                std::this_thread::sleep_for(std::chrono::milliseconds(PULSE_MONITOR_WAKEUP_INTERVAL_MS));
+            }
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(PULSE_MONITOR_WAKEUP_INTERVAL_MS));
+        }
 
-    } catch(const std::bad_alloc& e) {
-        return RC_MEMORY_ALLOCATION_FAILURE;
+        int8_t deadClientFound = false;
+        for(int32_t i = 0; i < readyFdCount; i++) {
+            this->submitDeadClient((int32_t)events[i].data.u64);
+            deadClientFound = true;
+        }
 
-    } catch(const std::exception& e) {
-        return RC_MEMORY_ALLOCATION_FAILURE;
+        int64_t currentMillis = AuxRoutines::getCurrentTimeInMilliseconds();
+        if(currentMillis - lastPulseMillis >= this->mPulseDuration) {
+            lastPulseMillis = currentMillis;
+            deadClientFound = this->checkForDeadClients() || deadClientFound;
+        }
+
+        // Release the dead clients' Resources right away, instead of on the next collection.
+        if(deadClientFound) {
+            ClientGarbageCollector::getInstance()->triggerCleanup();
+        }
+    }
+}
+
+ErrCode PulseMonitor::startPulseMonitorDaemon() {
+    if(this->mIsRunning.load()) {
+        return RC_SUCCESS;
     }
 
-    if(!this->mTimer->startTimer(this->mPulseDuration)) {
+    try {
+        this->mIsRunning.store(true);
+        this->mMonitorThread = std::thread(&PulseMonitor::monitorRoutine, this);
+
+    } catch(const std::system_error& e) {
+        this->mIsRunning.store(false);
+        TYPELOGV(SYSTEM_THREAD_CREATION_FAILURE, "pulse-monitor", e.what());
         return RC_WORKER_THREAD_ASSIGNMENT_FAILURE;
     }
 
@@ -51,16 +93,19 @@ ErrCode PulseMonitor::startPulseMonitorDaemon() {
 }
 
 void PulseMonitor::stopPulseMonitorDaemon() {
-    if(this->mTimer != nullptr) {
-        this->mTimer->killTimer();
+    if(!this->mIsRunning.exchange(false)) {
+        return;
+    }
+
+    if(this->mMonitorThread.joinable()) {
+        this->mMonitorThread.join();
+    } else {
+        TYPELOGV(SYSTEM_THREAD_NOT_JOINABLE, "pulse-monitor");
     }
 }
 
 PulseMonitor::~PulseMonitor() {
-    if(this->mTimer != nullptr) {
-        FreeBlock<Timer>(this->mTimer);
-        this->mTimer = nullptr;
-    }
+    this->stopPulseMonitorDaemon();
 }
 
 ErrCode startPulseMonitorDaemon() {
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause-Clear
 
 #include "RestuneInternal.h"
+#include "RequestReceiver.h"
 
 static int8_t getRequestPriority(int8_t clientPermissions, int8_t reqSpecifiedPriority) {
     if(clientPermissions == PERMISSION_SYSTEM) {
@@ -139,7 +140,8 @@ static int8_t VerifyIncomingRequest(Request* req) {
     int8_t clientPermissions =
         ClientDataManager::getInstance()->getClientLevelByClientID(req->getClientPID());
     // If the client permissions could not be determined, reject this request.
-    // This could happen if the /proc/<pid>/status file for the Process could not be opened.
+    // This could happen if the client's credentials were not available to the Listener,
+    // and the /proc/<pid>/status file for the Process could not be opened either.
     if(clientPermissions == -1) {
         TYPELOGV(VERIFIER_INVALID_PERMISSION, req->getClientPID(), req->getClientTID());
         return false;
@@ -230,7 +232,8 @@ static int8_t addToRequestManager(Request* request) {
     return false;
 }
 
-static void processIncomingRequest(Request* request, int8_t isValidated=false) {
+// Returns true if the Request was accepted for processing, else it is freed.
+static int8_t processIncomingRequest(Request* request, int8_t isValidated=false) {
     std::shared_ptr<ClientDataManager> clientDataManager = ClientDataManager::getInstance();
     std::shared_ptr<RateLimiter> rateLimiter = RateLimiter::getInstance();
     std::shared_ptr<RequestManager> requestManager = RequestManager::getInstance();
@@ -246,18 +249,20 @@ static void processIncomingRequest(Request* request, int8_t isValidated=false) {
             TYPELOGV(RATE_LIMITER_GLOBAL_RATE_LIMIT_HIT, request->getHandle());
             // Free the Request Memory Block
             Request::cleanUpRequest(request);
-            return;
+            return false;
         }
 
         // Client Checks
         if(!clientDataManager->clientExists(request->getClientPID(), request->getClientTID())) {
-            if(!clientDataManager->createNewClient(request->getClientPID(), request->getClientTID())) {
+            if(!clientDataManager->createNewClient(request->getClientPID(),
+                                                   request->getClientTID(),
+                                                   request->getClientLevel())) {
                 // Client Entry Could not be Created, don't Proceed further with the Request
                 TYPELOGV(CLIENT_ENTRY_CREATION_FAILURE, request->getHandle());
 
                 // Free the Request Memory Block
                 Request::cleanUpRequest(request);
-                return;
+                return false;
             }
         }
     }
@@ -269,7 +274,7 @@ static void processIncomingRequest(Request* request, int8_t isValidated=false) {
         if(!clientDataManager->clientExists(request->getClientPID(), request->getClientTID())) {
             // Client does not exist, drop the request
             Request::cleanUpRequest(request);
-            return;
+            return false;
         }
 
         if(request->getRequestType() == REQ_RESOURCE_UNTUNING) {
@@ -282,7 +287,7 @@ static void processIncomingRequest(Request* request, int8_t isValidated=false) {
             //    up for Processing in the RequestQueue before the Tune Request is added to the RequestManager.
             if(!requestManager->disableRequestProcessing(request->getHandle())) {
                 Request::cleanUpRequest(request);
-                return;
+                return false;
             }
         }
     }
@@ -291,7 +296,7 @@ static void processIncomingRequest(Request* request, int8_t isValidated=false) {
     if(!isValidated && !rateLimiter->isRateLimitHonored(request->getClientTID())) {
         TYPELOGV(RATE_LIMITER_RATE_LIMITED, request->getClientTID(), request->getHandle());
         Request::cleanUpRequest(request);
-        return;
+        return false;
     }
 
     // For requests of type - retune / untune
@@ -304,71 +309,82 @@ static void processIncomingRequest(Request* request, int8_t isValidated=false) {
         if(!requestManager->verifyHandle(request->getHandle())) {
             TYPELOGV(REQUEST_MANAGER_REQUEST_NOT_ACTIVE, request->getHandle());
             Request::cleanUpRequest(request);
-        } else {
-            // Add it to request queue for further processing
-            requestQueue->addAndWakeup(request);
+            return false;
         }
 
-        return;
+        // Add it to request queue for further processing
+        requestQueue->addAndWakeup(request);
+        return true;
     }
 
     // Validate the Request
     if(!isValidated) {
-        if(VerifyIncomingRequest(request)) {
-            TYPELOGV(VERIFIER_REQUEST_VALIDATED, request->getHandle());
-
-            if(addToRequestManager(request)) {
-                // Add this request to the RequestQueue
-                requestQueue->addAndWakeup(request);
-            } else {
-                Request::cleanUpRequest(request);
-            }
-
-        } else {
+        if(!VerifyIncomingRequest(request)) {
             TYPELOGV(VERIFIER_STATUS_FAILURE, request->getHandle());
             Request::cleanUpRequest(request);
+            return false;
         }
-    } else {
-        if(addToRequestManager(request)) {
-            // Add this request to the RequestQueue
-            requestQueue->addAndWakeup(request);
-        } else {
-            Request::cleanUpRequest(request);
-        }
+        TYPELOGV(VERIFIER_REQUEST_VALIDATED, request->getHandle());
+    }
+
+    if(!addToRequestManager(request)) {
+        Request::cleanUpRequest(request);
+        return false;
     }
+
+    // Add this request to the RequestQueue
+    requestQueue->addAndWakeup(request);
+    return true;
 }
 
 void submitResProvisionRequest(Request* request, int8_t isValidated) {
     processIncomingRequest(request, isValidated);
 }
 
+int8_t admitResProvisionRequest(Request* request, int8_t isValidated) {
+    return processIncomingRequest(request, isValidated);
+}
+
 void submitResProvisionReqMsg(void* msg) {
-    if(msg == nullptr) return;
+    admitResProvisionReqMsg(msg);
+}
+
+int8_t admitResProvisionReqMsg(void* msg) {
+    if(msg == nullptr) return false;
 
     MsgForwardInfo* info = (MsgForwardInfo*) msg;
     Request* request = nullptr;
-
-    if(info == nullptr) return;
+    int8_t accepted = false;
 
     try {
         request = MPLACED(Request);
-        if(RC_IS_NOTOK(request->deserialize(info->mBuffer))) {
+        if(RC_IS_NOTOK(request->deserialize(info->mBuffer, info->mPayloadSize))) {
             Request::cleanUpRequest(request);
         } else {
             if(request->getRequestType() == REQ_RESOURCE_TUNING) {
                 request->setHandle(info->mHandle);
             }
-            processIncomingRequest(request);
+
+            // The Kernel-reported identity of the connection takes precedence over the
+            // PID reported by the client in the Request.
+            if(info->mPeer.mPID > 0) {
+                request->setClientPID(info->mPeer.mPID);
+            }
+            request->setClientLevel(info->mPeer.mLevel);
+            accepted = processIncomingRequest(request);
         }
 
     } catch(const std::bad_alloc& e) {
         TYPELOGV(REQUEST_MEMORY_ALLOCATION_FAILURE, e.what());
     }
 
-    if(info != nullptr) {
-        FreeBlock<char[REQ_BUFFER_SIZE]>(info->mBuffer);
-        FreeBlock<MsgForwardInfo>(info);
+    // The client does not wait on Requests issued with a leased handle.
+    if(!accepted) {
+        RequestReceiver::getInstance()->notifyLeasedRejection(info);
     }
+
+    freeForwardInfo(info);
+    return accepted;
 }
 
 int8_t submitPropGetRequest(const std::string& prop,
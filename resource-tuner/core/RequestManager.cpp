@@ -3,37 +3,50 @@
 
 #include "RequestManager.h"
 
-static int8_t resourceCmpPolicy(DLRootNode* src, DLRootNode* target) {
-    if(target == nullptr) return false;
-    // This covers the case where the client fires the exact same request multiple times
-    Resource* res1 = (Resource*)((ResIterable*)src)->mData;
-    Resource* res2 = (Resource*) ((ResIterable*)target)->mData;
-
+static int8_t resourcesMatch(Resource* res1, Resource* res2) {
     if(res1->getResCode() != res2->getResCode()) return false;
     if(res1->getResInfo() != res2->getResInfo()) return false;
     if(res1->getOptionalInfo() != res2->getOptionalInfo()) return false;
     if(res1->getValuesCount() != res2->getValuesCount()) return false;
 
-    if(res1->getValuesCount() == 1) {
-        if(res1->getValueAt(0) != res2->getValueAt(0)) {
+    for(int32_t i = 0; i < res1->getValuesCount(); i++) {
+        if(res1->getValueAt(i) != res2->getValueAt(i)) {
             return false;
         }
-    } else {
-        for(int32_t i = 0; i < res1->getValuesCount(); i++) {
-            int32_t res1Val = res1->getValueAt(i);
-            int32_t res2Val = res2->getValueAt(i);
-            if(res1Val != res2Val) {
-                return false;
+    }
+
+    return true;
+}
+
+// Confirms a fingerprint match, the Resources can be specified in any order.
+// Only called on a fingerprint hit, hence the quadratic scan is acceptable.
+static int8_t requestsMatch(Request* request, Request* targetRequest) {
+    if(request->getResourcesCount() != targetRequest->getResourcesCount()) {
+        return false;
+    }
+
+    std::vector<Resource*> targetResources;
+    targetResources.reserve(targetRequest->getResourcesCount());
+    DL_ITERATE(targetRequest->getResDlMgr()) {
+        targetResources.push_back((Resource*)((ResIterable*)iter)->mData);
+    }
+
+    DL_ITERATE(request->getResDlMgr()) {
+        Resource* resource = (Resource*)((ResIterable*)iter)->mData;
+
+        int8_t matched = false;
+        for(size_t i = 0; i < targetResources.size(); i++) {
+            if(resourcesMatch(resource, targetResources[i])) {
+                targetResources[i] = targetResources.back();
+                targetResources.pop_back();
+                matched = true;
+                break;
             }
         }
+
+        if(!matched) return false;
     }
 
-    // Consideration:
-    // How to efficiently check duplicate in cases where the client sends 2
-    // requests with the same Resources, but in different orders. For example:
-    // Rq1 -> Rs1, Rs2, Rs3
-    // Rq2 - Rs1, Rs3, Rs2
-    // - These requests are still duplicates, but the above logic won't catch it
     return true;
 }
 
@@ -41,9 +54,23 @@ std::shared_ptr<RequestManager> RequestManager::mReqeustManagerInstance = nullpt
 std::mutex RequestManager::instanceProtectionLock{};
 
 RequestManager::RequestManager() {
-    this->mTotalRequestServed = 0;
-    this->mActiveRequests.reserve(UrmSettings::metaConfigs.mMaxConcurrentRequests);
-    this->mActiveRequests.max_load_factor(1.0f);
+    this->mTotalRequestServed.store(0);
+    this->mActiveRequestsCount.store(0);
+
+    size_t stripeCapacity = UrmSettings::metaConfigs.mMaxConcurrentRequests / REQUEST_TABLE_STRIPE_COUNT + 1;
+    for(RequestStripe& stripe: this->mActiveRequests) {
+        stripe.mRequests.reserve(stripeCapacity);
+        stripe.mRequests.max_load_factor(1.0f);
+    }
+}
+
+RequestStripe& RequestManager::getStripe(int64_t handle) {
+    // Handles are generated sequentially, hence the low bits spread them evenly.
+    return this->mActiveRequests[(uint64_t)handle % REQUEST_TABLE_STRIPE_COUNT];
+}
+
+FingerprintStripe& RequestManager::getFingerprintStripe(int32_t clientTID) {
+    return this->mClientFingerprints[(uint32_t)clientTID % REQUEST_TABLE_STRIPE_COUNT];
 }
 
 int8_t RequestManager::isSane(Request* request) {
@@ -80,112 +107,144 @@ int8_t RequestManager::isSane(Request* request) {
     return true;
 }
 
+// A Request is a duplicate if the same client already has an active Request
+// with the same Resources. Candidates are looked up by fingerprint.
 int8_t RequestManager::requestMatch(Request* request) {
-    int32_t clientTID = request->getClientTID();
+    FingerprintStripe& fingerprintStripe = this->getFingerprintStripe(request->getClientTID());
+    std::shared_lock<std::shared_timed_mutex> fingerprintLock(fingerprintStripe.mMutex);
 
-    // Get the list of Requests for this client
-    std::unordered_set<int64_t>* clientHandles =
-        ClientDataManager::getInstance()->getRequestsByClientID(clientTID);
-
-    if(clientHandles == nullptr || clientHandles->size() == 0) {
+    auto clientIt = fingerprintStripe.mClients.find(request->getClientTID());
+    if(clientIt == fingerprintStripe.mClients.end()) {
         return false;
     }
-    // Assumptions: Number of Resources per request won't be too large
-    // If it is, we can use multiple threads from the pool for faster checking
 
-    for(int64_t handle: *clientHandles) {
-        Request* targetRequest = this->mActiveRequests[handle].first;
-        if(targetRequest == nullptr) {
+    auto candidates = clientIt->second.equal_range(request->getFingerprint());
+    for(auto it = candidates.first; it != candidates.second; ++it) {
+        RequestStripe& stripe = this->getStripe(it->second);
+        std::shared_lock<std::shared_timed_mutex> lock(stripe.mMutex);
+
+        auto activeIt = stripe.mRequests.find(it->second);
+        if(activeIt == stripe.mRequests.end() || activeIt->second.first == nullptr) {
             continue;
         }
 
-        // Check that the Number of Resources in the requests are the same
-        if(request->getResourcesCount() != targetRequest->getResourcesCount()) {
-            return false;
+        if(requestsMatch(request, activeIt->second.first)) {
+            return true;
         }
+    }
 
-        if(!request->getResDlMgr()->matchAgainst(targetRequest->getResDlMgr(), resourceCmpPolicy)) {
-            return false;
+    return false;
+}
+
+void RequestManager::indexRequest(Request* request) {
+    FingerprintStripe& fingerprintStripe = this->getFingerprintStripe(request->getClientTID());
+    const std::lock_guard<std::shared_timed_mutex> lock(fingerprintStripe.mMutex);
+
+    fingerprintStripe.mClients[request->getClientTID()].insert({request->getFingerprint(), request->getHandle()});
+}
+
+void RequestManager::unindexRequest(Request* request) {
+    FingerprintStripe& fingerprintStripe = this->getFingerprintStripe(request->getClientTID());
+    const std::lock_guard<std::shared_timed_mutex> lock(fingerprintStripe.mMutex);
+
+    auto clientIt = fingerprintStripe.mClients.find(request->getClientTID());
+    if(clientIt == fingerprintStripe.mClients.end()) {
+        return;
+    }
+
+    auto candidates = clientIt->second.equal_range(request->getFingerprint());
+    for(auto it = candidates.first; it != candidates.second; ++it) {
+        if(it->second == request->getHandle()) {
+            clientIt->second.erase(it);
+            break;
         }
     }
 
-    return true;
+    if(clientIt->second.empty()) {
+        fingerprintStripe.mClients.erase(clientIt);
+    }
 }
 
 int8_t RequestManager::verifyHandle(int64_t handle) {
-    this->mRequestMapMutex.lock_shared();
-    int8_t handleExists = (this->mActiveRequests.find(handle) != this->mActiveRequests.end());
-    this->mRequestMapMutex.unlock_shared();
+    RequestStripe& stripe = this->getStripe(handle);
+    std::shared_lock<std::shared_timed_mutex> lock(stripe.mMutex);
 
-    return handleExists;
+    return stripe.mRequests.find(handle) != stripe.mRequests.end();
 }
 
 RequestInfo RequestManager::getRequestFromMap(int64_t handle) {
-    this->mRequestMapMutex.lock_shared();
-    if(this->mActiveRequests.find(handle) == this->mActiveRequests.end()) {
-        this->mRequestMapMutex.unlock_shared();
+    RequestStripe& stripe = this->getStripe(handle);
+    std::shared_lock<std::shared_timed_mutex> lock(stripe.mMutex);
+
+    auto activeIt = stripe.mRequests.find(handle);
+    if(activeIt == stripe.mRequests.end()) {
         return RequestInfo {nullptr, REQ_CANCELLED};
     }
 
-    RequestInfo reqInfo = this->mActiveRequests[handle];
-    this->mRequestMapMutex.unlock_shared();
-    return reqInfo;
+    return activeIt->second;
 }
 
 int8_t RequestManager::shouldRequestBeAdded(Request* request) {
     //sanity check.
     if(!isSane(request)) return false;
 
-    this->mRequestMapMutex.lock_shared();
-    if(this->mActiveRequests.size() >= UrmSettings::metaConfigs.mMaxConcurrentRequests) {
-        this->mRequestMapMutex.unlock_shared();
+    if(this->mActiveRequestsCount.load() >= (int64_t)UrmSettings::metaConfigs.mMaxConcurrentRequests) {
         return false;
     }
 
     // Check for duplicates
-    int8_t duplicateFound = this->requestMatch(request);
-
-    this->mRequestMapMutex.unlock_shared();
-
-    return !duplicateFound;
+    return !this->requestMatch(request);
 }
 
 int8_t RequestManager::addRequest(Request* request) {
     if(request == nullptr) return false;
-    this->mRequestMapMutex.lock();
-
-    if(this->mActiveRequests.size() >= UrmSettings::metaConfigs.mMaxConcurrentRequests) {
-        this->mRequestMapMutex.unlock();
-        return false;
-    }
 
     int64_t handle = request->getHandle();
-    if(this->mActiveRequests.find(handle) != this->mActiveRequests.end()) {
-        this->mActiveRequests.erase(handle);
-        this->mRequestMapMutex.unlock();
-        return false;
+    Request* displacedRequest = nullptr;
+    {
+        RequestStripe& stripe = this->getStripe(handle);
+        const std::lock_guard<std::shared_timed_mutex> lock(stripe.mMutex);
+
+        auto activeIt = stripe.mRequests.find(handle);
+        if(activeIt != stripe.mRequests.end()) {
+            displacedRequest = activeIt->second.first;
+            stripe.mRequests.erase(activeIt);
+            this->mActiveRequestsCount.fetch_sub(1);
+
+        } else {
+            {
+                const std::lock_guard<std::mutex> cacheLock(this->mUntuneCacheMutex);
+                if(this->mUntuneCache.isPresent(handle)) {
+                    return false;
+                }
+            }
+
+            // Reserve a slot first, the limit applies across all the stripes.
+            if(this->mActiveRequestsCount.fetch_add(1) >= (int64_t)UrmSettings::metaConfigs.mMaxConcurrentRequests) {
+                this->mActiveRequestsCount.fetch_sub(1);
+                return false;
+            }
+
+            stripe.mRequests[handle] = {request, REQ_UNCHANGED};
+        }
     }
 
-    if(this->mUntuneCache.isPresent(handle)) {
-        this->mRequestMapMutex.unlock();
+    if(displacedRequest != nullptr) {
+        this->unindexRequest(displacedRequest);
         return false;
     }
 
     // Populate all the Trackers with info for this Request
-    this->mTotalRequestServed++;
-    this->mActiveRequests[handle] = {request, REQ_UNCHANGED};
+    this->mTotalRequestServed.fetch_add(1);
+    this->indexRequest(request);
 
     // Add this request handle to the client list
-    int32_t clientTID = request->getClientTID();
-    ClientDataManager::getInstance()->insertRequestByClientId(clientTID, handle);
-
-    this->mRequestMapMutex.unlock();
+    ClientDataManager::getInstance()->insertRequestByClientId(request->getClientTID(), handle);
     return true;
 }
 
 void RequestManager::removeRequest(Request* request) {
     if(request == nullptr) return;
-    this->mRequestMapMutex.lock();
 
     // Remove the handle reference from the client handles list
     int32_t clientTID = request->getClientTID();
@@ -194,99 +253,66 @@ void RequestManager::removeRequest(Request* request) {
     ClientDataManager::getInstance()->deleteRequestByClientId(clientTID, handle);
 
     // Remove the handle from the list of active requests
-    this->mActiveRequests.erase(handle);
-    this->mRequestMapMutex.unlock();
-}
+    Request* removedRequest = nullptr;
+    {
+        RequestStripe& stripe = this->getStripe(handle);
+        const std::lock_guard<std::shared_timed_mutex> lock(stripe.mMutex);
+
+        auto activeIt = stripe.mRequests.find(handle);
+        if(activeIt == stripe.mRequests.end()) {
+            return;
+        }
 
-std::vector<Request*> RequestManager::getPendingList() {
-    this->mRequestMapMutex.lock_shared();
-    std::vector<Request*> pendingList;
-    for(Request* request: this->mRequestsList[PENDING_TUNE]) {
-        pendingList.push_back(request);
+        removedRequest = activeIt->second.first;
+        stripe.mRequests.erase(activeIt);
+        this->mActiveRequestsCount.fetch_sub(1);
+    }
+
+    if(removedRequest != nullptr) {
+        this->unindexRequest(removedRequest);
     }
-    this->mRequestMapMutex.unlock_shared();
-    return pendingList;
 }
 
 int8_t RequestManager::disableRequestProcessing(int64_t handle) {
-    this->mRequestMapMutex.lock();
-    if(this->mActiveRequests.find(handle) == this->mActiveRequests.end()) {
+    RequestStripe& stripe = this->getStripe(handle);
+    const std::lock_guard<std::shared_timed_mutex> lock(stripe.mMutex);
+
+    auto activeIt = stripe.mRequests.find(handle);
+    if(activeIt == stripe.mRequests.end()) {
         // Request not in the activeList
+        const std::lock_guard<std::mutex> cacheLock(this->mUntuneCacheMutex);
         this->mUntuneCache.insert(handle);
-        this->mRequestMapMutex.unlock();
         return false;
-
-    } else {
-        this->mActiveRequests[handle].second |= REQ_CANCELLED;
     }
 
-    this->mRequestMapMutex.unlock();
+    activeIt->second.second |= REQ_CANCELLED;
     return true;
 }
 
 int64_t RequestManager::getActiveReqeustsCount() {
-    this->mRequestMapMutex.lock_shared();
-    int32_t size = this->mActiveRequests.size();
-    this->mRequestMapMutex.unlock_shared();
-    return size;
+    return this->mActiveRequestsCount.load();
 }
 
 void RequestManager::markRequestAsComplete(int64_t handle) {
-    this->mRequestMapMutex.lock();
-    if(this->mActiveRequests.find(handle) != this->mActiveRequests.end()) {
-        this->mActiveRequests[handle].second |= REQ_COMPLETED;
-    }
-    this->mRequestMapMutex.unlock();
-}
+    RequestStripe& stripe = this->getStripe(handle);
+    const std::lock_guard<std::shared_timed_mutex> lock(stripe.mMutex);
 
-int8_t RequestManager::getRequestProcessingStatus(int64_t handle) {
-    if(this->mActiveRequests.find(handle) != this->mActiveRequests.end()) {
-        return this->mActiveRequests[handle].second;
+    auto activeIt = stripe.mRequests.find(handle);
+    if(activeIt != stripe.mRequests.end()) {
+        activeIt->second.second |= REQ_COMPLETED;
     }
-
-    return REQ_NOT_FOUND;
 }
 
-void RequestManager::moveToPendingList() {
-    this->mRequestMapMutex.lock();
-
-    // This method will essentially drain out the CocoTable
-    // The Requests will be moved to the Pending List or Kept in the Active Requests List
-    // based on whether background Processing is enabled for the Request.
-    for(Request* request: this->mRequestsList[ACTIVE_TUNE]) {
-        // Iterate over all the Requests in the activeRequestsList
-        // - Send Corresponding Untune Request for each of the Requests
-        // - Add the Requests to the Pending List, which are not eligible for background processing
-        //   while removing them from the activeRequestsList
-        if((request->getProcessingModes() & MODE_SUSPEND) == 0) {
-            Request* untuneRequest = nullptr;
-            try {
-                untuneRequest = MPLACED(Request);
-            } catch(const std::bad_alloc& e) {
-                LOGI("RESTUNE_REQUEST_MANAGER"
-                     "Failed to create Untune Request for Request: ", std::to_string(request->getHandle()));
-            }
-
-            if(untuneRequest != nullptr) {
-                request->populateUntuneRequest(untuneRequest);
-
-                // Keep the Untune Request's Priority as high as possible
-                // So that all the existing Requests are untuned before the new Requests are Added.
-                untuneRequest->setPriority(HIGH_TRANSFER_PRIORITY);
-                RequestQueue::getInstance()->addAndWakeup(untuneRequest);
-            }
+int8_t RequestManager::getRequestProcessingStatus(int64_t handle) {
+    RequestStripe& stripe = this->getStripe(handle);
+    std::shared_lock<std::shared_timed_mutex> lock(stripe.mMutex);
 
-            this->mRequestsList[PENDING_TUNE].insert(request);
-        }
+    auto activeIt = stripe.mRequests.find(handle);
+    if(activeIt != stripe.mRequests.end()) {
+        return activeIt->second.second;
     }
 
-    this->mRequestMapMutex.unlock();
-}
-
-void RequestManager::clearPending() {
-    this->mRequestMapMutex.lock();
-    this->mRequestsList[PENDING_TUNE].clear();
-    this->mRequestMapMutex.unlock();
+    return REQ_NOT_FOUND;
 }
 
 RequestManager::~RequestManager() {}
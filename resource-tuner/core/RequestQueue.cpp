@@ -23,6 +23,19 @@ void RequestQueue::orderedQueueConsumerHook() {
             return;
         }
 
+        // Device Mode transitions are applied in order with the Requests queued ahead of them.
+        if(message->getRequestType() == REQ_MODE_TRANSITION) {
+            cocoTable->applyModeTransition(message->getProcessingModes());
+            FreeBlock<Message>(static_cast<void*>(message));
+            continue;
+        }
+
+        if(message->getRequestType() == REQ_CLIENT_CLEANUP) {
+            FreeBlock<Message>(static_cast<void*>(message));
+            this->processClientCleanup();
+            continue;
+        }
+
         Request* req = dynamic_cast<Request*>(message);
         if(req == nullptr) {
             continue;
@@ -93,4 +106,69 @@ void RequestQueue::orderedQueueConsumerHook() {
     }
 }
 
+int8_t RequestQueue::postModeTransition(int8_t mode) {
+    Message* message = nullptr;
+    try {
+        message = MPLACED(Message);
+    } catch(const std::bad_alloc& e) {
+        TYPELOGV(GENERIC_CALL_FAILURE_LOG, e.what());
+        return false;
+    }
+
+    message->setRequestType(REQ_MODE_TRANSITION);
+    // The mode is carried in the processing modes, with the highest transfer priority.
+    message->setProperties(((int32_t)mode << 8) | (uint8_t)HIGH_TRANSFER_PRIORITY);
+    return this->addAndWakeup(message);
+}
+
+int8_t RequestQueue::postClientCleanup(const std::vector<int64_t>& handles) {
+    if(handles.empty()) return true;
+
+    Message* message = nullptr;
+    try {
+        message = MPLACED(Message);
+    } catch(const std::bad_alloc& e) {
+        TYPELOGV(GENERIC_CALL_FAILURE_LOG, e.what());
+        return false;
+    }
+
+    this->mCleanupHandlesMutex.lock();
+    this->mCleanupHandles.insert(this->mCleanupHandles.end(), handles.begin(), handles.end());
+    this->mCleanupHandlesMutex.unlock();
+
+    message->setRequestType(REQ_CLIENT_CLEANUP);
+    message->setProperties((uint8_t)HIGH_TRANSFER_PRIORITY);
+    return this->addAndWakeup(message);
+}
+
+// Remove all the Requests handed over by the Garbage Collector in one go, Requests
+// which have not reached the CocoTable yet are dropped when they are dequeued.
+void RequestQueue::processClientCleanup() {
+    std::shared_ptr<RequestManager> requestManager = RequestManager::getInstance();
+
+    std::vector<int64_t> handles;
+    this->mCleanupHandlesMutex.lock();
+    handles.swap(this->mCleanupHandles);
+    this->mCleanupHandlesMutex.unlock();
+
+    std::vector<Request*> requests;
+    for(int64_t handle: handles) {
+        RequestInfo requestInfo = requestManager->getRequestFromMap(handle);
+        if(requestInfo.first == nullptr || (requestInfo.second & REQ_NOT_FOUND)) continue;
+
+        if((requestInfo.second & REQ_COMPLETED) == 0) {
+            requestManager->disableRequestProcessing(handle);
+            continue;
+        }
+        requests.push_back(requestInfo.first);
+    }
+
+    CocoTable::getInstance()->removeRequests(requests);
+
+    for(Request* request: requests) {
+        requestManager->removeRequest(request);
+        Request::cleanUpRequest(request);
+    }
+}
+
 RequestQueue::~RequestQueue() {}
@@ -8,6 +8,12 @@
 #include "Extensions.h"
 #include "TargetRegistry.h"
 #include "ResourceRegistry.h"
+#include "SysfsWriter.h"
+#include "DriftDetector.h"
+#include "CGroupMigrator.h"
+#include "PmQosManager.h"
+#include "NodeJournal.h"
+#include "NodeArbiter.h"
 
 static std::string getClusterTypeResourceNodePath(Resource* resource, int32_t clusterID) {
     ResConfInfo* resourceConfig =
@@ -54,6 +60,48 @@ static std::string getCGroupTypeResourceNodePath(Resource* resource, const std::
     return filePath;
 }
 
+// Post the winning value for the node, and track it so that it can be verified later.
+static void applyNodeValue(const std::string& nodePath, const std::string& value, uint32_t resCode) {
+    std::string valueToBeWritten = value;
+    uint32_t winnerResCode = resCode;
+
+    // Nodes shared across Resources are written only if the node-level winner changes.
+    ResConfInfo* rConf = ResourceRegistry::getInstance()->getResConf(resCode);
+    if(rConf != nullptr && rConf->mSharesNode) {
+        if(!NodeArbiter::getInstance()->claim(nodePath, resCode, value, rConf->mPolicy,
+                                              valueToBeWritten, winnerResCode)) {
+            return;
+        }
+    }
+
+    // Tracked ahead of the post, so that a reassert from the Drift Detector can only
+    // ever carry the new value.
+    ResourceRegistry::getInstance()->captureDefaultValue(nodePath);
+    DriftDetector::getInstance()->trackNode(nodePath, valueToBeWritten, winnerResCode);
+    SysfsWriter::getInstance()->post(nodePath, valueToBeWritten);
+    NodeJournal::getInstance()->recordAppliedValue(nodePath, valueToBeWritten);
+}
+
+static void resetNodeValue(const std::string& nodePath, const std::string& defaultValue, uint32_t resCode) {
+    // If some other Resource still holds the shared node, fall back to its value instead.
+    ResConfInfo* rConf = ResourceRegistry::getInstance()->getResConf(resCode);
+    if(rConf != nullptr && rConf->mSharesNode) {
+        std::string remainingValue;
+        uint32_t remainingResCode = 0;
+        if(NodeArbiter::getInstance()->release(nodePath, resCode, remainingValue, remainingResCode)) {
+            // Drift is charged to the Resource which now holds the node.
+            DriftDetector::getInstance()->trackNode(nodePath, remainingValue, remainingResCode);
+            SysfsWriter::getInstance()->post(nodePath, remainingValue);
+            NodeJournal::getInstance()->recordAppliedValue(nodePath, remainingValue);
+            return;
+        }
+    }
+
+    DriftDetector::getInstance()->untrackNode(nodePath);
+    SysfsWriter::getInstance()->post(nodePath, defaultValue);
+    NodeJournal::getInstance()->recordAppliedValue(nodePath, defaultValue);
+}
+
 // Default Applier Callback for Resources with ApplyType = "cluster"
 void defaultClusterLevelApplierCb(void* context) {
     if(context == nullptr) return;
@@ -78,18 +126,7 @@ void defaultClusterLevelApplierCb(void* context) {
     }
 
     TYPELOGV(NOTIFY_NODE_WRITE, resourceNodePath.c_str(), valueToBeWritten);
-    std::ofstream resourceFileStream(resourceNodePath);
-    if(!resourceFileStream.is_open()) {
-        TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-        return;
-    }
-
-    resourceFileStream<<translatedValue<<std::endl;
-
-    if(resourceFileStream.fail()) {
-        TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-    }
-    resourceFileStream.close();
+    applyNodeValue(resourceNodePath, std::to_string(translatedValue), resource->getResCode());
 }
 
 // Default Tear Callback for Resources with ApplyType = "cluster"
@@ -104,18 +141,7 @@ void defaultClusterLevelTearCb(void* context) {
         ResourceRegistry::getInstance()->getDefaultValue(resourceNodePath);
 
     TYPELOGV(NOTIFY_NODE_RESET, resourceNodePath.c_str(), defaultValue.c_str());
-    std::ofstream resourceFileStream(resourceNodePath);
-    if(!resourceFileStream.is_open()) {
-        TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-        return;
-    }
-
-    resourceFileStream<<defaultValue<<std::endl;
-
-    if(resourceFileStream.fail()) {
-        TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-    }
-    resourceFileStream.close();
+    resetNodeValue(resourceNodePath, defaultValue, resource->getResCode());
 }
 
 static void defaultCoreLevelApplierHelper(Resource* resource, int32_t coreID) {
@@ -136,18 +162,7 @@ static void defaultCoreLevelApplierHelper(Resource* resource, int32_t coreID) {
     }
 
     TYPELOGV(NOTIFY_NODE_WRITE, resourceNodePath.c_str(), valueToBeWritten);
-    std::ofstream resourceFileStream(resourceNodePath);
-    if(!resourceFileStream.is_open()) {
-        TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-        return;
-    }
-
-    resourceFileStream<<translatedValue<<std::endl;
-
-    if(resourceFileStream.fail()) {
-        TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-    }
-    resourceFileStream.close();
+    applyNodeValue(resourceNodePath, std::to_string(translatedValue), resource->getResCode());
 }
 
 // Default Applier Callback for Resources with ApplyType = "core"
@@ -179,18 +194,7 @@ static void defaultCoreLevelTearHelper(Resource* resource, int32_t coreID) {
         ResourceRegistry::getInstance()->getDefaultValue(resourceNodePath);
 
     TYPELOGV(NOTIFY_NODE_RESET, resourceNodePath.c_str(), defaultValue.c_str());
-    std::ofstream controllerFile(resourceNodePath);
-    if(!controllerFile.is_open()) {
-        TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-        return;
-    }
-
-    controllerFile<<defaultValue<<std::endl;
-
-    if(controllerFile.fail()) {
-        TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-    }
-    controllerFile.close();
+    resetNodeValue(resourceNodePath, defaultValue, resource->getResCode());
 }
 
 // Default Tear Callback for Resources with ApplyType = "core"
@@ -250,18 +254,7 @@ void defaultCGroupLevelApplierCb(void* context) {
 
             TYPELOGV(NOTIFY_NODE_WRITE, controllerFilePath.c_str(), valueToBeWritten);
             LOGD("RESTUNE_COCO_TABLE", "Actual value to be written = " + std::to_string(translatedValue));
-            std::ofstream controllerFile(controllerFilePath);
-            if(!controllerFile.is_open()) {
-                TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-                return;
-            }
-
-            controllerFile<<translatedValue<<std::endl;
-
-            if(controllerFile.fail()) {
-                TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-            }
-            controllerFile.close();
+            applyNodeValue(controllerFilePath, std::to_string(translatedValue), resource->getResCode());
         }
     } else {
         TYPELOGV(VERIFIER_CGROUP_NOT_FOUND, cGroupIdentifier);
@@ -293,18 +286,7 @@ void defaultCGroupLevelTearCb(void* context) {
             ResourceRegistry::getInstance()->getDefaultValue(controllerFilePath);
 
         TYPELOGV(NOTIFY_NODE_RESET, controllerFilePath.c_str(), defaultValue.c_str());
-        std::ofstream controllerFile(controllerFilePath);
-        if(!controllerFile.is_open()) {
-            TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-            return;
-        }
-
-        controllerFile<<defaultValue<<std::endl;
-
-        if(controllerFile.fail()) {
-            TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-        }
-        controllerFile.close();
+        resetNodeValue(controllerFilePath, defaultValue, resource->getResCode());
     }
 }
 
@@ -318,7 +300,9 @@ void defaultGlobalLevelApplierCb(void* context) {
 
     if(resourceConfig != nullptr) {
         TYPELOGV(NOTIFY_NODE_WRITE, resourceConfig->mResourcePath.c_str(), resource->getValueAt(0));
-        AuxRoutines::writeToFile(resourceConfig->mResourcePath, std::to_string(resource->getValueAt(0)));
+        applyNodeValue(resourceConfig->mResourcePath,
+                       std::to_string(resource->getValueAt(0)),
+                       resource->getResCode());
     }
 }
 
@@ -335,7 +319,7 @@ void defaultGlobalLevelTearCb(void* context) {
             ResourceRegistry::getInstance()->getDefaultValue(resourceConfig->mResourcePath);
 
         TYPELOGV(NOTIFY_NODE_RESET, resourceConfig->mResourcePath.c_str(), defaultValue.c_str());
-        AuxRoutines::writeToFile(resourceConfig->mResourcePath, defaultValue);
+        resetNodeValue(resourceConfig->mResourcePath, defaultValue, resource->getResCode());
     }
 }
 
@@ -352,9 +336,6 @@ static void moveProcessToCGroup(void* context) {
     CGroupConfigInfo* cGroupConfig =
         TargetRegistry::getInstance()->getCGroupConfig(cGroupIdentifier);
 
-    ResConfInfo* resourceConfig =
-        ResourceRegistry::getInstance()->getResConf(resource->getResCode());
-
     if(cGroupConfig == nullptr) {
         TYPELOGV(VERIFIER_CGROUP_NOT_FOUND, cGroupIdentifier);
         return;
@@ -366,36 +347,14 @@ static void moveProcessToCGroup(void* context) {
         return;
     }
 
-    std::string filePath = resourceConfig->mResourcePath;
-
-    // Replace %s in above file path with the actual cgroup name
-    char pathBuffer[128] = {0};
-    std::snprintf(pathBuffer, sizeof(pathBuffer), filePath.c_str(), cGroupName.c_str());
-
+    std::vector<int32_t> pids;
     for(int32_t i = 1; i < resource->getValuesCount(); i++) {
-        int32_t pid = resource->getValueAt(i);
-        std::string currentCGroupFilePath = "/proc/" + std::to_string(pid) + "/cgroup";
-        std::string currentCGroup = AuxRoutines::readFromFile(currentCGroupFilePath);
-
-        if(currentCGroup.length() > 4) {
-            currentCGroup = currentCGroup.substr(4);
-            ResourceRegistry::getInstance()->addDefaultValue(currentCGroupFilePath, currentCGroup);
-        }
-
-        TYPELOGV(NOTIFY_NODE_WRITE, pathBuffer, pid);
-        std::ofstream controllerFile(pathBuffer);
-        if(!controllerFile.is_open()) {
-            TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-            return;
-        }
-
-        controllerFile<<pid<<std::endl;
-
-        if(controllerFile.fail()) {
-            TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-        }
-        controllerFile.close();
+        pids.push_back(resource->getValueAt(i));
     }
+
+    // The original CGroup of each PID is recorded by the Migrator, for the Tear Callback.
+    std::string controllerFilePath = getCGroupTypeResourceNodePath(resource, cGroupName);
+    CGroupMigrator::getInstance()->migrateProcesses(controllerFilePath, pids);
 }
 
 static void moveThreadToCGroup(void* context) {
@@ -419,24 +378,13 @@ static void moveThreadToCGroup(void* context) {
         return;
     }
 
-    std::string controllerFilePath = getCGroupTypeResourceNodePath(resource, cGroupName);
+    std::vector<int32_t> tids;
     for(int32_t i = 1; i < resource->getValuesCount(); i++) {
-        int32_t tid = resource->getValueAt(i);
-
-        TYPELOGV(NOTIFY_NODE_WRITE, controllerFilePath.c_str(), tid);
-        std::ofstream controllerFile(controllerFilePath);
-        if(!controllerFile.is_open()) {
-            TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-            return;
-        }
-
-        controllerFile<<tid<<std::endl;
-
-        if(controllerFile.fail()) {
-            TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-        }
-        controllerFile.close();
+        tids.push_back(resource->getValueAt(i));
     }
+
+    std::string controllerFilePath = getCGroupTypeResourceNodePath(resource, cGroupName);
+    CGroupMigrator::getInstance()->migrateThreads(controllerFilePath, tids);
 }
 
 static void setRunOnCores(void* context) {
@@ -462,19 +410,9 @@ static void setRunOnCores(void* context) {
 
             std::string controllerFilePath = getCGroupTypeResourceNodePath(resource, cGroupName);
 
+            ResourceRegistry::getInstance()->captureDefaultValue(controllerFilePath);
             TYPELOGV(NOTIFY_NODE_WRITE_S, controllerFilePath.c_str(), cpusString.c_str());
-            std::ofstream controllerFile(controllerFilePath);
-            if(!controllerFile.is_open()) {
-                TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-                return;
-            }
-
-            controllerFile<<cpusString<<std::endl;
-
-            if(controllerFile.fail()) {
-                TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-            }
-            controllerFile.close();
+            SysfsWriter::getInstance()->post(controllerFilePath, cpusString);
         }
     } else {
         TYPELOGV(VERIFIER_CGROUP_NOT_FOUND, cGroupIdentifier);
@@ -496,6 +434,16 @@ static void setRunOnCoresExclusively(void* context) {
             const std::string cGroupControllerFilePath =
                 UrmSettings::mBaseCGroupPath + cGroupName + "/cpuset.cpus";
 
+            // cpuset.cpus and the partition file must be updated in order,
+            // wait for any asynchronous intents on them to land first.
+            SysfsWriter::getInstance()->flush();
+
+            const std::string cGroupCpusetPartitionFilePath =
+                UrmSettings::mBaseCGroupPath + cGroupName + "/cpuset.cpus.partition";
+
+            ResourceRegistry::getInstance()->captureDefaultValue(cGroupControllerFilePath);
+            ResourceRegistry::getInstance()->captureDefaultValue(cGroupCpusetPartitionFilePath);
+
             std::string cpusString = "";
             for(int32_t i = 1; i < resource->getValuesCount(); i++) {
                 int32_t curVal = resource->getValueAt(i);
@@ -514,9 +462,6 @@ static void setRunOnCoresExclusively(void* context) {
             controllerFile<<cpusString<<std::endl;
             controllerFile.close();
 
-            const std::string cGroupCpusetPartitionFilePath =
-                UrmSettings::mBaseCGroupPath + cGroupName + "/cpuset.cpus.partition";
-
             std::ofstream partitionFile(cGroupCpusetPartitionFilePath);
             if(!partitionFile.is_open()) {
                 TYPELOGV(ERRNO_LOG, "open", strerror(errno));
@@ -546,19 +491,9 @@ static void limitCpuTime(void* context) {
 
         if(cGroupName.length() > 0) {
             std::string controllerFilePath = getCGroupTypeResourceNodePath(resource, cGroupName);
-            std::ofstream controllerFile(controllerFilePath);
-
-            if(!controllerFile.is_open()) {
-                TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-                return;
-            }
-
-            controllerFile<<maxUsageMicroseconds<<" "<<periodMicroseconds<<std::endl;
-
-            if(controllerFile.fail()) {
-                TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-            }
-            controllerFile.close();
+            ResourceRegistry::getInstance()->captureDefaultValue(controllerFilePath);
+            SysfsWriter::getInstance()->post(controllerFilePath,
+                std::to_string(maxUsageMicroseconds) + " " + std::to_string(periodMicroseconds));
         }
     } else {
         TYPELOGV(VERIFIER_CGROUP_NOT_FOUND, cGroupIdentifier);
@@ -570,35 +505,13 @@ static void removeProcessFromCGroup(void* context) {
     Resource* resource = static_cast<Resource*>(context);
     if(resource->getValuesCount() < 2) return;
 
+    std::vector<int32_t> pids;
     for(int32_t i = 1; i < resource->getValuesCount(); i++) {
-        int32_t pid = resource->getValueAt(i);
-
-        std::string originalCGroupKey = "/proc/" + std::to_string(pid) + "/cgroup";
-        std::string cGroupPath =
-            ResourceRegistry::getInstance()->getDefaultValue(originalCGroupKey);
-
-        if(cGroupPath.length() == 0) {
-            cGroupPath = UrmSettings::mBaseCGroupPath + "cgroup.procs";
-        } else {
-            cGroupPath =  UrmSettings::mBaseCGroupPath + cGroupPath + "/cgroup.procs";
-        }
-
-        ResourceRegistry::getInstance()->deleteDefaultValue(originalCGroupKey);
-
-        LOGD("RESTUNE_COCO_TABLE", "Moving PID: " + std::to_string(pid) + " to: " + cGroupPath);
-        std::ofstream controllerFile(cGroupPath, std::ios::app);
-        if(!controllerFile.is_open()) {
-            TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-            return;
-        }
-
-        controllerFile<<pid<<std::endl;
-
-        if(controllerFile.fail()) {
-            TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-        }
-        controllerFile.close();
+        pids.push_back(resource->getValueAt(i));
     }
+
+    // Move the PIDs back to the CGroups they were in prior to the migration
+    CGroupMigrator::getInstance()->restoreProcesses(pids);
 }
 
 static void removeThreadFromCGroup(void* context) {
@@ -606,24 +519,12 @@ static void removeThreadFromCGroup(void* context) {
     Resource* resource = static_cast<Resource*>(context);
     if(resource->getValuesCount() < 2) return;
 
+    std::vector<int32_t> tids;
     for(int32_t i = 1; i < resource->getValuesCount(); i++) {
-        int32_t tid = resource->getValueAt(i);
-        std::string cGroupPath = UrmSettings::mBaseCGroupPath + cGroupPath + "/cgroup.threads";
-
-        LOGD("RESTUNE_COCO_TABLE", "Moving TID: " + std::to_string(tid) + " to: " + cGroupPath);
-        std::ofstream controllerFile(cGroupPath, std::ios::app);
-        if(!controllerFile.is_open()) {
-            TYPELOGV(ERRNO_LOG, "open", strerror(errno));
-            return;
-        }
-
-        controllerFile<<tid<<std::endl;
-
-        if(controllerFile.fail()) {
-            TYPELOGV(ERRNO_LOG, "write", strerror(errno));
-        }
-        controllerFile.close();
+        tids.push_back(resource->getValueAt(i));
     }
+
+    CGroupMigrator::getInstance()->restoreThreads(tids);
 }
 
 static void resetRunOnCoresExclusively(void* context) {
@@ -642,6 +543,8 @@ static void resetRunOnCoresExclusively(void* context) {
             const std::string cGroupCpuSetFilePath =
                 UrmSettings::mBaseCGroupPath + cGroupName + "/cpuset.cpus";
 
+            SysfsWriter::getInstance()->flush();
+
             std::string defaultValue =
                 ResourceRegistry::getInstance()->getDefaultValue(cGroupCpuSetFilePath);
 
@@ -718,13 +621,43 @@ static void resetPmQos(void* context) {
     }
 }
 
+// /dev/cpu_dma_latency holds the constraint only while the fd remains open,
+// hence it is routed through the PmQosManager instead of the SysfsWriter.
+static void setCpuDmaLatency(void* context) {
+    if(context == nullptr) return;
+    Resource* resource = static_cast<Resource*>(context);
+    if(resource->getValuesCount() < 1) return;
+
+    ResConfInfo* resourceConfig =
+        ResourceRegistry::getInstance()->getResConf(resource->getResCode());
+
+    if(resourceConfig != nullptr) {
+        TYPELOGV(NOTIFY_NODE_WRITE, resourceConfig->mResourcePath.c_str(), resource->getValueAt(0));
+        PmQosManager::getInstance()->applyQos(resourceConfig->mResourcePath, resource->getValueAt(0));
+    }
+}
+
+static void resetCpuDmaLatency(void* context) {
+    if(context == nullptr) return;
+    Resource* resource = static_cast<Resource*>(context);
+
+    ResConfInfo* resourceConfig =
+        ResourceRegistry::getInstance()->getResConf(resource->getResCode());
+
+    if(resourceConfig != nullptr) {
+        PmQosManager::getInstance()->releaseQos(resourceConfig->mResourcePath);
+    }
+}
+
 // Register the specific Callbacks
+URM_REGISTER_RES_APPLIER_CB(0x00010000, setCpuDmaLatency);
 URM_REGISTER_RES_APPLIER_CB(0x00010001, setPmQos);
 URM_REGISTER_RES_APPLIER_CB(0x00090000, moveProcessToCGroup);
 URM_REGISTER_RES_APPLIER_CB(0x00090001, moveThreadToCGroup);
 URM_REGISTER_RES_APPLIER_CB(0x00090002, setRunOnCores);
 URM_REGISTER_RES_APPLIER_CB(0x00090003, setRunOnCoresExclusively);
 URM_REGISTER_RES_APPLIER_CB(0x00090005, limitCpuTime);
+URM_REGISTER_RES_TEAR_CB(0x00010000, resetCpuDmaLatency);
 URM_REGISTER_RES_TEAR_CB(0x00010001, resetPmQos);
 URM_REGISTER_RES_TEAR_CB(0x00090000, removeProcessFromCGroup);
 URM_REGISTER_RES_TEAR_CB(0x00090001, removeThreadFromCGroup);
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause-Clear
 
 #include "ResourceRegistry.h"
+#include "NodeJournal.h"
 
 static const int32_t unsupportedResoure = -2;
 
@@ -39,54 +40,24 @@ void ResourceRegistry::setLifeCycleCallbacks(ResConfInfo* resourceConfigInfo) {
 }
 
 void ResourceRegistry::addDefaultValue(const std::string& filePath, const std::string& value) {
+    const std::lock_guard<std::mutex> lock(this->mDefaultValueStoreMutex);
     this->mDefaultValueStore[filePath] = value;
-
-    // std::fstream persistenceFile(UrmSettings::mPersistenceFile, std::ios::out | std::ios::app);
-    // std::string resourceData = filePath;
-    // resourceData.push_back(',');
-    // resourceData.append(value);
-    // resourceData.push_back('\n');
-    // persistenceFile << resourceData;
+    NodeJournal::getInstance()->recordOriginalValue(filePath, value);
 }
 
-void ResourceRegistry::fetchAndStoreDefaults(ResConfInfo* resourceConfigInfo) {
-    if(resourceConfigInfo == nullptr) return;
-    switch(resourceConfigInfo->mApplyType) {
-        case APPLY_CLUSTER: {
-            std::vector<int32_t> clusterIDs;
-            TargetRegistry::getInstance()->getClusterIDs(clusterIDs);
-            for(int32_t clusterID : clusterIDs) {
-                char filePath[128];
-                snprintf(filePath, sizeof(filePath), resourceConfigInfo->mResourcePath.c_str(), (int32_t)clusterID);
-                this->addDefaultValue(std::string(filePath), AuxRoutines::readFromFile(filePath));
-            }
-            break;
-        }
-        case APPLY_CGROUP: {
-            std::vector<std::string> cGroupNames;
-            TargetRegistry::getInstance()->getCGroupNames(cGroupNames);
-            for(std::string cGroupName : cGroupNames) {
-                char filePath[128];
-                snprintf(filePath, sizeof(filePath), resourceConfigInfo->mResourcePath.c_str(), cGroupName.c_str());
-                this->addDefaultValue(std::string(filePath), AuxRoutines::readFromFile(filePath));
-            }
-            break;
-        }
-        case APPLY_CORE: {
-            int32_t count = UrmSettings::targetConfigs.mTotalCoreCount;
-            for(int32_t coreID = 0; coreID < count; coreID++) {
-                char filePath[128];
-                snprintf(filePath, sizeof(filePath), resourceConfigInfo->mResourcePath.c_str(), (int32_t)coreID);
-                this->addDefaultValue(std::string(filePath), AuxRoutines::readFromFile(filePath));
-            }
-            break;
-        }
-        case APPLY_GLOBAL: {
-            this->addDefaultValue(resourceConfigInfo->mResourcePath,
-                                  AuxRoutines::readFromFile(resourceConfigInfo->mResourcePath));
-            break;
-        }
+void ResourceRegistry::captureDefaultValue(const std::string& filePath) {
+    if(filePath.length() == 0) return;
+    const std::lock_guard<std::mutex> lock(this->mDefaultValueStoreMutex);
+
+    // Only the first tune of a node captures its value, once a node has been
+    // tuned, the node no longer holds the original value.
+    if(this->mDefaultValueStore.find(filePath) != this->mDefaultValueStore.end()) {
+        return;
     }
+
+    std::string value = AuxRoutines::readFromFile(filePath);
+    this->mDefaultValueStore[filePath] = value;
+    NodeJournal::getInstance()->recordOriginalValue(filePath, value);
 }
 
 void ResourceRegistry::registerResource(ResConfInfo* resourceConfigInfo,
@@ -132,8 +103,9 @@ void ResourceRegistry::registerResource(ResConfInfo* resourceConfigInfo,
         this->mTotalResources++;
     }
 
+    // Note: Default values are not read here, they are captured lazily via
+    // captureDefaultValue when a node is tuned for the first time.
     this->setLifeCycleCallbacks(resourceConfigInfo);
-    this->fetchAndStoreDefaults(resourceConfigInfo);
 }
 
 void ResourceRegistry::displayResources() {
@@ -182,11 +154,19 @@ int32_t ResourceRegistry::getTotalResourcesCount() {
 }
 
 std::string ResourceRegistry::getDefaultValue(const std::string& filePath) {
-    return this->mDefaultValueStore[filePath];
+    const std::lock_guard<std::mutex> lock(this->mDefaultValueStoreMutex);
+
+    auto it = this->mDefaultValueStore.find(filePath);
+    if(it == this->mDefaultValueStore.end()) {
+        return "";
+    }
+    return it->second;
 }
 
 void ResourceRegistry::deleteDefaultValue(const std::string& filePath) {
+    const std::lock_guard<std::mutex> lock(this->mDefaultValueStoreMutex);
     this->mDefaultValueStore.erase(filePath);
+    NodeJournal::getInstance()->eraseNode(filePath);
 }
 
 void ResourceRegistry::pluginModifications() {
@@ -208,7 +188,36 @@ void ResourceRegistry::pluginModifications() {
     }
 }
 
+int32_t ResourceRegistry::identifySharedNodes() {
+    std::unordered_map<std::string, std::vector<ResConfInfo*>> resourcesByPath;
+    for(ResConfInfo* resourceConfig: this->mResourceConfigs) {
+        if(resourceConfig == nullptr) continue;
+        resourceConfig->mSharesNode = false;
+
+        if(resourceConfig->mResourcePath.length() == 0 ||
+           resourceConfig->mPolicy == Policy::PASS_THROUGH) {
+            continue;
+        }
+        resourcesByPath[resourceConfig->mResourcePath].push_back(resourceConfig);
+    }
+
+    int32_t sharedCount = 0;
+    for(std::pair<const std::string, std::vector<ResConfInfo*>>& entry: resourcesByPath) {
+        if(entry.second.size() < 2) continue;
+
+        for(ResConfInfo* resourceConfig: entry.second) {
+            resourceConfig->mSharesNode = true;
+            sharedCount++;
+        }
+        LOGI("RESTUNE_RESOURCE_REGISTRY",
+             "Node: " + entry.first + " is shared by " + std::to_string(entry.second.size()) + " Resources");
+    }
+
+    return sharedCount;
+}
+
 void ResourceRegistry::restoreResourcesToDefaultValues() {
+    const std::lock_guard<std::mutex> lock(this->mDefaultValueStoreMutex);
     for(std::pair<std::string, std::string> defaultConfig: this->mDefaultValueStore) {
         std::string filePath = defaultConfig.first;
         std::string value = defaultConfig.second;
@@ -238,6 +247,7 @@ ResourceConfigInfoBuilder::ResourceConfigInfoBuilder() {
     this->mResourceConfigInfo->mResourceResID = 0;
     this->mResourceConfigInfo->mResourceApplierCallback = nullptr;
     this->mResourceConfigInfo->mResourceTearCallback = nullptr;
+    this->mResourceConfigInfo->mSharesNode = false;
     this->mResourceConfigInfo->mModes = 0;
     this->mResourceConfigInfo->mHighThreshold = this->mResourceConfigInfo->mLowThreshold = -1;
     this->mResourceConfigInfo->mPermissions = PERMISSION_THIRD_PARTY;
@@ -5,6 +5,10 @@
 #define RESTUNE_REQUEST_RECEIVER_H
 
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unordered_map>
 #include <cstring>
 #include <fstream>
 #include <sstream>
@@ -14,10 +18,32 @@
 #include "RestuneInternal.h"
 #include "SignalInternal.h"
 #include "RestuneListener.h"
+#include "ShmListener.h"
 #include "UrmSettings.h"
 #include "AuxRoutines.h"
 #include "ComponentRegistry.h"
 
+/**
+ * @brief HandleLease
+ * @details A block of handles leased to a client connection, handles from the block
+ *          are accepted in increasing order only, hence each can be used at most once.
+ */
+typedef struct {
+    int64_t mNext;
+    int64_t mEnd;
+} HandleLease;
+
+/**
+ * @brief ClientLeases
+ * @details The handle leases held by a client socket. Socket fds are reused across connections,
+ *          hence every connection is tagged with a distinct generation, so that a Rejection notice
+ *          raised after the connection has gone away is never delivered to its successor.
+ */
+typedef struct {
+    uint64_t mGeneration;
+    std::vector<HandleLease> mLeases;
+} ClientLeases;
+
 /**
  * @brief RequestReceiver
  * @details Handles incoming client-requests, by forwarding the request to the
@@ -28,13 +54,41 @@ class RequestReceiver {
 private:
     static std::shared_ptr<RequestReceiver> mRequestReceiverInstance;
 
+    // Leases are tracked per client socket, channels negotiated over a socket share
+    // its leases. Granted and claimed on the Listener threads, the Request handlers
+    // only look up the connection generation, to report rejections. Nothing is ever
+    // sent to a client with the lock held.
+    std::mutex mLeasesMutex;
+    std::unordered_map<int32_t, ClientLeases> mHandleLeases;
+    uint64_t mLastLeaseGeneration;
+
     RequestReceiver();
 
+    int64_t dispatchRequest(int32_t clientSocket, MsgForwardInfo* info);
+    void dispatchBatch(int32_t clientSocket, MsgForwardInfo* info);
+
+    int32_t getLeaseOwner(int32_t clientSocket);
+    int64_t grantHandleLease(int32_t clientSocket);
+    uint64_t claimLeasedHandle(int32_t clientSocket, int64_t handle);
+
 public:
     static ThreadPool* mRequestsThreadPool;
 
     void forwardMessage(int32_t clientSocket, MsgForwardInfo* msgForwardInfo);
 
+    /**
+     * @brief Revoke all the handle leases held by a client socket, once it is closed.
+     */
+    void releaseHandleLeases(int32_t clientSocket);
+
+    /**
+     * @brief Notify the client of a Request issued with a leased handle, which was rejected
+     *        after being dispatched (by the verifier, the rate limiter and so on).
+     * @details Requests with a handle assigned by the Server are not affected, the notice
+     *          is dropped if the connection the Request was received over has since gone away.
+     */
+    void notifyLeasedRejection(MsgForwardInfo* info);
+
     static std::shared_ptr<RequestReceiver> getInstance() {
         if(mRequestReceiverInstance == nullptr) {
             mRequestReceiverInstance = std::shared_ptr<RequestReceiver>(new RequestReceiver());
@@ -13,6 +13,12 @@
 #include <fcntl.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
 
 #include "MemoryPool.h"
 #include "Request.h"
@@ -25,14 +31,81 @@
 
 #define RESTUNE_SOCKET_PATH "/run/restune_sock"
 
+// Every message exchanged over a connection is framed as: [uint32_t payload length][payload]
+#define RESTUNE_MAX_FRAME_SIZE REQ_BATCH_BUFFER_SIZE
+
+// Upper bound on the fds which can be passed (SCM_RIGHTS) in a single message.
+#define RESTUNE_MAX_PASSED_FDS 4
+
+// Reads performed on a connection per wakeup, a client which keeps writing is picked
+// up again on the next epoll_wait instead of holding up the Listener thread.
+#define RESTUNE_MAX_READS_PER_WAKEUP 16
+
 static const uint32_t maxEvents = 128;
 
+/**
+ * @brief ClientConnection
+ * @details A connection accepted by the SocketServer. Replies are not only sent from the Listener
+ *          thread, hence the connection is shared: its fd is closed once the last reference to it
+ *          is released, so that the fd is never reused while a reply is being sent on it.
+ */
+typedef struct {
+    int32_t mFd;
+    std::atomic<int8_t> mFailed; //!< Set once a send fails, the Listener then drops the connection.
+    std::mutex mSendMutex; //!< Held while a frame is sent, frames are never interleaved.
+} ClientConnection;
+
+/**
+ * @brief Allocate a MsgForwardInfo (from the Memory Pool) holding a copy of the given payload.
+ * @return MsgForwardInfo*:\n
+ *            - Pointer to the allocated MsgForwardInfo\n
+ *            - nullptr: If the payload is too large, or the allocation failed
+ */
+MsgForwardInfo* createForwardInfo(const char* payload, uint32_t payloadSize);
+
+/**
+ * @brief Fetch the Kernel-reported credentials of the process at the other end of the connection.
+ * @details The permission level is derived from the effective UID at connect time, hence it only
+ *          needs to be fetched once per connection.
+ * @return int8_t:\n
+ *            - 1: If the credentials were fetched\n
+ *            - 0: Otherwise, all the fields of the identity are set to -1
+ */
+int8_t fetchPeerIdentity(int32_t clientSocket, PeerIdentity& identity);
+
+/**
+ * @brief SocketServer
+ * @details Client connections are long-lived, once accepted a connection is registered in the epoll
+ *          set and remains open until the client closes it. Multiple Requests can be in flight on a
+ *          connection at a time, they are dispatched in the order in which they were received.
+ */
 class SocketServer : public ServerEndpoint {
 private:
     int32_t sockFd;
+    int32_t epollFd;
     ServerOnlineCheckCallback mServerOnlineCheckCb;
     MessageReceivedCallback mMessageRecvCb;
 
+    // Bytes received on each client connection, which do not form a complete frame yet.
+    std::unordered_map<int32_t, std::string> mPendingBytes;
+
+    // fds passed by each client, which have not yet been claimed by a Request.
+    std::unordered_map<int32_t, std::vector<int32_t>> mPendingFds;
+
+    // Identity of each client connection, fetched once when the connection is accepted.
+    std::unordered_map<int32_t, PeerIdentity> mPeerIdentities;
+
+    // Connections accepted, and not yet dropped by the Listener.
+    static std::mutex mConnectionsMutex;
+    static std::unordered_map<int32_t, std::shared_ptr<ClientConnection>> mConnections;
+
+    int8_t acceptClients();
+    int8_t readFromClient(int32_t clientSocket);
+    int8_t dispatchFrames(int32_t clientSocket);
+    void attachShmChannel(int32_t clientSocket);
+    void dropClient(int32_t clientSocket);
+    void releaseConnection(int32_t clientSocket);
+
 public:
     SocketServer(
         ServerOnlineCheckCallback mServerOnlineCheckCb,
@@ -42,6 +115,32 @@ public:
 
     virtual int32_t ListenForClientRequests();
     virtual int32_t closeConnection();
+
+    /**
+     * @brief Get the connection accepted on the given fd.
+     * @return std::shared_ptr<ClientConnection>:\n
+     *            - The connection, its fd stays open for as long as the reference is held\n
+     *            - nullptr: If no such connection exists
+     */
+    static std::shared_ptr<ClientConnection> getConnection(int32_t clientSocket);
+
+    /**
+     * @brief Send a framed message on the given client connection.
+     * @details Replies are matched to Requests by the client in order, hence if the message could
+     *          not be sent in its entirety, the connection is shut down (and dropped by the Listener).
+     * @return int8_t:\n
+     *            - 1: If the entire message was sent\n
+     *            - 0: Otherwise
+     */
+    static int8_t sendFrame(int32_t clientSocket, const void* buf, uint32_t bufSize);
+    static int8_t sendFrame(const std::shared_ptr<ClientConnection>& connection, const void* buf, uint32_t bufSize);
+
+    /**
+     * @brief Shut the connection down, once the replies on it can no longer be delivered in order.
+     * @details Can be called from any thread, the Listener drops the connection (along with the
+     *          channels negotiated over it) once it sees the hang up, and the client reconnects.
+     */
+    static void failConnection(const std::shared_ptr<ClientConnection>& connection);
 };
 
 #endif
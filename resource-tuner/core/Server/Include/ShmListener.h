@@ -0,0 +1,133 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#ifndef RESTUNE_SHM_LISTENER_H
+#define RESTUNE_SHM_LISTENER_H
+
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <sys/epoll.h>
+
+#include "ServerEndpoint.h"
+#include "RestuneListener.h"
+#include "ShmRing.h"
+#include "ErrCodes.h"
+#include "Logger.h"
+
+/**
+ * @brief ShmChannel
+ * @details A client's shared-memory region along with its doorbells. The channel is identified by
+ *          the Server-side fd of its Request doorbell, which is used in place of the client socket
+ *          when forwarding Requests, hence channel and socket identifiers never collide.
+ */
+typedef struct {
+    int32_t mOwnerSocket; //!< The socket over which the channel was negotiated.
+    std::shared_ptr<ClientConnection> mOwner; //!< The owner socket's connection, if accepted by the Listener.
+    int32_t mMemFd;
+    int32_t mRequestDoorbell;
+    int32_t mResponseDoorbell;
+    ShmRegion* mRegion;
+    PeerIdentity mPeer; //!< Identity of the owner socket, Requests drained from the channel carry it.
+    std::mutex mReplyMutex; //!< Serializes the producers of the Response ring.
+} ShmChannel;
+
+/**
+ * @brief ShmServer
+ * @details Server side of the shared-memory transport. Channels are negotiated over the socket
+ *          (see SocketServer), after which Requests are drained directly from the client's ring.
+ *          The channel is torn down when the socket it was negotiated over is closed.
+ */
+class ShmServer : public ServerEndpoint {
+private:
+    static std::shared_ptr<ShmServer> mShmServerInstance;
+    static std::mutex instanceProtectionLock;
+
+    int32_t epollFd;
+    ServerOnlineCheckCallback mServerOnlineCheckCb;
+    MessageReceivedCallback mMessageRecvCb;
+
+    std::mutex mChannelsMutex;
+    std::unordered_map<int32_t, std::shared_ptr<ShmChannel>> mChannels;
+
+    ShmServer();
+
+    void drainChannel(std::shared_ptr<ShmChannel> channel);
+    void detachChannel(const std::shared_ptr<ShmChannel>& channel);
+
+public:
+    ~ShmServer();
+
+    void setCallbacks(ServerOnlineCheckCallback mServerOnlineCheckCb,
+                      MessageReceivedCallback mMessageRecvCb);
+
+    /**
+     * @brief Map a client's region and start draining its Request ring.
+     * @details Takes ownership of the supplied fds, they are closed if the channel is rejected.
+     * @param ownerSocket Socket over which the channel was negotiated.
+     * @param memFd Sealed memfd holding the ShmRegion.
+     * @param requestDoorbell eventfd signalled by the client after publishing a Request.
+     * @param responseDoorbell eventfd signalled by the Server after publishing a Response.
+     * @return int32_t:\n
+     *            - Channel ID, if the channel was attached\n
+     *            - -1: Otherwise
+     */
+    int32_t attachChannel(int32_t ownerSocket, int32_t memFd, int32_t requestDoorbell, int32_t responseDoorbell);
+
+    /**
+     * @brief Detach all the channels negotiated over the given socket.
+     */
+    void detachOwner(int32_t ownerSocket);
+
+    int8_t isChannel(int32_t channelId);
+
+    /**
+     * @brief Get the channel with the given ID.
+     * @return std::shared_ptr<ShmChannel>:\n
+     *            - The channel, it is not released for as long as the reference is held\n
+     *            - nullptr: If no such channel exists
+     */
+    std::shared_ptr<ShmChannel> getChannel(int32_t channelId);
+
+    /**
+     * @brief Get the socket over which the given channel was negotiated.
+     * @return int32_t:\n
+     *            - The owner socket\n
+     *            - -1: If no such channel exists
+     */
+    int32_t getOwnerSocket(int32_t channelId);
+
+    /**
+     * @brief Publish a Response to the client on the given channel.
+     * @details If the Response ring is full, the client would pair the Responses which follow with
+     *          the wrong Requests, hence the channel is detached, and its owner socket shut down.
+     * @return int8_t:\n
+     *            - 1: If the Response was published\n
+     *            - 0: Otherwise
+     */
+    int8_t sendReply(int32_t channelId, const void* buf, uint32_t bufSize);
+    int8_t sendReply(const std::shared_ptr<ShmChannel>& channel, const void* buf, uint32_t bufSize);
+
+    int32_t getChannelsCount();
+
+    virtual int32_t ListenForClientRequests();
+    virtual int32_t closeConnection();
+
+    static std::shared_ptr<ShmServer> getInstance() {
+        if(mShmServerInstance == nullptr) {
+            instanceProtectionLock.lock();
+            if(mShmServerInstance == nullptr) {
+                try {
+                    mShmServerInstance = std::shared_ptr<ShmServer> (new ShmServer());
+                } catch(const std::bad_alloc& e) {
+                    instanceProtectionLock.unlock();
+                    return nullptr;
+                }
+            }
+            instanceProtectionLock.unlock();
+        }
+        return mShmServerInstance;
+    }
+};
+
+#endif
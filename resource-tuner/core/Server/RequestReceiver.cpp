@@ -6,52 +6,375 @@
 std::shared_ptr<RequestReceiver> RequestReceiver::mRequestReceiverInstance = nullptr;
 ThreadPool* RequestReceiver::mRequestsThreadPool = nullptr;
 
-RequestReceiver::RequestReceiver() {}
+RequestReceiver::RequestReceiver() {
+    this->mLastLeaseGeneration = 0;
+}
 
-void RequestReceiver::forwardMessage(int32_t clientSocket, MsgForwardInfo* info) {
-    int8_t moduleID = *(int8_t*) info->mBuffer;
-    int8_t requestType = *(int8_t*) ((unsigned char*) info->mBuffer + sizeof(int8_t));
+// Replies go back over the transport the Request arrived on.
+static int8_t replyToClient(int32_t clientId, const void* buf, uint32_t bufSize) {
+    if(ShmServer::getInstance()->isChannel(clientId)) {
+        return ShmServer::getInstance()->sendReply(clientId, buf, bufSize);
+    }
+    return SocketServer::sendFrame(clientId, buf, bufSize);
+}
 
-    info->mModuleID = moduleID;
-    info->mRequestType = requestType;
+// Prop Get Requests are lightweight, and hence served directly on the Listener thread.
+static void servePropGetRequest(int32_t clientSocket, MsgForwardInfo* info) {
+    // Encoding: [Module ID][Request Type][Null-terminated Prop Name][uint64_t Result Buffer Size]
+    char* propStart = info->mBuffer + 2 * sizeof(int8_t);
+    size_t maxPropLength = 0;
+    if(info->mPayloadSize > 2 * sizeof(int8_t) + sizeof(uint64_t)) {
+        maxPropLength = info->mPayloadSize - 2 * sizeof(int8_t) - sizeof(uint64_t);
+    }
+    size_t propLength = strnlen(propStart, maxPropLength);
 
-    info->mHandle = AuxRoutines::generateUniqueHandle();
-    if(info->mHandle < 0) {
-        // Handle Generation Failure
-        LOGE("RESTUNE_REQUEST_RECEIVER", "Failed to Generate Request handle");
-        return;
+    std::string result = "na";
+    if(propLength < maxPropLength) {
+        std::string propName(propStart, propLength);
+        uint64_t resultBufSize = 0;
+        std::memcpy(&resultBufSize, propStart + propLength + 1, sizeof(uint64_t));
+
+        submitPropGetRequest(propName, result, "na");
+        if(resultBufSize > 0 && result.length() >= resultBufSize) {
+            result.resize(resultBufSize - 1);
+        }
+    }
+
+    // Include the null terminator in the reply.
+    if(!replyToClient(clientSocket, result.c_str(), result.length() + 1)) {
+        LOGE("RESTUNE_REQUEST_RECEIVER", "Failed to send the Prop Get result to the client");
+    }
+}
+
+static int8_t isTuneRequest(int8_t requestType) {
+    return requestType == REQ_RESOURCE_TUNING || requestType == REQ_SIGNAL_TUNING;
+}
+
+// Tune Requests carry the handle the client assigned from its lease, if any (0 otherwise).
+// The handle is the first field following the header, refer WireFormat.h
+static int64_t getLeasedHandle(MsgForwardInfo* info, int8_t requestType) {
+    if(!isTuneRequest(requestType)) return 0;
+
+    try {
+        WireReader reader(info->mBuffer, info->mPayloadSize);
+        for(int32_t i = 0; i < WIRE_HEADER_SIZE; i++) {
+            reader.readByte();
+        }
+        return reader.readSignedVarint();
+
+    } catch(const std::invalid_argument& e) {
+        // Malformed, left for the deserializer to reject.
+        return 0;
+    }
+}
+
+static void notifyRejection(int32_t clientSocket, int64_t handle) {
+    int64_t notice[2] = {REQ_REJECTION_MARKER, handle};
+    if(!replyToClient(clientSocket, notice, sizeof(notice))) {
+        LOGE("RESTUNE_REQUEST_RECEIVER", "Failed to notify the client of the rejected Request");
+    }
+}
+
+int32_t RequestReceiver::getLeaseOwner(int32_t clientSocket) {
+    int32_t ownerSocket = ShmServer::getInstance()->getOwnerSocket(clientSocket);
+    return ownerSocket >= 0 ? ownerSocket : clientSocket;
+}
+
+int64_t RequestReceiver::grantHandleLease(int32_t clientSocket) {
+    int64_t firstHandle = AuxRoutines::reserveHandleRange(HANDLE_LEASE_SIZE);
+    if(firstHandle < 0) {
+        LOGE("RESTUNE_REQUEST_RECEIVER", "Failed to reserve a handle lease");
+        return -1;
+    }
+
+    const std::lock_guard<std::mutex> lock(this->mLeasesMutex);
+    ClientLeases& clientLeases = this->mHandleLeases[this->getLeaseOwner(clientSocket)];
+    if(clientLeases.mGeneration == 0) {
+        clientLeases.mGeneration = ++this->mLastLeaseGeneration;
+    }
+
+    std::vector<HandleLease>& leases = clientLeases.mLeases;
+
+    // Drop exhausted leases, and if still at the limit, the oldest one.
+    for(auto it = leases.begin(); it != leases.end();) {
+        it = (it->mNext >= it->mEnd) ? leases.erase(it) : it + 1;
     }
+    if(leases.size() >= HANDLE_LEASE_MAX_PER_CLIENT) {
+        leases.erase(leases.begin());
+    }
+
+    leases.push_back({firstHandle, firstHandle + HANDLE_LEASE_SIZE});
+    return firstHandle;
+}
+
+// Returns the generation of the connection holding the lease, 0 if the handle was not leased to it.
+uint64_t RequestReceiver::claimLeasedHandle(int32_t clientSocket, int64_t handle) {
+    const std::lock_guard<std::mutex> lock(this->mLeasesMutex);
+
+    auto it = this->mHandleLeases.find(this->getLeaseOwner(clientSocket));
+    if(it == this->mHandleLeases.end()) {
+        return 0;
+    }
+
+    for(HandleLease& lease: it->second.mLeases) {
+        if(handle >= lease.mNext && handle < lease.mEnd) {
+            lease.mNext = handle + 1;
+            return it->second.mGeneration;
+        }
+    }
+
+    return 0;
+}
+
+void RequestReceiver::releaseHandleLeases(int32_t clientSocket) {
+    const std::lock_guard<std::mutex> lock(this->mLeasesMutex);
+    this->mHandleLeases.erase(clientSocket);
+}
+
+void RequestReceiver::notifyLeasedRejection(MsgForwardInfo* info) {
+    if(info == nullptr || info->mLeaseGeneration == 0) return;
+
+    // The transport is resolved with the lock held: the Listener revokes the leases before
+    // releasing the connection, hence if the generation matches, the connection (or channel)
+    // is the one the Request was received over. The reference taken keeps its fd from being
+    // reused, so the notice is sent once the lock is released.
+    std::shared_ptr<ShmChannel> channel = nullptr;
+    std::shared_ptr<ClientConnection> connection = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(this->mLeasesMutex);
+
+        channel = ShmServer::getInstance()->getChannel(info->mClientId);
+        int32_t ownerSocket = (channel != nullptr) ? channel->mOwnerSocket : info->mClientId;
+
+        auto it = this->mHandleLeases.find(ownerSocket);
+        if(it == this->mHandleLeases.end() || it->second.mGeneration != info->mLeaseGeneration) {
+            return;
+        }
+
+        if(channel == nullptr) {
+            connection = SocketServer::getConnection(info->mClientId);
+        }
+    }
+
+    int64_t notice[2] = {REQ_REJECTION_MARKER, info->mHandle};
+    int8_t notified = false;
+    if(channel != nullptr) {
+        notified = ShmServer::getInstance()->sendReply(channel, notice, sizeof(notice));
+    } else if(connection != nullptr) {
+        notified = SocketServer::sendFrame(connection, notice, sizeof(notice));
+    } else {
+        // Not accepted by the Listener (for example, one end of a socketpair).
+        notified = SocketServer::sendFrame(info->mClientId, notice, sizeof(notice));
+    }
+
+    if(!notified) {
+        LOGE("RESTUNE_REQUEST_RECEIVER", "Failed to notify the client of the rejected Request");
+    }
+}
+
+int64_t RequestReceiver::dispatchRequest(int32_t clientSocket, MsgForwardInfo* info) {
+    info->mModuleID = *(int8_t*) info->mBuffer;
+    info->mRequestType = *(int8_t*) ((unsigned char*) info->mBuffer + sizeof(int8_t));
 
     if(this->mRequestsThreadPool == nullptr) {
         LOGE("URM_SERVER_ENDPOINT", "Thread pool not initialized, Dropping the Request");
-        return;
+        freeForwardInfo(info);
+        return -1;
+    }
+
+    if(info->mPayloadSize < WIRE_HEADER_SIZE || info->mBuffer[2 * sizeof(int8_t)] != WIRE_FORMAT_VERSION) {
+        LOGE("RESTUNE_REQUEST_RECEIVER", "Unsupported wire format version, Dropping the Request");
+        freeForwardInfo(info);
+        return -1;
     }
 
+    info->mClientId = clientSocket;
+    info->mLeaseGeneration = 0;
+
+    int64_t leasedHandle = getLeasedHandle(info, info->mRequestType);
+    if(leasedHandle > 0) {
+        // Handle assigned by the client, it must come from one of its own leases.
+        info->mLeaseGeneration = this->claimLeasedHandle(clientSocket, leasedHandle);
+        if(info->mLeaseGeneration == 0) {
+            LOGE("RESTUNE_REQUEST_RECEIVER", "Handle not leased to the client, Dropping the Request");
+            freeForwardInfo(info);
+            return -1;
+        }
+        info->mHandle = leasedHandle;
+    } else {
+        info->mHandle = AuxRoutines::generateUniqueHandle();
+    }
+
+    if(info->mHandle < 0) {
+        // Handle Generation Failure
+        LOGE("RESTUNE_REQUEST_RECEIVER", "Failed to Generate Request handle");
+        freeForwardInfo(info);
+        return -1;
+    }
+
+    // Once enqueued, info is owned by the Thread Pool and can be freed at any point.
+    int64_t handle = info->mHandle;
+    int8_t enqueued = false;
+
     // Enqueue the Request to the Thread Pool for async processing.
     switch(info->mRequestType) {
+        case REQ_RESOURCE_RETUNING: {
+            // Admitting a Retune is lightweight, hence it is done on the Listener thread,
+            // so that the outcome can be reported back to the client.
+            return admitResProvisionReqMsg(info) ? handle : -1;
+        }
+
         case REQ_RESOURCE_TUNING:
-        case REQ_RESOURCE_RETUNING:
         case REQ_RESOURCE_UNTUNING: {
-            if(!this->mRequestsThreadPool->enqueueTask(submitResProvisionReqMsg, info)) {
-                LOGE("URM_SERVER_ENDPOINT", "Failed to enqueue the Request to the Thread Pool");
-            }
+            enqueued = this->mRequestsThreadPool->enqueueTask(submitResProvisionReqMsg, info);
             break;
         }
 
         case REQ_SIGNAL_TUNING:
         case REQ_SIGNAL_UNTUNING:
         case REQ_SIGNAL_RELAY: {
-            if(!this->mRequestsThreadPool->enqueueTask(submitSignalRequest, info)) {
-                LOGE("URM_SERVER_ENDPOINT", "Failed to enqueue the Request to the Thread Pool");
-            }
+            enqueued = this->mRequestsThreadPool->enqueueTask(submitSignalRequest, info);
+            break;
+        }
+
+        default: {
+            freeForwardInfo(info);
+            return -1;
+        }
+    }
+
+    if(!enqueued) {
+        LOGE("URM_SERVER_ENDPOINT", "Failed to enqueue the Request to the Thread Pool");
+        freeForwardInfo(info);
+        return -1;
+    }
+
+    return handle;
+}
+
+// Unpack the batch and fan the Requests out into the pipeline in a single pass.
+// The handles of all the Requests are returned to the client in a single reply,
+// in batch order. Requests other than tune Requests report 0 if accepted.
+void RequestReceiver::dispatchBatch(int32_t clientSocket, MsgForwardInfo* info) {
+    int64_t handles[REQ_BATCH_MAX_COUNT];
+    int32_t count = 0;
+    if(info->mPayloadSize >= 2 * sizeof(int8_t) + sizeof(int32_t)) {
+        std::memcpy(&count, info->mBuffer + 2 * sizeof(int8_t), sizeof(int32_t));
+    }
+
+    if(count <= 0 || count > REQ_BATCH_MAX_COUNT) {
+        LOGE("RESTUNE_REQUEST_RECEIVER", "Invalid batch size: " + std::to_string(count));
+        count = 0;
+    }
+
+    for(int32_t i = 0; i < count; i++) {
+        handles[i] = -1;
+    }
+
+    uint64_t offset = 2 * sizeof(int8_t) + sizeof(int32_t);
+    for(int32_t i = 0; i < count; i++) {
+        uint32_t reqSize = 0;
+        if(offset + sizeof(uint32_t) > info->mPayloadSize) break;
+        std::memcpy(&reqSize, info->mBuffer + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+
+        if(reqSize < 2 * sizeof(int8_t) || reqSize > REQ_BUFFER_SIZE || offset + reqSize > info->mPayloadSize) {
+            LOGE("RESTUNE_REQUEST_RECEIVER", "Malformed batch, dropping the remaining Requests");
             break;
         }
+
+        const char* reqStart = info->mBuffer + offset;
+        offset += reqSize;
+
+        int8_t requestType = reqStart[sizeof(int8_t)];
+        if(requestType == REQ_PROP_GET || requestType == REQ_BATCH) {
+            continue;
+        }
+
+        MsgForwardInfo* reqInfo = nullptr;
+        try {
+            reqInfo = new (GetBlock<MsgForwardInfo>()) MsgForwardInfo;
+            reqInfo->mBuffer = allocReqBuffer(reqSize, reqInfo->mBufferSize);
+            reqInfo->mPayloadSize = reqSize;
+
+        } catch(const std::bad_alloc& e) {
+            FreeBlock<MsgForwardInfo>(reqInfo);
+            continue;
+        }
+
+        std::memcpy(reqInfo->mBuffer, reqStart, reqSize);
+
+        int64_t handle = this->dispatchRequest(clientSocket, reqInfo);
+        if(handle >= 0 && !isTuneRequest(requestType)) {
+            handle = 0;
+        }
+        handles[i] = handle;
+    }
+
+    freeForwardInfo(info);
+
+    if(!replyToClient(clientSocket, handles, count * sizeof(int64_t))) {
+        LOGE("RESTUNE_REQUEST_RECEIVER", "Failed to send the batch handles to the client");
+    }
+}
+
+void RequestReceiver::forwardMessage(int32_t clientSocket, MsgForwardInfo* info) {
+    int8_t requestType = *(int8_t*) ((unsigned char*) info->mBuffer + sizeof(int8_t));
+
+    if(requestType == REQ_PROP_GET) {
+        servePropGetRequest(clientSocket, info);
+        freeForwardInfo(info);
+        return;
+    }
+
+    if(requestType == REQ_BATCH) {
+        this->dispatchBatch(clientSocket, info);
+        return;
+    }
+
+    if(requestType == REQ_HANDLE_LEASE) {
+        freeForwardInfo(info);
+        int64_t firstHandle = this->grantHandleLease(clientSocket);
+        if(!replyToClient(clientSocket, &firstHandle, sizeof(int64_t))) {
+            LOGE("RESTUNE_REQUEST_RECEIVER", "Failed to send the handle lease to the client");
+        }
+        return;
+    }
+
+    if(info->mPayloadSize > REQ_BUFFER_SIZE) {
+        // Only batches are allowed to exceed the Request buffer size.
+        LOGE("RESTUNE_REQUEST_RECEIVER", "Request Size exceeds max capacity, Dropping the Request");
+        freeForwardInfo(info);
+        return;
+    }
+
+    // Info is owned by the Thread Pool once dispatched.
+    int64_t leasedHandle = getLeasedHandle(info, requestType);
+    int64_t handle = this->dispatchRequest(clientSocket, info);
+
+    // Clients do not wait on Requests issued with a leased handle, only rejections are reported.
+    // Rejections past this point are reported by the handlers, refer notifyLeasedRejection.
+    if(leasedHandle > 0) {
+        if(handle < 0) {
+            notifyRejection(clientSocket, leasedHandle);
+        }
+        return;
     }
 
     // Only in Case of Tune Requests, Write back the handle to the client.
-    if(requestType == REQ_RESOURCE_TUNING || requestType == REQ_SIGNAL_TUNING) {
-        if(write(clientSocket, (const void*)&info->mHandle, sizeof(int64_t)) == -1) {
-            TYPELOGV(ERRNO_LOG, "write", strerror(errno));
+    // The connection is persistent, hence the handle is framed like any other message,
+    // and is written back even on failure so that the client is not left waiting.
+    if(isTuneRequest(requestType)) {
+        if(!replyToClient(clientSocket, &handle, sizeof(int64_t))) {
+            LOGE("RESTUNE_REQUEST_RECEIVER", "Failed to send the Request handle to the client");
+        }
+    }
+
+    // Retunes are answered with their status, 0 if accepted and -1 otherwise.
+    if(requestType == REQ_RESOURCE_RETUNING) {
+        int64_t status = (handle < 0) ? -1 : 0;
+        if(!replyToClient(clientSocket, &status, sizeof(int64_t))) {
+            LOGE("RESTUNE_REQUEST_RECEIVER", "Failed to send the Retune status to the client");
         }
     }
 }
@@ -65,8 +388,22 @@ void onMsgRecvCallback(int32_t clientSocket, MsgForwardInfo* msgForwardInfo) {
     requestReceiver->forwardMessage(clientSocket, msgForwardInfo);
 }
 
+static void shmListenerThreadStartRoutine() {
+    std::shared_ptr<ShmServer> shmServer = ShmServer::getInstance();
+    if(shmServer == nullptr) {
+        return;
+    }
+
+    shmServer->setCallbacks(checkServerOnlineStatus, onMsgRecvCallback);
+    if(RC_IS_NOTOK(shmServer->ListenForClientRequests())) {
+        LOGE("URM_SERVER_ENDPOINT", "Shared Memory Endpoint could not be started");
+    }
+    shmServer->closeConnection();
+}
+
 void listenerThreadStartRoutine() {
     SocketServer* connection = nullptr;
+    std::thread shmListener;
 
     try {
         connection = new SocketServer(checkServerOnlineStatus, onMsgRecvCallback);
@@ -76,6 +413,13 @@ void listenerThreadStartRoutine() {
         return;
     }
 
+    // Channels negotiated over the socket are drained on a dedicated thread.
+    try {
+        shmListener = std::thread(shmListenerThreadStartRoutine);
+    } catch(const std::system_error& e) {
+        TYPELOGV(SYSTEM_THREAD_CREATION_FAILURE, "resource-tuner-shm-listener", e.what());
+    }
+
     if(RC_IS_NOTOK(connection->ListenForClientRequests())) {
         LOGE("URM_SERVER_ENDPOINT", "Server Socket Endpoint crashed");
     }
@@ -83,4 +427,8 @@ void listenerThreadStartRoutine() {
     if(connection != nullptr) {
         delete(connection);
     }
+
+    if(shmListener.joinable()) {
+        shmListener.join();
+    }
 }
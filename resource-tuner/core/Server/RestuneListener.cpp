@@ -1,24 +1,368 @@
 // Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
 // SPDX-License-Identifier: BSD-3-Clause-Clear
 
+#include <poll.h>
+#include <cstring>
+#include <algorithm>
+#include <mutex>
+
 #include "RestuneListener.h"
+#include "ShmListener.h"
+#include "RequestReceiver.h"
 
 #ifndef UNIX_PATH_MAX
 #define UNIX_PATH_MAX sizeof(((struct sockaddr_un *)0)->sun_path)
 #endif
 
+std::mutex SocketServer::mConnectionsMutex {};
+std::unordered_map<int32_t, std::shared_ptr<ClientConnection>> SocketServer::mConnections {};
+
+static void closeClientConnection(ClientConnection* connection) {
+    close(connection->mFd);
+    delete connection;
+}
+
 SocketServer::SocketServer(
     ServerOnlineCheckCallback mServerOnlineCheckCb,
     MessageReceivedCallback mMessageRecvCb) {
 
     this->sockFd = -1;
+    this->epollFd = -1;
     this->mServerOnlineCheckCb = mServerOnlineCheckCb;
     this->mMessageRecvCb = mMessageRecvCb;
 }
 
+std::shared_ptr<ClientConnection> SocketServer::getConnection(int32_t clientSocket) {
+    const std::lock_guard<std::mutex> lock(mConnectionsMutex);
+
+    auto it = mConnections.find(clientSocket);
+    if(it == mConnections.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+static int8_t writeFrame(int32_t clientSocket, const void* buf, uint32_t bufSize) {
+    if(clientSocket < 0 || buf == nullptr) return false;
+
+    char frame[sizeof(uint32_t) + RESTUNE_MAX_FRAME_SIZE];
+    if(bufSize > RESTUNE_MAX_FRAME_SIZE) return false;
+
+    std::memcpy(frame, &bufSize, sizeof(uint32_t));
+    std::memcpy(frame + sizeof(uint32_t), buf, bufSize);
+
+    size_t totalSize = sizeof(uint32_t) + bufSize;
+    size_t bytesSent = 0;
+
+    while(bytesSent < totalSize) {
+        ssize_t curSent = send(clientSocket, frame + bytesSent, totalSize - bytesSent, MSG_NOSIGNAL);
+        if(curSent < 0) {
+            if(errno == EINTR) continue;
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Client connections are non-blocking, wait briefly for the socket to drain.
+                struct pollfd pfd = {clientSocket, POLLOUT, 0};
+                if(poll(&pfd, 1, 100) > 0) continue;
+            }
+            TYPELOGV(ERRNO_LOG, "send", strerror(errno));
+            return false;
+        }
+        bytesSent += curSent;
+    }
+
+    return true;
+}
+
+int8_t SocketServer::sendFrame(const std::shared_ptr<ClientConnection>& connection,
+                               const void* buf,
+                               uint32_t bufSize) {
+    if(connection == nullptr || connection->mFailed.load()) return false;
+
+    // Frames are mostly sent from the Listener thread, but Rejection notices are sent from the
+    // Request handlers as well, a frame must not be interleaved with another on the same socket.
+    // A client which does not read only ever holds up the senders to itself.
+    const std::lock_guard<std::mutex> lock(connection->mSendMutex);
+    if(!writeFrame(connection->mFd, buf, bufSize)) {
+        // Part of the frame might have been written, and either way the client would pair the
+        // replies which follow with the wrong Requests.
+        failConnection(connection);
+        return false;
+    }
+
+    return true;
+}
+
+void SocketServer::failConnection(const std::shared_ptr<ClientConnection>& connection) {
+    if(connection == nullptr) return;
+
+    // No further Requests are taken from the connection in the meantime.
+    connection->mFailed.store(true);
+    shutdown(connection->mFd, SHUT_RDWR);
+}
+
+int8_t SocketServer::sendFrame(int32_t clientSocket, const void* buf, uint32_t bufSize) {
+    std::shared_ptr<ClientConnection> connection = getConnection(clientSocket);
+    if(connection == nullptr) {
+        // Not accepted by the Listener (for example, one end of a socketpair).
+        return writeFrame(clientSocket, buf, bufSize);
+    }
+    return sendFrame(connection, buf, bufSize);
+}
+
+int8_t SocketServer::acceptClients() {
+    // Process all the connections in the backlog
+    while(true) {
+        int32_t clientSocket = accept4(this->sockFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(clientSocket < 0) {
+            if(errno == EINTR) continue;
+            if(errno != EAGAIN && errno != EWOULDBLOCK) {
+                TYPELOGV(ERRNO_LOG, "accept", strerror(errno));
+                return false;
+            }
+            // No more clients to accept, Backlog is completely drained.
+            return true;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = clientSocket;
+        if(epoll_ctl(this->epollFd, EPOLL_CTL_ADD, clientSocket, &event) < 0) {
+            TYPELOGV(ERRNO_LOG, "epoll_ctl", strerror(errno));
+            close(clientSocket);
+            continue;
+        }
+
+        ClientConnection* connection = nullptr;
+        try {
+            connection = new ClientConnection;
+        } catch(const std::bad_alloc& e) {
+            epoll_ctl(this->epollFd, EPOLL_CTL_DEL, clientSocket, nullptr);
+            close(clientSocket);
+            continue;
+        }
+
+        connection->mFd = clientSocket;
+        connection->mFailed.store(false);
+        {
+            const std::lock_guard<std::mutex> lock(mConnectionsMutex);
+            mConnections[clientSocket] = std::shared_ptr<ClientConnection>(connection, closeClientConnection);
+        }
+
+        this->mPendingBytes[clientSocket] = "";
+        fetchPeerIdentity(clientSocket, this->mPeerIdentities[clientSocket]);
+    }
+}
+
+int8_t fetchPeerIdentity(int32_t clientSocket, PeerIdentity& identity) {
+    struct ucred credentials;
+    socklen_t credentialsSize = sizeof(credentials);
+
+    identity.mPID = identity.mUID = identity.mLevel = -1;
+    if(getsockopt(clientSocket, SOL_SOCKET, SO_PEERCRED, &credentials, &credentialsSize) < 0) {
+        TYPELOGV(ERRNO_LOG, "getsockopt", strerror(errno));
+        return false;
+    }
+
+    identity.mPID = credentials.pid;
+    identity.mUID = credentials.uid;
+    identity.mLevel = (credentials.uid == 0) ? PERMISSION_SYSTEM : PERMISSION_THIRD_PARTY;
+    return true;
+}
+
+MsgForwardInfo* createForwardInfo(const char* payload, uint32_t payloadSize) {
+    MsgForwardInfo* info = nullptr;
+
+    // Only batched Requests are allowed to exceed the regular Request buffer,
+    // the receiver validates this based on the payload size.
+    if(payloadSize > REQ_BATCH_BUFFER_SIZE) {
+        return nullptr;
+    }
+
+    try {
+        info = new (GetBlock<MsgForwardInfo>()) MsgForwardInfo;
+        info->mPeer.mPID = info->mPeer.mUID = info->mPeer.mLevel = -1;
+        info->mBuffer = allocReqBuffer(payloadSize, info->mBufferSize);
+        info->mPayloadSize = payloadSize;
+
+    } catch(const std::bad_alloc& e) {
+        FreeBlock<MsgForwardInfo>(info);
+
+        // Failed to allocate memory for Request, drop it.
+        return nullptr;
+    }
+
+    std::memcpy(info->mBuffer, payload, payloadSize);
+    return info;
+}
+
+// Drain the connection, returns false if the connection is no longer usable.
+int8_t SocketServer::readFromClient(int32_t clientSocket) {
+    char recvBuf[RESTUNE_MAX_FRAME_SIZE];
+    char controlBuf[CMSG_SPACE(sizeof(int32_t) * RESTUNE_MAX_PASSED_FDS)];
+    std::string& pendingBytes = this->mPendingBytes[clientSocket];
+
+    for(int32_t readCount = 0; readCount < RESTUNE_MAX_READS_PER_WAKEUP;) {
+        struct iovec iov = {recvBuf, sizeof(recvBuf)};
+        struct msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = controlBuf;
+        msg.msg_controllen = sizeof(controlBuf);
+
+        ssize_t bytesRead = recvmsg(clientSocket, &msg, MSG_CMSG_CLOEXEC);
+        if(bytesRead > 0) {
+            // Collect any fds passed along (shared memory transport negotiation).
+            for(struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                if(cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+
+                int32_t fdCount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int32_t);
+                int32_t* fds = (int32_t*)CMSG_DATA(cmsg);
+                for(int32_t i = 0; i < fdCount; i++) {
+                    this->mPendingFds[clientSocket].push_back(fds[i]);
+                }
+            }
+
+            // Dispatch complete frames right away, so that at most a single partial
+            // frame is ever carried over between reads.
+            pendingBytes.append(recvBuf, bytesRead);
+            if(!this->dispatchFrames(clientSocket)) {
+                return false;
+            }
+            readCount++;
+            continue;
+        }
+
+        if(bytesRead == 0) {
+            // Client closed the connection, dispatch whatever was completely received.
+            this->dispatchFrames(clientSocket);
+            return false;
+        }
+
+        if(errno == EINTR) continue;
+        if(errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+
+        TYPELOGV(ERRNO_LOG, "recv", strerror(errno));
+        return false;
+    }
+
+    // Connections are level-triggered, any data left unread is reported again.
+    return true;
+}
+
+// The client passes [memfd, request doorbell, response doorbell] along with the attach Request.
+void SocketServer::attachShmChannel(int32_t clientSocket) {
+    std::vector<int32_t>& passedFds = this->mPendingFds[clientSocket];
+    int64_t channelId = -1;
+
+    if(passedFds.size() == 3) {
+        channelId = ShmServer::getInstance()->attachChannel(clientSocket, passedFds[0], passedFds[1], passedFds[2]);
+    } else {
+        LOGE("RESTUNE_SOCKET_SERVER", "Shared memory attach Request without the expected fds");
+        for(int32_t fd: passedFds) {
+            close(fd);
+        }
+    }
+    passedFds.clear();
+
+    if(!sendFrame(clientSocket, &channelId, sizeof(int64_t))) {
+        ShmServer::getInstance()->detachOwner(clientSocket);
+    }
+}
+
+// Replies are matched to Requests by the client in arrival order, hence if a Request can not
+// be dispatched the connection is dropped, so that the client does not wait on a reply forever.
+int8_t SocketServer::dispatchFrames(int32_t clientSocket) {
+    std::string& pendingBytes = this->mPendingBytes[clientSocket];
+    std::shared_ptr<ClientConnection> connection = getConnection(clientSocket);
+    size_t offset = 0;
+
+    while(pendingBytes.length() - offset >= sizeof(uint32_t)) {
+        // A reply could not be sent, the client has lost track of the replies on this connection.
+        if(connection != nullptr && connection->mFailed.load()) {
+            pendingBytes.clear();
+            return false;
+        }
+
+        uint32_t frameSize = 0;
+        std::memcpy(&frameSize, pendingBytes.data() + offset, sizeof(uint32_t));
+
+        if(frameSize == 0 || frameSize > RESTUNE_MAX_FRAME_SIZE) {
+            // Malformed stream, there is no way to re-synchronize, discard everything.
+            LOGE("RESTUNE_SOCKET_SERVER", "Invalid frame size: " + std::to_string(frameSize));
+            pendingBytes.clear();
+            return false;
+        }
+
+        if(pendingBytes.length() - offset - sizeof(uint32_t) < frameSize) {
+            // Frame not yet completely received
+            break;
+        }
+
+        const char* payload = pendingBytes.data() + offset + sizeof(uint32_t);
+        offset += sizeof(uint32_t) + frameSize;
+
+        // Transport negotiation is handled by the Listener itself.
+        if(frameSize >= 2 * sizeof(int8_t) && payload[sizeof(int8_t)] == REQ_SHM_ATTACH) {
+            this->attachShmChannel(clientSocket);
+            continue;
+        }
+
+        MsgForwardInfo* info = createForwardInfo(payload, frameSize);
+        if(info == nullptr) {
+            LOGE("RESTUNE_SOCKET_SERVER", "Failed to allocate memory for Request, dropping the connection");
+            pendingBytes.clear();
+            return false;
+        }
+
+        auto identity = this->mPeerIdentities.find(clientSocket);
+        if(identity != this->mPeerIdentities.end()) {
+            info->mPeer = identity->second;
+        }
+        this->mMessageRecvCb(clientSocket, info);
+    }
+
+    pendingBytes.erase(0, offset);
+    return true;
+}
+
+// The fd is closed once no reply is being sent on it anymore, refer ClientConnection.
+void SocketServer::releaseConnection(int32_t clientSocket) {
+    std::shared_ptr<ClientConnection> connection = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(mConnectionsMutex);
+        auto it = mConnections.find(clientSocket);
+        if(it == mConnections.end()) {
+            return;
+        }
+        // Released outside of the lock, if it is the last reference.
+        connection = it->second;
+        mConnections.erase(it);
+    }
+}
+
+void SocketServer::dropClient(int32_t clientSocket) {
+    epoll_ctl(this->epollFd, EPOLL_CTL_DEL, clientSocket, nullptr);
+    this->mPendingBytes.erase(clientSocket);
+    this->mPeerIdentities.erase(clientSocket);
+
+    // Any shared memory channel negotiated over this connection goes away along with it,
+    // as do the handles leased to it. Both must happen before the fd can be reused.
+    ShmServer::getInstance()->detachOwner(clientSocket);
+    RequestReceiver::getInstance()->releaseHandleLeases(clientSocket);
+    this->releaseConnection(clientSocket);
+    auto it = this->mPendingFds.find(clientSocket);
+    if(it != this->mPendingFds.end()) {
+        for(int32_t fd: it->second) {
+            close(fd);
+        }
+        this->mPendingFds.erase(it);
+    }
+}
+
 // Called by server, this will put the server in listening mode
 int32_t SocketServer::ListenForClientRequests() {
-    if((this->sockFd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    if((this->sockFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0) {
         TYPELOGV(ERRNO_LOG, "socket", strerror(errno));
         LOGE("RESTUNE_SOCKET_SERVER", "Failed to initialize Server Socket");
         return RC_SOCKET_CONN_NOT_INITIALIZED;
@@ -68,8 +412,8 @@ int32_t SocketServer::ListenForClientRequests() {
         return RC_SOCKET_CONN_NOT_INITIALIZED;
     }
 
-    int32_t epollFd = epoll_create1(0);
-    if(epollFd < 0) {
+    this->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if(this->epollFd < 0) {
         TYPELOGV(ERRNO_LOG, "epoll_create1", strerror(errno));
         close(this->sockFd);
         this->sockFd = -1;
@@ -79,68 +423,40 @@ int32_t SocketServer::ListenForClientRequests() {
     epoll_event event{}, events[maxEvents];
     event.events = EPOLLIN;
     event.data.fd = this->sockFd;
-    if(epoll_ctl(epollFd, EPOLL_CTL_ADD, this->sockFd, &event) < 0) {
+    if(epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->sockFd, &event) < 0) {
         TYPELOGV(ERRNO_LOG, "epoll_ctl", strerror(errno));
-        close(epollFd);
+        close(this->epollFd);
+        this->epollFd = -1;
         close(this->sockFd);
         this->sockFd = -1;
         return RC_SOCKET_CONN_NOT_INITIALIZED;
     }
 
     while(this->mServerOnlineCheckCb()) {
-        int32_t clientsFdCount = epoll_wait(epollFd, events, maxEvents, 1000);
-
-        for(int32_t i = 0; i < clientsFdCount; i++) {
-            if(events[i].data.fd == this->sockFd) {
-                // Process all the Requests in the backlog
-                while(true) {
-                    int32_t clientSocket = -1;
-                    if((clientSocket = accept(this->sockFd, nullptr, nullptr)) < 0) {
-                        if(errno != EAGAIN && errno != EWOULDBLOCK) {
-                            TYPELOGV(ERRNO_LOG, "accept", strerror(errno));
-                            LOGE("RESTUNE_SOCKET_SERVER", "Server Socket-Endpoint crashed");
-                            return RC_SOCKET_OP_FAILURE;
-                        } else {
-                            // No more clients to accept, Backlog is completely drained.
-                            break;
-                        }
-                    }
-
-                    if(clientSocket >= 0) {
-                        MsgForwardInfo* info = nullptr;
-                        char* reqBuf = nullptr;
-
-                        try {
-                            info = new (GetBlock<MsgForwardInfo>()) MsgForwardInfo;
-                            reqBuf = new (GetBlock<char[REQ_BUFFER_SIZE]>()) char[REQ_BUFFER_SIZE];
-
-                            info->mBuffer = reqBuf;
-                            info->mBufferSize = REQ_BUFFER_SIZE;
-
-                        } catch(const std::bad_alloc& e) {
-                            FreeBlock<MsgForwardInfo>(info);
-                            FreeBlock<char[REQ_BUFFER_SIZE]>(reqBuf);
-
-                            // Failed to allocate memory for Request, close client socket.
-                            close(clientSocket);
-                            continue;
-                        }
-
-                        int32_t bytesRead = 0;
-                        if((bytesRead = recv(clientSocket, info->mBuffer, info->mBufferSize, 0)) < 0) {
-                            if(errno != EAGAIN && errno != EWOULDBLOCK) {
-                                TYPELOGV(ERRNO_LOG, "recv", strerror(errno));
-                                LOGE("RESTUNE_SOCKET_SERVER", "Server Socket-Endpoint crashed");
-                                return RC_SOCKET_OP_FAILURE;
-                            }
-                        }
-
-                        if(bytesRead > 0) {
-                            this->mMessageRecvCb(clientSocket, info);
-                        }
-                        close(clientSocket);
-                    }
+        int32_t readyFdCount = epoll_wait(this->epollFd, events, maxEvents, 1000);
+
+        for(int32_t i = 0; i < readyFdCount; i++) {
+            int32_t readyFd = events[i].data.fd;
+
+            if(readyFd == this->sockFd) {
+                if(!this->acceptClients()) {
+                    LOGE("RESTUNE_SOCKET_SERVER", "Server Socket-Endpoint crashed");
+                    return RC_SOCKET_OP_FAILURE;
                 }
+                continue;
+            }
+
+            // Client connection, read any Requests first, even if the peer has hung up.
+            int8_t connectionAlive = true;
+            if(events[i].events & EPOLLIN) {
+                connectionAlive = this->readFromClient(readyFd);
+            }
+
+            // A hung up connection with data still unread (readFromClient returns once its read
+            // budget is spent) is kept until the data is drained and the end of stream is seen.
+            if(!connectionAlive || (events[i].events & EPOLLERR) ||
+               ((events[i].events & EPOLLHUP) && !(events[i].events & EPOLLIN))) {
+                this->dropClient(readyFd);
             }
         }
     }
@@ -149,6 +465,26 @@ int32_t SocketServer::ListenForClientRequests() {
 }
 
 int32_t SocketServer::closeConnection() {
+    for(std::pair<const int32_t, std::string>& client: this->mPendingBytes) {
+        ShmServer::getInstance()->detachOwner(client.first);
+        RequestReceiver::getInstance()->releaseHandleLeases(client.first);
+        this->releaseConnection(client.first);
+    }
+    this->mPendingBytes.clear();
+    this->mPeerIdentities.clear();
+
+    for(std::pair<const int32_t, std::vector<int32_t>>& client: this->mPendingFds) {
+        for(int32_t fd: client.second) {
+            close(fd);
+        }
+    }
+    this->mPendingFds.clear();
+
+    if(this->epollFd != -1) {
+        close(this->epollFd);
+        this->epollFd = -1;
+    }
+
     if(this->sockFd != -1) {
         close(this->sockFd);
         this->sockFd = -1;
@@ -157,8 +493,5 @@ int32_t SocketServer::closeConnection() {
 }
 
 SocketServer::~SocketServer() {
-    if(this->sockFd != -1) {
-        close(this->sockFd);
-        this->sockFd = -1;
-    }
+    this->closeConnection();
 }
@@ -0,0 +1,254 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ShmListener.h"
+#include "RestuneListener.h"
+
+std::shared_ptr<ShmServer> ShmServer::mShmServerInstance = nullptr;
+std::mutex ShmServer::instanceProtectionLock {};
+
+static void releaseChannel(ShmChannel* channel) {
+    if(channel->mRegion != nullptr) {
+        munmap(channel->mRegion, sizeof(ShmRegion));
+    }
+    close(channel->mMemFd);
+    close(channel->mRequestDoorbell);
+    close(channel->mResponseDoorbell);
+    delete channel;
+}
+
+ShmServer::ShmServer() {
+    this->mServerOnlineCheckCb = nullptr;
+    this->mMessageRecvCb = nullptr;
+    this->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if(this->epollFd < 0) {
+        TYPELOGV(ERRNO_LOG, "epoll_create1", strerror(errno));
+    }
+}
+
+void ShmServer::setCallbacks(ServerOnlineCheckCallback mServerOnlineCheckCb,
+                             MessageReceivedCallback mMessageRecvCb) {
+    this->mServerOnlineCheckCb = mServerOnlineCheckCb;
+    this->mMessageRecvCb = mMessageRecvCb;
+}
+
+int32_t ShmServer::attachChannel(int32_t ownerSocket,
+                                 int32_t memFd,
+                                 int32_t requestDoorbell,
+                                 int32_t responseDoorbell) {
+    ShmChannel* channel = nullptr;
+    try {
+        channel = new ShmChannel;
+    } catch(const std::bad_alloc& e) {
+        close(memFd);
+        close(requestDoorbell);
+        close(responseDoorbell);
+        return -1;
+    }
+
+    channel->mOwnerSocket = ownerSocket;
+    channel->mOwner = SocketServer::getConnection(ownerSocket);
+    channel->mMemFd = memFd;
+    channel->mRequestDoorbell = requestDoorbell;
+    channel->mResponseDoorbell = responseDoorbell;
+    channel->mRegion = nullptr;
+    fetchPeerIdentity(ownerSocket, channel->mPeer);
+
+    // The region is owned by the client, it must be sealed against resizing,
+    // else the client could shrink it and fault the Server on access.
+    int32_t seals = fcntl(memFd, F_GET_SEALS);
+    struct stat memFdStat;
+    if(this->epollFd < 0 || seals < 0 || !(seals & F_SEAL_SHRINK) ||
+       fstat(memFd, &memFdStat) < 0 || memFdStat.st_size < (off_t)sizeof(ShmRegion)) {
+        LOGE("RESTUNE_SHM_SERVER", "Rejecting shared memory channel: region is not sealed or too small");
+        releaseChannel(channel);
+        return -1;
+    }
+
+    void* region = mmap(nullptr, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+    if(region == MAP_FAILED) {
+        TYPELOGV(ERRNO_LOG, "mmap", strerror(errno));
+        releaseChannel(channel);
+        return -1;
+    }
+
+    channel->mRegion = (ShmRegion*)region;
+    if(channel->mRegion->mMagic != SHM_RING_MAGIC || channel->mRegion->mVersion != SHM_RING_VERSION) {
+        LOGE("RESTUNE_SHM_SERVER", "Rejecting shared memory channel: version mismatch");
+        releaseChannel(channel);
+        return -1;
+    }
+
+    std::shared_ptr<ShmChannel> sharedChannel(channel, releaseChannel);
+    const std::lock_guard<std::mutex> lock(this->mChannelsMutex);
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = requestDoorbell;
+    if(epoll_ctl(this->epollFd, EPOLL_CTL_ADD, requestDoorbell, &event) < 0) {
+        TYPELOGV(ERRNO_LOG, "epoll_ctl", strerror(errno));
+        return -1;
+    }
+
+    this->mChannels[requestDoorbell] = sharedChannel;
+    return requestDoorbell;
+}
+
+void ShmServer::detachOwner(int32_t ownerSocket) {
+    const std::lock_guard<std::mutex> lock(this->mChannelsMutex);
+
+    for(auto it = this->mChannels.begin(); it != this->mChannels.end();) {
+        if(it->second->mOwnerSocket != ownerSocket) {
+            ++it;
+            continue;
+        }
+
+        // The channel is released once any in-progress drain lets go of it.
+        epoll_ctl(this->epollFd, EPOLL_CTL_DEL, it->first, nullptr);
+        it = this->mChannels.erase(it);
+    }
+}
+
+void ShmServer::detachChannel(const std::shared_ptr<ShmChannel>& channel) {
+    const std::lock_guard<std::mutex> lock(this->mChannelsMutex);
+
+    auto it = this->mChannels.find(channel->mRequestDoorbell);
+    if(it != this->mChannels.end() && it->second == channel) {
+        epoll_ctl(this->epollFd, EPOLL_CTL_DEL, it->first, nullptr);
+        this->mChannels.erase(it);
+    }
+}
+
+std::shared_ptr<ShmChannel> ShmServer::getChannel(int32_t channelId) {
+    const std::lock_guard<std::mutex> lock(this->mChannelsMutex);
+
+    auto it = this->mChannels.find(channelId);
+    if(it == this->mChannels.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+int8_t ShmServer::isChannel(int32_t channelId) {
+    return this->getChannel(channelId) != nullptr;
+}
+
+int32_t ShmServer::getOwnerSocket(int32_t channelId) {
+    std::shared_ptr<ShmChannel> channel = this->getChannel(channelId);
+    if(channel == nullptr) return -1;
+    return channel->mOwnerSocket;
+}
+
+int8_t ShmServer::sendReply(int32_t channelId, const void* buf, uint32_t bufSize) {
+    return this->sendReply(this->getChannel(channelId), buf, bufSize);
+}
+
+int8_t ShmServer::sendReply(const std::shared_ptr<ShmChannel>& channel, const void* buf, uint32_t bufSize) {
+    if(channel == nullptr) return false;
+    if(channel->mOwner != nullptr && channel->mOwner->mFailed.load()) return false;
+
+    // Replies are published from the draining thread, and Rejection notices from the
+    // Request handlers, the ring expects a single producer at a time.
+    const std::lock_guard<std::mutex> lock(channel->mReplyMutex);
+    if(!shmRingPush(&channel->mRegion->mResponseRing, buf, bufSize)) {
+        // The client bounds the replies it has outstanding, but not the Rejection notices.
+        // Fail it back, its pending Requests fail and it negotiates a fresh channel on reconnecting.
+        LOGE("RESTUNE_SHM_SERVER", "Response ring full, detaching the channel");
+        this->detachChannel(channel);
+        SocketServer::failConnection(channel->mOwner);
+        return false;
+    }
+
+    uint64_t doorbell = 1;
+    if(write(channel->mResponseDoorbell, &doorbell, sizeof(doorbell)) < 0) {
+        TYPELOGV(ERRNO_LOG, "write", strerror(errno));
+    }
+    return true;
+}
+
+void ShmServer::drainChannel(std::shared_ptr<ShmChannel> channel) {
+    uint64_t doorbell = 0;
+    if(read(channel->mRequestDoorbell, &doorbell, sizeof(doorbell)) < 0 && errno != EAGAIN) {
+        TYPELOGV(ERRNO_LOG, "read", strerror(errno));
+    }
+
+    char payload[SHM_RING_SLOT_SIZE];
+    while(true) {
+        // A Response could not be published, the client has lost track of the replies.
+        if(channel->mOwner != nullptr && channel->mOwner->mFailed.load()) {
+            break;
+        }
+
+        int32_t payloadSize = shmRingPop(&channel->mRegion->mRequestRing, payload, sizeof(payload));
+        if(payloadSize == 0) {
+            break;
+        }
+
+        if(payloadSize < 0) {
+            LOGE("RESTUNE_SHM_SERVER", "Request ring corrupted, detaching the channel");
+            this->detachOwner(channel->mOwnerSocket);
+            break;
+        }
+
+        MsgForwardInfo* info = createForwardInfo(payload, payloadSize);
+        if(info == nullptr) {
+            // The client would otherwise wait on the reply forever.
+            LOGE("RESTUNE_SHM_SERVER", "Failed to allocate memory for Request, detaching the channel");
+            this->detachOwner(channel->mOwnerSocket);
+            break;
+        }
+
+        info->mPeer = channel->mPeer;
+        this->mMessageRecvCb(channel->mRequestDoorbell, info);
+    }
+}
+
+int32_t ShmServer::getChannelsCount() {
+    const std::lock_guard<std::mutex> lock(this->mChannelsMutex);
+    return this->mChannels.size();
+}
+
+int32_t ShmServer::ListenForClientRequests() {
+    if(this->epollFd < 0 || this->mServerOnlineCheckCb == nullptr || this->mMessageRecvCb == nullptr) {
+        return RC_SOCKET_CONN_NOT_INITIALIZED;
+    }
+
+    epoll_event events[maxEvents];
+    while(this->mServerOnlineCheckCb()) {
+        int32_t readyFdCount = epoll_wait(this->epollFd, events, maxEvents, 1000);
+
+        for(int32_t i = 0; i < readyFdCount; i++) {
+            std::shared_ptr<ShmChannel> channel = this->getChannel(events[i].data.fd);
+            if(channel != nullptr) {
+                this->drainChannel(channel);
+            }
+        }
+    }
+
+    return RC_SUCCESS;
+}
+
+int32_t ShmServer::closeConnection() {
+    const std::lock_guard<std::mutex> lock(this->mChannelsMutex);
+    for(std::pair<const int32_t, std::shared_ptr<ShmChannel>>& entry: this->mChannels) {
+        epoll_ctl(this->epollFd, EPOLL_CTL_DEL, entry.first, nullptr);
+    }
+    this->mChannels.clear();
+    return RC_SUCCESS;
+}
+
+ShmServer::~ShmServer() {
+    this->closeConnection();
+    if(this->epollFd >= 0) {
+        close(this->epollFd);
+        this->epollFd = -1;
+    }
+}
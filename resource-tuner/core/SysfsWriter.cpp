@@ -0,0 +1,184 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+#include "SysfsWriter.h"
+#include "NodeJournal.h"
+
+std::shared_ptr<SysfsWriter> SysfsWriter::mSysfsWriterInstance = nullptr;
+std::mutex SysfsWriter::instanceProtectionLock {};
+
+SysfsWriter::SysfsWriter() {
+    this->mIsRunning = false;
+    this->mWriterBusy = false;
+    this->mPostedCount.store(0);
+    this->mSupersededCount.store(0);
+    this->mWrittenCount.store(0);
+}
+
+int8_t SysfsWriter::writeNode(const std::string& nodePath, const std::string& value) {
+    if(nodePath.length() == 0) return false;
+
+    int32_t fd = open(nodePath.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+    if(fd < 0) {
+        TYPELOGV(ERRNO_LOG, "open", strerror(errno));
+        return false;
+    }
+
+    int8_t status = true;
+    ssize_t bytesWritten = 0;
+    do {
+        bytesWritten = write(fd, value.c_str(), value.length());
+    } while(bytesWritten < 0 && errno == EINTR);
+
+    if(bytesWritten < 0) {
+        TYPELOGV(ERRNO_LOG, "write", strerror(errno));
+        status = false;
+    }
+
+    close(fd);
+    return status;
+}
+
+void SysfsWriter::writerRoutine() {
+    std::unique_lock<std::mutex> lock(this->mWriterMutex);
+
+    while(true) {
+        this->mWriterCond.wait(lock, [this] {
+            return !this->mPendingNodes.empty() || !this->mIsRunning;
+        });
+
+        if(this->mPendingNodes.empty() && !this->mIsRunning) {
+            break;
+        }
+
+        // Pick up the whole batch, so that the posting threads are blocked
+        // only for the duration of the swap and not for the Kernel writes.
+        std::deque<std::string> batchNodes;
+        std::unordered_map<std::string, std::string> batchValues;
+        batchNodes.swap(this->mPendingNodes);
+        batchValues.swap(this->mMailbox);
+        this->mWriterBusy = true;
+
+        lock.unlock();
+        for(const std::string& nodePath: batchNodes) {
+            if(writeNode(nodePath, batchValues[nodePath])) {
+                this->mWrittenCount.fetch_add(1);
+            }
+        }
+
+        // Persist the journal updates made for this batch, away from the Request path.
+        NodeJournal::getInstance()->sync();
+        lock.lock();
+
+        this->mWriterBusy = false;
+        if(this->mPendingNodes.empty()) {
+            this->mDrainCond.notify_all();
+        }
+    }
+
+    this->mWriterBusy = false;
+    this->mDrainCond.notify_all();
+}
+
+ErrCode SysfsWriter::start() {
+    std::unique_lock<std::mutex> lock(this->mWriterMutex);
+    if(this->mIsRunning) {
+        return RC_SUCCESS;
+    }
+
+    try {
+        this->mIsRunning = true;
+        this->mWriterThread = std::thread(&SysfsWriter::writerRoutine, this);
+
+    } catch(const std::system_error& e) {
+        this->mIsRunning = false;
+        TYPELOGV(SYSTEM_THREAD_CREATION_FAILURE, "sysfs-writer", e.what());
+        return RC_MODULE_INIT_FAILURE;
+    }
+
+    return RC_SUCCESS;
+}
+
+void SysfsWriter::stop() {
+    std::unique_lock<std::mutex> lock(this->mWriterMutex);
+    if(!this->mIsRunning) {
+        return;
+    }
+
+    // The Writer thread drains any remaining intents before exiting.
+    this->mIsRunning = false;
+    this->mWriterCond.notify_all();
+    lock.unlock();
+
+    if(this->mWriterThread.joinable()) {
+        this->mWriterThread.join();
+    } else {
+        TYPELOGV(SYSTEM_THREAD_NOT_JOINABLE, "sysfs-writer");
+    }
+
+    LOGI("RESTUNE_SYSFS_WRITER",
+         "Writes posted: " + std::to_string(this->mPostedCount.load()) +
+         ", superseded: " + std::to_string(this->mSupersededCount.load()) +
+         ", written: " + std::to_string(this->mWrittenCount.load()));
+}
+
+void SysfsWriter::post(const std::string& nodePath, const std::string& value) {
+    if(nodePath.length() == 0) return;
+    this->mPostedCount.fetch_add(1);
+
+    std::unique_lock<std::mutex> lock(this->mWriterMutex);
+    if(!this->mIsRunning) {
+        // No Writer thread, apply inline.
+        lock.unlock();
+        if(writeNode(nodePath, value)) {
+            this->mWrittenCount.fetch_add(1);
+        }
+        return;
+    }
+
+    auto it = this->mMailbox.find(nodePath);
+    if(it != this->mMailbox.end()) {
+        // An older intent for this node has not been written yet, drop it.
+        it->second = value;
+        this->mSupersededCount.fetch_add(1);
+        return;
+    }
+
+    this->mMailbox[nodePath] = value;
+    this->mPendingNodes.push_back(nodePath);
+    this->mWriterCond.notify_one();
+}
+
+void SysfsWriter::flush() {
+    std::unique_lock<std::mutex> lock(this->mWriterMutex);
+    this->mDrainCond.wait(lock, [this] {
+        return (this->mPendingNodes.empty() && !this->mWriterBusy) || !this->mIsRunning;
+    });
+}
+
+int8_t SysfsWriter::isPending(const std::string& nodePath) {
+    const std::lock_guard<std::mutex> lock(this->mWriterMutex);
+    // Nodes part of the batch currently being written are treated as pending as well.
+    return this->mWriterBusy || this->mMailbox.find(nodePath) != this->mMailbox.end();
+}
+
+uint64_t SysfsWriter::getPostedCount() {
+    return this->mPostedCount.load();
+}
+
+uint64_t SysfsWriter::getSupersededCount() {
+    return this->mSupersededCount.load();
+}
+
+uint64_t SysfsWriter::getWrittenCount() {
+    return this->mWrittenCount.load();
+}
+
+SysfsWriter::~SysfsWriter() {
+    this->stop();
+}
@@ -53,7 +53,7 @@ static int32_t onSdBusMessageReceived(sd_bus_message* message,
         return 0;
     }
 
-    std::shared_ptr<RequestManager> requestManager = RequestManager::getInstance();
+    std::shared_ptr<RequestQueue> requestQueue = RequestQueue::getInstance();
     if(sleepStatus) {
         // System is suspending
         LOGI("RESTUNE_MODE_DETECTION", "System is suspending");
@@ -62,9 +62,9 @@ static int32_t onSdBusMessageReceived(sd_bus_message* message,
             UrmSettings::targetConfigs.currMode &= ~MODE_RESUME;
             UrmSettings::targetConfigs.currMode |= MODE_SUSPEND;
 
-            // First drain out the CocoTable, and move Requests to the Pending List
-            // (the ones which cannot be processed in Background)
-            requestManager->moveToPendingList();
+            // Requests which cannot be processed in Background are switched over
+            // in the CocoTable, they stay active and are restored on resume.
+            requestQueue->postModeTransition(MODE_SUSPEND);
         }
     } else {
         // System has resumed
@@ -74,12 +74,8 @@ static int32_t onSdBusMessageReceived(sd_bus_message* message,
             UrmSettings::targetConfigs.currMode &= ~MODE_SUSPEND;
             UrmSettings::targetConfigs.currMode |= MODE_RESUME;
 
-            // Add all the Requests from the Pending List into the Active List
-            std::vector<Request*> pendingRequests = requestManager->getPendingList();
-            for(Request* request: pendingRequests) {
-                submitResProvisionRequest(request, false);
-            }
-            requestManager->clearPending();
+            // Restore the Resources which were switched over on suspend.
+            requestQueue->postModeTransition(MODE_RESUME);
         }
     }
 
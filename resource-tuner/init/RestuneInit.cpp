@@ -17,9 +17,14 @@
 #include "PulseMonitor.h"
 #include "RequestReceiver.h"
 #include "ClientGarbageCollector.h"
+#include "DriftDetector.h"
 #include "UrmSettings.h"
 #include "SignalRegistry.h"
 #include "RestuneParser.h"
+#include "SysfsWriter.h"
+#include "CGroupMigrator.h"
+#include "PmQosManager.h"
+#include "NodeJournal.h"
 
 static void* extensionsLibHandle = nullptr;
 static std::thread restuneHandlerThread;
@@ -27,7 +32,8 @@ static std::thread resourceTunerListener;
 
 static void restoreToSafeState() {
     if(AuxRoutines::fileExists(UrmSettings::mPersistenceFile)) {
-        AuxRoutines::writeSysFsDefaults();
+        int32_t restoredCount = NodeJournal::recover(UrmSettings::mPersistenceFile);
+        LOGI("RESTUNE_SERVER_INIT", "Restored " + std::to_string(restoredCount) + " nodes from journal");
 
         // Delete the Node Persistence File
         AuxRoutines::deleteFile(UrmSettings::mPersistenceFile);
@@ -62,12 +68,15 @@ static void preAllocateMemory() {
     MakeAlloc<DLManager> (concurrentRequestsUB);
     MakeAlloc<Timer> (concurrentRequestsUB);
     MakeAlloc<Resource> (maxBlockCount);
-    MakeAlloc<ClientInfo> (maxBlockCount);
-    MakeAlloc<ClientTidData> (maxBlockCount);
     MakeAlloc<std::unordered_set<int64_t>> (maxBlockCount);
     MakeAlloc<MsgForwardInfo> (maxBlockCount);
     MakeAlloc<ResIterable> (maxBlockCount);
-    MakeAlloc<char[REQ_BUFFER_SIZE]> (maxBlockCount);
+    // Most in-flight Requests fit in the small size class.
+    MakeAlloc<char[REQ_SMALL_BUFFER_SIZE]> (maxBlockCount);
+    MakeAlloc<char[REQ_BUFFER_SIZE]> (concurrentRequestsUB);
+    // Batches are unpacked on the Listener threads (socket and shared memory),
+    // and released before the next message is read.
+    MakeAlloc<char[REQ_BATCH_BUFFER_SIZE]> (2);
     MakeAlloc<Signal> (concurrentRequestsUB);
     MakeAlloc<std::vector<Resource*>> (concurrentRequestsUB * resourcesPerRequestUB);
     MakeAlloc<std::vector<uint32_t>> (concurrentRequestsUB * resourcesPerRequestUB);
@@ -124,9 +133,6 @@ static ErrCode fetchMetaConfigs() {
         submitPropGetRequest(GARBAGE_COLLECTOR_DURATION, resultBuffer, "83000");
         UrmSettings::metaConfigs.mClientGarbageCollectorDuration = (uint32_t)std::stol(resultBuffer);
 
-        submitPropGetRequest(GARBAGE_COLLECTOR_BATCH_SIZE, resultBuffer, "5");
-        UrmSettings::metaConfigs.mCleanupBatchSize = (uint32_t)std::stol(resultBuffer);
-
         submitPropGetRequest(RATE_LIMITER_DELTA, resultBuffer, "5");
         UrmSettings::metaConfigs.mDelta = (uint32_t)std::stol(resultBuffer);
 
@@ -136,6 +142,12 @@ static ErrCode fetchMetaConfigs() {
         submitPropGetRequest(RATE_LIMITER_REWARD_FACTOR, resultBuffer, "0.4");
         UrmSettings::metaConfigs.mRewardFactor = std::stod(resultBuffer);
 
+        submitPropGetRequest(DRIFT_DETECTOR_DURATION, resultBuffer, "0");
+        UrmSettings::metaConfigs.mDriftCheckDuration = (uint32_t)std::stol(resultBuffer);
+
+        submitPropGetRequest(DRIFT_DETECTOR_REASSERT, resultBuffer, "false");
+        UrmSettings::metaConfigs.mReassertOnDrift = (resultBuffer == "true");
+
         initLogger();
 
     } catch(const std::invalid_argument& e) {
@@ -363,8 +375,8 @@ static ErrCode preAllocateWorkers() {
         RequestReceiver::mRequestsThreadPool = new ThreadPool(desiredThreadCapacity,
                                                               maxScalingCapacity);
 
-        // Allocate 2 extra threads for Pulse Monitor and Garbage Collector
-        Timer::mTimerThreadPool = new ThreadPool(desiredThreadCapacity + 2,
+        // Allocate 3 extra threads for Pulse Monitor, Garbage Collector and Drift Detector
+        Timer::mTimerThreadPool = new ThreadPool(desiredThreadCapacity + 3,
                                                  maxScalingCapacity);
 
     } catch(const std::bad_alloc& e) {
@@ -423,6 +435,11 @@ static ErrCode init(void* arg) {
     // Ensure that Resource Nodes are reset to sane state
     restoreToSafeState();
 
+    // Journal the original values of the nodes tuned from here on
+    if(RC_IS_NOTOK(NodeJournal::getInstance()->open(UrmSettings::mPersistenceFile))) {
+        LOGW("RESTUNE_SERVER_INIT", "Node Journal could not be created, crash recovery disabled");
+    }
+
     // Start Resource Tuner Server Initialization
     // As part of Server Initialization the Configs (Resource / Signals etc.) will be parsed
     // If any of mandatory Configs cannot be parsed then initialization will fail.
@@ -486,12 +503,20 @@ static ErrCode init(void* arg) {
     // By this point, all the Extension Appliers / Resources would have been registered.
     ResourceRegistry::getInstance()->pluginModifications();
 
+    // Nodes backed by multiple Resources are arbitrated at the node-level
+    ResourceRegistry::getInstance()->identifySharedNodes();
+
     // Initialize external features
     ExtFeaturesRegistry::getInstance()->initializeFeatures();
 
     // Configure focused.slice parameters
     configureFocusedSlice();
 
+    // Start the asynchronous Resource Node writer, before any Request can be applied.
+    if(RC_IS_NOTOK(SysfsWriter::getInstance()->start())) {
+        return RC_MODULE_INIT_FAILURE;
+    }
+
     // Create the Processor thread:
     try {
         restuneHandlerThread = std::thread(restuneThreadStart);
@@ -514,6 +539,11 @@ static ErrCode init(void* arg) {
         return RC_MODULE_INIT_FAILURE;
     }
 
+    if(RC_IS_NOTOK(startDriftDetectorDaemon())) {
+        LOGE("RESTUNE_SERVER_INIT", "Drift Detector could not be started");
+        return RC_MODULE_INIT_FAILURE;
+    }
+
     // Create the listener thread
     try {
         resourceTunerListener = std::thread(listenerThreadStartRoutine);
@@ -547,9 +577,21 @@ static ErrCode tear(void* arg) {
         TYPELOGV(SYSTEM_THREAD_NOT_JOINABLE, "resource-tuner");
     }
 
+    // No more re-asserts once teardown begins
+    stopDriftDetectorDaemon();
+
+    // Drain any pending node writes, so that they don't race with the restore below.
+    SysfsWriter::getInstance()->stop();
+
     // Restore all the Resources to Original Values
     ResourceRegistry::getInstance()->restoreResourcesToDefaultValues();
 
+    // Move any migrated Processes / Threads back to their original CGroups
+    CGroupMigrator::getInstance()->restoreAll();
+
+    // Drop any PM QoS constraints still held
+    PmQosManager::getInstance()->releaseAll();
+
     stopPulseMonitorDaemon();
     stopClientGarbageCollectorDaemon();
 
@@ -562,6 +604,7 @@ static ErrCode tear(void* arg) {
     }
 
     // Delete the Sysfs Persistent File
+    NodeJournal::getInstance()->close();
     AuxRoutines::deleteFile(UrmSettings::mPersistenceFile);
 
     if(extensionsLibHandle != nullptr) {
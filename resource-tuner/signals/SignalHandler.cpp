@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause-Clear
 
 #include "SignalInternal.h"
+#include "RequestReceiver.h"
 
 static int8_t getRequestPriority(int8_t clientPermissions, int8_t reqSpecifiedPriority) {
     if(clientPermissions == PERMISSION_SYSTEM) {
@@ -117,6 +118,7 @@ static Request* createResourceTuningRequest(Signal* signal) {
         request->setProperties(signal->getProperties());
         request->setClientPID(signal->getClientPID());
         request->setClientTID(signal->getClientTID());
+        request->setClientLevel(signal->getClientLevel());
 
         std::vector<Resource*>* signalLocks = signalInfo->mSignalResources;
 
@@ -147,6 +149,7 @@ static Request* createResourceTuningRequest(Signal* signal) {
             request->addResource(resIterable);
         }
 
+        request->computeFingerprint();
         return request;
 
     } catch(const std::bad_alloc& e) {
@@ -174,11 +177,13 @@ static Request* createResourceUntuneRequest(Signal* signal) {
     request->setProperties(signal->getProperties());
     request->setClientPID(signal->getClientPID());
     request->setClientTID(signal->getClientTID());
+    request->setClientLevel(signal->getClientLevel());
 
     return request;
 }
 
-static void processIncomingRequest(Signal* signal) {
+// Returns true if the Signal was accepted for processing, else it is freed.
+static int8_t processIncomingRequest(Signal* signal) {
     std::shared_ptr<RateLimiter> rateLimiter = RateLimiter::getInstance();
     std::shared_ptr<ClientDataManager> clientDataManager = ClientDataManager::getInstance();
 
@@ -186,19 +191,21 @@ static void processIncomingRequest(Signal* signal) {
         TYPELOGV(RATE_LIMITER_GLOBAL_RATE_LIMIT_HIT, signal->getHandle());
         // Free the Signal Memory Block
         Signal::cleanUpSignal(signal);
-        return;
+        return false;
     }
 
     if(signal->getRequestType() == REQ_SIGNAL_RELAY || signal->getRequestType() == REQ_SIGNAL_TUNING) {
         // Check if the client exists, if not create a new client tracking entry
         if(!clientDataManager->clientExists(signal->getClientPID(), signal->getClientTID())) {
-            if(!clientDataManager->createNewClient(signal->getClientPID(), signal->getClientTID())) {
+            if(!clientDataManager->createNewClient(signal->getClientPID(),
+                                                   signal->getClientTID(),
+                                                   signal->getClientLevel())) {
                 // Failed to create a tracking entry, drop the Request.
                 TYPELOGV(CLIENT_ENTRY_CREATION_FAILURE, signal->getHandle());
 
                 // Free the Signal Memory Block
                 Signal::cleanUpSignal(signal);
-                return;
+                return false;
             }
         }
     } else {
@@ -206,7 +213,7 @@ static void processIncomingRequest(Signal* signal) {
         if(!clientDataManager->clientExists(signal->getClientPID(), signal->getClientTID())) {
             // Client does not exist, drop the request
             Signal::cleanUpSignal(signal);
-            return;
+            return false;
         }
     }
 
@@ -214,7 +221,7 @@ static void processIncomingRequest(Signal* signal) {
     if(!rateLimiter->isRateLimitHonored(signal->getClientTID())) {
         TYPELOGV(RATE_LIMITER_RATE_LIMITED, signal->getClientTID(), signal->getHandle());
         Signal::cleanUpSignal(signal);
-        return;
+        return false;
     }
 
     switch(signal->getRequestType()) {
@@ -223,7 +230,7 @@ static void processIncomingRequest(Signal* signal) {
             if(!VerifyIncomingRequest(signal)) {
                 TYPELOGV(VERIFIER_STATUS_FAILURE, signal->getHandle());
                 Signal::cleanUpSignal(signal);
-                return;
+                return false;
             }
 
             // Translate to Request and send to RequestQueue for application
@@ -231,12 +238,11 @@ static void processIncomingRequest(Signal* signal) {
             FreeBlock<Signal>(static_cast<void*>(signal));
 
             // Submit the Resource Provisioning request for processing
-            if(request != nullptr) {
-                submitResProvisionRequest(request, false);
-            } else {
+            if(request == nullptr) {
                 LOGE("RESTUNE_SIGNAL_QUEUE", "Malformed Signal Request");
+                return false;
             }
-            break;
+            return admitResProvisionRequest(request, false);
         }
 
         case REQ_SIGNAL_UNTUNING: {
@@ -272,6 +278,8 @@ static void processIncomingRequest(Signal* signal) {
         default:
             break;
     }
+
+    return true;
 }
 
 ErrCode submitSignalRequest(void* msg) {
@@ -280,6 +288,7 @@ ErrCode submitSignalRequest(void* msg) {
     ErrCode opStatus = RC_SUCCESS;
     MsgForwardInfo* info = (MsgForwardInfo*) msg;
     Signal* signal = nullptr;
+    int8_t accepted = false;
 
     if(RC_IS_OK(opStatus)) {
         if(info == nullptr) {
@@ -290,7 +299,7 @@ ErrCode submitSignalRequest(void* msg) {
     if(RC_IS_OK(opStatus)) {
         try {
             signal = MPLACED(Signal);
-            opStatus = signal->deserialize(info->mBuffer);
+            opStatus = signal->deserialize(info->mBuffer, info->mPayloadSize);
             if(RC_IS_NOTOK(opStatus)) {
                 Signal::cleanUpSignal(signal);
             }
@@ -306,12 +315,22 @@ ErrCode submitSignalRequest(void* msg) {
             signal->setHandle(info->mHandle);
         }
 
-        processIncomingRequest(signal);
+        // The Kernel-reported identity of the connection takes precedence over the
+        // PID reported by the client in the Request.
+        if(info->mPeer.mPID > 0) {
+            signal->setClientPID(info->mPeer.mPID);
+        }
+        signal->setClientLevel(info->mPeer.mLevel);
+        accepted = processIncomingRequest(signal);
+    }
+
+    // The client does not wait on Requests issued with a leased handle.
+    if(!accepted) {
+        RequestReceiver::getInstance()->notifyLeasedRejection(info);
     }
 
     if(info != nullptr) {
-        FreeBlock<char[REQ_BUFFER_SIZE]>(info->mBuffer);
-        FreeBlock<MsgForwardInfo>(info);
+        freeForwardInfo(info);
     }
 
     return RC_SUCCESS;
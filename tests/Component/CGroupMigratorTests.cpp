@@ -0,0 +1,47 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "TestUtils.h"
+#include "CGroupMigrator.h"
+#include "TestAggregator.h"
+
+#define MTEST_NO_MAIN
+#include "../framework/mini.h"
+
+using namespace mtest;
+
+// Suite: CGroupMigratorTests
+
+static const std::string migratorTestNodePath = "/etc/urm/tests/nodes/cgroup_migrator_test_procs.txt";
+
+MT_TEST(Component, CGroupMigratorBulkMigration, "cgroupmigrator") {
+    AuxRoutines::writeToFile(migratorTestNodePath, "");
+
+    int32_t pid = getpid();
+    int32_t tid = syscall(SYS_gettid);
+    std::vector<int32_t> ids = {pid, tid};
+
+    // Every ID is written individually, over the same cached fd
+    MT_REQUIRE_EQ(ctx, CGroupMigrator::getInstance()->migrateProcesses(migratorTestNodePath, ids), 2);
+    MT_REQUIRE_EQ(ctx, AuxRoutines::readFromFile(migratorTestNodePath),
+                  std::to_string(pid) + std::to_string(tid));
+
+    // The CGroup the PID belonged to prior to migration is recorded
+    std::string currentCGroup = AuxRoutines::readFromFile("/proc/self/cgroup");
+    if(currentCGroup.length() > 4) {
+        currentCGroup = currentCGroup.substr(4);
+        MT_REQUIRE_EQ(ctx, CGroupMigrator::getInstance()->getOriginalCGroup(pid), currentCGroup);
+    }
+
+    AuxRoutines::deleteFile(migratorTestNodePath);
+}
+
+MT_TEST(Component, CGroupMigratorInvalidTarget, "cgroupmigrator") {
+    std::vector<int32_t> ids = {(int32_t)getpid()};
+    MT_REQUIRE_EQ(ctx, CGroupMigrator::getInstance()->migrateThreads("", ids), 0);
+    MT_REQUIRE_EQ(ctx, CGroupMigrator::getInstance()->migrateThreads(
+                  "/etc/urm/tests/nodes/non_existent_dir/cgroup.threads", ids), 0);
+}
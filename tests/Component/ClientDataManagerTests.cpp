@@ -14,6 +14,8 @@
 #include <cstdint>
 #include <cstdlib>        
 #include <iostream>
+#include <csignal>
+#include <sys/wait.h>
 
 #define MTEST_NO_MAIN
 #include "../framework/mini.h"
@@ -25,8 +27,6 @@ using namespace mtest;
 // Original Init() preserved
 // -------------------------
 static void Init() {
-    MakeAlloc<ClientInfo>(30);
-    MakeAlloc<ClientTidData>(30);
     MakeAlloc<std::unordered_set<int64_t>>(30);
 }
 
@@ -253,20 +253,21 @@ MT_TEST(Component, TestClientDataManagerRequestMapInsertion, "clientdatamanager"
         clientDataManager->insertRequestByClientId(testClientTID, i + 1);
     }
 
-    std::unordered_set<int64_t>* clientRequests =
-        clientDataManager->getRequestsByClientID(testClientTID);
-
-    MT_REQUIRE(ctx, clientRequests != nullptr);
-    MT_REQUIRE_EQ(ctx, static_cast<int>(clientRequests->size()), 20);
+    std::vector<int64_t> clientRequests;
+    MT_REQUIRE(ctx, clientDataManager->getRequestsByClientID(testClientTID, clientRequests));
+    MT_REQUIRE_EQ(ctx, static_cast<int>(clientRequests.size()), 20);
 
     for (int32_t i = 0; i < 20; i++) {
         clientDataManager->deleteRequestByClientId(testClientTID, i + 1);
     }
 
+    clientRequests.clear();
+    MT_REQUIRE(ctx, clientDataManager->getRequestsByClientID(testClientTID, clientRequests));
+
     clientDataManager->deleteClientPID(testClientPID);
     clientDataManager->deleteClientTID(testClientTID);
 
-    MT_REQUIRE_EQ(ctx, static_cast<int>(clientRequests->size()), 0);
+    MT_REQUIRE_EQ(ctx, static_cast<int>(clientRequests.size()), 0);
 }
 
 MT_TEST(Component, TestClientDataManagerClientThreadTracking1, "clientdatamanager") {
@@ -324,21 +325,17 @@ MT_TEST(Component, TestClientDataManagerClientThreadTracking2, "clientdatamanage
     }
 
     for (int32_t i = 0; i < 20; i++) {
-        std::unordered_set<int64_t>* clientRequests =
-            clientDataManager->getRequestsByClientID(i + 1);
-
-        MT_REQUIRE(ctx, clientRequests != nullptr);
-        MT_REQUIRE_EQ(ctx, static_cast<int>(clientRequests->size()), 1);
+        std::vector<int64_t> clientRequests;
+        MT_REQUIRE(ctx, clientDataManager->getRequestsByClientID(i + 1, clientRequests));
+        MT_REQUIRE_EQ(ctx, static_cast<int>(clientRequests.size()), 1);
 
         clientDataManager->deleteRequestByClientId(i + 1, 5 * i + 7);
     }
 
     for (int32_t i = 0; i < 20; i++) {
-        std::unordered_set<int64_t>* clientRequests =
-            clientDataManager->getRequestsByClientID(i + 1);
-
-        MT_REQUIRE(ctx, clientRequests != nullptr);
-        MT_REQUIRE_EQ(ctx, static_cast<int>(clientRequests->size()), 0);
+        std::vector<int64_t> clientRequests;
+        MT_REQUIRE(ctx, clientDataManager->getRequestsByClientID(i + 1, clientRequests));
+        MT_REQUIRE_EQ(ctx, static_cast<int>(clientRequests.size()), 0);
     }
 
     clientDataManager->deleteClientPID(testClientPID);
@@ -349,3 +346,156 @@ MT_TEST(Component, TestClientDataManagerClientThreadTracking2, "clientdatamanage
 }
 
 
+
+MT_TEST(Component, TestClientDataManagerSuppliedPermissionLevel, "clientdatamanager") {
+    EnsureInit();
+    std::shared_ptr<ClientDataManager> clientDataManager = ClientDataManager::getInstance();
+    int32_t testClientPID = getpid();
+    int32_t testClientTID = 701;
+
+    // A level verified by the Listener is used as is, without consulting procfs.
+    int8_t expectedLevel = (geteuid() == 0) ? PERMISSION_THIRD_PARTY : PERMISSION_SYSTEM;
+    MT_REQUIRE(ctx, clientDataManager->createNewClient(testClientPID, testClientTID, expectedLevel));
+    MT_REQUIRE_EQ(ctx, clientDataManager->getClientLevelByClientID(testClientPID), expectedLevel);
+
+    clientDataManager->deleteClientPID(testClientPID);
+    clientDataManager->deleteClientTID(testClientTID);
+}
+
+MT_TEST(Component, TestClientDataManagerHandleSpillOver, "clientdatamanager") {
+    EnsureInit();
+    std::shared_ptr<ClientDataManager> clientDataManager = ClientDataManager::getInstance();
+
+    int32_t testClientPID = 252;
+    int32_t testClientTID = 252;
+    clientDataManager->createNewClient(testClientPID, testClientTID);
+
+    // Enough handles to overflow the inline slots
+    for (int32_t i = 0; i < 3 * CLIENT_INLINE_HANDLES; i++) {
+        clientDataManager->insertRequestByClientId(testClientTID, 1000 + i);
+    }
+    clientDataManager->insertRequestByClientId(testClientTID, 1000);
+
+    std::vector<int64_t> clientRequests;
+    MT_REQUIRE(ctx, clientDataManager->getRequestsByClientID(testClientTID, clientRequests));
+    MT_REQUIRE_EQ(ctx, static_cast<int>(clientRequests.size()), 3 * CLIENT_INLINE_HANDLES);
+
+    // Drop every other handle, from both the inline slots and the spill set
+    for (int32_t i = 0; i < 3 * CLIENT_INLINE_HANDLES; i += 2) {
+        clientDataManager->deleteRequestByClientId(testClientTID, 1000 + i);
+    }
+
+    clientRequests.clear();
+    clientDataManager->getRequestsByClientID(testClientTID, clientRequests);
+    std::unordered_set<int64_t> remaining(clientRequests.begin(), clientRequests.end());
+    MT_REQUIRE_EQ(ctx, static_cast<int>(remaining.size()), 3 * CLIENT_INLINE_HANDLES / 2);
+    for (int32_t i = 1; i < 3 * CLIENT_INLINE_HANDLES; i += 2) {
+        MT_REQUIRE(ctx, remaining.count(1000 + i) == 1);
+    }
+
+    clientDataManager->deleteClientPID(testClientPID);
+    clientDataManager->deleteClientTID(testClientTID);
+}
+
+MT_TEST(Component, TestClientDataManagerClientChurn, "clientdatamanager") {
+    EnsureInit();
+    std::shared_ptr<ClientDataManager> clientDataManager = ClientDataManager::getInstance();
+
+    // More clients than the shards initially hold, deleted in an interleaved order
+    int32_t clientCount = 4 * CLIENT_TABLE_SHARD_COUNT * CLIENT_SHARD_MIN_CAPACITY;
+    for (int32_t round = 0; round < 3; round++) {
+        for (int32_t i = 1; i <= clientCount; i++) {
+            MT_REQUIRE(ctx, clientDataManager->createNewClient(5000 + i, 5000 + i));
+        }
+
+        for (int32_t i = 1; i <= clientCount; i += 2) {
+            clientDataManager->deleteClientPID(5000 + i);
+            clientDataManager->deleteClientTID(5000 + i);
+        }
+
+        for (int32_t i = 1; i <= clientCount; i++) {
+            MT_REQUIRE_EQ(ctx, clientDataManager->clientExists(5000 + i, 5000 + i), (i % 2 == 0));
+        }
+
+        for (int32_t i = 2; i <= clientCount; i += 2) {
+            clientDataManager->deleteClientPID(5000 + i);
+            clientDataManager->deleteClientTID(5000 + i);
+        }
+    }
+
+    std::vector<int32_t> clientList;
+    clientDataManager->getActiveClientList(clientList);
+    for (int32_t clientPID : clientList) {
+        MT_REQUIRE(ctx, clientPID <= 5000 || clientPID > 5000 + clientCount);
+    }
+}
+
+MT_TEST(Component, TestClientShardGrowsPastItsCapacity, "clientdatamanager") {
+    ClientShard<ClientInfo> shard;
+    shard.reserve(20);
+    MT_REQUIRE_EQ(ctx, shard.getCapacity(), 32);
+
+    // Sizing only applies to an empty shard, and never shrinks it.
+    shard.reserve(8);
+    MT_REQUIRE_EQ(ctx, shard.getCapacity(), 32);
+
+    // Enough entries for the shard to grow twice, the entries are carried over each time.
+    std::vector<int32_t> keys;
+    for (int32_t key = 1; key <= 100; key++) {
+        keys.push_back(key);
+    }
+
+    for (int32_t key : keys) {
+        ClientInfo* clientInfo = shard.insert(key);
+        MT_REQUIRE(ctx, clientInfo != nullptr);
+        clientInfo->mCurClientThreads = key;
+    }
+    MT_REQUIRE(ctx, shard.getCapacity() >= 128);
+
+    for (int32_t key : keys) {
+        ClientInfo* clientInfo = shard.find(key);
+        MT_REQUIRE(ctx, clientInfo != nullptr);
+        MT_REQUIRE_EQ(ctx, clientInfo->mCurClientThreads, key);
+    }
+
+    for (size_t i = 0; i < keys.size(); i += 2) {
+        shard.erase(keys[i]);
+    }
+
+    for (size_t i = 0; i < keys.size(); i++) {
+        MT_REQUIRE_EQ(ctx, shard.find(keys[i]) != nullptr, (i % 2 == 1));
+    }
+}
+
+MT_TEST(Component, TestClientDataManagerClientExitReported, "clientdatamanager") {
+    EnsureInit();
+    std::shared_ptr<ClientDataManager> clientDataManager = ClientDataManager::getInstance();
+    MT_REQUIRE(ctx, clientDataManager->getClientExitFd() >= 0);
+
+    pid_t childPID = fork();
+    if (childPID == 0) {
+        pause();
+        _exit(0);
+    }
+    MT_REQUIRE(ctx, childPID > 0);
+
+    MT_REQUIRE(ctx, clientDataManager->createNewClient(childPID, childPID));
+    kill(childPID, SIGKILL);
+
+    // The exit is reported without any polling of the client list
+    int8_t exitReported = false;
+    epoll_event events[8];
+    for (int32_t attempt = 0; attempt < 10 && !exitReported; attempt++) {
+        int32_t readyFdCount = epoll_wait(clientDataManager->getClientExitFd(), events, 8, 100);
+        for (int32_t i = 0; i < readyFdCount; i++) {
+            if ((int32_t)events[i].data.u64 == childPID) {
+                exitReported = true;
+            }
+        }
+    }
+    waitpid(childPID, nullptr, 0);
+    MT_REQUIRE(ctx, exitReported);
+
+    clientDataManager->deleteClientPID(childPID);
+    clientDataManager->deleteClientTID(childPID);
+}
@@ -9,6 +9,8 @@
 
 #include <iostream>
 #include <cstdint>
+#include <vector>
+#include <unordered_map>
 
 #define MTEST_NO_MAIN
 #include "../framework/mini.h"
@@ -45,3 +47,176 @@ MT_TEST(Component, InsertRequestWithoutCocoNodes, "cocotable") {
     delete request;
 }
 
+
+MT_TEST(Component, RemoveRequestsSkipsInvalidEntries, "cocotable") {
+    Request* request = new Request;
+
+    // Neither entry holds any Resources, the batch should be a no-op.
+    std::vector<Request*> requests = {nullptr, request};
+    CocoTable::getInstance()->removeRequests(requests);
+    MT_REQUIRE_EQ(ctx, CocoTable::getInstance()->removeRequest(request), 0);
+
+    delete request;
+}
+
+// Resources used by the mode transition tests. They are registered before the CocoTable
+// is first created, so that the table has entries for them.
+#define COCO_TEST_RES_HIGHER_BETTER 0x00ee0001
+#define COCO_TEST_RES_PASS_THROUGH 0x00ee0002
+#define COCO_TEST_RES_PASS_THROUGH_FG 0x00ee0003
+#define COCO_TEST_DEFAULT_VALUE -1
+
+static std::unordered_map<uint32_t, int32_t> appliedValues;
+
+static void recordApply(void* context) {
+    Resource* resource = (Resource*) context;
+    appliedValues[resource->getResCode()] = resource->getValueAt(0);
+}
+
+static void recordTear(void* context) {
+    Resource* resource = (Resource*) context;
+    appliedValues[resource->getResCode()] = COCO_TEST_DEFAULT_VALUE;
+}
+
+static void registerTestResource(uint32_t resCode, enum Policy policy) {
+    ResConfInfo* resConfInfo = new ResConfInfo();
+    resConfInfo->mResourceName = "coco_test_resource";
+    resConfInfo->mResourceResType = (uint8_t)(resCode >> 16);
+    resConfInfo->mResourceResID = (uint16_t)(resCode & 0xffff);
+    resConfInfo->mHighThreshold = 1024;
+    resConfInfo->mLowThreshold = 0;
+    resConfInfo->mModes = MODE_RESUME | MODE_SUSPEND;
+    resConfInfo->mApplyType = APPLY_GLOBAL;
+    resConfInfo->mPolicy = policy;
+
+    ResourceRegistry::getInstance()->registerResource(resConfInfo);
+
+    // Record the applied values instead of writing to any node.
+    resConfInfo = ResourceRegistry::getInstance()->getResConf(resCode);
+    resConfInfo->mResourceApplierCallback = recordApply;
+    resConfInfo->mResourceTearCallback = recordTear;
+}
+
+static int8_t registerTestResources() {
+    registerTestResource(COCO_TEST_RES_HIGHER_BETTER, HIGHER_BETTER);
+    registerTestResource(COCO_TEST_RES_PASS_THROUGH, PASS_THROUGH);
+    registerTestResource(COCO_TEST_RES_PASS_THROUGH_FG, PASS_THROUGH);
+    return true;
+}
+
+static int8_t testResourcesRegistered = registerTestResources();
+
+static Request* createTuneRequest(int64_t handle, int8_t background, uint32_t resCode, int32_t value) {
+    Request* request = new (GetBlock<Request>()) Request;
+    request->setRequestType(REQ_RESOURCE_TUNING);
+    request->setHandle(handle);
+    request->setDuration(-1);
+    request->setClientPID(321);
+    request->setClientTID(321);
+    request->setProperties(((background ? MODE_SUSPEND : 0) << 8) | SYSTEM_HIGH);
+
+    Resource* resource = new (GetBlock<Resource>()) Resource;
+    resource->setResCode(resCode);
+    resource->setResInfo(0);
+    resource->setNumValues(1);
+    resource->setValueAt(0, value);
+
+    ResIterable* resIterable = new (GetBlock<ResIterable>()) ResIterable;
+    resIterable->mData = resource;
+    request->addResource(resIterable);
+    return request;
+}
+
+static void enterMode(int8_t mode) {
+    UrmSettings::targetConfigs.currMode = mode;
+    CocoTable::getInstance()->applyModeTransition(mode);
+}
+
+MT_TEST(Component, SuspendSwitchesToBackgroundRequestsAndResumeRestores, "cocotable") {
+    MT_REQUIRE(ctx, testResourcesRegistered);
+    MakeAlloc<Request>(8);
+    MakeAlloc<Resource>(8);
+    MakeAlloc<ResIterable>(8);
+    MakeAlloc<DLManager>(16);
+
+    std::shared_ptr<CocoTable> cocoTable = CocoTable::getInstance();
+    uint8_t savedMode = UrmSettings::targetConfigs.currMode;
+    UrmSettings::targetConfigs.currMode = MODE_RESUME;
+    appliedValues.clear();
+
+    std::vector<Request*> requests = {
+        createTuneRequest(9001, false, COCO_TEST_RES_HIGHER_BETTER, 500),
+        createTuneRequest(9002, true, COCO_TEST_RES_HIGHER_BETTER, 300),
+        createTuneRequest(9003, true, COCO_TEST_RES_PASS_THROUGH, 200),
+        createTuneRequest(9004, false, COCO_TEST_RES_PASS_THROUGH, 700),
+        createTuneRequest(9005, false, COCO_TEST_RES_PASS_THROUGH_FG, 900),
+    };
+
+    for(Request* request: requests) {
+        MT_REQUIRE(ctx, cocoTable->insertRequest(request));
+    }
+
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_HIGHER_BETTER], 500);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH], 700);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH_FG], 900);
+
+    // Only the background Requests stay applied.
+    enterMode(MODE_SUSPEND);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_HIGHER_BETTER], 300);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH], 200);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH_FG], COCO_TEST_DEFAULT_VALUE);
+
+    enterMode(MODE_RESUME);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_HIGHER_BETTER], 500);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH], 700);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH_FG], 900);
+
+    for(Request* request: requests) {
+        cocoTable->removeRequest(request);
+        Request::cleanUpRequest(request);
+    }
+
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_HIGHER_BETTER], COCO_TEST_DEFAULT_VALUE);
+    UrmSettings::targetConfigs.currMode = savedMode;
+}
+
+MT_TEST(Component, PassThroughRequestsHeldWhileSuspended, "cocotable") {
+    MT_REQUIRE(ctx, testResourcesRegistered);
+    MakeAlloc<Request>(8);
+    MakeAlloc<Resource>(8);
+    MakeAlloc<ResIterable>(8);
+    MakeAlloc<DLManager>(16);
+
+    std::shared_ptr<CocoTable> cocoTable = CocoTable::getInstance();
+    uint8_t savedMode = UrmSettings::targetConfigs.currMode;
+    UrmSettings::targetConfigs.currMode = MODE_RESUME;
+    appliedValues.clear();
+
+    Request* background = createTuneRequest(9011, true, COCO_TEST_RES_PASS_THROUGH, 200);
+    MT_REQUIRE(ctx, cocoTable->insertRequest(background));
+
+    enterMode(MODE_SUSPEND);
+
+    // Not applied until resume.
+    Request* foreground = createTuneRequest(9012, false, COCO_TEST_RES_PASS_THROUGH, 700);
+    MT_REQUIRE(ctx, cocoTable->insertRequest(foreground));
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH], 200);
+
+    enterMode(MODE_RESUME);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH], 700);
+
+    // Untuning a held Request does not reset the value applied by the background one.
+    enterMode(MODE_SUSPEND);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH], 200);
+    cocoTable->removeRequest(foreground);
+    Request::cleanUpRequest(foreground);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH], 200);
+
+    enterMode(MODE_RESUME);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH], 200);
+
+    cocoTable->removeRequest(background);
+    Request::cleanUpRequest(background);
+    MT_REQUIRE_EQ(ctx, appliedValues[COCO_TEST_RES_PASS_THROUGH], COCO_TEST_DEFAULT_VALUE);
+    UrmSettings::targetConfigs.currMode = savedMode;
+}
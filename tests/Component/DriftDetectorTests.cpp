@@ -0,0 +1,76 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include "TestUtils.h"
+#include "DriftDetector.h"
+#include "TestAggregator.h"
+
+#define MTEST_NO_MAIN
+#include "../framework/mini.h"
+
+using namespace mtest;
+
+// Suite: DriftDetectorTests
+
+static const std::string driftTestNodePath = "/etc/urm/tests/nodes/drift_detector_test_node.txt";
+
+MT_TEST(Component, DriftDetectorNoDrift, "driftdetector") {
+    AuxRoutines::writeToFile(driftTestNodePath, "250");
+    std::shared_ptr<DriftDetector> detector = DriftDetector::getInstance();
+
+    detector->trackNode(driftTestNodePath, "250", 0x00ff0001);
+    MT_REQUIRE_EQ(ctx, detector->checkForDrift(), 0);
+    MT_REQUIRE_EQ(ctx, detector->getDriftCount(0x00ff0001), (uint64_t)0);
+
+    detector->untrackNode(driftTestNodePath);
+    AuxRoutines::deleteFile(driftTestNodePath);
+}
+
+MT_TEST(Component, DriftDetectorDriftCountedAndReasserted, "driftdetector") {
+    AuxRoutines::writeToFile(driftTestNodePath, "250");
+    std::shared_ptr<DriftDetector> detector = DriftDetector::getInstance();
+    int32_t trackedBefore = detector->getTrackedNodesCount();
+
+    detector->setReassertOnDrift(false);
+    detector->trackNode(driftTestNodePath, "250", 0x00ff0002);
+    MT_REQUIRE_EQ(ctx, detector->getTrackedNodesCount(), trackedBefore + 1);
+
+    // Some other entity overwrites the node
+    AuxRoutines::writeToFile(driftTestNodePath, "900");
+    MT_REQUIRE_EQ(ctx, detector->checkForDrift(), 1);
+    MT_REQUIRE_EQ(ctx, detector->getDriftCount(0x00ff0002), (uint64_t)1);
+    MT_REQUIRE_EQ(ctx, AuxRoutines::readFromFile(driftTestNodePath), std::string("900"));
+
+    detector->setReassertOnDrift(true);
+    MT_REQUIRE_EQ(ctx, detector->checkForDrift(), 1);
+    MT_REQUIRE_EQ(ctx, detector->getDriftCount(0x00ff0002), (uint64_t)2);
+    MT_REQUIRE_EQ(ctx, AuxRoutines::readFromFile(driftTestNodePath), std::string("250"));
+    MT_REQUIRE_EQ(ctx, detector->checkForDrift(), 0);
+
+    detector->setReassertOnDrift(false);
+    detector->untrackNode(driftTestNodePath);
+    MT_REQUIRE_EQ(ctx, detector->getTrackedNodesCount(), trackedBefore);
+    AuxRoutines::deleteFile(driftTestNodePath);
+}
+
+MT_TEST(Component, DriftDetectorOpensNodesCreatedAfterTracking, "driftdetector") {
+    AuxRoutines::deleteFile(driftTestNodePath);
+    std::shared_ptr<DriftDetector> detector = DriftDetector::getInstance();
+
+    detector->setReassertOnDrift(false);
+    detector->trackNode(driftTestNodePath, "250", 0x00ff0003);
+    MT_REQUIRE_EQ(ctx, detector->checkForDrift(), 0);
+
+    // Opened (and cached) by the check, once the node shows up.
+    AuxRoutines::writeToFile(driftTestNodePath, "900");
+    MT_REQUIRE_EQ(ctx, detector->checkForDrift(), 1);
+    MT_REQUIRE_EQ(ctx, detector->checkForDrift(), 1);
+    MT_REQUIRE_EQ(ctx, detector->getDriftCount(0x00ff0003), (uint64_t)2);
+
+    // Re-tracked with the value found, the node is in sync again.
+    detector->trackNode(driftTestNodePath, "900", 0x00ff0003);
+    MT_REQUIRE_EQ(ctx, detector->checkForDrift(), 0);
+
+    detector->untrackNode(driftTestNodePath);
+    AuxRoutines::deleteFile(driftTestNodePath);
+}
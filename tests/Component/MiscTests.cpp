@@ -8,6 +8,14 @@
 #include "MemoryPool.h"
 #include "Request.h"
 #include "Signal.h"
+#include "Logger.h"
+
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <unistd.h>
+#include "ResourceRegistry.h"
 #include "TestAggregator.h"
 #include "TestUtils.h" // where MakeAlloc<T>() lives
 
@@ -162,3 +170,253 @@ MT_TEST(Component, RequestModeAddition, "misctest") {
         static_cast<uint32_t>(MODE_DOZE));
 }
 
+
+MT_TEST(Component, ResourceDefaultValueLazyCapture, "misctest") {
+    const std::string nodePath = "/etc/urm/tests/nodes/lazy_default_capture_node.txt";
+    AuxRoutines::writeToFile(nodePath, "734");
+    ResourceRegistry::getInstance()->deleteDefaultValue(nodePath);
+
+    MT_REQUIRE_EQ(ctx, ResourceRegistry::getInstance()->getDefaultValue(nodePath), std::string(""));
+    ResourceRegistry::getInstance()->captureDefaultValue(nodePath);
+    MT_REQUIRE_EQ(ctx, ResourceRegistry::getInstance()->getDefaultValue(nodePath), std::string("734"));
+
+    // Once captured, subsequent writes to the node must not replace the default
+    AuxRoutines::writeToFile(nodePath, "1200");
+    ResourceRegistry::getInstance()->captureDefaultValue(nodePath);
+    MT_REQUIRE_EQ(ctx, ResourceRegistry::getInstance()->getDefaultValue(nodePath), std::string("734"));
+
+    ResourceRegistry::getInstance()->deleteDefaultValue(nodePath);
+    AuxRoutines::deleteFile(nodePath);
+}
+
+MT_TEST(Component, SignalWireFormatRoundTrip, "misctest") {
+    MakeAlloc<Signal>(4);
+    MakeAlloc<std::vector<uint32_t>>(4);
+
+    std::vector<uint32_t> listArgs = {7, 300, 70000};
+    Signal signal;
+    signal.setRequestType(REQ_SIGNAL_TUNING);
+    signal.setHandle(-5);
+    signal.setDuration(2500);
+    signal.setProperties(3);
+    signal.setClientPID(1234);
+    signal.setClientTID(5678);
+    signal.setSignalCode(0x80a10000);
+    signal.setSignalType(2);
+    signal.setAppName("camera");
+    signal.setScenario("launch");
+    signal.setNumArgs(listArgs.size());
+    signal.setList(&listArgs);
+
+    char buf[REQ_BUFFER_SIZE];
+    MT_REQUIRE_EQ(ctx, signal.serialize(buf, sizeof(buf)), RC_SUCCESS);
+
+    Signal* decoded = new(GetBlock<Signal>()) Signal;
+    MT_REQUIRE_EQ(ctx, decoded->deserialize(buf, sizeof(buf)), RC_SUCCESS);
+    MT_REQUIRE_EQ(ctx, decoded->getRequestType(), (int8_t)REQ_SIGNAL_TUNING);
+    MT_REQUIRE_EQ(ctx, decoded->getHandle(), (int64_t)-5);
+    MT_REQUIRE_EQ(ctx, decoded->getDuration(), (int64_t)2500);
+    MT_REQUIRE_EQ(ctx, decoded->getProperties(), 3);
+    MT_REQUIRE_EQ(ctx, decoded->getClientPID(), 1234);
+    MT_REQUIRE_EQ(ctx, decoded->getClientTID(), 5678);
+    MT_REQUIRE_EQ(ctx, decoded->getSignalCode(), (uint32_t)0x80a10000);
+    MT_REQUIRE_EQ(ctx, decoded->getSignalType(), (uint32_t)2);
+    MT_REQUIRE_EQ(ctx, decoded->getAppName(), std::string("camera"));
+    MT_REQUIRE_EQ(ctx, decoded->getScenario(), std::string("launch"));
+    MT_REQUIRE_EQ(ctx, decoded->getNumArgs(), 3);
+    for(int32_t i = 0; i < 3; i++) {
+        MT_REQUIRE_EQ(ctx, decoded->getListArgAt(i), listArgs[i]);
+    }
+    Signal::cleanUpSignal(decoded);
+}
+
+MT_TEST(Component, RequestWireFormatDefaultsAndBounds, "misctest") {
+    MakeAlloc<DLManager>(8);
+    MakeAlloc<ResIterable>(8);
+    MakeAlloc<Resource>(8);
+
+    // A single-valued Tune Request with the duration and properties left at their defaults.
+    char buf[REQ_BUFFER_SIZE];
+    FlatBuffEncoder encoder(sizeof(buf));
+    encoder.setBuf(buf);
+    encoder.append<int8_t>(MOD_RESTUNE)
+           .append<int8_t>(REQ_RESOURCE_TUNING)
+           .append<int8_t>(WIRE_FORMAT_VERSION)
+           .appendSignedVarint(300)
+           .appendVarint(0)
+           .appendVarint(1234)
+           .appendVarint(5678)
+           .appendVarint(1)
+           .appendVarint(0x00030000)
+           .appendVarint(0)
+           .appendVarint(0)
+           .appendVarint(1)
+           .appendSignedVarint(-1);
+    MT_REQUIRE(ctx, encoder.isBufSane());
+
+    int32_t encodedSize = encoder.getEncodedSize();
+    MT_REQUIRE(ctx, encodedSize <= REQ_SMALL_BUFFER_SIZE);
+
+    Request request;
+    MT_REQUIRE_EQ(ctx, request.deserialize(buf, encodedSize), RC_SUCCESS);
+    MT_REQUIRE_EQ(ctx, request.getHandle(), (int64_t)300);
+    MT_REQUIRE_EQ(ctx, request.getDuration(), (int64_t)-1);
+    MT_REQUIRE_EQ(ctx, request.getProperties(), 0);
+    MT_REQUIRE_EQ(ctx, request.getClientPID(), 1234);
+    MT_REQUIRE_EQ(ctx, request.getResourcesCount(), 1);
+
+    Resource* resource = (Resource*)((ResIterable*)request.getResDlMgr()->mHead)->mData;
+    MT_REQUIRE_EQ(ctx, resource->getResCode(), (uint32_t)0x00030000);
+    MT_REQUIRE_EQ(ctx, resource->getValueAt(0), -1);
+    request.clearResources();
+
+    // Truncated Requests and unknown format versions are rejected.
+    Request truncated;
+    MT_REQUIRE_EQ(ctx, truncated.deserialize(buf, encodedSize - 1), RC_REQUEST_PARSING_FAILED);
+    truncated.clearResources();
+
+    buf[2] = WIRE_FORMAT_VERSION + 1;
+    Request unversioned;
+    MT_REQUIRE_EQ(ctx, unversioned.deserialize(buf, encodedSize), RC_REQUEST_PARSING_FAILED);
+}
+
+MT_TEST(Component, LoggerDisabledLevelSkipsFormatting, "misctest") {
+    int32_t evaluations = 0;
+    auto buildMessage = [&evaluations]() {
+        evaluations++;
+        return std::string("message");
+    };
+
+    Logger::configure(LOG_ERR, false, RedirectOptions::LOG_TOSYSLOG);
+    MT_REQUIRE(ctx, Logger::isLevelEnabled(LOG_ERR));
+    MT_REQUIRE(ctx, !Logger::isLevelEnabled(LOG_INFO));
+    MT_REQUIRE(ctx, !Logger::isLevelEnabled(LOG_DEBUG));
+    MT_REQUIRE(ctx, Logger::isTypeEnabled(ERRNO_LOG));
+    MT_REQUIRE(ctx, !Logger::isTypeEnabled(NOTIFY_NODE_WRITE));
+
+    LOGD("RESTUNE_TEST", buildMessage());
+    MT_REQUIRE_EQ(ctx, evaluations, 0);
+    LOGE("RESTUNE_TEST", buildMessage());
+    MT_REQUIRE_EQ(ctx, evaluations, 1);
+
+    Logger::configure(LOG_INFO, true, RedirectOptions::LOG_TOSYSLOG);
+    MT_REQUIRE(ctx, Logger::isLevelEnabled(LOG_INFO));
+    MT_REQUIRE(ctx, !Logger::isLevelEnabled(LOG_ERR));
+    MT_REQUIRE(ctx, !Logger::isTypeEnabled(ERRNO_LOG));
+
+    Logger::configure(LOG_DEBUG, false, RedirectOptions::LOG_TOSYSLOG);
+    MT_REQUIRE(ctx, Logger::isLevelEnabled(LOG_DEBUG));
+    MT_REQUIRE(ctx, Logger::isTypeEnabled(NOTIFY_NODE_WRITE));
+}
+
+MT_TEST(Component, LoggerSinkWritesRecordsFromAllThreads, "misctest") {
+    int8_t logFilePresent = AuxRoutines::fileExists("log.txt");
+
+    Logger::configure(LOG_DEBUG, false, RedirectOptions::LOG_TOFILE);
+    MT_REQUIRE(ctx, Logger::startSink());
+
+    auto logRoutine = [](int32_t threadId) {
+        for(int32_t i = 0; i < 20; i++) {
+            LOGI("RESTUNE_TEST", "sink-record-" + std::to_string(threadId) + "-" + std::to_string(i));
+        }
+    };
+
+    std::thread first(logRoutine, 1);
+    std::thread second(logRoutine, 2);
+    first.join();
+    second.join();
+
+    Logger::stopSink();
+    Logger::configure(LOG_DEBUG, false, RedirectOptions::LOG_TOSYSLOG);
+
+    std::ifstream logFile("log.txt");
+    std::stringstream contents;
+    contents<<logFile.rdbuf();
+    logFile.close();
+    if(!logFilePresent) {
+        AuxRoutines::deleteFile("log.txt");
+    }
+
+    MT_REQUIRE_EQ(ctx, Logger::getDroppedCount(), (uint64_t)0);
+    for(int32_t threadId = 1; threadId <= 2; threadId++) {
+        for(int32_t i = 0; i < 20; i++) {
+            std::string marker = "sink-record-" + std::to_string(threadId) + "-" + std::to_string(i) + "\n";
+            MT_REQUIRE(ctx, contents.str().find(marker) != std::string::npos);
+        }
+    }
+}
+
+MT_TEST(Component, LoggerIdleSinkIsWokenByRecords, "misctest") {
+    int8_t logFilePresent = AuxRoutines::fileExists("log.txt");
+    std::string marker = "sink-wakeup-" + std::to_string(getpid()) + "-" + std::to_string(time(nullptr));
+
+    Logger::configure(LOG_DEBUG, false, RedirectOptions::LOG_TOFILE);
+    MT_REQUIRE(ctx, Logger::startSink());
+
+    // Give the sink time to find the rings empty and go to sleep.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    LOGI("RESTUNE_TEST", marker);
+
+    // Written by the sink well before it is stopped.
+    int8_t written = false;
+    for(int32_t i = 0; i < 100 && !written; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::ifstream logFile("log.txt");
+        std::stringstream contents;
+        contents<<logFile.rdbuf();
+        written = contents.str().find(marker) != std::string::npos;
+    }
+
+    Logger::stopSink();
+    Logger::configure(LOG_DEBUG, false, RedirectOptions::LOG_TOSYSLOG);
+    if(!logFilePresent) {
+        AuxRoutines::deleteFile("log.txt");
+    }
+
+    MT_REQUIRE(ctx, written);
+}
+
+MT_TEST(Component, LoggerSinkStopKeepsRecordsInFlight, "misctest") {
+    int8_t logFilePresent = AuxRoutines::fileExists("log.txt");
+    std::string runMarker = "sink-stop-" + std::to_string(getpid()) + "-" + std::to_string(time(nullptr)) + "-";
+
+    Logger::configure(LOG_DEBUG, false, RedirectOptions::LOG_TOFILE);
+    uint64_t droppedBefore = Logger::getDroppedCount();
+    MT_REQUIRE(ctx, Logger::startSink());
+
+    // Records are logged while the sink is being stopped, each is either
+    // written (by the sink, or inline) or accounted for as dropped.
+    std::atomic<int8_t> keepLogging(true);
+    std::atomic<uint64_t> loggedCount(0);
+    auto logRoutine = [&keepLogging, &loggedCount, &runMarker]() {
+        while(keepLogging.load()) {
+            LOGI("RESTUNE_TEST", runMarker + "record");
+            loggedCount.fetch_add(1);
+        }
+    };
+
+    std::thread first(logRoutine);
+    std::thread second(logRoutine);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    Logger::stopSink();
+    keepLogging.store(false);
+    first.join();
+    second.join();
+
+    Logger::configure(LOG_DEBUG, false, RedirectOptions::LOG_TOSYSLOG);
+
+    std::ifstream logFile("log.txt");
+    std::string line;
+    uint64_t writtenCount = 0;
+    while(std::getline(logFile, line)) {
+        if(line.find(runMarker) != std::string::npos) {
+            writtenCount++;
+        }
+    }
+    logFile.close();
+    if(!logFilePresent) {
+        AuxRoutines::deleteFile("log.txt");
+    }
+
+    MT_REQUIRE_EQ(ctx, writtenCount + (Logger::getDroppedCount() - droppedBefore), loggedCount.load());
+}
@@ -0,0 +1,60 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include "TestUtils.h"
+#include "NodeArbiter.h"
+#include "TestAggregator.h"
+
+#define MTEST_NO_MAIN
+#include "../framework/mini.h"
+
+using namespace mtest;
+
+// Suite: NodeArbiterTests
+
+MT_TEST(Component, NodeArbiterLowerBetterAcrossResources, "nodearbiter") {
+    const std::string nodePath = "/sys/devices/system/cpu/cpu1/power/pm_qos_resume_latency_us";
+    std::shared_ptr<NodeArbiter> arbiter = NodeArbiter::getInstance();
+    std::string winner = "";
+    uint32_t winnerResCode = 0;
+
+    // Cluster variant claims the node first
+    MT_REQUIRE(ctx, arbiter->claim(nodePath, 0x00010001, "300", LOWER_BETTER, winner, winnerResCode));
+    MT_REQUIRE_EQ(ctx, winner, std::string("300"));
+
+    // Core variant with a better value takes over the node
+    MT_REQUIRE(ctx, arbiter->claim(nodePath, 0x00010002, "100", LOWER_BETTER, winner, winnerResCode));
+    MT_REQUIRE_EQ(ctx, winner, std::string("100"));
+    MT_REQUIRE_EQ(ctx, winnerResCode, (uint32_t)0x00010002);
+
+    // A worse value from the cluster variant does not result in a write
+    MT_REQUIRE(ctx, !arbiter->claim(nodePath, 0x00010001, "500", LOWER_BETTER, winner, winnerResCode));
+    MT_REQUIRE_EQ(ctx, arbiter->getClaimsCount(nodePath), 2);
+
+    // Tear of the core variant falls back to the cluster variant's value, not the default
+    MT_REQUIRE(ctx, arbiter->release(nodePath, 0x00010002, winner, winnerResCode));
+    MT_REQUIRE_EQ(ctx, winner, std::string("500"));
+    MT_REQUIRE_EQ(ctx, winnerResCode, (uint32_t)0x00010001);
+
+    // Last claim dropped, node needs to be reset
+    MT_REQUIRE(ctx, !arbiter->release(nodePath, 0x00010001, winner, winnerResCode));
+    MT_REQUIRE_EQ(ctx, arbiter->getClaimsCount(nodePath), 0);
+}
+
+MT_TEST(Component, NodeArbiterInstantApplyLatestWins, "nodearbiter") {
+    const std::string nodePath = "/etc/urm/tests/nodes/node_arbiter_shared_node.txt";
+    std::shared_ptr<NodeArbiter> arbiter = NodeArbiter::getInstance();
+    std::string winner = "";
+    uint32_t winnerResCode = 0;
+
+    MT_REQUIRE(ctx, arbiter->claim(nodePath, 0x00ff0001, "10", INSTANT_APPLY, winner, winnerResCode));
+    MT_REQUIRE(ctx, arbiter->claim(nodePath, 0x00ff0002, "20", INSTANT_APPLY, winner, winnerResCode));
+    MT_REQUIRE_EQ(ctx, winner, std::string("20"));
+    MT_REQUIRE(ctx, arbiter->claim(nodePath, 0x00ff0001, "30", INSTANT_APPLY, winner, winnerResCode));
+    MT_REQUIRE_EQ(ctx, winner, std::string("30"));
+
+    MT_REQUIRE(ctx, arbiter->release(nodePath, 0x00ff0001, winner, winnerResCode));
+    MT_REQUIRE_EQ(ctx, winner, std::string("20"));
+    MT_REQUIRE_EQ(ctx, winnerResCode, (uint32_t)0x00ff0002);
+    MT_REQUIRE(ctx, !arbiter->release(nodePath, 0x00ff0002, winner, winnerResCode));
+}
@@ -0,0 +1,54 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include "TestUtils.h"
+#include "NodeJournal.h"
+#include "TestAggregator.h"
+
+#define MTEST_NO_MAIN
+#include "../framework/mini.h"
+
+using namespace mtest;
+
+// Suite: NodeJournalTests
+
+static const std::string journalTestFilePath = "/etc/urm/tests/nodes/node_journal_test.journal";
+static const std::string journalTestNodePath = "/etc/urm/tests/nodes/node_journal_test_node.txt";
+
+MT_TEST(Component, NodeJournalRecoverOriginalValues, "nodejournal") {
+    std::shared_ptr<NodeJournal> journal = NodeJournal::getInstance();
+    AuxRoutines::writeToFile(journalTestNodePath, "300");
+
+    MT_REQUIRE_EQ(ctx, journal->open(journalTestFilePath), RC_SUCCESS);
+    journal->recordOriginalValue(journalTestNodePath, "300");
+    AuxRoutines::writeToFile(journalTestNodePath, "900");
+    journal->recordAppliedValue(journalTestNodePath, "900");
+
+    // A second capture must not replace the original value
+    journal->recordOriginalValue(journalTestNodePath, "900");
+    MT_REQUIRE_EQ(ctx, journal->getRecordedNodesCount(), 1);
+
+    // Simulate a restart with the journal left behind
+    MT_REQUIRE_EQ(ctx, NodeJournal::recover(journalTestFilePath), 1);
+    MT_REQUIRE_EQ(ctx, AuxRoutines::readFromFile(journalTestNodePath), std::string("300"));
+
+    // Erased nodes are not restored
+    journal->eraseNode(journalTestNodePath);
+    MT_REQUIRE_EQ(ctx, journal->getRecordedNodesCount(), 0);
+    AuxRoutines::writeToFile(journalTestNodePath, "900");
+    MT_REQUIRE_EQ(ctx, NodeJournal::recover(journalTestFilePath), 0);
+    MT_REQUIRE_EQ(ctx, AuxRoutines::readFromFile(journalTestNodePath), std::string("900"));
+
+    journal->close();
+    AuxRoutines::deleteFile(journalTestFilePath);
+    AuxRoutines::deleteFile(journalTestNodePath);
+}
+
+MT_TEST(Component, NodeJournalMalformedFile, "nodejournal") {
+    // A legacy or corrupted file is discarded
+    AuxRoutines::writeToFile(journalTestFilePath, "/sys/some/node,100\n");
+    MT_REQUIRE_EQ(ctx, NodeJournal::recover(journalTestFilePath), 0);
+    AuxRoutines::deleteFile(journalTestFilePath);
+
+    MT_REQUIRE_EQ(ctx, NodeJournal::recover("/etc/urm/tests/nodes/non_existent.journal"), 0);
+}
@@ -0,0 +1,58 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "TestUtils.h"
+#include "PmQosManager.h"
+#include "TestAggregator.h"
+
+#define MTEST_NO_MAIN
+#include "../framework/mini.h"
+
+using namespace mtest;
+
+// Suite: PmQosManagerTests
+
+static const std::string qosTestNodePath = "/etc/urm/tests/nodes/pm_qos_test_node.txt";
+
+static int32_t readQosValue(const std::string& nodePath, off_t& nodeSize) {
+    int32_t value = -1;
+    int32_t fd = open(nodePath.c_str(), O_RDONLY);
+    if(fd < 0) return value;
+
+    nodeSize = lseek(fd, 0, SEEK_END);
+    if(pread(fd, &value, sizeof(value), 0) != sizeof(value)) {
+        value = -1;
+    }
+    close(fd);
+    return value;
+}
+
+MT_TEST(Component, PmQosHandleHeldAndRewrittenInPlace, "pmqos") {
+    AuxRoutines::writeToFile(qosTestNodePath, "");
+    std::shared_ptr<PmQosManager> qosManager = PmQosManager::getInstance();
+    off_t nodeSize = 0;
+
+    MT_REQUIRE_EQ(ctx, qosManager->applyQos(qosTestNodePath, 100), RC_SUCCESS);
+    MT_REQUIRE(ctx, qosManager->isQosHeld(qosTestNodePath));
+    MT_REQUIRE_EQ(ctx, readQosValue(qosTestNodePath, nodeSize), 100);
+
+    // Winner change, the same fd is reused and the value is overwritten
+    MT_REQUIRE_EQ(ctx, qosManager->applyQos(qosTestNodePath, 20), RC_SUCCESS);
+    MT_REQUIRE_EQ(ctx, readQosValue(qosTestNodePath, nodeSize), 20);
+    MT_REQUIRE_EQ(ctx, nodeSize, (off_t)sizeof(int32_t));
+
+    qosManager->releaseQos(qosTestNodePath);
+    MT_REQUIRE(ctx, !qosManager->isQosHeld(qosTestNodePath));
+    AuxRoutines::deleteFile(qosTestNodePath);
+}
+
+MT_TEST(Component, PmQosInvalidNode, "pmqos") {
+    std::shared_ptr<PmQosManager> qosManager = PmQosManager::getInstance();
+    MT_REQUIRE_EQ(ctx, qosManager->applyQos("", 10), RC_BAD_ARG);
+    MT_REQUIRE_EQ(ctx, qosManager->applyQos("/etc/urm/tests/nodes/non_existent_qos_node", 10),
+                  RC_FILE_NOT_FOUND);
+    MT_REQUIRE(ctx, !qosManager->isQosHeld("/etc/urm/tests/nodes/non_existent_qos_node"));
+}
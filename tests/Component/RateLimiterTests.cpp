@@ -8,6 +8,7 @@
 #include <limits>
 #include <chrono>
 #include <thread>
+#include <atomic>
 #include <new>       
 #include <iostream>
 
@@ -21,8 +22,6 @@
 
 // ---------- Init (unchanged) ----------
 static void Init() {
-    MakeAlloc<ClientInfo> (30);
-    MakeAlloc<ClientTidData> (30);
     MakeAlloc<std::unordered_set<int64_t>> (30);
     MakeAlloc<Resource> (120);
     MakeAlloc<Request> (100);
@@ -198,3 +197,35 @@ MT_TEST(Component, TestClientSpammingWithGoodRequests, "ratelimiter") {
     }
 }
 
+// TestConcurrentClientSpamming
+MT_TEST(Component, TestConcurrentClientSpamming, "ratelimiter") {
+    Init();
+    std::shared_ptr<ClientDataManager> clientDataManager = ClientDataManager::getInstance();
+    std::shared_ptr<RateLimiter>       rateLimiter       = RateLimiter::getInstance();
+
+    int32_t clientPID = 999;
+    int32_t clientTID = 999;
+    clientDataManager->createNewClient(clientPID, clientTID);
+
+    // Same budget as TestClientSpammingScenario, spread across threads
+    std::atomic<int32_t> acceptedCount(0);
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < 4; t++) {
+        threads.emplace_back([&]() {
+            for (int32_t i = 0; i < 20; i++) {
+                if (rateLimiter->isRateLimitHonored(clientTID)) {
+                    acceptedCount.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (std::thread& th : threads) {
+        th.join();
+    }
+
+    MT_REQUIRE_EQ(ctx, acceptedCount.load(), 50);
+    MT_REQUIRE(ctx, clientDataManager->getHealthByClientID(clientTID) <= 0);
+
+    clientDataManager->deleteClientPID(clientPID);
+    clientDataManager->deleteClientTID(clientTID);
+}
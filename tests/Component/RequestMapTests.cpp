@@ -9,6 +9,8 @@
 #include <cstdint>
 #include <limits>
 #include <new>       // std::bad_alloc
+#include <atomic>
+#include <thread>
 
 #define MTEST_NO_MAIN
 #include "../framework/mini.h"
@@ -23,8 +25,6 @@
 
 // ---------- Init ----------
 static void Init() {
-    MakeAlloc<ClientInfo> (30);
-    MakeAlloc<ClientTidData> (30);
     MakeAlloc<std::unordered_set<int64_t>> (30);
     MakeAlloc<Resource> (30);
     MakeAlloc<ResIterable> (30);
@@ -436,6 +436,139 @@ MT_TEST_F(Component, TestDuplicateRequestScenario4, "requestmap", CleanStateFixt
     Request::cleanUpRequest(secondRequest);
 }
 
+// TestDuplicateRequestScenario5
+// Same Resources specified in a different order, along with a Request which
+// differs only in the multiplicity of a Resource.
+MT_TEST_F(Component, TestDuplicateRequestScenario5, "requestmap", CleanStateFixture) {
+    Init();
+    std::shared_ptr<ClientDataManager> clientDataManager = ClientDataManager::getInstance();
+    std::shared_ptr<RequestManager>    requestMap        = RequestManager::getInstance();
+
+    Request* requests[3];
+    int32_t seeds[3][3] = {{1, 2, 3}, {3, 1, 2}, {1, 1, 2}};
+
+    for(int32_t index = 0; index < 3; index++) {
+        requests[index] = MPLACED(Request);
+        requests[index]->setRequestType(REQ_RESOURCE_TUNING);
+        requests[index]->setHandle(401 + index);
+        requests[index]->setDuration(-1);
+        requests[index]->setPriority(REQ_PRIORITY_HIGH);
+        requests[index]->setClientPID(321);
+        requests[index]->setClientTID(321);
+        requests[index]->setBackgroundProcessing(false);
+
+        for(int32_t seed: seeds[index]) {
+            ResIterable* resIter = MPLACED(ResIterable);
+            resIter->mData = generateResourceForTesting(seed);
+            requests[index]->addResource(resIter);
+        }
+    }
+
+    MT_REQUIRE(ctx, requests[0]->getFingerprint() == requests[1]->getFingerprint());
+    MT_REQUIRE(ctx, requests[0]->getFingerprint() != requests[2]->getFingerprint());
+
+    if(!clientDataManager->clientExists(321, 321)) {
+        clientDataManager->createNewClient(321, 321);
+    }
+
+    // The admission limit is otherwise only configured at Server init.
+    uint32_t maxConcurrentRequests = UrmSettings::metaConfigs.mMaxConcurrentRequests;
+    UrmSettings::metaConfigs.mMaxConcurrentRequests = 10;
+
+    int8_t resultFirst  = requestMap->shouldRequestBeAdded(requests[0]);
+    if(resultFirst)  requestMap->addRequest(requests[0]);
+
+    int8_t resultSecond = requestMap->shouldRequestBeAdded(requests[1]);
+    int8_t resultThird  = requestMap->shouldRequestBeAdded(requests[2]);
+
+    MT_REQUIRE(ctx, resultFirst  == true);
+    MT_REQUIRE(ctx, resultSecond == false);
+    MT_REQUIRE(ctx, resultThird  == true);
+
+    // Once the original Request is removed, the duplicate is accepted.
+    requestMap->removeRequest(requests[0]);
+    MT_REQUIRE(ctx, requestMap->shouldRequestBeAdded(requests[1]) == true);
+
+    UrmSettings::metaConfigs.mMaxConcurrentRequests = maxConcurrentRequests;
+    clientDataManager->deleteClientPID(321);
+    clientDataManager->deleteClientTID(321);
+
+    for(int32_t index = 0; index < 3; index++) {
+        Request::cleanUpRequest(requests[index]);
+    }
+}
+
+// TestConcurrentAdmissionLimit
+// Requests admitted from multiple threads land on different stripes, while the
+// concurrency limit still applies across all of them.
+MT_TEST_F(Component, TestConcurrentAdmissionLimit, "requestmap", CleanStateFixture) {
+    Init();
+    std::shared_ptr<ClientDataManager> clientDataManager = ClientDataManager::getInstance();
+    std::shared_ptr<RequestManager>    requestMap        = RequestManager::getInstance();
+
+    const int32_t threadCount = 4;
+    const int32_t requestsPerThread = 6;
+    std::vector<Request*> requests;
+
+    for(int32_t index = 0; index < threadCount * requestsPerThread; index++) {
+        int32_t clientTID = 500 + index / requestsPerThread;
+
+        ResIterable* resIter = MPLACED(ResIterable);
+        resIter->mData = generateResourceForTesting(index);
+
+        Request* request = MPLACED(Request);
+        request->setRequestType(REQ_RESOURCE_TUNING);
+        request->setHandle(600 + index);
+        request->setDuration(-1);
+        request->setPriority(REQ_PRIORITY_HIGH);
+        request->setClientPID(500);
+        request->setClientTID(clientTID);
+        request->addResource(resIter);
+        request->setBackgroundProcessing(false);
+        requests.push_back(request);
+
+        if(!clientDataManager->clientExists(500, clientTID)) {
+            clientDataManager->createNewClient(500, clientTID);
+        }
+    }
+
+    uint32_t maxConcurrentRequests = UrmSettings::metaConfigs.mMaxConcurrentRequests;
+    UrmSettings::metaConfigs.mMaxConcurrentRequests = 20;
+
+    std::atomic<int32_t> admittedCount(0);
+    std::vector<std::thread> threads;
+    for(int32_t t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t] {
+            for(int32_t i = 0; i < requestsPerThread; i++) {
+                if(requestMap->addRequest(requests[t * requestsPerThread + i])) {
+                    admittedCount.fetch_add(1);
+                }
+            }
+        });
+    }
+    for(std::thread& thread: threads) {
+        thread.join();
+    }
+
+    MT_REQUIRE_EQ(ctx, admittedCount.load(), 20);
+    MT_REQUIRE_EQ(ctx, requestMap->getActiveReqeustsCount(), 20);
+
+    for(Request* request: requests) {
+        requestMap->removeRequest(request);
+    }
+    MT_REQUIRE_EQ(ctx, requestMap->getActiveReqeustsCount(), 0);
+
+    UrmSettings::metaConfigs.mMaxConcurrentRequests = maxConcurrentRequests;
+    for(int32_t t = 0; t < threadCount; t++) {
+        clientDataManager->deleteClientTID(500 + t);
+    }
+    clientDataManager->deleteClientPID(500);
+
+    for(Request* request: requests) {
+        Request::cleanUpRequest(request);
+    }
+}
+
 // TestMultipleClientsScenario5
 MT_TEST_F(Component, TestMultipleClientsScenario5, "requestmap", CleanStateFixture) {
     Init();
@@ -0,0 +1,159 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+
+#include "TestUtils.h"
+#include "ShmListener.h"
+#include "RestuneListener.h"
+#include "TestAggregator.h"
+
+#define MTEST_NO_MAIN
+#include "../framework/mini.h"
+
+using namespace mtest;
+
+// Suite: ShmTransportTests
+
+static int32_t listenIterations = 0;
+static std::vector<std::string> receivedPayloads;
+
+static int8_t listenOnce() {
+    return listenIterations++ == 0;
+}
+
+static void recordMessage(int32_t channelId, MsgForwardInfo* info) {
+    (void)channelId;
+    receivedPayloads.push_back(std::string(info->mBuffer, 4));
+    freeForwardInfo(info);
+}
+
+static ShmRegion* createRegion(int32_t& memFd, int8_t seal) {
+    memFd = memfd_create("urm-shm-test", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if(memFd < 0 || ftruncate(memFd, sizeof(ShmRegion)) < 0) return nullptr;
+    if(seal && fcntl(memFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) < 0) return nullptr;
+
+    void* region = mmap(nullptr, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+    if(region == MAP_FAILED) return nullptr;
+
+    ((ShmRegion*)region)->mMagic = SHM_RING_MAGIC;
+    ((ShmRegion*)region)->mVersion = SHM_RING_VERSION;
+    return (ShmRegion*)region;
+}
+
+MT_TEST(Component, ShmRingWrapsAndReportsFull, "shmtransport") {
+    ShmRing* ring = new ShmRing();
+    char buf[8] = {0};
+
+    MT_REQUIRE_EQ(ctx, shmRingPop(ring, buf, sizeof(buf)), 0);
+    for(int32_t round = 0; round < 3; round++) {
+        for(int32_t i = 0; i < SHM_RING_SLOT_COUNT; i++) {
+            MT_REQUIRE(ctx, shmRingPush(ring, &i, sizeof(i)));
+        }
+        MT_REQUIRE(ctx, !shmRingPush(ring, buf, sizeof(buf)));
+
+        for(int32_t i = 0; i < SHM_RING_SLOT_COUNT; i++) {
+            int32_t value = -1;
+            MT_REQUIRE_EQ(ctx, shmRingPop(ring, &value, sizeof(value)), (int32_t)sizeof(int32_t));
+            MT_REQUIRE_EQ(ctx, value, i);
+        }
+        MT_REQUIRE_EQ(ctx, shmRingPop(ring, buf, sizeof(buf)), 0);
+    }
+
+    // Indices published by the peer are never trusted.
+    ring->mHead = ring->mTail + SHM_RING_SLOT_COUNT + 1;
+    MT_REQUIRE_EQ(ctx, shmRingPop(ring, buf, sizeof(buf)), -1);
+    delete ring;
+}
+
+MT_TEST(Component, ShmChannelRequiresSealedRegion, "shmtransport") {
+    int32_t memFd = -1;
+    ShmRegion* region = createRegion(memFd, false);
+    MT_REQUIRE(ctx, region != nullptr);
+
+    int32_t channelId = ShmServer::getInstance()->attachChannel(-100, memFd, eventfd(0, EFD_NONBLOCK),
+                                                                eventfd(0, EFD_NONBLOCK));
+    MT_REQUIRE_EQ(ctx, channelId, -1);
+    MT_REQUIRE_EQ(ctx, ShmServer::getInstance()->getChannelsCount(), 0);
+    munmap(region, sizeof(ShmRegion));
+}
+
+MT_TEST(Component, ShmChannelDrainsRequestsAndPublishesReplies, "shmtransport") {
+    MakeAlloc<MsgForwardInfo> (8);
+    MakeAlloc<char[REQ_BUFFER_SIZE]> (8);
+
+    int32_t memFd = -1;
+    ShmRegion* region = createRegion(memFd, true);
+    MT_REQUIRE(ctx, region != nullptr);
+
+    int32_t requestDoorbell = eventfd(0, EFD_NONBLOCK);
+    int32_t responseDoorbell = eventfd(0, EFD_NONBLOCK);
+    // The Server takes ownership of the fds, keep duplicates for the client end.
+    int32_t clientRequestDoorbell = dup(requestDoorbell);
+    int32_t clientResponseDoorbell = dup(responseDoorbell);
+
+    std::shared_ptr<ShmServer> shmServer = ShmServer::getInstance();
+    int32_t channelId = shmServer->attachChannel(-101, memFd, requestDoorbell, responseDoorbell);
+    MT_REQUIRE(ctx, channelId >= 0);
+    MT_REQUIRE(ctx, shmServer->isChannel(channelId));
+
+    // Client end: publish two Requests and ring the doorbell once.
+    MT_REQUIRE(ctx, shmRingPush(&region->mRequestRing, "req1", 4));
+    MT_REQUIRE(ctx, shmRingPush(&region->mRequestRing, "req2", 4));
+    uint64_t doorbell = 1;
+    MT_REQUIRE_EQ(ctx, write(clientRequestDoorbell, &doorbell, sizeof(doorbell)), (ssize_t)sizeof(doorbell));
+
+    listenIterations = 0;
+    receivedPayloads.clear();
+    shmServer->setCallbacks(listenOnce, recordMessage);
+    MT_REQUIRE_EQ(ctx, shmServer->ListenForClientRequests(), RC_SUCCESS);
+
+    MT_REQUIRE_EQ(ctx, receivedPayloads.size(), (size_t)2);
+    MT_REQUIRE_EQ(ctx, receivedPayloads[0], std::string("req1"));
+    MT_REQUIRE_EQ(ctx, receivedPayloads[1], std::string("req2"));
+
+    int64_t handle = 77;
+    MT_REQUIRE(ctx, shmServer->sendReply(channelId, &handle, sizeof(handle)));
+    MT_REQUIRE_EQ(ctx, read(clientResponseDoorbell, &doorbell, sizeof(doorbell)), (ssize_t)sizeof(doorbell));
+
+    int64_t receivedHandle = -1;
+    MT_REQUIRE_EQ(ctx, shmRingPop(&region->mResponseRing, &receivedHandle, sizeof(receivedHandle)),
+                  (int32_t)sizeof(int64_t));
+    MT_REQUIRE_EQ(ctx, receivedHandle, handle);
+
+    // Closing the owning socket tears the channel down.
+    shmServer->detachOwner(-101);
+    MT_REQUIRE(ctx, !shmServer->isChannel(channelId));
+    MT_REQUIRE(ctx, !shmServer->sendReply(channelId, &handle, sizeof(handle)));
+
+    munmap(region, sizeof(ShmRegion));
+    close(clientRequestDoorbell);
+    close(clientResponseDoorbell);
+}
+
+MT_TEST(Component, ShmChannelDetachedOnResponseOverflow, "shmtransport") {
+    int32_t memFd = -1;
+    ShmRegion* region = createRegion(memFd, true);
+    MT_REQUIRE(ctx, region != nullptr);
+
+    std::shared_ptr<ShmServer> shmServer = ShmServer::getInstance();
+    int32_t channelId = shmServer->attachChannel(-102, memFd, eventfd(0, EFD_NONBLOCK), eventfd(0, EFD_NONBLOCK));
+    MT_REQUIRE(ctx, channelId >= 0);
+
+    // The client never collects the Responses.
+    int64_t handle = 1;
+    for(int32_t i = 0; i < SHM_RING_SLOT_COUNT; i++) {
+        MT_REQUIRE(ctx, shmServer->sendReply(channelId, &handle, sizeof(handle)));
+    }
+
+    // A dropped Response would shift every later one onto the wrong Request, hence
+    // the channel is detached rather than left attached with a gap in its Responses.
+    MT_REQUIRE(ctx, !shmServer->sendReply(channelId, &handle, sizeof(handle)));
+    MT_REQUIRE(ctx, !shmServer->isChannel(channelId));
+    MT_REQUIRE(ctx, !shmServer->sendReply(channelId, &handle, sizeof(handle)));
+
+    munmap(region, sizeof(ShmRegion));
+}
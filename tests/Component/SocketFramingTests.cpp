@@ -0,0 +1,269 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "TestUtils.h"
+#include "RestuneListener.h"
+#include "RequestReceiver.h"
+#include "TestAggregator.h"
+
+#define MTEST_NO_MAIN
+#include "../framework/mini.h"
+
+using namespace mtest;
+
+// Suite: SocketFramingTests
+
+MT_TEST(Component, FramesAreLengthPrefixed, "socketframing") {
+    int32_t fds[2];
+    MT_REQUIRE_EQ(ctx, socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    int64_t firstHandle = 17, secondHandle = 42;
+    MT_REQUIRE(ctx, SocketServer::sendFrame(fds[0], &firstHandle, sizeof(int64_t)));
+    MT_REQUIRE(ctx, SocketServer::sendFrame(fds[0], &secondHandle, sizeof(int64_t)));
+
+    // Both frames are delivered back to back on the same connection.
+    char buf[2 * (sizeof(uint32_t) + sizeof(int64_t))];
+    MT_REQUIRE_EQ(ctx, read(fds[1], buf, sizeof(buf)), (ssize_t)sizeof(buf));
+
+    uint32_t frameSize = 0;
+    int64_t handle = -1;
+    std::memcpy(&frameSize, buf, sizeof(uint32_t));
+    std::memcpy(&handle, buf + sizeof(uint32_t), sizeof(int64_t));
+    MT_REQUIRE_EQ(ctx, frameSize, (uint32_t)sizeof(int64_t));
+    MT_REQUIRE_EQ(ctx, handle, firstHandle);
+
+    std::memcpy(&frameSize, buf + sizeof(uint32_t) + sizeof(int64_t), sizeof(uint32_t));
+    std::memcpy(&handle, buf + 2 * sizeof(uint32_t) + sizeof(int64_t), sizeof(int64_t));
+    MT_REQUIRE_EQ(ctx, frameSize, (uint32_t)sizeof(int64_t));
+    MT_REQUIRE_EQ(ctx, handle, secondHandle);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+MT_TEST(Component, OversizedFramesAreRejected, "socketframing") {
+    int32_t fds[2];
+    MT_REQUIRE_EQ(ctx, socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    char payload[RESTUNE_MAX_FRAME_SIZE + 1] = {0};
+    MT_REQUIRE(ctx, !SocketServer::sendFrame(fds[0], payload, sizeof(payload)));
+    MT_REQUIRE(ctx, !SocketServer::sendFrame(-1, payload, 1));
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+MT_TEST(Component, FailedSendsShutTheConnectionDown, "socketframing") {
+    int32_t fds[2];
+    MT_REQUIRE_EQ(ctx, socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    MT_REQUIRE(ctx, fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0);
+
+    std::shared_ptr<ClientConnection> connection(new ClientConnection);
+    connection->mFd = fds[0];
+    connection->mFailed.store(false);
+
+    // The client never reads, the send eventually times out, possibly mid-frame.
+    static char payload[RESTUNE_MAX_FRAME_SIZE];
+    int32_t sentCount = 0;
+    while(sentCount < 1024 && SocketServer::sendFrame(connection, payload, sizeof(payload))) {
+        sentCount++;
+    }
+    MT_REQUIRE(ctx, sentCount < 1024);
+    MT_REQUIRE(ctx, connection->mFailed.load());
+
+    // Nothing more is sent on it, and the client sees the end of the stream.
+    int64_t handle = 1;
+    MT_REQUIRE(ctx, !SocketServer::sendFrame(connection, &handle, sizeof(handle)));
+
+    ssize_t bytesRead = 0;
+    while((bytesRead = read(fds[1], payload, sizeof(payload))) > 0);
+    MT_REQUIRE_EQ(ctx, bytesRead, (ssize_t)0);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+MT_TEST(Component, ForwardInfoKeepsThePayloadSize, "socketframing") {
+    MakeAlloc<MsgForwardInfo> (2);
+    MakeAlloc<char[REQ_SMALL_BUFFER_SIZE]> (2);
+
+    char payload[WIRE_HEADER_SIZE + 1] = {MOD_RESTUNE, REQ_RESOURCE_TUNING, WIRE_FORMAT_VERSION, 0};
+    MsgForwardInfo* info = createForwardInfo(payload, sizeof(payload));
+    MT_REQUIRE(ctx, info != nullptr);
+
+    // The decoders are bounded by the payload, not by the (zero-padded) size class.
+    MT_REQUIRE_EQ(ctx, info->mPayloadSize, (uint64_t)sizeof(payload));
+    MT_REQUIRE_EQ(ctx, info->mBufferSize, (uint64_t)REQ_SMALL_BUFFER_SIZE);
+
+    Request request;
+    MT_REQUIRE(ctx, RC_IS_NOTOK(request.deserialize(info->mBuffer, info->mPayloadSize)));
+
+    freeForwardInfo(info);
+}
+
+MT_TEST(Component, BatchRepliesWithOneHandlePerRequest, "socketframing") {
+    MakeAlloc<MsgForwardInfo> (8);
+    MakeAlloc<char[REQ_BUFFER_SIZE]> (8);
+    MakeAlloc<char[REQ_BATCH_BUFFER_SIZE]> (1);
+
+    int32_t fds[2];
+    MT_REQUIRE_EQ(ctx, socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    MsgForwardInfo* info = new (GetBlock<MsgForwardInfo>()) MsgForwardInfo;
+    info->mBuffer = new (GetBlock<char[REQ_BATCH_BUFFER_SIZE]>()) char[REQ_BATCH_BUFFER_SIZE];
+    info->mBufferSize = REQ_BATCH_BUFFER_SIZE;
+    std::memset(info->mBuffer, 0, REQ_BATCH_BUFFER_SIZE);
+
+    // [Module ID][REQ_BATCH][int32_t Count]{[uint32_t Length][Request]} x Count
+    int32_t count = 3;
+    info->mBuffer[0] = MOD_RESTUNE;
+    info->mBuffer[1] = REQ_BATCH;
+    std::memcpy(info->mBuffer + 2, &count, sizeof(int32_t));
+
+    char* cursor = info->mBuffer + 2 + sizeof(int32_t);
+    for(int32_t i = 0; i < count; i++) {
+        uint32_t reqSize = 2;
+        std::memcpy(cursor, &reqSize, sizeof(uint32_t));
+        cursor[sizeof(uint32_t)] = MOD_RESTUNE;
+        cursor[sizeof(uint32_t) + 1] = REQ_RESOURCE_TUNING;
+        cursor += sizeof(uint32_t) + reqSize;
+    }
+    info->mPayloadSize = cursor - info->mBuffer;
+
+    // The Thread Pool is not running, hence each Request is rejected,
+    // but a reply is still sent covering every Request in the batch.
+    RequestReceiver::getInstance()->forwardMessage(fds[0], info);
+
+    uint32_t frameSize = 0;
+    int64_t handles[3] = {0, 0, 0};
+    MT_REQUIRE_EQ(ctx, read(fds[1], &frameSize, sizeof(uint32_t)), (ssize_t)sizeof(uint32_t));
+    MT_REQUIRE_EQ(ctx, frameSize, (uint32_t)sizeof(handles));
+    MT_REQUIRE_EQ(ctx, read(fds[1], handles, sizeof(handles)), (ssize_t)sizeof(handles));
+
+    for(int32_t i = 0; i < count; i++) {
+        MT_REQUIRE_EQ(ctx, handles[i], (int64_t)-1);
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+MT_TEST(Component, LeasedHandleRejectionsAreNotified, "socketframing") {
+    MakeAlloc<MsgForwardInfo> (8);
+    MakeAlloc<char[REQ_BUFFER_SIZE]> (8);
+
+    int32_t fds[2];
+    MT_REQUIRE_EQ(ctx, socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    auto makeRequest = [](int8_t requestType, int64_t handle) {
+        MsgForwardInfo* info = new (GetBlock<MsgForwardInfo>()) MsgForwardInfo;
+        info->mBuffer = new (GetBlock<char[REQ_BUFFER_SIZE]>()) char[REQ_BUFFER_SIZE];
+        info->mBufferSize = info->mPayloadSize = REQ_BUFFER_SIZE;
+        std::memset(info->mBuffer, 0, REQ_BUFFER_SIZE);
+        info->mBuffer[0] = MOD_RESTUNE;
+        info->mBuffer[1] = requestType;
+        info->mBuffer[2] = WIRE_FORMAT_VERSION;
+        wireEncodeVarint(info->mBuffer + WIRE_HEADER_SIZE, 16, wireZigZag(handle));
+        return info;
+    };
+
+    // The lease is the first handle of a block reserved for this connection.
+    RequestReceiver::getInstance()->forwardMessage(fds[0], makeRequest(REQ_HANDLE_LEASE, 0));
+
+    uint32_t frameSize = 0;
+    int64_t firstHandle = -1;
+    MT_REQUIRE_EQ(ctx, read(fds[1], &frameSize, sizeof(uint32_t)), (ssize_t)sizeof(uint32_t));
+    MT_REQUIRE_EQ(ctx, frameSize, (uint32_t)sizeof(int64_t));
+    MT_REQUIRE_EQ(ctx, read(fds[1], &firstHandle, sizeof(int64_t)), (ssize_t)sizeof(int64_t));
+    MT_REQUIRE(ctx, firstHandle > 0);
+    MT_REQUIRE(ctx, AuxRoutines::generateUniqueHandle() >= firstHandle + HANDLE_LEASE_SIZE);
+
+    // Leased Requests get no reply, a rejection (here, the Thread Pool is not running,
+    // or the handle was never leased) is reported via a notice carrying the handle.
+    int64_t handles[2] = {firstHandle, firstHandle + HANDLE_LEASE_SIZE};
+    for(int64_t handle: handles) {
+        RequestReceiver::getInstance()->forwardMessage(fds[0], makeRequest(REQ_RESOURCE_TUNING, handle));
+
+        int64_t notice[2] = {0, 0};
+        MT_REQUIRE_EQ(ctx, read(fds[1], &frameSize, sizeof(uint32_t)), (ssize_t)sizeof(uint32_t));
+        MT_REQUIRE_EQ(ctx, frameSize, (uint32_t)sizeof(notice));
+        MT_REQUIRE_EQ(ctx, read(fds[1], notice, sizeof(notice)), (ssize_t)sizeof(notice));
+        MT_REQUIRE_EQ(ctx, notice[0], (int64_t)REQ_REJECTION_MARKER);
+        MT_REQUIRE_EQ(ctx, notice[1], handle);
+    }
+
+    RequestReceiver::getInstance()->releaseHandleLeases(fds[0]);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+MT_TEST(Component, HandlerRejectionsOfLeasedHandlesAreNotified, "socketframing") {
+    MakeAlloc<MsgForwardInfo> (8);
+    MakeAlloc<char[REQ_BUFFER_SIZE]> (8);
+    MakeAlloc<Request> (8);
+
+    int32_t fds[2];
+    MT_REQUIRE_EQ(ctx, socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    auto makeRequest = [](int8_t requestType, int64_t handle) {
+        MsgForwardInfo* info = new (GetBlock<MsgForwardInfo>()) MsgForwardInfo;
+        info->mBuffer = new (GetBlock<char[REQ_BUFFER_SIZE]>()) char[REQ_BUFFER_SIZE];
+        info->mBufferSize = info->mPayloadSize = REQ_BUFFER_SIZE;
+        std::memset(info->mBuffer, 0, REQ_BUFFER_SIZE);
+        info->mBuffer[0] = MOD_RESTUNE;
+        info->mBuffer[1] = requestType;
+        info->mBuffer[2] = WIRE_FORMAT_VERSION;
+        wireEncodeVarint(info->mBuffer + WIRE_HEADER_SIZE, 16, wireZigZag(handle));
+        return info;
+    };
+
+    ThreadPool* threadPool = new ThreadPool(1, 1);
+    RequestReceiver::mRequestsThreadPool = threadPool;
+
+    RequestReceiver::getInstance()->forwardMessage(fds[0], makeRequest(REQ_HANDLE_LEASE, 0));
+
+    uint32_t frameSize = 0;
+    int64_t firstHandle = -1;
+    MT_REQUIRE_EQ(ctx, read(fds[1], &frameSize, sizeof(uint32_t)), (ssize_t)sizeof(uint32_t));
+    MT_REQUIRE_EQ(ctx, read(fds[1], &firstHandle, sizeof(int64_t)), (ssize_t)sizeof(int64_t));
+    MT_REQUIRE(ctx, firstHandle > 0);
+
+    // Dispatched successfully, but rejected by the Request handler (no Resources to tune),
+    // which reports it on the connection the Request was received over.
+    RequestReceiver::getInstance()->forwardMessage(fds[0], makeRequest(REQ_RESOURCE_TUNING, firstHandle));
+
+    int64_t notice[2] = {0, 0};
+    MT_REQUIRE_EQ(ctx, read(fds[1], &frameSize, sizeof(uint32_t)), (ssize_t)sizeof(uint32_t));
+    MT_REQUIRE_EQ(ctx, frameSize, (uint32_t)sizeof(notice));
+    MT_REQUIRE_EQ(ctx, read(fds[1], notice, sizeof(notice)), (ssize_t)sizeof(notice));
+    MT_REQUIRE_EQ(ctx, notice[0], (int64_t)REQ_REJECTION_MARKER);
+    MT_REQUIRE_EQ(ctx, notice[1], firstHandle);
+
+    RequestReceiver::getInstance()->releaseHandleLeases(fds[0]);
+    RequestReceiver::mRequestsThreadPool = nullptr;
+    delete threadPool;
+    close(fds[0]);
+    close(fds[1]);
+}
+
+MT_TEST(Component, PeerIdentityIsReportedByKernel, "socketframing") {
+    int32_t fds[2];
+    MT_REQUIRE_EQ(ctx, socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    PeerIdentity identity;
+    MT_REQUIRE(ctx, fetchPeerIdentity(fds[1], identity));
+    MT_REQUIRE_EQ(ctx, identity.mPID, (int32_t)getpid());
+    MT_REQUIRE_EQ(ctx, identity.mUID, (int32_t)geteuid());
+    MT_REQUIRE_EQ(ctx, identity.mLevel, (int8_t)(geteuid() == 0 ? PERMISSION_SYSTEM : PERMISSION_THIRD_PARTY));
+
+    close(fds[0]);
+    close(fds[1]);
+
+    // Without credentials, the identity is left unknown.
+    MT_REQUIRE(ctx, !fetchPeerIdentity(-1, identity));
+    MT_REQUIRE_EQ(ctx, identity.mPID, -1);
+    MT_REQUIRE_EQ(ctx, identity.mLevel, (int8_t)-1);
+}
@@ -0,0 +1,50 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include "TestUtils.h"
+#include "SysfsWriter.h"
+#include "TestAggregator.h"
+
+#define MTEST_NO_MAIN
+#include "../framework/mini.h"
+
+using namespace mtest;
+
+// Suite: SysfsWriterTests
+
+static const std::string testNodePath = "/etc/urm/tests/nodes/sysfs_writer_test_node.txt";
+
+MT_TEST(Component, SysfsWriterInlineWhenNotStarted, "sysfswriter") {
+    AuxRoutines::writeToFile(testNodePath, "0");
+
+    SysfsWriter::getInstance()->post(testNodePath, "42");
+    MT_REQUIRE_EQ(ctx, AuxRoutines::readFromFile(testNodePath), std::string("42"));
+
+    AuxRoutines::deleteFile(testNodePath);
+}
+
+MT_TEST(Component, SysfsWriterLastWriterWins, "sysfswriter") {
+    AuxRoutines::writeToFile(testNodePath, "0");
+    std::shared_ptr<SysfsWriter> writer = SysfsWriter::getInstance();
+
+    uint64_t postedBefore = writer->getPostedCount();
+    uint64_t supersededBefore = writer->getSupersededCount();
+    uint64_t writtenBefore = writer->getWrittenCount();
+
+    MT_REQUIRE_EQ(ctx, writer->start(), RC_SUCCESS);
+    for(int32_t i = 1; i <= 500; i++) {
+        writer->post(testNodePath, std::to_string(i));
+    }
+    writer->flush();
+
+    MT_REQUIRE_EQ(ctx, AuxRoutines::readFromFile(testNodePath), std::string("500"));
+
+    uint64_t posted = writer->getPostedCount() - postedBefore;
+    uint64_t superseded = writer->getSupersededCount() - supersededBefore;
+    uint64_t written = writer->getWrittenCount() - writtenBefore;
+    MT_REQUIRE_EQ(ctx, posted, (uint64_t)500);
+    MT_REQUIRE_EQ(ctx, superseded + written, posted);
+
+    writer->stop();
+    AuxRoutines::deleteFile(testNodePath);
+}
@@ -0,0 +1,180 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#include <thread>
+#include <vector>
+
+#include "TuneCoalescer.h"
+
+#define MTEST_NO_MAIN
+#include "../framework/mini.h"
+
+using namespace mtest;
+
+// Suite: TuneCoalescerTests
+
+static std::vector<std::pair<int64_t, int64_t>> retunesIssued;
+
+static int8_t acceptRetune(int64_t handle, int64_t duration) {
+    retunesIssued.push_back({handle, duration});
+    return 0;
+}
+
+static int8_t rejectRetune(int64_t handle, int64_t duration) {
+    retunesIssued.push_back({handle, duration});
+    return -1;
+}
+
+static SysResource makeResource(uint32_t resCode, int32_t value) {
+    SysResource resource;
+    std::memset(&resource, 0, sizeof(resource));
+    resource.mResCode = resCode;
+    resource.mNumValues = 1;
+    resource.mResValue.value = value;
+    return resource;
+}
+
+MT_TEST(Component, CoalescingKeyCoversThreadPropertiesAndResources, "tunecoalescer") {
+    SysResource resources[2] = {makeResource(0x00030000, 700), makeResource(0x00030001, 900)};
+    std::string key = TuneCoalescer::makeKey(100, 0, 2, resources);
+
+    MT_REQUIRE(ctx, key == TuneCoalescer::makeKey(100, 0, 2, resources));
+    MT_REQUIRE(ctx, key != TuneCoalescer::makeKey(101, 0, 2, resources));
+    MT_REQUIRE(ctx, key != TuneCoalescer::makeKey(100, 1, 2, resources));
+    MT_REQUIRE(ctx, key != TuneCoalescer::makeKey(100, 0, 1, resources));
+
+    SysResource changed[2] = {makeResource(0x00030000, 700), makeResource(0x00030001, 901)};
+    MT_REQUIRE(ctx, key != TuneCoalescer::makeKey(100, 0, 2, changed));
+}
+
+MT_TEST(Component, CoalescingServesIdenticalTunes, "tunecoalescer") {
+    TuneCoalescer coalescer;
+    coalescer.setWindow(std::chrono::milliseconds(1000));
+    retunesIssued.clear();
+
+    SysResource resource = makeResource(0x00030000, 700);
+    std::string key = TuneCoalescer::makeKey(100, 0, 1, &resource);
+    std::string otherKey = TuneCoalescer::makeKey(101, 0, 1, &resource);
+
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 5000, acceptRetune), -1);
+    coalescer.track(key, 42, 5000);
+
+    // The tracked Request outlasts the new one, no Retune is needed.
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 3000, acceptRetune), 42);
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(otherKey, 3000, acceptRetune), -1);
+    MT_REQUIRE(ctx, retunesIssued.empty());
+
+    UrmCoalescingStats stats;
+    coalescer.getStats(&stats);
+    MT_REQUIRE_EQ(ctx, stats.tuneRequests, 3);
+    MT_REQUIRE_EQ(ctx, stats.coalesced, 1);
+    MT_REQUIRE_EQ(ctx, stats.retunesSent, 0);
+}
+
+MT_TEST(Component, CoalescingExtendsTheTrackedRequest, "tunecoalescer") {
+    TuneCoalescer coalescer;
+    coalescer.setWindow(std::chrono::milliseconds(1000));
+    retunesIssued.clear();
+
+    SysResource resource = makeResource(0x00030000, 700);
+    std::string key = TuneCoalescer::makeKey(100, 0, 1, &resource);
+    coalescer.track(key, 42, 2000);
+
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 8000, acceptRetune), 42);
+    MT_REQUIRE_EQ(ctx, retunesIssued.size(), 1);
+    MT_REQUIRE_EQ(ctx, retunesIssued[0].first, 42);
+    MT_REQUIRE_EQ(ctx, retunesIssued[0].second, 8000);
+
+    // The extended duration is tracked, a shorter Request is served without a Retune.
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 6000, acceptRetune), 42);
+    MT_REQUIRE_EQ(ctx, retunesIssued.size(), 1);
+
+    UrmCoalescingStats stats;
+    coalescer.getStats(&stats);
+    MT_REQUIRE_EQ(ctx, stats.coalesced, 2);
+    MT_REQUIRE_EQ(ctx, stats.retunesSent, 1);
+}
+
+MT_TEST(Component, CoalescingFallsBackWhenTheRetuneIsRejected, "tunecoalescer") {
+    TuneCoalescer coalescer;
+    coalescer.setWindow(std::chrono::milliseconds(1000));
+    retunesIssued.clear();
+
+    SysResource resource = makeResource(0x00030000, 700);
+    std::string key = TuneCoalescer::makeKey(100, 0, 1, &resource);
+    coalescer.track(key, 42, 2000);
+
+    // The Server dropped the Request, a new one has to be issued.
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 8000, rejectRetune), -1);
+    MT_REQUIRE_EQ(ctx, retunesIssued.size(), 1);
+
+    // And the stale handle is not served anymore.
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 1000, acceptRetune), -1);
+    MT_REQUIRE_EQ(ctx, retunesIssued.size(), 1);
+
+    UrmCoalescingStats stats;
+    coalescer.getStats(&stats);
+    MT_REQUIRE_EQ(ctx, stats.coalesced, 0);
+    MT_REQUIRE_EQ(ctx, stats.retunesSent, 0);
+}
+
+MT_TEST(Component, CoalescingRefusesShorterDurationsWhichNeedARetune, "tunecoalescer") {
+    TuneCoalescer coalescer;
+    coalescer.setWindow(std::chrono::milliseconds(1000));
+    retunesIssued.clear();
+
+    SysResource resource = makeResource(0x00030000, 700);
+    std::string key = TuneCoalescer::makeKey(100, 0, 1, &resource);
+    coalescer.track(key, 42, 2000);
+
+    // Issued later, the new Request would outlast the tracked one, but the Server
+    // does not accept a Retune to a shorter duration.
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 1900, acceptRetune), -1);
+    MT_REQUIRE(ctx, retunesIssued.empty());
+
+    // The entry is dropped, the new Request takes its place.
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 100000, acceptRetune), -1);
+    MT_REQUIRE(ctx, retunesIssued.empty());
+}
+
+MT_TEST(Component, CoalescingSkipsExpiringAndStaleRequests, "tunecoalescer") {
+    TuneCoalescer coalescer;
+    coalescer.setWindow(std::chrono::milliseconds(200));
+    retunesIssued.clear();
+
+    SysResource resource = makeResource(0x00030000, 700);
+    std::string key = TuneCoalescer::makeKey(100, 0, 1, &resource);
+
+    // Too close to expiry to be extended in time.
+    coalescer.track(key, 42, 50);
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 5000, acceptRetune), -1);
+
+    // Outside the window.
+    coalescer.track(key, 43, 5000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 1000, acceptRetune), -1);
+    MT_REQUIRE(ctx, retunesIssued.empty());
+}
+
+MT_TEST(Component, CoalescingForgetsUntunedRequests, "tunecoalescer") {
+    TuneCoalescer coalescer;
+    coalescer.setWindow(std::chrono::milliseconds(1000));
+    retunesIssued.clear();
+
+    SysResource resources[2] = {makeResource(0x00030000, 700), makeResource(0x00030001, 900)};
+    std::string key = TuneCoalescer::makeKey(100, 0, 1, &resources[0]);
+    std::string otherKey = TuneCoalescer::makeKey(100, 0, 1, &resources[1]);
+    coalescer.track(key, 42, 5000);
+    coalescer.track(otherKey, 43, 5000);
+
+    coalescer.forget(42);
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(key, 1000, acceptRetune), -1);
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(otherKey, 1000, acceptRetune), 43);
+
+    // Disabling coalescing drops all of them.
+    coalescer.setWindow(std::chrono::milliseconds(0));
+    coalescer.setWindow(std::chrono::milliseconds(1000));
+    MT_REQUIRE_EQ(ctx, coalescer.coalesce(otherKey, 1000, acceptRetune), -1);
+    MT_REQUIRE(ctx, retunesIssued.empty());
+}
@@ -76,6 +76,14 @@ int32_t main(int32_t argc, char *argv[]) {
         }
     }
 
+    if(RC_IS_OK(opStatus)) {
+        // The Logger is configured as part of the resource-tuner init, from here on
+        // hand the writes off to the background sink.
+        if(!Logger::startSink()) {
+            TYPELOGV(SYSTEM_THREAD_CREATION_FAILURE, "logger-sink", "sink not started");
+        }
+    }
+
     if(RC_IS_OK(opStatus)) {
         opStatus = initModuleIfPresent(ModuleID::MOD_CLASSIFIER);
         if(RC_IS_NOTOK(opStatus)) {
@@ -99,6 +107,7 @@ int32_t main(int32_t argc, char *argv[]) {
     cleanupModule(ModuleID::MOD_RESTUNE);
     cleanupModule(ModuleID::MOD_CLASSIFIER);
 
+    Logger::stopSink();
     closelog();
     return 0;
 }